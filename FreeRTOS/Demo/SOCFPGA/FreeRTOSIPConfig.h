@@ -354,7 +354,9 @@
 #define ipconfigTCP_MAY_LOG_PORT( xPort )    ((xPort) != 23U)
 
 /* AGX5-added */
-#define ipconfigZERO_COPY_RX_DRIVER               (0)
+/* Received frames are passed up in the buffer the DMA wrote them to, the
+ * driver refills the Rx ring from a reserve of network buffers */
+#define ipconfigZERO_COPY_RX_DRIVER               (1)
 
 #define ipconfigZERO_COPY_TX_DRIVER               (0)
 
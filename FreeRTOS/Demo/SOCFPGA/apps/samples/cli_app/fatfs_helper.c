@@ -11,6 +11,7 @@
 #include "ff_sys.h"
 #include <stdio.h>
 #include "fatfs_helper.h"
+#include "socfpga_sdmmc_bcache.h"
 
 #define MOUNTED        1
 #define UNMOUNTED      0
@@ -224,6 +225,10 @@ void ff_un_mount( disk_type_t dtype)
     if (DiskObj != NULL)
     {
         FF_Unmount(DiskObj);
+        if ((dtype == DISK_TYPE_SDMMC) && (sdmmc_bcache_flush() != 0))
+        {
+            printf("\r Failed to write back cached blocks \n");
+        }
         FF_SDDiskDelete(DiskObj);
         printf("\r Unmounting Successful \n");
         if( dtype == DISK_TYPE_SDMMC)
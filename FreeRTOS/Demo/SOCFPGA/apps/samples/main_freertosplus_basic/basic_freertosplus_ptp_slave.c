@@ -0,0 +1,331 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (C) 2025 Altera Corporation
+ *
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Sample application which disciplines the XGMAC hardware clock to a PTP
+ * master using the hardware timestamps of the network interface.
+ */
+
+#include <string.h>
+#include "main_freertosplus_basic.h"
+#include "SocfpgaNetworkInterface.h"
+
+/**
+ * @file basic_freertosplus_ptp_slave.c
+ * @brief Minimal IEEE 1588 slave using the XGMAC hardware timestamps.
+ */
+
+/**
+ * @defgroup ptp_slave_sample Ethernet - PTP Slave
+ * @ingroup samples
+ *
+ * Sample Application to synchronise the XGMAC hardware clock to a PTP master
+ *
+ * @details
+ * @section ptp_desc Description
+ * The XGMAC stamps PTP event messages with its hardware clock when they
+ * cross the MAC. This sample runs a minimal end-to-end PTPv2 slave over
+ * UDP/IPv4:
+ * - The master time t1 is taken from Sync, or from Follow_Up for a two-step
+ *   master, and the receive time t2 from the Sync hardware timestamp.
+ * - A Delay_Req is sent, its transmit time t3 is read back from the MAC and
+ *   the master receive time t4 is taken from the Delay_Resp.
+ * - The clock offset ((t2 - t1) - (t4 - t3)) / 2 is removed with a step
+ *   when it is large and with a PI frequency servo otherwise.
+ *
+ * @section ptp_pre Prerequisites
+ * - Ensure FreeRTOS+TCP is correctly configured and integrated with the network driver.
+ * - A PTP master on the same LAN using UDP/IPv4 and the end-to-end delay
+ *   mechanism, for example a Linux host running `ptp4l -i eth0 -H -4 -m`.
+ * - XGMAC_PTP_CLK_HZ must match the PTP reference clock of the board.
+ *
+ * @section ptp_howto How to Run
+ * 1. Set DEMO_PTP_SLAVE to 1 in main_freertosplus_basic.h.
+ * 2. Follow the platform-specific README to build and flash the application.
+ * 3. Connect the device to a LAN where the PTP master resides.
+ *
+ * @section ptp_res Expected Results
+ * - One line is printed per Sync interval, for example:
+ *   - `PTP offset -42 ns delay 1250 ns freq -3120 ppb`
+ * - After a step on the first exchanges the offset settles within a few
+ *   tens of nanoseconds.
+ * @{
+ */
+/** @} */
+
+#define PTP_EVENT_PORT              319U
+#define PTP_GENERAL_PORT            320U
+#define PTP_PRIMARY_GROUP           "224.0.1.129"
+
+#define PTP_MSG_SYNC                0x0U
+#define PTP_MSG_DELAY_REQ           0x1U
+#define PTP_MSG_FOLLOW_UP           0x8U
+#define PTP_MSG_DELAY_RESP          0x9U
+
+#define PTP_HEADER_LENGTH           34U
+#define PTP_DELAY_REQ_LENGTH        44U
+#define PTP_DELAY_RESP_LENGTH       54U
+#define PTP_FLAG_TWO_STEP           0x02U
+#define PTP_CTRL_DELAY_REQ          0x01U
+
+/* Offsets above this are stepped out rather than slewed */
+#define PTP_STEP_THRESHOLD_NS       1000000LL
+#define PTP_MAX_ADJ_PPB             500000LL
+#define PTP_RX_TIMEOUT_MS           2000U
+#define PTP_TX_TIMESTAMP_POLLS      10U
+
+#define PTP_NSEC_PER_SEC            1000000000LL
+
+static uint8_t ucPortIdentity[ 10 ];
+
+static uint16_t prvGet16( const uint8_t *pucBuf )
+{
+    return (uint16_t)( ( (uint16_t)pucBuf[ 0 ] << 8 ) | pucBuf[ 1 ] );
+}
+
+/* 48 bit seconds and 32 bit nanoseconds, big-endian, to nanoseconds */
+static int64_t prvReadTimestamp( const uint8_t *pucBuf )
+{
+    uint64_t ullSec = 0U;
+    uint32_t ulNsec = 0U;
+
+    for (uint32_t i = 0; i < 6U; i++)
+    {
+        ullSec = ( ullSec << 8 ) | pucBuf[ i ];
+    }
+    for (uint32_t i = 6U; i < 10U; i++)
+    {
+        ulNsec = ( ulNsec << 8 ) | pucBuf[ i ];
+    }
+
+    return ( (int64_t)ullSec * PTP_NSEC_PER_SEC ) + (int64_t)ulNsec;
+}
+
+/* correctionField is in nanoseconds scaled by 2^16 */
+static int64_t prvReadCorrection( const uint8_t *pucHeader )
+{
+    uint64_t ullVal = 0U;
+
+    for (uint32_t i = 8U; i < 16U; i++)
+    {
+        ullVal = ( ullVal << 8 ) | pucHeader[ i ];
+    }
+
+    return ( (int64_t)ullVal ) / 65536;
+}
+
+static int64_t prvTimestampToNs( const NetworkTimestamp_t *pxTime )
+{
+    return ( (int64_t)pxTime->ullSeconds * PTP_NSEC_PER_SEC ) +
+           (int64_t)pxTime->ulNanoseconds;
+}
+
+/* Receive until a message of the given type and sequence id arrives */
+static BaseType_t prvWaitMessage( Socket_t xSocket, uint8_t ucType,
+        uint16_t usSequenceId, uint8_t *pucBuf, size_t uxMinLength )
+{
+    TickType_t xStart = xTaskGetTickCount();
+    int32_t lLen;
+
+    while ( ( xTaskGetTickCount() - xStart ) < pdMS_TO_TICKS(PTP_RX_TIMEOUT_MS) )
+    {
+        lLen = FreeRTOS_recvfrom(xSocket, pucBuf, BUFFER_SIZE, 0, NULL, NULL);
+        if ( lLen < (int32_t)uxMinLength )
+        {
+            continue;
+        }
+        if ( ( ( pucBuf[ 0 ] & 0x0FU ) == ucType ) &&
+             ( prvGet16( &pucBuf[ 30 ] ) == usSequenceId ) )
+        {
+            return pdPASS;
+        }
+    }
+
+    return pdFAIL;
+}
+
+static void prvBuildDelayReq( uint8_t *pucBuf, uint16_t usSequenceId )
+{
+    memset( pucBuf, 0, PTP_DELAY_REQ_LENGTH );
+    pucBuf[ 0 ] = PTP_MSG_DELAY_REQ;
+    pucBuf[ 1 ] = 2U;
+    pucBuf[ 3 ] = PTP_DELAY_REQ_LENGTH;
+    memcpy( &pucBuf[ 20 ], ucPortIdentity, sizeof(ucPortIdentity) );
+    pucBuf[ 30 ] = (uint8_t)( usSequenceId >> 8 );
+    pucBuf[ 31 ] = (uint8_t)usSequenceId;
+    pucBuf[ 32 ] = PTP_CTRL_DELAY_REQ;
+    pucBuf[ 33 ] = 0x7FU;
+}
+
+static Socket_t prvOpenSocket( uint16_t usPort )
+{
+    struct freertos_sockaddr xBindAddress;
+    const TickType_t xTimeOut = pdMS_TO_TICKS(200);
+    Socket_t xSocket;
+
+    xSocket = FreeRTOS_socket(FREERTOS_AF_INET, FREERTOS_SOCK_DGRAM, FREERTOS_IPPROTO_UDP);
+    configASSERT( xSocket != FREERTOS_INVALID_SOCKET );
+
+    FreeRTOS_setsockopt( xSocket, 0, FREERTOS_SO_RCVTIMEO, &xTimeOut,
+            sizeof( xTimeOut ) );
+    FreeRTOS_setsockopt( xSocket, 0, FREERTOS_SO_SNDTIMEO, &xTimeOut,
+            sizeof( xTimeOut ) );
+
+    memset( &xBindAddress, 0, sizeof(xBindAddress) );
+    xBindAddress.sin_port = FreeRTOS_htons(usPort);
+    xBindAddress.sin_family = FREERTOS_AF_INET;
+    FreeRTOS_bind( xSocket, &xBindAddress, sizeof(xBindAddress) );
+
+    return xSocket;
+}
+
+/* PTP slave */
+void vPTPSlaveTask( void *pvParameters )
+{
+    (void)pvParameters;
+    struct freertos_sockaddr xMaster;
+    static uint8_t ucBuffer[ BUFFER_SIZE ];
+    Socket_t xEventSocket, xGeneralSocket;
+    NetworkTimestamp_t xTime;
+    const uint8_t *pucMAC;
+    int64_t t1, t2, t3, t4;
+    int64_t llOffset, llDelay, llIntegral = 0, llPpb;
+    uint16_t usSyncSeq, usDelaySeq = 0U;
+    BaseType_t xGotTime;
+
+    /* Wait for network initalization */
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+    if (xNetworkInterfacePTPEnable(0, pdTRUE) != pdPASS)
+    {
+        FreeRTOS_printf(("PTP is not supported by the interface\n"));
+        vTaskDelete(NULL);
+        return;
+    }
+
+    /* EUI-64 clock identity from the MAC address, port number 1 */
+    pucMAC = FreeRTOS_GetMACAddress();
+    ucPortIdentity[ 0 ] = pucMAC[ 0 ];
+    ucPortIdentity[ 1 ] = pucMAC[ 1 ];
+    ucPortIdentity[ 2 ] = pucMAC[ 2 ];
+    ucPortIdentity[ 3 ] = 0xFFU;
+    ucPortIdentity[ 4 ] = 0xFEU;
+    ucPortIdentity[ 5 ] = pucMAC[ 3 ];
+    ucPortIdentity[ 6 ] = pucMAC[ 4 ];
+    ucPortIdentity[ 7 ] = pucMAC[ 5 ];
+    ucPortIdentity[ 8 ] = 0U;
+    ucPortIdentity[ 9 ] = 1U;
+
+    xEventSocket = prvOpenSocket(PTP_EVENT_PORT);
+    xGeneralSocket = prvOpenSocket(PTP_GENERAL_PORT);
+
+    memset( &xMaster, 0, sizeof(xMaster) );
+    xMaster.sin_port = FreeRTOS_htons(PTP_EVENT_PORT);
+    xMaster.sin_family = FREERTOS_AF_INET;
+    xMaster.sin_address.ulIP_IPv4 = FreeRTOS_inet_addr(PTP_PRIMARY_GROUP);
+
+    for ( ;; )
+    {
+        /* Sync: t2 from the hardware, t1 from the message or its Follow_Up */
+        if (FreeRTOS_recvfrom(xEventSocket, ucBuffer, sizeof(ucBuffer), 0,
+                    NULL, NULL) < (int32_t)PTP_DELAY_REQ_LENGTH)
+        {
+            continue;
+        }
+        if ((ucBuffer[ 0 ] & 0x0FU) != PTP_MSG_SYNC)
+        {
+            continue;
+        }
+        usSyncSeq = prvGet16( &ucBuffer[ 30 ] );
+        if (xNetworkInterfaceGetRxTimestamp(0, PTP_MSG_SYNC, usSyncSeq,
+                    &xTime) != pdPASS)
+        {
+            continue;
+        }
+        t2 = prvTimestampToNs( &xTime );
+
+        if ((ucBuffer[ 6 ] & PTP_FLAG_TWO_STEP) != 0U)
+        {
+            t2 -= prvReadCorrection( ucBuffer );
+            if (prvWaitMessage(xGeneralSocket, PTP_MSG_FOLLOW_UP, usSyncSeq,
+                        ucBuffer, PTP_DELAY_REQ_LENGTH) != pdPASS)
+            {
+                continue;
+            }
+        }
+        t1 = prvReadTimestamp( &ucBuffer[ PTP_HEADER_LENGTH ] ) +
+             prvReadCorrection( ucBuffer );
+
+        /* Delay_Req: t3 from the MAC once the frame has left */
+        prvBuildDelayReq( ucBuffer, usDelaySeq );
+        if (FreeRTOS_sendto(xEventSocket, ucBuffer, PTP_DELAY_REQ_LENGTH, 0,
+                    &xMaster, sizeof(xMaster)) <= 0)
+        {
+            continue;
+        }
+        xGotTime = pdFAIL;
+        for (uint32_t i = 0; (i < PTP_TX_TIMESTAMP_POLLS) && (xGotTime != pdPASS); i++)
+        {
+            vTaskDelay(pdMS_TO_TICKS(1));
+            xGotTime = xNetworkInterfaceGetTxTimestamp(0, &xTime);
+        }
+        if (xGotTime != pdPASS)
+        {
+            FreeRTOS_printf(("PTP Delay_Req %u not timestamped\n", usDelaySeq));
+            usDelaySeq++;
+            continue;
+        }
+        t3 = prvTimestampToNs( &xTime );
+
+        /* Delay_Resp: t4 as seen by the master */
+        if (prvWaitMessage(xGeneralSocket, PTP_MSG_DELAY_RESP, usDelaySeq,
+                    ucBuffer, PTP_DELAY_RESP_LENGTH) != pdPASS)
+        {
+            usDelaySeq++;
+            continue;
+        }
+        usDelaySeq++;
+        if (memcmp(&ucBuffer[ 44 ], ucPortIdentity, sizeof(ucPortIdentity)) != 0)
+        {
+            continue;
+        }
+        t4 = prvReadTimestamp( &ucBuffer[ PTP_HEADER_LENGTH ] ) -
+             prvReadCorrection( ucBuffer );
+
+        llOffset = ((t2 - t1) - (t4 - t3)) / 2;
+        llDelay = ((t2 - t1) + (t4 - t3)) / 2;
+
+        if ((llOffset > PTP_STEP_THRESHOLD_NS) || (llOffset < -PTP_STEP_THRESHOLD_NS))
+        {
+            xNetworkInterfacePTPAdjTime(0, -llOffset);
+            llIntegral = 0;
+            FreeRTOS_printf(("PTP step %ld ns\n", (long)-llOffset));
+            continue;
+        }
+
+        /* PI servo, one Sync per second makes ns of offset ppb of rate */
+        llIntegral += (llOffset * 3) / 10;
+        if (llIntegral > PTP_MAX_ADJ_PPB)
+        {
+            llIntegral = PTP_MAX_ADJ_PPB;
+        }
+        else if (llIntegral < -PTP_MAX_ADJ_PPB)
+        {
+            llIntegral = -PTP_MAX_ADJ_PPB;
+        }
+        llPpb = -(((llOffset * 7) / 10) + llIntegral);
+        if (llPpb > PTP_MAX_ADJ_PPB)
+        {
+            llPpb = PTP_MAX_ADJ_PPB;
+        }
+        else if (llPpb < -PTP_MAX_ADJ_PPB)
+        {
+            llPpb = -PTP_MAX_ADJ_PPB;
+        }
+        xNetworkInterfacePTPAdjFreq(0, (int32_t)llPpb);
+
+        FreeRTOS_printf(("PTP offset %ld ns delay %ld ns freq %ld ppb\n",
+                    (long)llOffset, (long)llDelay, (long)llPpb));
+    }
+}
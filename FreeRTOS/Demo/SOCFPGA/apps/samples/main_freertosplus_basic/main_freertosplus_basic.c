@@ -68,6 +68,8 @@ TaskHandle_t PingTaskHandle = NULL;
 TaskHandle_t TCPTaskHandle = NULL;
 TaskHandle_t UDPTaskHandle = NULL;
 TaskHandle_t EchoTCPServerTaskHandle = NULL;
+TaskHandle_t ScrubBenchTaskHandle = NULL;
+TaskHandle_t PTPSlaveTaskHandle = NULL;
 
 void vApplicationTickHook( void )
 {
@@ -128,6 +130,14 @@ void main_freertosplus_basic( void )
 
 #elif (DEMO_IPERF == 1)
     vIPerfInstall();
+#elif (DEMO_SCRUB_BENCH == 1)
+    /* Task to benchmark the Tx buffer scrub policies */
+    xReturned = xTaskCreate(vScrubBenchTask, "ScrubBench", configMINIMAL_STACK_SIZE*4,
+            NULL, tskIDLE_PRIORITY+1, &ScrubBenchTaskHandle);
+#elif (DEMO_PTP_SLAVE == 1)
+    /* Task to synchronise the hardware clock to a PTP master */
+    xReturned = xTaskCreate(vPTPSlaveTask, "PTPSlave", configMINIMAL_STACK_SIZE*4,
+            NULL, tskIDLE_PRIORITY+2, &PTPSlaveTaskHandle);
 #endif
     /* Start the scheduler */
     vTaskStartScheduler();
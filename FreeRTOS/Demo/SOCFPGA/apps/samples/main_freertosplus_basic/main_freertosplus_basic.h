@@ -26,6 +26,8 @@
 #define DEMO_UDP               0
 #define DEMO_ECHOTCP           1
 #define DEMO_IPERF             0
+#define DEMO_SCRUB_BENCH       0
+#define DEMO_PTP_SLAVE         0
 #define TCP_SERVER_PORT        9640
 #define UDP_SERVER_PORT        8897
 #define PING_SERVER_IP         "192.168.1.100"
@@ -47,6 +49,8 @@ void vPingTask( void *pvParameters );
 void vTCPServerTask( void *pvParameters );
 void vUDPServerTask( void *pvParameters );
 void vSimpleTCPServerTask( void *pvParameters );
+void vScrubBenchTask( void *pvParameters );
+void vPTPSlaveTask( void *pvParameters );
 
 /* This example code snippet assumes the queue has already been created! */
 extern QueueHandle_t xPingReplyQueue;
@@ -61,6 +65,12 @@ extern TaskHandle_t EchoTCPServerTaskHandle;
 /* UDP notify Handler */
 extern TaskHandle_t UDPTaskHandle;
 
+/* Scrub benchmark notify Handler */
+extern TaskHandle_t ScrubBenchTaskHandle;
+
+/* PTP slave notify Handler */
+extern TaskHandle_t PTPSlaveTaskHandle;
+
 /* ICMP ping Reply Hook Function */
 void vApplicationPingReplyHook( ePingReplyStatus_t eStatus,
         uint16_t usIdentifier );
@@ -181,6 +181,14 @@ void vApplicationIPNetworkEventHook_Multi( eIPCallbackEvent_t eNetworkEvent,
 #if DEMO_ECHOTCP
         /* Notify to UDP task to initiate server and client communication */
         xTaskNotifyGive(EchoTCPServerTaskHandle);
+#endif
+#if DEMO_SCRUB_BENCH
+        /* Notify to scrub benchmark task to start sending */
+        xTaskNotifyGive(ScrubBenchTaskHandle);
+#endif
+#if DEMO_PTP_SLAVE
+        /* Notify to PTP slave task to start listening to the master */
+        xTaskNotifyGive(PTPSlaveTaskHandle);
 #endif
     }
 
@@ -51,6 +51,7 @@
 #include "NetworkInterface.h"
 #include "FreeRTOS_Routing.h"
 #include <FreeRTOSIPConfig.h>
+#include "SocfpgaNetworkInterface.h"
 
 #include "socfpga_xgmac.h"
 #include "socfpga_xgmac_phy.h"
@@ -106,9 +107,7 @@
 #define XGMAC_IF_RX_EVENT     1U
 #define XGMAC_IF_TX_EVENT     2U
 #define XGMAC_IF_ERR_EVENT    4U
-#define XGMAC_IF_ALL_EVENT                    \
-    ( XGMAC_IF_RX_EVENT | XGMAC_IF_TX_EVENT | \
-      XGMAC_IF_ERR_EVENT )
+#define XGMAC_IF_ALL_EVENT    ( XGMAC_IF_RX_EVENT | XGMAC_IF_TX_EVENT | XGMAC_IF_ERR_EVENT )
 
 #define TX_BUFFER_COUNT       ( 512U )
 #define TX_BUFFER_SIZE        XGMAC_MAX_PACKET_SIZE
@@ -116,45 +115,228 @@
 #define RX_BUFFER_COUNT       ( 512U )
 #define RX_BUFFER_SIZE        XGMAC_MAX_PACKET_SIZE
 
+/* Maximum number of received frames delivered to the IP task per pass of
+ * prvEMACHandlerTask. When a pass leaves frames in the ring the Rx interrupt
+ * stays masked and the ring is polled again, otherwise the interrupt is
+ * re-enabled. Dropped frames do not count against the budget, but a pass
+ * never looks at more than twice the budget in descriptors. */
+#ifndef niRX_POLL_BUDGET
+    #define niRX_POLL_BUDGET    ( 64 )
+#endif
+
+/* Ticks prvEMACHandlerTask sleeps when a polling pass ran out of network
+ * buffers, so that the IP task and the application get to run and release
+ * them. Must be at least 1. */
+#ifndef niRX_POLL_DELAY_TICKS
+    #define niRX_POLL_DELAY_TICKS    ( 1U )
+#endif
+
+#if ( niRX_POLL_DELAY_TICKS < 1U )
+    #error "niRX_POLL_DELAY_TICKS must be at least 1"
+#endif
+
+/* Number of completed Tx descriptors reclaimed per driver call */
+#ifndef niTX_DONE_BATCH
+    #define niTX_DONE_BATCH    ( 32U )
+#endif
+
+/* Frames up to this length are copied into a driver Tx buffer. Longer frames
+ * the stack hands over with bReleaseAfterSend are given to the DMA straight
+ * from the network buffer, which is released once transmitted. Only used
+ * when ipconfigZERO_COPY_TX_DRIVER is 0. */
+#ifndef niTX_COPY_BREAK
+    #define niTX_COPY_BREAK    ( 256U )
+#endif
+
+/* Network buffers set aside to refill the Rx descriptors in zero copy mode.
+ * The reserve is topped up from the stack only when it runs empty, so that
+ * buffers are allocated in bursts rather than once per received frame. */
+#ifndef niRX_REFILL_RESERVE
+    #define niRX_REFILL_RESERVE    ( 32U )
+#endif
+
+/* Number of received descriptors handed back to the DMA with one driver call,
+ * each call does one cache maintenance pass and one tail pointer write. */
+#ifndef niRX_REFILL_BATCH
+    #define niRX_REFILL_BATCH    ( 16U )
+#endif
+
+/* Every network buffer of BufferAllocation_1 takes a full DMA buffer plus one
+ * cache line, so that the padding in front of a received frame never shares a
+ * cache line with the end of the previous buffer. */
+#define niNETWORK_BUFFER_STRIDE    ( XGMAC_MAX_PACKET_SIZE + XGMAC_DMA_ALIGN_BYTES )
+
+/* Number of local TCP/UDP ports which can be steered to a DMA channel with
+ * xNetworkInterfaceSetPortChannel(), one L3/L4 filter each */
+#define niPORT_STEERING_SLOTS    XGMAC_NUM_L3L4_FILTERS
+
+/* Offsets into an untagged Ethernet frame used to pick the Tx channel */
+#define niETH_TYPE_OFFSET        ( 12U )
+#define niETH_HEADER_LENGTH      ( 14U )
+#define niETH_TYPE_VLAN          ( 0x8100U )
+#define niETH_TYPE_IPV4          ( 0x0800U )
+#define niETH_TYPE_IPV6          ( 0x86DDU )
+#define niIPV6_HEADER_LENGTH     ( 40U )
+#define niUDP_HEADER_LENGTH      ( 8U )
+
+/* PTP event messages (Sync, Delay_Req, ...) are sent to this UDP port, the
+ * message type and sequence identify a message in the timestamp lookups */
+#define niPTP_EVENT_PORT         ( 319U )
+#define niPTP_SEQUENCE_OFFSET    ( 30U )
+#define niPTP_HEADER_LENGTH      ( 34U )
+
+/* Receive timestamps of PTP event messages kept per interface until the
+ * application picks them up with xNetworkInterfaceGetRxTimestamp() */
+#ifndef niPTP_RX_TIMESTAMP_SLOTS
+    #define niPTP_RX_TIMESTAMP_SLOTS    ( 8U )
+#endif
+
+/* Scrub policy of the driver owned Tx/Rx DMA buffer pools, see
+ * eBufferScrubPolicy_t. Can be changed at run time with
+ * xNetworkInterfaceSetScrubPolicy(). */
+#ifndef niBUFFER_SCRUB_POLICY
+    #define niBUFFER_SCRUB_POLICY    eBufferScrubNone
+#endif
+
+/* Priority of the task which clears released buffers with the deferred
+ * scrub policy. */
+#ifndef niBUFFER_SCRUB_TASK_PRIORITY
+    #define niBUFFER_SCRUB_TASK_PRIORITY    ( tskIDLE_PRIORITY + 1U )
+#endif
+
+/* Wake the scrub task once this many buffers are waiting, or after
+ * niBUFFER_SCRUB_PERIOD_MS when traffic is light. */
+#ifndef niBUFFER_SCRUB_BATCH
+    #define niBUFFER_SCRUB_BATCH    ( 32U )
+#endif
+
+#ifndef niBUFFER_SCRUB_PERIOD_MS
+    #define niBUFFER_SCRUB_PERIOD_MS    ( 10U )
+#endif
+
+/* A buffer released by a preempted task can be counted as free before its
+ * index is visible in the ring. Retry the ring this many times, yielding
+ * in between, before reporting the pool as exhausted. */
+#ifndef niBUFFER_POOL_GET_RETRIES
+    #define niBUFFER_POOL_GET_RETRIES    ( 4U )
+#endif
+
+/* Account the CPU cycles spent scrubbing buffers, see xGetBufferScrubStats().
+ * The driver then enables the PMU cycle counter (PMCCNTR_EL0) on init, which
+ * requires that EL2/EL3 do not trap PMU register accesses. */
+#ifndef niBUFFER_SCRUB_STATS
+    #define niBUFFER_SCRUB_STATS    0
+#endif
+
 
 static NetworkInterface_t * AgxInterface = NULL;
 /*-----------------------------------------------------------*/
 
-/* Structure with TX data output buffer details*/
+#if ( ( TX_BUFFER_COUNT & ( TX_BUFFER_COUNT - 1U ) ) != 0U ) || \
+    ( ( RX_BUFFER_COUNT & ( RX_BUFFER_COUNT - 1U ) ) != 0U )
+    #error "TX_BUFFER_COUNT and RX_BUFFER_COUNT must be a power of two"
+#endif
+
+/* In zero copy mode the Rx rings and the refill reserve hold network buffers
+ * permanently, enough must be left for the stack */
+#if ( ipconfigZERO_COPY_RX_DRIVER != 0 ) && \
+    ( ( ( XGMAC_NUM_RX_DESC * XGMAC_NUM_DMA_CHANNELS ) + niRX_REFILL_RESERVE ) >= ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS )
+    #error "ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS is too low for the Rx rings and niRX_REFILL_RESERVE"
+#endif
+
+/* The pools back the descriptor rings of all DMA channels */
+#if ( ( XGMAC_NUM_TX_DESC * XGMAC_NUM_DMA_CHANNELS ) > TX_BUFFER_COUNT ) || \
+    ( ( XGMAC_NUM_RX_DESC * XGMAC_NUM_DMA_CHANNELS ) > RX_BUFFER_COUNT )
+    #error "TX_BUFFER_COUNT and RX_BUFFER_COUNT must cover the rings of all DMA channels"
+#endif
+
+#define niBUFFER_POOL_MAX_COUNT \
+    ( ( TX_BUFFER_COUNT > RX_BUFFER_COUNT ) ? TX_BUFFER_COUNT : RX_BUFFER_COUNT )
+
+/* One slot of a buffer index ring. The sequence number tells producers and
+ * consumers whether the slot currently holds a buffer index. */
+typedef struct
+{
+volatile uint32_t ulSequence;
+uint32_t ulBufferIndex;
+} BufferPoolSlot_t;
+
+/* Bounded multi-producer/multi-consumer ring of buffer indices. It is updated
+ * with compare-and-swap only, so it never blocks. */
+typedef struct
+{
+BufferPoolSlot_t xSlots[ niBUFFER_POOL_MAX_COUNT ];
+volatile uint32_t ulEnqueuePos __attribute__( ( aligned( 64 ) ) );
+volatile uint32_t ulDequeuePos __attribute__( ( aligned( 64 ) ) );
+} BufferIndexRing_t;
+
+/* Structure with DMA buffer pool details. The indices of the free buffers are
+ * kept in a lock-free ring, so the IP task and the EMAC handler task can get
+ * and release buffers at the same time without taking a lock or blocking.
+ * With the deferred scrub policy released buffers are parked in a second ring
+ * until the scrub task has cleared them. */
 typedef struct
 {
-uint8_t * pTxBuffer[ TX_BUFFER_COUNT ];
-uint16_t usHeadIndex;
-uint16_t usTailIndex;
-uint16_t usBufUsedCnt;
+BufferIndexRing_t xFreeRing;
+BufferIndexRing_t xDirtyRing;
+uint16_t usUsedLength[ niBUFFER_POOL_MAX_COUNT ];
+volatile uint8_t ucInUse[ niBUFFER_POOL_MAX_COUNT ];
+uint8_t * pucBufferBase;
+size_t uxBufferSize;
+uint32_t ulBufferCount;
+uint32_t ulIndexMask;
+volatile uint32_t ulBufUsedCnt;
+volatile uint32_t ulBufUsedHighWater;
+volatile uint32_t ulAllocFailures;
+volatile uint32_t ulDirtyCnt;
 uint8_t ucIsInitiazed;
-} TxBufferPool_t;
+} BufferPool_t;
+
+typedef BufferPool_t TxBufferPool_t;
+typedef BufferPool_t RxBufferPool_t;
 /*-----------------------------------------------------------*/
 
 #if ( !( ipconfigZERO_COPY_TX_DRIVER ) )
-static TxBufferPool_t TxBufferPool = { NULL };
+static TxBufferPool_t TxBufferPool __attribute__( ( aligned( 64 ) ) );
 static TxBufferPool_t * pxTxBufferPool = &TxBufferPool;
 #endif
 
-static SemaphoreHandle_t xTxBufSynchSem = NULL;
+#if ( !( ipconfigZERO_COPY_RX_DRIVER ) )
+static RxBufferPool_t RxBufferPool __attribute__( ( aligned( 64 ) ) );
+static RxBufferPool_t * pxRxBufferPool = &RxBufferPool;
+#endif
+
+/* Scrub policy applied to buffers released back to the pools */
+static volatile eBufferScrubPolicy_t eScrubPolicy = niBUFFER_SCRUB_POLICY;
+
+#if ( niBUFFER_SCRUB_STATS != 0 )
+static NetworkBufferScrubStats_t xScrubStats;
+#endif
+
+/* Holds the handle of the task which scrubs buffers in deferred mode */
+static TaskHandle_t xScrubTaskHandle = NULL;
 
-/* Structure with RX data output buffer details*/
+#if ( ipconfigZERO_COPY_RX_DRIVER != 0 )
+
+/* Network buffers ready to replace the ones passed up to the stack. Only the
+ * EMAC handler task uses it. */
 typedef struct
 {
-uint8_t * pRxBuffer[ RX_BUFFER_COUNT ];
-uint16_t usHeadIndex;
-uint16_t usTailIndex;
-uint16_t usBufUsedCnt;
-uint8_t ucIsInitiazed;
-} RxBufferPool_t;
-/*-----------------------------------------------------------*/
+NetworkBufferDescriptor_t * pxBuffers[ niRX_REFILL_RESERVE ];
+uint32_t ulCount;
+uint32_t ulAllocFailures;
+} RxRefillReserve_t;
 
-#if ( !( ipconfigZERO_COPY_RX_DRIVER ) )
-static RxBufferPool_t RxBufferPool = { NULL };
-static RxBufferPool_t * pxRxBufferPool = &RxBufferPool;
+static RxRefillReserve_t xRxReserve[ EMAC_MAX_INSTANCE ];
+
+static NetworkBufferDescriptor_t * prvRxReserveGet( int instance );
+static void prvRxReserveDrain( int instance );
 #endif
 
-static SemaphoreHandle_t xRxBufSynchSem = NULL;
+static void prvRxRefill( xgmac_handle_t pXGMACHandle,
+                         int32_t lChannel,
+                         uint8_t ** pucBuffers,
+                         uint32_t * pulCount );
 
 BaseType_t prvUpdateRxDMADescriptors( uint8_t * pucRxBuffer,
                                       NetworkInterface_t * pxInterface );
@@ -185,6 +367,36 @@ BaseType_t pucReleaseTXBuffer( TxBufferPool_t * pTxBufferPool,
 BaseType_t prvReinitTxBufferPool( TxBufferPool_t * pTxBufferPool );
 BaseType_t prvReinitRxBufferPool( RxBufferPool_t * pRxBufferPool );
 
+/*
+ * Lock-free buffer pool primitives shared by the Tx and Rx pools
+ */
+static void prvBufferPoolInit( BufferPool_t * pxPool,
+                               uint8_t * pucBufferBase,
+                               size_t uxBufferSize,
+                               uint32_t ulBufferCount );
+static uint8_t * prvBufferPoolGet( BufferPool_t * pxPool );
+static BaseType_t prvBufferPoolIndexOf( const BufferPool_t * pxPool,
+                                        const void * pvBuffer,
+                                        uint32_t * pulIndex );
+static BaseType_t prvBufferPoolPut( BufferPool_t * pxPool,
+                                    const void * pvBuffer );
+static void prvBufferPoolSetUsedLength( BufferPool_t * pxPool,
+                                        const void * pvBuffer,
+                                        size_t uxLength );
+static void prvBufferPoolGetStats( const BufferPool_t * pxPool,
+                                   NetworkBufferPoolStats_t * pxStats );
+
+/*
+ * Background task which scrubs released buffers with the deferred policy
+ */
+static void prvBufferScrubTask( void * pvParameters );
+static BaseType_t prvStartBufferScrubTask( void );
+
+/*
+ * Starts the PMU cycle counter used by the scrub statistics
+ */
+static void prvEnableCycleCounter( void );
+
 /*
  * A deferred interrupt handler for XGMAC DMA interrupt sources.
  */
@@ -201,13 +413,24 @@ BaseType_t xNetworkInterfaceOutput( NetworkInterface_t * pxInterface,
 /* Holds the handle of the task used as a deferred interrupt processor */
 static TaskHandle_t xEMACTaskHandle = NULL;
 
+/* Serialises xNetworkInterfaceInitialise() against the event processing of
+ * prvEMACHandlerTask, so that a reinitialisation does not re-arm the DMA
+ * descriptors while the task refills them or drains the Rx refill reserve */
+static SemaphoreHandle_t xEMACMutex = NULL;
+
 void prvEMACIRQHanlderCallback( xgmac_int_status_t xIntrStatus,
                                 void * pvIrqData );
 
 /*
- * NetworkInterfaceInput function to receive a new packet and send it to IP_task
+ * NetworkInterfaceInput function to receive up to xBudget packets and send them
+ * to IP_task. Returns the number of frames delivered. *pxPending is set when
+ * the pass stopped with frames left in the rings, and *pxStarved when it
+ * stopped because no network buffer was free.
  */
-BaseType_t prvNetworkInterfaceInput( NetworkInterface_t * pxInterface );
+BaseType_t prvNetworkInterfaceInput( NetworkInterface_t * pxInterface,
+                                     BaseType_t xBudget,
+                                     BaseType_t * pxPending,
+                                     BaseType_t * pxStarved );
 
 /*
  * prvNetworkInterfaceDown function to stop EMAC and DMA for recovery from error
@@ -253,7 +476,45 @@ typedef enum XGMAC_STATE
  */
 
 static xgmac_config_t xEmacConfig[ EMAC_MAX_INSTANCE ] __attribute__( ( aligned( 64 ) ) );
-static SemaphoreHandle_t xSemaphoreCounterTx;
+/*-----------------------------------------------------------*/
+
+/* Local ports steered to a DMA channel, looked up for every transmitted frame
+ * while at least one is in use. Received frames are steered by the MAC. */
+typedef struct
+{
+uint8_t ucProtocol;
+uint8_t ucChannel;
+uint16_t usPort;
+} PortSteering_t;
+
+static PortSteering_t xPortSteering[ EMAC_MAX_INSTANCE ][ niPORT_STEERING_SLOTS ];
+static volatile uint32_t ulPortSteeringCount[ EMAC_MAX_INSTANCE ];
+
+static uint8_t prvSelectTxChannel( int instance,
+                                   const uint8_t * pucFrame,
+                                   size_t uxLength );
+/*-----------------------------------------------------------*/
+
+/* Hardware timestamps of received PTP event messages, written by the EMAC
+ * handler task and read by the PTP application */
+typedef struct
+{
+NetworkTimestamp_t xTime;
+uint16_t usSequenceId;
+uint8_t ucMessageType;
+uint8_t ucValid;
+} PTPRxTimestamp_t;
+
+static PTPRxTimestamp_t xPTPRxTimestamps[ EMAC_MAX_INSTANCE ][ niPTP_RX_TIMESTAMP_SLOTS ];
+static uint32_t ulPTPRxNext[ EMAC_MAX_INSTANCE ];
+static volatile BaseType_t xPTPEnabled[ EMAC_MAX_INSTANCE ];
+
+static size_t prvPTPEventOffset( const uint8_t * pucFrame,
+                                 size_t uxLength );
+static void prvPTPStoreRxTimestamp( int instance,
+                                    const uint8_t * pucFrame,
+                                    size_t uxLength,
+                                    const xgmac_timestamp_t * pxTime );
 /*-----------------------------------------------------------*/
 
 /* Initialize PHY parameters */
@@ -283,13 +544,30 @@ const TickType_t xWaitLinkDelay = pdMS_TO_TICKS( 1000U );
 xgmac_handle_t pXGMACHandle = NULL;
 uint8_t * pucBufferPool = NULL;
 
-    eXGMACState = XGMAC_EMACInit;
+    if( xEMACMutex == NULL )
+    {
+        xEMACMutex = xSemaphoreCreateMutex();
+
+        if( xEMACMutex == NULL )
+        {
+            FreeRTOS_printf( ( "SOCFPGA_XGMAC: EMAC Mutex Creation Failed....\n" ) );
+            return pdFAIL;
+        }
+    }
 
-    xSemaphoreCounterTx = xSemaphoreCreateCounting( 512, 0 );
-    configASSERT( xSemaphoreCounterTx != NULL );
+    /* Keep prvEMACHandlerTask out until the interface is set up again */
+    ( void ) xSemaphoreTake( xEMACMutex, portMAX_DELAY );
+
+    eXGMACState = XGMAC_EMACInit;
 
     AgxInterface = pxInterface;
 
+    #if ( ipconfigZERO_COPY_RX_DRIVER != 0 )
+        /* Reinitialisation, return the Rx refill reserve to the stack before
+         * the descriptors are re-armed */
+        prvRxReserveDrain( instance );
+    #endif
+
     switch( eXGMACState )
     {
         case XGMAC_EMACInit:
@@ -383,6 +661,19 @@ uint8_t * pucBufferPool = NULL;
                     break;
                 }
             #endif /* if ( !( ipconfigZERO_COPY_RX_DRIVER != 0 ) ) */
+
+            prvEnableCycleCounter();
+
+            if( eScrubPolicy == eBufferScrubDeferred )
+            {
+                if( prvStartBufferScrubTask() != pdPASS )
+                {
+                    FreeRTOS_printf( ( "SOCFPGA_XGMAC: Buffer Scrub Task Creation Failed....\n" ) );
+                    eXGMACState = XGMAC_Failed;
+                    break;
+                }
+            }
+
             xStatus = xgmac_dma_initialize( pXGMACHandle );
 
             if( xStatus != 0 )
@@ -474,6 +765,8 @@ uint8_t * pucBufferPool = NULL;
             break;
     }
 
+    ( void ) xSemaphoreGive( xEMACMutex );
+
     return xReturn;
 }
 /*-----------------------------------------------------------*/
@@ -516,12 +809,34 @@ uint32_t ulDataLength = 0;
         }
 
         #if ( ipconfigZERO_COPY_TX_DRIVER == 0 )
-            /* Get Tx Buffer Index from DMA Tx Buffer Pool */
-            pucBuffer = pucGetTXBuffer( pxTxBufferPool, XGMAC_MAX_PACKET_SIZE );
-            configASSERT( pucBuffer != NULL );
+            if( ( bReleaseAfterSend != pdFALSE ) && ( ulDataLength > niTX_COPY_BREAK ) )
+            {
+                /* The network buffer is ours now, send it without copying and
+                 * release it in prvNetworkInterfaceOutDone() */
+                pucBuffer = ( uint8_t * ) pxNetworkBuffer->pucEthernetBuffer;
+                bReleaseAfterSend = pdFALSE;
+            }
+            else
+            {
+                /* Get Tx Buffer Index from DMA Tx Buffer Pool */
+                pucBuffer = pucGetTXBuffer( pxTxBufferPool, XGMAC_MAX_PACKET_SIZE );
+
+                if( pucBuffer == NULL )
+                {
+                    /* Pool exhausted, drop the frame as for a failed
+                     * transmit */
+                    if( bReleaseAfterSend != pdFALSE )
+                    {
+                        vReleaseNetworkBufferAndDescriptor( pxNetworkBuffer );
+                    }
 
-            /* Copy the bytes from NW buffer to XGMAC Tx Buffer  */
-            ( void ) memcpy( pucBuffer, pxNetworkBuffer->pucEthernetBuffer, ulDataLength );
+                    return pdFALSE;
+                }
+
+                /* Copy the bytes from NW buffer to XGMAC Tx Buffer  */
+                ( void ) memcpy( pucBuffer, pxNetworkBuffer->pucEthernetBuffer, ulDataLength );
+                prvBufferPoolSetUsedLength( pxTxBufferPool, pucBuffer, ulDataLength );
+            }
         #else
             /* Pass the address of Network Buffer as-is */
             pucBuffer = ( uint8_t * ) pxNetworkBuffer->pucEthernetBuffer;
@@ -535,13 +850,20 @@ uint32_t ulDataLength = 0;
          * hence set the flag. This will be used in DMA TRansmit Done */
         xDMATxBuffer.release_buf = 1;
 
+        /* PTP event messages get their transmit time captured by the MAC */
+        xDMATxBuffer.timestamp = ( ( xPTPEnabled[ instance ] != pdFALSE ) &&
+                                   ( prvPTPEventOffset( pucBuffer, ulDataLength ) != 0U ) ) ? 1U : 0U;
+
         if( pXGMACHandle == NULL )
         {
             return pdFALSE;
         }
 
-        /* XGMAC transmit function */
-        xStatus = xgmac_dma_transmit( pXGMACHandle, &( xDMATxBuffer ) );
+        /* XGMAC transmit function, time critical traffic goes out on the
+         * higher priority channels ahead of bulk transfers */
+        xStatus = xgmac_dma_transmit_ch( pXGMACHandle,
+                                         prvSelectTxChannel( instance, pucBuffer, ulDataLength ),
+                                         &( xDMATxBuffer ) );
 
         if( xStatus != 0 )
         {
@@ -630,7 +952,10 @@ IPStackEvent_t xRxEvent;
 }
 /*-----------------------------------------------------------*/
 
-BaseType_t prvNetworkInterfaceInput( NetworkInterface_t * pxInterface )
+BaseType_t prvNetworkInterfaceInput( NetworkInterface_t * pxInterface,
+                                     BaseType_t xBudget,
+                                     BaseType_t * pxPending,
+                                     BaseType_t * pxStarved )
 {
     #if ( ipconfigUSE_LINKED_RX_MESSAGES != 0 )
         NetworkBufferDescriptor_t * pxFirstDescriptor = NULL;
@@ -645,18 +970,33 @@ uint8_t * pucEthernetBuffer;
 uint8_t * pucRefillRxBuffer;
 uint32_t ulPacketStatus;
 volatile int msgCount = 0;
-
-    do
+BaseType_t xDelivered = 0;
+BaseType_t xHandled = 0;
+int32_t lChannel = ( int32_t ) XGMAC_NUM_DMA_CHANNELS - 1;
+uint8_t * pucRefill[ niRX_REFILL_BATCH ];
+uint32_t ulRefillCount = 0U;
+
+    /* Drain the rings from the highest priority channel down, so that time
+     * critical frames are not held up by bulk traffic within the budget */
+    *pxStarved = pdFALSE;
+    *pxPending = pdFALSE;
+
+    while( ( xDelivered < xBudget ) && ( xHandled < ( 2 * xBudget ) ) &&
+           ( lChannel >= 0 ) && ( *pxStarved == pdFALSE ) )
     {
     NetworkBufferDescriptor_t * pxCurrentBufferDesc, * pxNewBufferDesc = NULL;
     BaseType_t xSendPacket = pdTRUE;
 
         /* XGMAC receive function */
-        xStatus = xgmac_dma_receive( pXGMACHandle, &( xDMARxBufferIn ) );
+        xStatus = xgmac_dma_receive_ch( pXGMACHandle, ( uint8_t ) lChannel, &( xDMARxBufferIn ) );
 
         if( xStatus != 0 )
         {
-            break;
+            /* Ring is empty, hand the consumed descriptors back and continue
+             * with the next lower priority channel */
+            prvRxRefill( pXGMACHandle, lChannel, pucRefill, &ulRefillCount );
+            lChannel--;
+            continue;
         }
 
         pucEthernetBuffer = xDMARxBufferIn.buf;
@@ -668,6 +1008,8 @@ volatile int msgCount = 0;
             break;
         }
 
+        xHandled++;
+
         /* Check the validity of the received packet and send only if valid else discard here */
         /* Check if packet has errors and discard if true */
         ulPacketStatus = xDMARxBufferIn.packet_status;
@@ -685,8 +1027,12 @@ volatile int msgCount = 0;
         }
         else
         {
-            pxNewBufferDesc = pxGetNetworkBufferWithDescriptor(
-                XGMAC_MAX_PACKET_SIZE, ( TickType_t ) 0 );
+            #if ( ipconfigZERO_COPY_RX_DRIVER != 0 )
+                pxNewBufferDesc = prvRxReserveGet( instance );
+            #else
+                pxNewBufferDesc = pxGetNetworkBufferWithDescriptor(
+                    XGMAC_MAX_PACKET_SIZE, ( TickType_t ) 0 );
+            #endif
 
             if( pxNewBufferDesc == NULL )
             {
@@ -695,11 +1041,19 @@ volatile int msgCount = 0;
                  */
                 FreeRTOS_printf( ( "Unable to allocate a Network Buffer\n" ) );
                 xSendPacket = pdFALSE;
+                /* End the pass, the IP task has to run to free buffers */
+                *pxStarved = pdTRUE;
             }
         }
 
         if( xSendPacket != pdFALSE )
         {
+            if( xDMARxBufferIn.timestamp_valid != 0U )
+            {
+                prvPTPStoreRxTimestamp( instance, pucEthernetBuffer, xReceivedPacketLength,
+                                        &( xDMARxBufferIn.timestamp ) );
+            }
+
             #if ( ipconfigZERO_COPY_RX_DRIVER != 0 )
             {
                 pxCurrentBufferDesc = pxPacketBuffer_to_NetworkBuffer(
@@ -764,6 +1118,7 @@ volatile int msgCount = 0;
             }
             #endif /* if ( ipconfigUSE_LINKED_RX_MESSAGES != 0 ) */
             msgCount++;
+            xDelivered++;
         }
 
         if( ( pXGMACHandle == NULL ) || ( pucRefillRxBuffer == NULL ) )
@@ -771,13 +1126,24 @@ volatile int msgCount = 0;
             return 0;
         }
 
-        /* Update the descriptor with new address and rest other fields */
-        if( xgmac_refill_rx_descriptor( pXGMACHandle, pucRefillRxBuffer ) != 0 )
+        /* Queue the descriptor for a refill with the new buffer, or with the
+         * old one when the frame was dropped or copied */
+        pucRefill[ ulRefillCount ] = pucRefillRxBuffer;
+        ulRefillCount++;
+
+        if( ulRefillCount == niRX_REFILL_BATCH )
         {
-            FreeRTOS_printf( ( "SOCFPGA_XGMAC: Refill Rx Descriptor Failed....\n" ) );
-            break;
+            prvRxRefill( pXGMACHandle, lChannel, pucRefill, &ulRefillCount );
         }
-    } while( true );
+    }
+
+    /* Budget used up part way through a ring */
+    *pxPending = ( lChannel >= 0 ) ? pdTRUE : pdFALSE;
+
+    if( lChannel >= 0 )
+    {
+        prvRxRefill( pXGMACHandle, lChannel, pucRefill, &ulRefillCount );
+    }
 
     #if ( ipconfigUSE_LINKED_RX_MESSAGES != 0 )
     {
@@ -788,10 +1154,88 @@ volatile int msgCount = 0;
     }
     #endif /* ipconfigUSE_LINKED_RX_MESSAGES */
 
-    return msgCount;
+    ( void ) msgCount;
+
+    return xDelivered;
+}
+/*-----------------------------------------------------------*/
+
+static void prvRxRefill( xgmac_handle_t pXGMACHandle,
+                         int32_t lChannel,
+                         uint8_t ** pucBuffers,
+                         uint32_t * pulCount )
+{
+int32_t lRefilled;
+
+    if( *pulCount == 0U )
+    {
+        return;
+    }
+
+    /* Update the descriptors with new addresses and rest other fields */
+    lRefilled = xgmac_refill_rx_descriptors_ch( pXGMACHandle, ( uint8_t ) lChannel,
+                                                pucBuffers, *pulCount );
+
+    if( lRefilled != ( int32_t ) *pulCount )
+    {
+        FreeRTOS_printf( ( "SOCFPGA_XGMAC: Refill Rx Descriptor Failed....\n" ) );
+    }
+
+    *pulCount = 0U;
+}
+/*-----------------------------------------------------------*/
+
+#if ( ipconfigZERO_COPY_RX_DRIVER != 0 )
+
+static NetworkBufferDescriptor_t * prvRxReserveGet( int instance )
+{
+RxRefillReserve_t * pxReserve = &( xRxReserve[ instance ] );
+NetworkBufferDescriptor_t * pxBuffer;
+
+    /* Top the reserve up in one go once it runs empty, without blocking */
+    if( pxReserve->ulCount == 0U )
+    {
+        while( pxReserve->ulCount < niRX_REFILL_RESERVE )
+        {
+            pxBuffer = pxGetNetworkBufferWithDescriptor( XGMAC_MAX_PACKET_SIZE, ( TickType_t ) 0 );
+
+            if( pxBuffer == NULL )
+            {
+                pxReserve->ulAllocFailures++;
+                break;
+            }
+
+            pxReserve->pxBuffers[ pxReserve->ulCount ] = pxBuffer;
+            pxReserve->ulCount++;
+        }
+    }
+
+    if( pxReserve->ulCount == 0U )
+    {
+        return NULL;
+    }
+
+    pxReserve->ulCount--;
+
+    return pxReserve->pxBuffers[ pxReserve->ulCount ];
+}
+/*-----------------------------------------------------------*/
+
+static void prvRxReserveDrain( int instance )
+{
+RxRefillReserve_t * pxReserve = &( xRxReserve[ instance ] );
+
+    /* Hand the spare buffers back to the stack while the link is down, the
+     * reserve is topped up again on the next receive */
+    while( pxReserve->ulCount > 0U )
+    {
+        pxReserve->ulCount--;
+        vReleaseNetworkBufferAndDescriptor( pxReserve->pxBuffers[ pxReserve->ulCount ] );
+    }
 }
 /*-----------------------------------------------------------*/
 
+#endif /* ipconfigZERO_COPY_RX_DRIVER */
 
 BaseType_t GetPhyLinkStatus( struct xNetworkInterface * pxDescriptor )
 {
@@ -825,7 +1269,7 @@ xgmac_handle_t pXGMACHandle = ( xgmac_handle_t ) xEmacConfig[ instance ].hxgmac;
 __attribute__( ( aligned( 64 ) ) )
 
 static uint8_t ucNetworkPackets[ ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS *
-                                 XGMAC_MAX_PACKET_SIZE ];
+                                 niNETWORK_BUFFER_STRIDE ];
 
 void vNetworkInterfaceAllocateRAMToBuffers( NetworkBufferDescriptor_t pxNetworkBuffers[ ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS ] )
 
@@ -841,7 +1285,7 @@ uint32_t ul;
         *( ( uintptr_t * ) ucRAMBuffer ) =
             ( uintptr_t ) ( &( pxNetworkBuffers[ ul ] ) );
 
-        ucRAMBuffer += XGMAC_MAX_PACKET_SIZE;
+        ucRAMBuffer += niNETWORK_BUFFER_STRIDE;
     }
 }
 /*-----------------------------------------------------------*/
@@ -913,44 +1357,58 @@ BaseType_t prvUpdateRxDMADescriptors( uint8_t * pucRxBuffer,
                                       NetworkInterface_t * pxInterface )
 {
 uint8_t * pucBufAddr = NULL;
-int32_t xStatus;
+uint8_t * pucRefill[ niRX_REFILL_BATCH ];
+uint32_t ulRefillCount = 0U;
 
     ( void ) ( pucRxBuffer );
 int instance = ( int ) ( ( uintptr_t ) pxInterface->pvArgument );
 xgmac_handle_t pXGMACHandle = ( xgmac_handle_t ) xEmacConfig[ instance ].hxgmac;
 
-    for( uint16_t usIndex = 0U; usIndex < ( uint32_t ) XGMAC_NUM_RX_DESC; usIndex++ )
+    for( uint8_t ucChannel = 0U; ucChannel < XGMAC_NUM_DMA_CHANNELS; ucChannel++ )
     {
-        #if ( ipconfigZERO_COPY_RX_DRIVER != 0 )
-            TickType_t uxBlockTimeTicks = pdMS_TO_TICKS( 100UL );
-            NetworkBufferDescriptor_t * pxBufferDescriptor;
+        for( uint32_t ulIndex = 0U; ulIndex < ( uint32_t ) XGMAC_NUM_RX_DESC; ulIndex++ )
+        {
+            #if ( ipconfigZERO_COPY_RX_DRIVER != 0 )
+                TickType_t uxBlockTimeTicks = pdMS_TO_TICKS( 100UL );
+                NetworkBufferDescriptor_t * pxBufferDescriptor;
 
-            pxBufferDescriptor = pxGetNetworkBufferWithDescriptor(
-                XGMAC_MAX_PACKET_SIZE, uxBlockTimeTicks );
+                pxBufferDescriptor = pxGetNetworkBufferWithDescriptor(
+                    XGMAC_MAX_PACKET_SIZE, uxBlockTimeTicks );
 
-            if( pxBufferDescriptor != NULL )
-            {
-                pucBufAddr = pxBufferDescriptor->pucEthernetBuffer;
-            }
-            else
-            {
-                return pdFAIL;
-            }
-        #else  /* if ( ipconfigZERO_COPY_RX_DRIVER != 0 ) */
-            /* Get address of Rx Buffer to assign to Descriptor */
-            pucBufAddr = pucGetRXBuffer( ( RxBufferPool_t * ) ( uintptr_t ) pucRxBuffer,
-                                         XGMAC_MAX_PACKET_SIZE );
+                if( pxBufferDescriptor != NULL )
+                {
+                    pucBufAddr = pxBufferDescriptor->pucEthernetBuffer;
+                }
+                else
+                {
+                    return pdFAIL;
+                }
+            #else  /* if ( ipconfigZERO_COPY_RX_DRIVER != 0 ) */
+                /* Get address of Rx Buffer to assign to Descriptor */
+                pucBufAddr = pucGetRXBuffer( ( RxBufferPool_t * ) ( uintptr_t ) pucRxBuffer,
+                                             XGMAC_MAX_PACKET_SIZE );
+
+                if( pucBufAddr == NULL )
+                {
+                    return pdFAIL;
+                }
+            #endif /* if ( ipconfigZERO_COPY_RX_DRIVER != 0 ) */
 
-            if( pucBufAddr == NULL )
+            /* Fill the ring of each DMA channel in batches */
+            pucRefill[ ulRefillCount ] = pucBufAddr;
+            ulRefillCount++;
+
+            if( ( ulRefillCount == niRX_REFILL_BATCH ) ||
+                ( ulIndex == ( ( uint32_t ) XGMAC_NUM_RX_DESC - 1U ) ) )
             {
-                return pdFAIL;
-            }
-        #endif /* if ( ipconfigZERO_COPY_RX_DRIVER != 0 ) */
-        xStatus = xgmac_refill_rx_descriptor( pXGMACHandle, pucBufAddr );
+                if( xgmac_refill_rx_descriptors_ch( pXGMACHandle, ucChannel, pucRefill,
+                                                    ulRefillCount ) != ( int32_t ) ulRefillCount )
+                {
+                    return pdFAIL;
+                }
 
-        if( xStatus != 0 )
-        {
-            return pdFAIL;
+                ulRefillCount = 0U;
+            }
         }
     }
 
@@ -960,32 +1418,34 @@ xgmac_handle_t pXGMACHandle = ( xgmac_handle_t ) xEmacConfig[ instance ].hxgmac;
 
 BaseType_t prvNetworkInterfaceOutDone( NetworkInterface_t * pxInterface )
 {
-uint8_t * pucReleaseBuffer = NULL;
+uint8_t * pucReleaseBuffers[ niTX_DONE_BATCH ];
+uint32_t ulCount;
 int32_t xStatus;
 int instance = ( int ) ( ( uintptr_t ) pxInterface->pvArgument );
 xgmac_handle_t pXGMACHandle = ( xgmac_handle_t ) xEmacConfig[ instance ].hxgmac;
 
-    while( xSemaphoreTake( xSemaphoreCounterTx, 0U ) == pdTRUE )
+    /* One completion event covers all frames sent on any channel since the
+     * previous one when Tx interrupts are coalesced, so reclaim every ring
+     * until the driver runs dry. */
+    for( uint8_t ucChannel = 0U; ucChannel < XGMAC_NUM_DMA_CHANNELS; ucChannel++ )
     {
-        xStatus = xgmac_dma_tx_done( pXGMACHandle, &pucReleaseBuffer );
-
-        if( xStatus != 0 )
+        do
         {
-            break;
-        }
+            ulCount = niTX_DONE_BATCH;
+            xStatus = xgmac_dma_tx_done_ch( pXGMACHandle, ucChannel, pucReleaseBuffers, &ulCount );
 
-        if( pucReleaseBuffer != NULL )
-        {
-            #if ( ipconfigZERO_COPY_TX_DRIVER != 0 )
+            for( uint32_t i = 0U; i < ulCount; i++ )
             {
-            NetworkBufferDescriptor_t * pxBuffer;
-            void * pvBuffer;
-
-                pvBuffer = ( void * ) pucReleaseBuffer;
+                if( pucReleaseBuffers[ i ] == NULL )
+                {
+                    continue;
+                }
 
-                if( pvBuffer != NULL )
+                #if ( ipconfigZERO_COPY_TX_DRIVER != 0 )
                 {
-                    pxBuffer = pxPacketBuffer_to_NetworkBuffer( pvBuffer );
+                NetworkBufferDescriptor_t * pxBuffer;
+
+                    pxBuffer = pxPacketBuffer_to_NetworkBuffer( ( void * ) pucReleaseBuffers[ i ] );
 
                     if( pxBuffer != NULL )
                     {
@@ -996,100 +1456,1008 @@ xgmac_handle_t pXGMACHandle = ( xgmac_handle_t ) xEmacConfig[ instance ].hxgmac;
                         FreeRTOS_printf( ( "Tx Done Get Buff: Can not find network buffer\n" ) );
                     }
                 }
-            }
-            #else  /* if ( ipconfigZERO_COPY_TX_DRIVER != 0 ) */
-                BaseType_t xReturn;
-                xReturn = pucReleaseTXBuffer( pxTxBufferPool, pucReleaseBuffer );
+                #else  /* if ( ipconfigZERO_COPY_TX_DRIVER != 0 ) */
+                    BaseType_t xReturn;
+                    uint32_t ulPoolIndex;
 
-                if( xReturn != pdPASS )
-                {
-                    FreeRTOS_printf( ( "Tx Done Get Buff: Can not release pool buffer  \n" ) );
-                }
-            #endif /* ipconfigZERO_COPY_TX_DRIVER */
-        }
+                    if( prvBufferPoolIndexOf( pxTxBufferPool, pucReleaseBuffers[ i ], &ulPoolIndex ) == pdPASS )
+                    {
+                        xReturn = pucReleaseTXBuffer( pxTxBufferPool, pucReleaseBuffers[ i ] );
+                    }
+                    else
+                    {
+                    NetworkBufferDescriptor_t * pxBuffer;
+
+                        /* Sent without a copy, see niTX_COPY_BREAK */
+                        pxBuffer = pxPacketBuffer_to_NetworkBuffer( ( void * ) pucReleaseBuffers[ i ] );
+                        xReturn = ( pxBuffer != NULL ) ? pdPASS : pdFAIL;
+
+                        if( pxBuffer != NULL )
+                        {
+                            vReleaseNetworkBufferAndDescriptor( pxBuffer );
+                        }
+                    }
+
+                    if( xReturn != pdPASS )
+                    {
+                        FreeRTOS_printf( ( "Tx Done Get Buff: Can not release pool buffer  \n" ) );
+                    }
+                #endif /* ipconfigZERO_COPY_TX_DRIVER */
+            }
+        } while( ( xStatus == 0 ) && ( ulCount == niTX_DONE_BATCH ) );
     }
 
     return pdPASS;
 }
 /*-----------------------------------------------------------*/
 
-BaseType_t prvCreateTxBufferPool( TxBufferPool_t * pTxBufferPool )
+BaseType_t xNetworkInterfaceSetRxCoalesce( BaseType_t xEMACIndex,
+                                           uint32_t ulFrames,
+                                           uint32_t ulTimeoutUs )
 {
-uint8_t * pTxBuf;
-BaseType_t xReturn = pdPASS;
-
-    /* Allocate Transmit Buffer Pool */
-    pTxBuf = ( uint8_t * ) pvPortMalloc( ( size_t ) TX_BUFFER_COUNT * ( size_t ) TX_BUFFER_SIZE );
-
-    /* Return failure if unable to allocate buffer */
-    if( pTxBuf == NULL )
+    if( ( xEMACIndex < 0 ) || ( xEMACIndex >= EMAC_MAX_INSTANCE ) ||
+        ( xEmacConfig[ xEMACIndex ].hxgmac == NULL ) )
     {
-        xReturn = pdFAIL;
-        return xReturn;
+        return pdFAIL;
     }
 
-    /* Assign Tx Buffer Addresses to Tx Pool Structure  */
-    for( uint32_t i = 0U; i < TX_BUFFER_COUNT; i++ )
+    if( xgmac_set_rx_coalesce( ( xgmac_handle_t ) xEmacConfig[ xEMACIndex ].hxgmac,
+                               ulFrames, ulTimeoutUs ) != 0 )
     {
-        pTxBufferPool->pTxBuffer[ i ] = ( uint8_t * ) &( pTxBuf[ i * TX_BUFFER_SIZE ] );
+        return pdFAIL;
     }
 
-    /* Assign Head and Tail to start of the location */
-    pTxBufferPool->usHeadIndex = 0;
-    pTxBufferPool->usTailIndex = 0;
-
-    /* Initial available buffer count */
-    pTxBufferPool->usBufUsedCnt = 0;
-
-    pTxBufferPool->ucIsInitiazed = 1;
+    return pdPASS;
+}
+/*-----------------------------------------------------------*/
 
-    xTxBufSynchSem = xSemaphoreCreateMutex();
+BaseType_t xNetworkInterfaceSetTxCoalesce( BaseType_t xEMACIndex,
+                                           uint32_t ulFrames,
+                                           uint32_t ulTimeoutMs )
+{
+    if( ( xEMACIndex < 0 ) || ( xEMACIndex >= EMAC_MAX_INSTANCE ) ||
+        ( xEmacConfig[ xEMACIndex ].hxgmac == NULL ) )
+    {
+        return pdFAIL;
+    }
 
-    if( xTxBufSynchSem == NULL )
+    if( xgmac_set_tx_coalesce( ( xgmac_handle_t ) xEmacConfig[ xEMACIndex ].hxgmac,
+                               ulFrames, ulTimeoutMs ) != 0 )
     {
-        xReturn = pdFAIL;
+        return pdFAIL;
     }
 
-    return xReturn;
+    return pdPASS;
 }
 /*-----------------------------------------------------------*/
 
-BaseType_t prvCreateRxBufferPool( RxBufferPool_t * pRxBufferPool )
+BaseType_t xNetworkInterfaceSetPortChannel( BaseType_t xEMACIndex,
+                                            uint8_t ucSlot,
+                                            uint8_t ucProtocol,
+                                            uint16_t usPort,
+                                            uint8_t ucChannel )
 {
-uint8_t * pRxBuf;
-BaseType_t xReturn = pdPASS;
-
-    /* Allocate Receive Buffer Pool */
-    pRxBuf = ( uint8_t * ) pvPortAlignedAlloc(64, ( size_t ) RX_BUFFER_COUNT * ( size_t ) RX_BUFFER_SIZE );
+xgmac_l3l4_filter_t xFilter;
+PortSteering_t * pxSlot;
+uint32_t ulInUse = 0U;
 
-    /* Return failure if unable to allocate buffer */
-    if( pRxBuf == NULL )
+    if( ( xEMACIndex < 0 ) || ( xEMACIndex >= EMAC_MAX_INSTANCE ) ||
+        ( xEmacConfig[ xEMACIndex ].hxgmac == NULL ) ||
+        ( ucSlot >= niPORT_STEERING_SLOTS ) || ( ucChannel >= XGMAC_NUM_DMA_CHANNELS ) )
     {
-        xReturn = pdFAIL;
-        return xReturn;
+        return pdFAIL;
     }
 
-    /* Assign Rx Buffer Addresses to Rx Pool Structure  */
-    for( uint32_t i = 0U; i < RX_BUFFER_COUNT; i++ )
+    if( ( usPort != 0U ) && ( ucProtocol != XGMAC_L4_PROTO_TCP ) &&
+        ( ucProtocol != XGMAC_L4_PROTO_UDP ) )
     {
-        pRxBufferPool->pRxBuffer[ i ] = ( uint8_t * ) &( pRxBuf[ i * RX_BUFFER_SIZE ] );
+        return pdFAIL;
     }
 
-    /* Assign Head and Tail to start of the location */
-    pRxBufferPool->usHeadIndex = 0;
-    pRxBufferPool->usTailIndex = 0;
-
-    /* Initial available buffer count */
-    pRxBufferPool->usBufUsedCnt = 0;
-
-    pRxBufferPool->ucIsInitiazed = 1;
-
-    xRxBufSynchSem = xSemaphoreCreateMutex();
+    pxSlot = &( xPortSteering[ xEMACIndex ][ ucSlot ] );
 
-    if( xRxBufSynchSem == NULL )
+    /* Received frames are steered by the destination port, which is the
+     * local port */
+    if( usPort != 0U )
     {
-        xReturn = pdFAIL;
-    }
+        ( void ) memset( &xFilter, 0, sizeof( xFilter ) );
+        xFilter.l4_proto = ucProtocol;
+        xFilter.dst_port = usPort;
+        xFilter.chan = ucChannel;
+
+        if( xgmac_set_l3l4_filter( ( xgmac_handle_t ) xEmacConfig[ xEMACIndex ].hxgmac,
+                                   ucSlot, &xFilter ) != 0 )
+        {
+            return pdFAIL;
+        }
+    }
+    else if( xgmac_set_l3l4_filter( ( xgmac_handle_t ) xEmacConfig[ xEMACIndex ].hxgmac,
+                                    ucSlot, NULL ) != 0 )
+    {
+        return pdFAIL;
+    }
+
+    /* Clear the port first so that a concurrent transmit never sees a port
+     * with the channel of another one */
+    pxSlot->usPort = 0U;
+    pxSlot->ucProtocol = ucProtocol;
+    pxSlot->ucChannel = ucChannel;
+    __atomic_store_n( &( pxSlot->usPort ), usPort, __ATOMIC_RELEASE );
+
+    for( uint8_t i = 0U; i < niPORT_STEERING_SLOTS; i++ )
+    {
+        if( xPortSteering[ xEMACIndex ][ i ].usPort != 0U )
+        {
+            ulInUse++;
+        }
+    }
+
+    ulPortSteeringCount[ xEMACIndex ] = ulInUse;
+
+    return pdPASS;
+}
+/*-----------------------------------------------------------*/
+
+static uint8_t prvSelectTxChannel( int instance,
+                                   const uint8_t * pucFrame,
+                                   size_t uxLength )
+{
+xgmac_handle_t pXGMACHandle = ( xgmac_handle_t ) xEmacConfig[ instance ].hxgmac;
+uint16_t usEthType;
+size_t uxL4Offset = 0U;
+uint8_t ucProtocol = 0U;
+uint8_t ucPriority = 0U;
+uint16_t usSrcPort;
+
+    if( ( XGMAC_NUM_DMA_CHANNELS == 1U ) || ( uxLength < ( niETH_HEADER_LENGTH + 2U ) ) )
+    {
+        return XGMAC_DMA_CH0;
+    }
+
+    usEthType = ( uint16_t ) ( ( ( uint16_t ) pucFrame[ niETH_TYPE_OFFSET ] << 8 ) |
+                               pucFrame[ niETH_TYPE_OFFSET + 1U ] );
+
+    if( usEthType == niETH_TYPE_VLAN )
+    {
+        /* Priority Code Point of the tag */
+        ucPriority = pucFrame[ niETH_HEADER_LENGTH ] >> 5;
+    }
+    else if( usEthType == niETH_TYPE_IPV4 )
+    {
+        /* Precedence bits of the type of service */
+        ucPriority = pucFrame[ niETH_HEADER_LENGTH + 1U ] >> 5;
+
+        if( uxLength >= ( niETH_HEADER_LENGTH + 20U ) )
+        {
+            ucProtocol = pucFrame[ niETH_HEADER_LENGTH + 9U ];
+            uxL4Offset = niETH_HEADER_LENGTH + ( ( size_t ) ( pucFrame[ niETH_HEADER_LENGTH ] & 0x0FU ) * 4U );
+        }
+    }
+    else if( usEthType == niETH_TYPE_IPV6 )
+    {
+        /* Top bits of the traffic class */
+        ucPriority = ( pucFrame[ niETH_HEADER_LENGTH ] & 0x0FU ) >> 1;
+
+        if( uxLength >= ( niETH_HEADER_LENGTH + niIPV6_HEADER_LENGTH ) )
+        {
+            ucProtocol = pucFrame[ niETH_HEADER_LENGTH + 6U ];
+            uxL4Offset = niETH_HEADER_LENGTH + niIPV6_HEADER_LENGTH;
+        }
+    }
+    else
+    {
+        /* ARP and other frames use the lowest priority */
+    }
+
+    /* Frames sent from a steered local port use the channel of the port */
+    if( ( ulPortSteeringCount[ instance ] != 0U ) && ( uxL4Offset != 0U ) &&
+        ( uxLength >= ( uxL4Offset + 2U ) ) &&
+        ( ( ucProtocol == XGMAC_L4_PROTO_TCP ) || ( ucProtocol == XGMAC_L4_PROTO_UDP ) ) )
+    {
+        usSrcPort = ( uint16_t ) ( ( ( uint16_t ) pucFrame[ uxL4Offset ] << 8 ) |
+                                   pucFrame[ uxL4Offset + 1U ] );
+
+        for( uint8_t i = 0U; i < niPORT_STEERING_SLOTS; i++ )
+        {
+        const PortSteering_t * pxSlot = &( xPortSteering[ instance ][ i ] );
+
+            if( ( __atomic_load_n( &( pxSlot->usPort ), __ATOMIC_ACQUIRE ) == usSrcPort ) &&
+                ( pxSlot->ucProtocol == ucProtocol ) )
+            {
+                return pxSlot->ucChannel;
+            }
+        }
+    }
+
+    return xgmac_get_tx_prio_chan( pXGMACHandle, ucPriority );
+}
+/*-----------------------------------------------------------*/
+
+static size_t prvPTPEventOffset( const uint8_t * pucFrame,
+                                 size_t uxLength )
+{
+uint16_t usEthType;
+size_t uxL4Offset;
+uint8_t ucProtocol;
+uint16_t usDstPort;
+
+    if( uxLength < ( niETH_HEADER_LENGTH + 20U ) )
+    {
+        return 0U;
+    }
+
+    usEthType = ( uint16_t ) ( ( ( uint16_t ) pucFrame[ niETH_TYPE_OFFSET ] << 8 ) |
+                               pucFrame[ niETH_TYPE_OFFSET + 1U ] );
+
+    if( usEthType == niETH_TYPE_IPV4 )
+    {
+        ucProtocol = pucFrame[ niETH_HEADER_LENGTH + 9U ];
+        uxL4Offset = niETH_HEADER_LENGTH + ( ( size_t ) ( pucFrame[ niETH_HEADER_LENGTH ] & 0x0FU ) * 4U );
+    }
+    else if( usEthType == niETH_TYPE_IPV6 )
+    {
+        ucProtocol = pucFrame[ niETH_HEADER_LENGTH + 6U ];
+        uxL4Offset = niETH_HEADER_LENGTH + niIPV6_HEADER_LENGTH;
+    }
+    else
+    {
+        return 0U;
+    }
+
+    if( ( ucProtocol != XGMAC_L4_PROTO_UDP ) ||
+        ( uxLength < ( uxL4Offset + niUDP_HEADER_LENGTH + niPTP_HEADER_LENGTH ) ) )
+    {
+        return 0U;
+    }
+
+    usDstPort = ( uint16_t ) ( ( ( uint16_t ) pucFrame[ uxL4Offset + 2U ] << 8 ) |
+                               pucFrame[ uxL4Offset + 3U ] );
+
+    if( usDstPort != niPTP_EVENT_PORT )
+    {
+        return 0U;
+    }
+
+    return uxL4Offset + niUDP_HEADER_LENGTH;
+}
+/*-----------------------------------------------------------*/
+
+static void prvPTPStoreRxTimestamp( int instance,
+                                    const uint8_t * pucFrame,
+                                    size_t uxLength,
+                                    const xgmac_timestamp_t * pxTime )
+{
+size_t uxOffset = prvPTPEventOffset( pucFrame, uxLength );
+PTPRxTimestamp_t * pxSlot;
+
+    if( uxOffset == 0U )
+    {
+        return;
+    }
+
+    /* Oldest entry is overwritten, the application picks up the timestamp
+     * right after receiving the message */
+    taskENTER_CRITICAL();
+    {
+        pxSlot = &( xPTPRxTimestamps[ instance ][ ulPTPRxNext[ instance ] ] );
+        ulPTPRxNext[ instance ] = ( ulPTPRxNext[ instance ] + 1U ) % niPTP_RX_TIMESTAMP_SLOTS;
+
+        pxSlot->ucMessageType = pucFrame[ uxOffset ] & 0x0FU;
+        pxSlot->usSequenceId = ( uint16_t ) ( ( ( uint16_t ) pucFrame[ uxOffset + niPTP_SEQUENCE_OFFSET ] << 8 ) |
+                                              pucFrame[ uxOffset + niPTP_SEQUENCE_OFFSET + 1U ] );
+        pxSlot->xTime.ullSeconds = pxTime->sec;
+        pxSlot->xTime.ulNanoseconds = pxTime->nsec;
+        pxSlot->ucValid = 1U;
+    }
+    taskEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xNetworkInterfacePTPEnable( BaseType_t xEMACIndex,
+                                       BaseType_t xEnable )
+{
+    if( ( xEMACIndex < 0 ) || ( xEMACIndex >= EMAC_MAX_INSTANCE ) ||
+        ( xEmacConfig[ xEMACIndex ].hxgmac == NULL ) )
+    {
+        return pdFAIL;
+    }
+
+    xPTPEnabled[ xEMACIndex ] = pdFALSE;
+
+    if( xgmac_ptp_enable( ( xgmac_handle_t ) xEmacConfig[ xEMACIndex ].hxgmac,
+                          ( xEnable != pdFALSE ) ? XGMAC_TS_RX_PTP : XGMAC_TS_RX_NONE ) != 0 )
+    {
+        return pdFAIL;
+    }
+
+    ( void ) memset( xPTPRxTimestamps[ xEMACIndex ], 0, sizeof( xPTPRxTimestamps[ xEMACIndex ] ) );
+    xPTPEnabled[ xEMACIndex ] = xEnable;
+
+    return pdPASS;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xNetworkInterfacePTPGetTime( BaseType_t xEMACIndex,
+                                        NetworkTimestamp_t * pxTime )
+{
+xgmac_timestamp_t xTime;
+
+    if( ( xEMACIndex < 0 ) || ( xEMACIndex >= EMAC_MAX_INSTANCE ) || ( pxTime == NULL ) ||
+        ( xgmac_ptp_gettime( ( xgmac_handle_t ) xEmacConfig[ xEMACIndex ].hxgmac, &xTime ) != 0 ) )
+    {
+        return pdFAIL;
+    }
+
+    pxTime->ullSeconds = xTime.sec;
+    pxTime->ulNanoseconds = xTime.nsec;
+
+    return pdPASS;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xNetworkInterfacePTPSetTime( BaseType_t xEMACIndex,
+                                        const NetworkTimestamp_t * pxTime )
+{
+xgmac_timestamp_t xTime;
+
+    if( ( xEMACIndex < 0 ) || ( xEMACIndex >= EMAC_MAX_INSTANCE ) || ( pxTime == NULL ) )
+    {
+        return pdFAIL;
+    }
+
+    xTime.sec = pxTime->ullSeconds;
+    xTime.nsec = pxTime->ulNanoseconds;
+
+    if( xgmac_ptp_settime( ( xgmac_handle_t ) xEmacConfig[ xEMACIndex ].hxgmac, &xTime ) != 0 )
+    {
+        return pdFAIL;
+    }
+
+    return pdPASS;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xNetworkInterfacePTPAdjTime( BaseType_t xEMACIndex,
+                                        int64_t llDeltaNs )
+{
+    if( ( xEMACIndex < 0 ) || ( xEMACIndex >= EMAC_MAX_INSTANCE ) ||
+        ( xgmac_ptp_adjtime( ( xgmac_handle_t ) xEmacConfig[ xEMACIndex ].hxgmac, llDeltaNs ) != 0 ) )
+    {
+        return pdFAIL;
+    }
+
+    return pdPASS;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xNetworkInterfacePTPAdjFreq( BaseType_t xEMACIndex,
+                                        int32_t lPpb )
+{
+    if( ( xEMACIndex < 0 ) || ( xEMACIndex >= EMAC_MAX_INSTANCE ) ||
+        ( xgmac_ptp_adjfreq( ( xgmac_handle_t ) xEmacConfig[ xEMACIndex ].hxgmac, lPpb ) != 0 ) )
+    {
+        return pdFAIL;
+    }
+
+    return pdPASS;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xNetworkInterfaceGetRxTimestamp( BaseType_t xEMACIndex,
+                                            uint8_t ucMessageType,
+                                            uint16_t usSequenceId,
+                                            NetworkTimestamp_t * pxTime )
+{
+BaseType_t xReturn = pdFAIL;
+PTPRxTimestamp_t * pxSlot;
+
+    if( ( xEMACIndex < 0 ) || ( xEMACIndex >= EMAC_MAX_INSTANCE ) || ( pxTime == NULL ) )
+    {
+        return pdFAIL;
+    }
+
+    taskENTER_CRITICAL();
+    {
+        for( uint32_t i = 0U; i < niPTP_RX_TIMESTAMP_SLOTS; i++ )
+        {
+            pxSlot = &( xPTPRxTimestamps[ xEMACIndex ][ i ] );
+
+            if( ( pxSlot->ucValid != 0U ) && ( pxSlot->ucMessageType == ucMessageType ) &&
+                ( pxSlot->usSequenceId == usSequenceId ) )
+            {
+                *pxTime = pxSlot->xTime;
+                pxSlot->ucValid = 0U;
+                xReturn = pdPASS;
+                break;
+            }
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xNetworkInterfaceGetTxTimestamp( BaseType_t xEMACIndex,
+                                            NetworkTimestamp_t * pxTime )
+{
+xgmac_timestamp_t xTime;
+
+    if( ( xEMACIndex < 0 ) || ( xEMACIndex >= EMAC_MAX_INSTANCE ) || ( pxTime == NULL ) ||
+        ( xgmac_ptp_get_tx_timestamp( ( xgmac_handle_t ) xEmacConfig[ xEMACIndex ].hxgmac, &xTime ) != 0 ) )
+    {
+        return pdFAIL;
+    }
+
+    pxTime->ullSeconds = xTime.sec;
+    pxTime->ulNanoseconds = xTime.nsec;
+
+    return pdPASS;
+}
+/*-----------------------------------------------------------*/
+
+static void prvEnableCycleCounter( void )
+{
+    #if ( niBUFFER_SCRUB_STATS != 0 )
+        uint64_t ullVal;
+
+        /* Enable the PMU and the cycle counter without resetting it */
+        __asm volatile ( "MRS %0, PMCR_EL0" : "=r" ( ullVal ) );
+        ullVal |= ( 1U << 0 );
+        __asm volatile ( "MSR PMCR_EL0, %0" : : "r" ( ullVal ) );
+        ullVal = ( 1ULL << 31 );
+        __asm volatile ( "MSR PMCNTENSET_EL0, %0" : : "r" ( ullVal ) );
+        __asm volatile ( "ISB" );
+    #endif
+}
+/*-----------------------------------------------------------*/
+
+static inline uint64_t prvReadCycleCounter( void )
+{
+uint64_t ullCycles = 0U;
+
+    #if ( niBUFFER_SCRUB_STATS != 0 )
+        __asm volatile ( "MRS %0, PMCCNTR_EL0" : "=r" ( ullCycles ) );
+    #endif
+
+    return ullCycles;
+}
+/*-----------------------------------------------------------*/
+
+static void prvIndexRingInit( BufferIndexRing_t * pxRing,
+                              uint32_t ulBufferCount,
+                              BaseType_t xFill )
+{
+    for( uint32_t i = 0U; i < ulBufferCount; i++ )
+    {
+        pxRing->xSlots[ i ].ulBufferIndex = i;
+
+        /* A filled slot carries the sequence number a consumer expects for
+         * the first lap, an empty one the number a producer expects. */
+        pxRing->xSlots[ i ].ulSequence = ( xFill != pdFALSE ) ? ( i + 1U ) : i;
+    }
+
+    pxRing->ulEnqueuePos = ( xFill != pdFALSE ) ? ulBufferCount : 0U;
+    pxRing->ulDequeuePos = 0U;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvIndexRingPop( BufferIndexRing_t * pxRing,
+                                   uint32_t ulIndexMask,
+                                   uint32_t * pulIndex )
+{
+BufferPoolSlot_t * pxSlot;
+uint32_t ulPos;
+uint32_t ulSeq;
+int32_t lDiff;
+
+    ulPos = __atomic_load_n( &( pxRing->ulDequeuePos ), __ATOMIC_RELAXED );
+
+    for( ; ; )
+    {
+        pxSlot = &( pxRing->xSlots[ ulPos & ulIndexMask ] );
+        ulSeq = __atomic_load_n( &( pxSlot->ulSequence ), __ATOMIC_ACQUIRE );
+        lDiff = ( int32_t ) ( ulSeq - ( ulPos + 1U ) );
+
+        if( lDiff == 0 )
+        {
+            /* The slot holds an index, try to claim it */
+            if( __atomic_compare_exchange_n( &( pxRing->ulDequeuePos ), &ulPos,
+                                             ulPos + 1U, pdTRUE,
+                                             __ATOMIC_RELAXED, __ATOMIC_RELAXED ) )
+            {
+                break;
+            }
+        }
+        else if( lDiff < 0 )
+        {
+            /* Ring is empty */
+            return pdFAIL;
+        }
+        else
+        {
+            /* Another consumer took this slot, retry from the new position */
+            ulPos = __atomic_load_n( &( pxRing->ulDequeuePos ), __ATOMIC_RELAXED );
+        }
+    }
+
+    *pulIndex = pxSlot->ulBufferIndex;
+
+    /* Hand the slot back to producers for the next lap of the ring */
+    __atomic_store_n( &( pxSlot->ulSequence ), ulPos + ulIndexMask + 1U,
+                      __ATOMIC_RELEASE );
+
+    return pdPASS;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvIndexRingPush( BufferIndexRing_t * pxRing,
+                                    uint32_t ulIndexMask,
+                                    uint32_t ulIndex )
+{
+BufferPoolSlot_t * pxSlot;
+uint32_t ulPos;
+uint32_t ulSeq;
+int32_t lDiff;
+
+    ulPos = __atomic_load_n( &( pxRing->ulEnqueuePos ), __ATOMIC_RELAXED );
+
+    for( ; ; )
+    {
+        pxSlot = &( pxRing->xSlots[ ulPos & ulIndexMask ] );
+        ulSeq = __atomic_load_n( &( pxSlot->ulSequence ), __ATOMIC_ACQUIRE );
+        lDiff = ( int32_t ) ( ulSeq - ulPos );
+
+        if( lDiff == 0 )
+        {
+            if( __atomic_compare_exchange_n( &( pxRing->ulEnqueuePos ), &ulPos,
+                                             ulPos + 1U, pdTRUE,
+                                             __ATOMIC_RELAXED, __ATOMIC_RELAXED ) )
+            {
+                break;
+            }
+        }
+        else if( lDiff < 0 )
+        {
+            /* Ring is full */
+            return pdFAIL;
+        }
+        else
+        {
+            ulPos = __atomic_load_n( &( pxRing->ulEnqueuePos ), __ATOMIC_RELAXED );
+        }
+    }
+
+    pxSlot->ulBufferIndex = ulIndex;
+
+    /* Publish the index to consumers */
+    __atomic_store_n( &( pxSlot->ulSequence ), ulPos + 1U, __ATOMIC_RELEASE );
+
+    return pdPASS;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvBufferPoolIndexOf( const BufferPool_t * pxPool,
+                                        const void * pvBuffer,
+                                        uint32_t * pulIndex )
+{
+uintptr_t uxOffset;
+uint32_t ulIndex;
+
+    /* Only buffers carved out of this pool belong to it */
+    if( ( uintptr_t ) pvBuffer < ( uintptr_t ) pxPool->pucBufferBase )
+    {
+        return pdFAIL;
+    }
+
+    uxOffset = ( uintptr_t ) pvBuffer - ( uintptr_t ) pxPool->pucBufferBase;
+    ulIndex = ( uint32_t ) ( uxOffset / pxPool->uxBufferSize );
+
+    if( ( ulIndex >= pxPool->ulBufferCount ) ||
+        ( ( uxOffset % pxPool->uxBufferSize ) != 0U ) )
+    {
+        return pdFAIL;
+    }
+
+    *pulIndex = ulIndex;
+
+    return pdPASS;
+}
+/*-----------------------------------------------------------*/
+
+static void prvBufferPoolScrub( BufferPool_t * pxPool,
+                                uint32_t ulIndex )
+{
+size_t uxLength = pxPool->usUsedLength[ ulIndex ];
+
+    /* Only the bytes written by the last user need clearing */
+    if( uxLength != 0U )
+    {
+        ( void ) memset( &( pxPool->pucBufferBase[ ( size_t ) ulIndex * pxPool->uxBufferSize ] ),
+                         '\0', uxLength );
+        pxPool->usUsedLength[ ulIndex ] = 0U;
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvBufferPoolInit( BufferPool_t * pxPool,
+                               uint8_t * pucBufferBase,
+                               size_t uxBufferSize,
+                               uint32_t ulBufferCount )
+{
+    pxPool->pucBufferBase = pucBufferBase;
+    pxPool->uxBufferSize = uxBufferSize;
+    pxPool->ulBufferCount = ulBufferCount;
+    pxPool->ulIndexMask = ulBufferCount - 1U;
+
+    /* All buffers start out free and nothing waits for scrubbing */
+    prvIndexRingInit( &( pxPool->xFreeRing ), ulBufferCount, pdTRUE );
+    prvIndexRingInit( &( pxPool->xDirtyRing ), ulBufferCount, pdFALSE );
+    ( void ) memset( pxPool->usUsedLength, 0, sizeof( pxPool->usUsedLength ) );
+    ( void ) memset( ( void * ) pxPool->ucInUse, 0, sizeof( pxPool->ucInUse ) );
+
+    /* Initial available buffer count */
+    pxPool->ulBufUsedCnt = 0U;
+    pxPool->ulBufUsedHighWater = 0U;
+    pxPool->ulAllocFailures = 0U;
+    pxPool->ulDirtyCnt = 0U;
+
+    __atomic_thread_fence( __ATOMIC_RELEASE );
+
+    pxPool->ucIsInitiazed = 1;
+}
+/*-----------------------------------------------------------*/
+
+static uint8_t * prvBufferPoolGet( BufferPool_t * pxPool )
+{
+uint32_t ulIndex;
+uint32_t ulUsed;
+uint32_t ulHighWater;
+uint32_t ulRetries = 0U;
+
+    for( ; ; )
+    {
+        if( prvIndexRingPop( &( pxPool->xFreeRing ), pxPool->ulIndexMask, &ulIndex ) == pdPASS )
+        {
+            break;
+        }
+
+        /* The scrub task is behind, take a released buffer and clear it here
+         * rather than failing the request. */
+        if( prvIndexRingPop( &( pxPool->xDirtyRing ), pxPool->ulIndexMask, &ulIndex ) == pdPASS )
+        {
+            ( void ) __atomic_sub_fetch( &( pxPool->ulDirtyCnt ), 1U, __ATOMIC_RELAXED );
+            prvBufferPoolScrub( pxPool, ulIndex );
+            break;
+        }
+
+        /* Both rings look empty. A release which is still publishing its
+         * index shows up within a few retries, a pool which is really in
+         * use does not. */
+        if( ( __atomic_load_n( &( pxPool->ulBufUsedCnt ), __ATOMIC_RELAXED ) >= pxPool->ulBufferCount ) ||
+            ( ulRetries >= niBUFFER_POOL_GET_RETRIES ) )
+        {
+            ( void ) __atomic_add_fetch( &( pxPool->ulAllocFailures ), 1U, __ATOMIC_RELAXED );
+            return NULL;
+        }
+
+        /* Let the releasing task, if it runs at this priority, finish
+         * publishing its index before looking at the rings again. */
+        ulRetries++;
+
+        if( xTaskGetSchedulerState() == taskSCHEDULER_RUNNING )
+        {
+            taskYIELD();
+        }
+    }
+
+    /* Mark the buffer as owned, prvBufferPoolPut() checks it */
+    __atomic_store_n( &( pxPool->ucInUse[ ulIndex ] ), 1U, __ATOMIC_RELAXED );
+
+    /* Update occupancy and the high-water mark */
+    ulUsed = __atomic_add_fetch( &( pxPool->ulBufUsedCnt ), 1U, __ATOMIC_RELAXED );
+    ulHighWater = __atomic_load_n( &( pxPool->ulBufUsedHighWater ), __ATOMIC_RELAXED );
+
+    while( ulUsed > ulHighWater )
+    {
+        if( __atomic_compare_exchange_n( &( pxPool->ulBufUsedHighWater ), &ulHighWater,
+                                         ulUsed, pdTRUE,
+                                         __ATOMIC_RELAXED, __ATOMIC_RELAXED ) )
+        {
+            break;
+        }
+    }
+
+    return &( pxPool->pucBufferBase[ ( size_t ) ulIndex * pxPool->uxBufferSize ] );
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvBufferPoolPut( BufferPool_t * pxPool,
+                                    const void * pvBuffer )
+{
+uint32_t ulIndex;
+uint32_t ulDirty;
+BaseType_t xReturn;
+
+    if( prvBufferPoolIndexOf( pxPool, pvBuffer, &ulIndex ) != pdPASS )
+    {
+        return pdFAIL;
+    }
+
+    /* Only the first release of a buffer clears its owner flag, a second
+     * one is refused before the index can get into a ring twice. */
+    if( __atomic_exchange_n( &( pxPool->ucInUse[ ulIndex ] ), 0U, __ATOMIC_RELAXED ) == 0U )
+    {
+        return pdFAIL;
+    }
+
+    switch( eScrubPolicy )
+    {
+        case eBufferScrubDeferred:
+
+            if( xScrubTaskHandle != NULL )
+            {
+                /* Park the buffer until the scrub task has cleared it */
+                xReturn = prvIndexRingPush( &( pxPool->xDirtyRing ), pxPool->ulIndexMask, ulIndex );
+
+                if( xReturn == pdPASS )
+                {
+                    ulDirty = __atomic_add_fetch( &( pxPool->ulDirtyCnt ), 1U, __ATOMIC_RELAXED );
+
+                    if( ulDirty == niBUFFER_SCRUB_BATCH )
+                    {
+                        ( void ) xTaskNotifyGive( xScrubTaskHandle );
+                    }
+                }
+
+                break;
+            }
+
+            /* No scrub task, clear the buffer inline instead. */
+            prvBufferPoolScrub( pxPool, ulIndex );
+            xReturn = prvIndexRingPush( &( pxPool->xFreeRing ), pxPool->ulIndexMask, ulIndex );
+            break;
+
+        case eBufferScrubUsedLength:
+            prvBufferPoolScrub( pxPool, ulIndex );
+            xReturn = prvIndexRingPush( &( pxPool->xFreeRing ), pxPool->ulIndexMask, ulIndex );
+            break;
+
+        case eBufferScrubNone:
+        default:
+            pxPool->usUsedLength[ ulIndex ] = 0U;
+            xReturn = prvIndexRingPush( &( pxPool->xFreeRing ), pxPool->ulIndexMask, ulIndex );
+            break;
+    }
+
+    if( xReturn != pdPASS )
+    {
+        /* Cannot happen while every index is in at most one ring */
+        return pdFAIL;
+    }
+
+    ( void ) __atomic_sub_fetch( &( pxPool->ulBufUsedCnt ), 1U, __ATOMIC_RELAXED );
+
+    return pdPASS;
+}
+/*-----------------------------------------------------------*/
+
+static void prvBufferPoolSetUsedLength( BufferPool_t * pxPool,
+                                        const void * pvBuffer,
+                                        size_t uxLength )
+{
+uint32_t ulIndex;
+
+    if( prvBufferPoolIndexOf( pxPool, pvBuffer, &ulIndex ) == pdPASS )
+    {
+        if( uxLength > pxPool->uxBufferSize )
+        {
+            uxLength = pxPool->uxBufferSize;
+        }
+
+        pxPool->usUsedLength[ ulIndex ] = ( uint16_t ) uxLength;
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvBufferPoolGetStats( const BufferPool_t * pxPool,
+                                   NetworkBufferPoolStats_t * pxStats )
+{
+    pxStats->ulBufferCount = pxPool->ulBufferCount;
+    pxStats->ulBuffersInUse = __atomic_load_n( &( pxPool->ulBufUsedCnt ), __ATOMIC_RELAXED );
+    pxStats->ulHighWaterMark = __atomic_load_n( &( pxPool->ulBufUsedHighWater ), __ATOMIC_RELAXED );
+    pxStats->ulAllocFailures = __atomic_load_n( &( pxPool->ulAllocFailures ), __ATOMIC_RELAXED );
+    pxStats->ulBuffersToScrub = __atomic_load_n( &( pxPool->ulDirtyCnt ), __ATOMIC_RELAXED );
+}
+/*-----------------------------------------------------------*/
+
+static uint32_t prvBufferPoolDrainDirty( BufferPool_t * pxPool )
+{
+uint32_t ulIndex;
+uint32_t ulCount = 0U;
+
+    if( pxPool->ucIsInitiazed == 0U )
+    {
+        return 0U;
+    }
+
+    while( prvIndexRingPop( &( pxPool->xDirtyRing ), pxPool->ulIndexMask, &ulIndex ) == pdPASS )
+    {
+        ( void ) __atomic_sub_fetch( &( pxPool->ulDirtyCnt ), 1U, __ATOMIC_RELAXED );
+        prvBufferPoolScrub( pxPool, ulIndex );
+
+        /* Cannot fail, the index was just taken out of the same pool */
+        ( void ) prvIndexRingPush( &( pxPool->xFreeRing ), pxPool->ulIndexMask, ulIndex );
+        ulCount++;
+    }
+
+    return ulCount;
+}
+/*-----------------------------------------------------------*/
+
+static void prvBufferScrubTask( void * pvParameters )
+{
+const TickType_t xScrubPeriod = pdMS_TO_TICKS( niBUFFER_SCRUB_PERIOD_MS );
+uint64_t ullStart;
+uint32_t ulCount;
+
+    ( void ) pvParameters;
+
+    for( ; ; )
+    {
+        ( void ) ulTaskNotifyTake( pdTRUE, xScrubPeriod );
+
+        ullStart = prvReadCycleCounter();
+        ulCount = 0U;
+
+        #if ( !( ipconfigZERO_COPY_TX_DRIVER ) )
+            ulCount += prvBufferPoolDrainDirty( pxTxBufferPool );
+        #endif
+        #if ( !( ipconfigZERO_COPY_RX_DRIVER ) )
+            ulCount += prvBufferPoolDrainDirty( pxRxBufferPool );
+        #endif
+
+        #if ( niBUFFER_SCRUB_STATS != 0 )
+            if( ulCount != 0U )
+            {
+                ullStart = prvReadCycleCounter() - ullStart;
+
+                taskENTER_CRITICAL();
+                {
+                    xScrubStats.ullDeferredCycles += ullStart;
+                    xScrubStats.ulDeferredCount += ulCount;
+                }
+                taskEXIT_CRITICAL();
+            }
+        #else
+            ( void ) ullStart;
+            ( void ) ulCount;
+        #endif
+    }
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvStartBufferScrubTask( void )
+{
+    if( xScrubTaskHandle == NULL )
+    {
+        ( void ) xTaskCreate( prvBufferScrubTask, "EMACScrub",
+                              configMINIMAL_STACK_SIZE, NULL,
+                              niBUFFER_SCRUB_TASK_PRIORITY, &xScrubTaskHandle );
+    }
+
+    return ( xScrubTaskHandle != NULL ) ? pdPASS : pdFAIL;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xNetworkInterfaceSetScrubPolicy( eBufferScrubPolicy_t ePolicy )
+{
+    switch( ePolicy )
+    {
+        case eBufferScrubNone:
+        case eBufferScrubUsedLength:
+            break;
+
+        case eBufferScrubDeferred:
+
+            if( prvStartBufferScrubTask() != pdPASS )
+            {
+                return pdFAIL;
+            }
+
+            break;
+
+        default:
+            return pdFAIL;
+    }
+
+    /* Buffers already parked for scrubbing are still drained by the task */
+    eScrubPolicy = ePolicy;
+
+    return pdPASS;
+}
+/*-----------------------------------------------------------*/
+
+eBufferScrubPolicy_t eNetworkInterfaceGetScrubPolicy( void )
+{
+    return eScrubPolicy;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xGetBufferScrubStats( NetworkBufferScrubStats_t * pxStats )
+{
+    if( pxStats == NULL )
+    {
+        return pdFAIL;
+    }
+
+    #if ( niBUFFER_SCRUB_STATS != 0 )
+        taskENTER_CRITICAL();
+        {
+            *pxStats = xScrubStats;
+        }
+        taskEXIT_CRITICAL();
+
+        return pdPASS;
+    #else
+        ( void ) memset( pxStats, 0, sizeof( NetworkBufferScrubStats_t ) );
+
+        return pdFAIL;
+    #endif
+}
+/*-----------------------------------------------------------*/
+
+void vResetBufferScrubStats( void )
+{
+    #if ( niBUFFER_SCRUB_STATS != 0 )
+        taskENTER_CRITICAL();
+        {
+            ( void ) memset( &xScrubStats, 0, sizeof( xScrubStats ) );
+        }
+        taskEXIT_CRITICAL();
+    #endif
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t prvCreateTxBufferPool( TxBufferPool_t * pTxBufferPool )
+{
+uint8_t * pTxBuf;
+BaseType_t xReturn = pdPASS;
+
+    /* Allocate Transmit Buffer Pool */
+    pTxBuf = ( uint8_t * ) pvPortMalloc( ( size_t ) TX_BUFFER_COUNT * ( size_t ) TX_BUFFER_SIZE );
+
+    /* Return failure if unable to allocate buffer */
+    if( pTxBuf == NULL )
+    {
+        xReturn = pdFAIL;
+        return xReturn;
+    }
+
+    /* Assign Tx Buffer Addresses to Tx Pool Structure  */
+    prvBufferPoolInit( pTxBufferPool, pTxBuf, TX_BUFFER_SIZE, TX_BUFFER_COUNT );
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t prvCreateRxBufferPool( RxBufferPool_t * pRxBufferPool )
+{
+uint8_t * pRxBuf;
+BaseType_t xReturn = pdPASS;
+
+    /* Allocate Receive Buffer Pool */
+    pRxBuf = ( uint8_t * ) pvPortAlignedAlloc(64, ( size_t ) RX_BUFFER_COUNT * ( size_t ) RX_BUFFER_SIZE );
+
+    /* Return failure if unable to allocate buffer */
+    if( pRxBuf == NULL )
+    {
+        xReturn = pdFAIL;
+        return xReturn;
+    }
+
+    /* Assign Rx Buffer Addresses to Rx Pool Structure  */
+    prvBufferPoolInit( pRxBufferPool, pRxBuf, RX_BUFFER_SIZE, RX_BUFFER_COUNT );
 
     return xReturn;
 }
@@ -1098,9 +2466,7 @@ BaseType_t xReturn = pdPASS;
 uint8_t * pucGetTXBuffer( TxBufferPool_t * pTxBufferPool,
                           size_t xWantedSize )
 {
-TickType_t xBlockTimeTicks = pdMS_TO_TICKS( 1000U );
-uint8_t * pucBufAddr = NULL;
-uint16_t usIndex;
+uint8_t * pucBufAddr;
 
     if( xWantedSize > TX_BUFFER_SIZE )
     {
@@ -1108,25 +2474,12 @@ uint16_t usIndex;
         return NULL;
     }
 
-    if( xSemaphoreTake( xTxBufSynchSem, xBlockTimeTicks ) != pdFAIL )
-    {
-        if( pTxBufferPool->usBufUsedCnt == ( uint16_t ) TX_BUFFER_COUNT )
-        {
-            FreeRTOS_printf( ( "Tx Buffer Pool Fully Used \n" ) );
-            return NULL;
-        }
-
-        /*Get the buffer from the head of the buffer pool */
-        usIndex = pTxBufferPool->usHeadIndex;
-        pTxBufferPool->usHeadIndex++;
-        pucBufAddr = pTxBufferPool->pTxBuffer[ usIndex ];
+    /*Get the buffer from the head of the buffer pool */
+    pucBufAddr = prvBufferPoolGet( pTxBufferPool );
 
-        /* Update Head and Buffer Count in use */
-        pTxBufferPool->usHeadIndex %= ( uint16_t ) TX_BUFFER_COUNT;
-        pTxBufferPool->usBufUsedCnt++;
-
-        /* Release the Mutex. */
-        ( void ) xSemaphoreGive( xTxBufSynchSem );
+    if( pucBufAddr == NULL )
+    {
+        FreeRTOS_printf( ( "Tx Buffer Pool Fully Used \n" ) );
     }
 
     return pucBufAddr;
@@ -1136,9 +2489,7 @@ uint16_t usIndex;
 uint8_t * pucGetRXBuffer( RxBufferPool_t * pRxBufferPool,
                           size_t xWantedSize )
 {
-TickType_t xBlockTimeTicks = pdMS_TO_TICKS( 1000U );
-uint8_t * pucBufAddr = NULL;
-uint16_t usIndex;
+uint8_t * pucBufAddr;
 
     if( xWantedSize > RX_BUFFER_SIZE )
     {
@@ -1146,25 +2497,12 @@ uint16_t usIndex;
         return NULL;
     }
 
-    if( xSemaphoreTake( xRxBufSynchSem, xBlockTimeTicks ) != pdFAIL )
-    {
-        if( pRxBufferPool->usBufUsedCnt == ( uint16_t ) RX_BUFFER_COUNT )
-        {
-            FreeRTOS_printf( ( "Rx Buffer Pool Fully Used \n" ) );
-            return NULL;
-        }
-
-        /*Get the buffer from the head of the buffer pool */
-        usIndex = pRxBufferPool->usHeadIndex;
-        pRxBufferPool->usHeadIndex++;
-        pucBufAddr = pRxBufferPool->pRxBuffer[ usIndex ];
+    /*Get the buffer from the head of the buffer pool */
+    pucBufAddr = prvBufferPoolGet( pRxBufferPool );
 
-        /* Update Head and Buffer Count in use */
-        pRxBufferPool->usHeadIndex %= ( uint16_t ) RX_BUFFER_COUNT;
-        pRxBufferPool->usBufUsedCnt++;
-
-        /* Release the Mutex. */
-        ( void ) xSemaphoreGive( xRxBufSynchSem );
+    if( pucBufAddr == NULL )
+    {
+        FreeRTOS_printf( ( "Rx Buffer Pool Fully Used \n" ) );
     }
 
     return pucBufAddr;
@@ -1174,35 +2512,73 @@ uint16_t usIndex;
 BaseType_t pucReleaseTXBuffer( TxBufferPool_t * pTxBufferPool,
                                void * pvBuffer )
 {
-TickType_t xBlockTimeTicks = pdMS_TO_TICKS( 1000U );
-BaseType_t xReturn = pdFAIL;
-uint16_t usIndex;
+BaseType_t xReturn;
+uint64_t ullStart;
 
-    if( xSemaphoreTake( xTxBufSynchSem, xBlockTimeTicks ) != pdFAIL )
-    {
-        if( pTxBufferPool->usBufUsedCnt == 0U )
+    /* Add the buffer to the tail of the pool, scrubbing it according to the
+     * configured policy */
+    ullStart = prvReadCycleCounter();
+    xReturn = prvBufferPoolPut( pTxBufferPool, pvBuffer );
+
+    #if ( niBUFFER_SCRUB_STATS != 0 )
+        ullStart = prvReadCycleCounter() - ullStart;
+
+        taskENTER_CRITICAL();
         {
-            FreeRTOS_printf( ( "Tx Buffer Pool is Already Empty \n" ) );
-            return xReturn;
+            xScrubStats.ullReleaseCycles += ullStart;
+            xScrubStats.ulReleaseCount++;
         }
+        taskEXIT_CRITICAL();
+    #else
+        ( void ) ullStart;
+    #endif
+
+    if( xReturn != pdPASS )
+    {
+        FreeRTOS_printf( ( "Tx Buffer does not belong to the pool or is already free \n" ) );
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xGetTXBufferPoolStats( NetworkBufferPoolStats_t * pxStats )
+{
+    if( pxStats == NULL )
+    {
+        return pdFAIL;
+    }
 
-        /* Add the buffer to the tail of the pool */
-        ( void ) memset( pvBuffer, '\0', TX_BUFFER_SIZE );
-        usIndex = pTxBufferPool->usTailIndex;
-        pTxBufferPool->usTailIndex++;
-        pTxBufferPool->pTxBuffer[ usIndex ] = ( uint8_t * ) pvBuffer;
+    ( void ) memset( pxStats, 0, sizeof( NetworkBufferPoolStats_t ) );
 
-        /* Update tail and free count */
-        pTxBufferPool->usTailIndex %= ( uint16_t ) TX_BUFFER_COUNT;
-        pTxBufferPool->usBufUsedCnt--;
+    #if ( ipconfigZERO_COPY_TX_DRIVER == 0 )
+        if( pxTxBufferPool->ucIsInitiazed != 0U )
+        {
+            prvBufferPoolGetStats( pxTxBufferPool, pxStats );
+        }
+    #endif
 
-        /* Release the Mutex. */
-        ( void ) xSemaphoreGive( xTxBufSynchSem );
+    return pdPASS;
+}
+/*-----------------------------------------------------------*/
 
-        xReturn = pdPASS;
+BaseType_t xGetRXBufferPoolStats( NetworkBufferPoolStats_t * pxStats )
+{
+    if( pxStats == NULL )
+    {
+        return pdFAIL;
     }
 
-    return xReturn;
+    ( void ) memset( pxStats, 0, sizeof( NetworkBufferPoolStats_t ) );
+
+    #if ( ipconfigZERO_COPY_RX_DRIVER == 0 )
+        if( pxRxBufferPool->ucIsInitiazed != 0U )
+        {
+            prvBufferPoolGetStats( pxRxBufferPool, pxStats );
+        }
+    #endif
+
+    return pdPASS;
 }
 /*-----------------------------------------------------------*/
 
@@ -1236,6 +2612,22 @@ xgmac_err_info_t * pxIntData = ( xgmac_err_info_t * ) pvIrqData;
     {
         if( xIntrStatus == XGMAC_RX_EVENT )
         {
+        int instance;
+
+            /* The callback context is the error information of the raising
+             * XGMAC, use it to find the instance. Mask further Rx interrupts,
+             * prvEMACHandlerTask polls the ring until it is drained and then
+             * unmasks them again */
+            for( instance = 0; instance < EMAC_MAX_INSTANCE; instance++ )
+            {
+                if( ( xEmacConfig[ instance ].hxgmac != NULL ) &&
+                    ( xgmac_get_err_info( ( xgmac_handle_t ) xEmacConfig[ instance ].hxgmac ) == pxIntData ) )
+                {
+                    ( void ) xgmac_dma_rx_irq_enable( ( xgmac_handle_t ) xEmacConfig[ instance ].hxgmac, false );
+                    break;
+                }
+            }
+
             /* Notify prvEMACHandlerTask of Receive event */
             ulISREvent = XGMAC_IF_RX_EVENT;
         }
@@ -1243,7 +2635,6 @@ xgmac_err_info_t * pxIntData = ( xgmac_err_info_t * ) pvIrqData;
         {
             /* Notify prvEMACHandlerTask of Transmit completion event */
             ulISREvent = XGMAC_IF_TX_EVENT;
-            ( void ) xSemaphoreGiveFromISR( xSemaphoreCounterTx, NULL );
         }
 /*-----------------------------------------------------------*/
 
@@ -1261,9 +2652,17 @@ xgmac_err_info_t * pxIntData = ( xgmac_err_info_t * ) pvIrqData;
             /*do nothing*/
         }
 
-        ( void ) xTaskNotifyFromISR( xEMACTaskHandle, ulISREvent, eSetBits,
-                                     &( xHigherPriorityTaskWoken ) );
-        portYIELD_FROM_ISR( xHigherPriorityTaskWoken );
+        /* The Tx coalescing watchdog reports from the timer service task */
+        if( xPortIsInsideInterrupt() == pdFALSE )
+        {
+            ( void ) xTaskNotify( xEMACTaskHandle, ulISREvent, eSetBits );
+        }
+        else
+        {
+            ( void ) xTaskNotifyFromISR( xEMACTaskHandle, ulISREvent, eSetBits,
+                                         &( xHigherPriorityTaskWoken ) );
+            portYIELD_FROM_ISR( xHigherPriorityTaskWoken );
+        }
     }
 }
 /*-----------------------------------------------------------*/
@@ -1278,6 +2677,9 @@ BaseType_t xResult;
 uint64_t xStatus;
 const TickType_t ulMaxBlockTime = pdMS_TO_TICKS( 100UL );
 uint32_t ulISREvents = 0U;
+BaseType_t xRxPolling = pdFALSE;
+BaseType_t xRxPending;
+BaseType_t xRxStarved = pdFALSE;
 xgmac_handle_t pXGMACHandle = ( xgmac_handle_t ) xEmacConfig[ instance ].hxgmac;
 
     /* Remove compiler warnings about unused parameters. */
@@ -1300,15 +2702,36 @@ xgmac_handle_t pXGMACHandle = ( xgmac_handle_t ) xEmacConfig[ instance ].hxgmac;
             #endif /* ( ipconfigHAS_PRINTF != 0 ) */
         #endif
 
-        /* Wait for a new event or a time-out. */
+        /* Wait for a new event or a time-out. While polling the Rx ring only
+         * pick up the events which are already pending. */
+        ulISREvents = 0U;
         ( void ) xTaskNotifyWait( 0U,                 /* ulBitsToClearOnEntry */
                                   XGMAC_IF_ALL_EVENT, /* ulBitsToClearOnExit */
                                   &( ulISREvents ),   /* pulNotificationValue */
-                                  ulMaxBlockTime );
+                                  ( xRxPolling != pdFALSE ) ? 0U : ulMaxBlockTime );
 
-        if( ( ulISREvents & XGMAC_IF_RX_EVENT ) != 0U )
+        /* Hold off xNetworkInterfaceInitialise() while handling the events */
+        ( void ) xSemaphoreTake( xEMACMutex, portMAX_DELAY );
+        xRxStarved = pdFALSE;
+
+        if( ( ( ulISREvents & XGMAC_IF_RX_EVENT ) != 0U ) || ( xRxPolling != pdFALSE ) )
         {
-            ( void ) prvNetworkInterfaceInput( pxInterface );
+            ( void ) prvNetworkInterfaceInput( pxInterface, niRX_POLL_BUDGET,
+                                               &xRxPending, &xRxStarved );
+
+            if( ( xRxPending == pdFALSE ) && ( xRxStarved == pdFALSE ) )
+            {
+                /* Ring is drained, return to interrupt driven reception. A
+                 * frame which arrived meanwhile raises the interrupt at once. */
+                xRxPolling = pdFALSE;
+                ( void ) xgmac_dma_rx_irq_enable( pXGMACHandle, true );
+            }
+            else
+            {
+                /* Frames left over, keep the interrupt masked and poll again
+                 * after picking up the pending events */
+                xRxPolling = pdTRUE;
+            }
         }
 
         if( ( ulISREvents & XGMAC_IF_TX_EVENT ) != 0U )
@@ -1349,6 +2772,13 @@ xgmac_handle_t pXGMACHandle = ( xgmac_handle_t ) xEmacConfig[ instance ].hxgmac;
                     xPHYLinkStatus = xStatus;
                     FreeRTOS_printf( ( "prvEMACHandlerTask: PHY LS now %lu\n",
                                         xPHYLinkStatus != 0uL ) );
+
+                    #if ( ipconfigZERO_COPY_RX_DRIVER != 0 )
+                        if( xPHYLinkStatus == pdFALSE )
+                        {
+                            prvRxReserveDrain( instance );
+                        }
+                    #endif
                 }
             }
 
@@ -1367,6 +2797,23 @@ xgmac_handle_t pXGMACHandle = ( xgmac_handle_t ) xEmacConfig[ instance ].hxgmac;
         {
             /*do nothing*/
         }
+
+        ( void ) xSemaphoreGive( xEMACMutex );
+
+        /* While polling only block when out of buffers, the IP task has to
+         * run to release them */
+        if( xRxStarved != pdFALSE )
+        {
+            vTaskDelay( niRX_POLL_DELAY_TICKS );
+        }
+        else if( xRxPolling != pdFALSE )
+        {
+            taskYIELD();
+        }
+        else
+        {
+            /*do nothing*/
+        }
     }
 }
 /*-----------------------------------------------------------*/
@@ -25,8 +25,8 @@
  * http://www.FreeRTOS.org
  */
 
-#ifndef NETWORK_INTERFACE_H
-#define NETWORK_INTERFACE_H
+#ifndef SOCFPGA_NETWORK_INTERFACE_H
+#define SOCFPGA_NETWORK_INTERFACE_H
 
 /* *INDENT-OFF* */
 #ifdef __cplusplus
@@ -56,6 +56,106 @@ BaseType_t xGetPhyLinkStatus( struct xNetworkInterface * pxInterface );
 NetworkInterface_t * pxFillInterfaceDescriptor( BaseType_t xEMACIndex,
                                                 NetworkInterface_t * pxInterface );
 
+/* Request a Tx completion interrupt once every ulFrames frames, with a
+ * watchdog of ulTimeoutMs for the frames in between. ulFrames of 1 restores
+ * one interrupt per frame. */
+BaseType_t xNetworkInterfaceSetTxCoalesce( BaseType_t xEMACIndex,
+                                           uint32_t ulFrames,
+                                           uint32_t ulTimeoutMs );
+
+/* Request an Rx completion interrupt once every ulFrames frames, the hardware
+ * Rx interrupt watchdog reports the frames in between after ulTimeoutUs. */
+BaseType_t xNetworkInterfaceSetRxCoalesce( BaseType_t xEMACIndex,
+                                           uint32_t ulFrames,
+                                           uint32_t ulTimeoutUs );
+
+/* Steer the traffic of a local TCP or UDP port to a DMA channel, in both
+ * directions. ucProtocol is FREERTOS_IPPROTO_TCP or FREERTOS_IPPROTO_UDP,
+ * ucSlot selects one of the steering entries and a usPort of 0 frees it.
+ * The highest channel has the highest priority, other traffic is spread
+ * across the channels by VLAN or IP priority. */
+BaseType_t xNetworkInterfaceSetPortChannel( BaseType_t xEMACIndex,
+                                            uint8_t ucSlot,
+                                            uint8_t ucProtocol,
+                                            uint16_t usPort,
+                                            uint8_t ucChannel );
+
+/* Time of the hardware clock of an interface, IEEE 1588 style. */
+typedef struct
+{
+    uint64_t ullSeconds;     /* Seconds, 48 bits are kept by the hardware. */
+    uint32_t ulNanoseconds;  /* Nanoseconds, below 10^9. */
+} NetworkTimestamp_t;
+
+/* Start the hardware clock of the interface at zero and timestamp the PTP
+ * messages it sends and receives, or stop it when xEnable is pdFALSE. */
+BaseType_t xNetworkInterfacePTPEnable( BaseType_t xEMACIndex,
+                                       BaseType_t xEnable );
+
+/* Read, set, step and trim the hardware clock. The frequency adjustment is
+ * in parts per billion relative to the nominal rate. */
+BaseType_t xNetworkInterfacePTPGetTime( BaseType_t xEMACIndex,
+                                        NetworkTimestamp_t * pxTime );
+BaseType_t xNetworkInterfacePTPSetTime( BaseType_t xEMACIndex,
+                                        const NetworkTimestamp_t * pxTime );
+BaseType_t xNetworkInterfacePTPAdjTime( BaseType_t xEMACIndex,
+                                        int64_t llDeltaNs );
+BaseType_t xNetworkInterfacePTPAdjFreq( BaseType_t xEMACIndex,
+                                        int32_t lPpb );
+
+/* Receive time of a PTP event message sent to UDP port 319, looked up by
+ * its message type and sequence id. Each timestamp can be read once, the
+ * last few messages are kept. */
+BaseType_t xNetworkInterfaceGetRxTimestamp( BaseType_t xEMACIndex,
+                                            uint8_t ucMessageType,
+                                            uint16_t usSequenceId,
+                                            NetworkTimestamp_t * pxTime );
+
+/* Transmit time of the last PTP event message sent. The MAC holds a single
+ * timestamp, wait for it before sending the next event message. Returns
+ * pdFAIL while the message has not left the MAC yet. */
+BaseType_t xNetworkInterfaceGetTxTimestamp( BaseType_t xEMACIndex,
+                                            NetworkTimestamp_t * pxTime );
+
+/* Occupancy counters of the driver owned DMA buffer pools which are used when
+ * zero copy is disabled. All fields read as zero when the pool is not in use. */
+typedef struct
+{
+    uint32_t ulBufferCount;    /* Total number of buffers in the pool. */
+    uint32_t ulBuffersInUse;   /* Buffers currently handed out. */
+    uint32_t ulHighWaterMark;  /* Largest number of buffers handed out at once. */
+    uint32_t ulAllocFailures;  /* Requests that found the pool empty. */
+    uint32_t ulBuffersToScrub; /* Released buffers waiting for the scrub task. */
+} NetworkBufferPoolStats_t;
+
+BaseType_t xGetTXBufferPoolStats( NetworkBufferPoolStats_t * pxStats );
+BaseType_t xGetRXBufferPoolStats( NetworkBufferPoolStats_t * pxStats );
+
+/* What happens to the contents of a pool buffer when it is released. */
+typedef enum
+{
+    eBufferScrubNone = 0,   /* Buffer is reused as-is, it is fully overwritten by the next user. */
+    eBufferScrubUsedLength, /* Only the bytes used by the last packet are zeroed on release. */
+    eBufferScrubDeferred    /* Used bytes are zeroed later by a low priority background task. */
+} eBufferScrubPolicy_t;
+
+BaseType_t xNetworkInterfaceSetScrubPolicy( eBufferScrubPolicy_t ePolicy );
+eBufferScrubPolicy_t eNetworkInterfaceGetScrubPolicy( void );
+
+/* CPU cycles (PMCCNTR_EL0) spent scrubbing and returning buffers to the pools.
+ * Release figures are paid on the EMAC handler task, deferred figures by the
+ * background scrub task. */
+typedef struct
+{
+    uint64_t ullReleaseCycles;  /* Cycles spent in the Tx buffer release path. */
+    uint32_t ulReleaseCount;    /* Number of Tx buffer releases. */
+    uint64_t ullDeferredCycles; /* Cycles spent by the scrub task. */
+    uint32_t ulDeferredCount;   /* Number of buffers cleared by the scrub task. */
+} NetworkBufferScrubStats_t;
+
+BaseType_t xGetBufferScrubStats( NetworkBufferScrubStats_t * pxStats );
+void vResetBufferScrubStats( void );
+
 #define MAC_IS_MULTICAST( pucMACAddressBytes )    ( ( pucMACAddressBytes[ 0 ] & 1U ) != 0U )
 #define MAC_IS_UNICAST( pucMACAddressBytes )      ( ( pucMACAddressBytes[ 0 ] & 1U ) == 0U )
 
@@ -65,4 +165,4 @@ NetworkInterface_t * pxFillInterfaceDescriptor( BaseType_t xEMACIndex,
 #endif
 /* *INDENT-ON* */
 
-#endif /* NETWORK_INTERFACE_H */
+#endif /* SOCFPGA_NETWORK_INTERFACE_H */
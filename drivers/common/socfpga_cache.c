@@ -0,0 +1,126 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (C) 2025 Altera Corporation
+ *
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Batched cache maintenance over lists of memory regions
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "socfpga_cache.h"
+
+static size_t cache_dline_size(void)
+{
+    uint64_t ctr;
+
+    __asm volatile ("MRS %0, CTR_EL0" : "=r" (ctr));
+    /* DminLine holds log2 of the line size in words */
+    return (size_t)4U << ((ctr >> 16U) & 0xFU);
+}
+
+static void cache_op_run(cache_op_t op, uintptr_t start, uintptr_t end)
+{
+    /*
+     * The range routines treat start + size as inclusive, pass the last
+     * byte of the run so the line following it is left untouched.
+     */
+    size_t size = (size_t)(end - start) - 1U;
+
+    switch (op)
+    {
+        case CACHE_OP_CLEAN:
+            cache_force_write_back((void *)start, size);
+            break;
+
+        case CACHE_OP_INVALIDATE:
+            cache_force_invalidate((void *)start, size);
+            break;
+
+        case CACHE_OP_FLUSH:
+            cache_flush((void *)start, size);
+            break;
+
+        default:
+            break;
+    }
+}
+
+void cache_range_list_op(cache_op_t op, const cache_range_t *ranges,
+        size_t count)
+{
+    uintptr_t line_mask;
+    uintptr_t run_start = 0U;
+    uintptr_t run_end = 0U;
+    uintptr_t start, end;
+    size_t line_size;
+    size_t total = 0U;
+    bool in_run = false;
+    size_t i;
+
+    if ((ranges == NULL) || (count == 0U))
+    {
+        return;
+    }
+
+    if (op != CACHE_OP_INVALIDATE)
+    {
+        for (i = 0U; i < count; i++)
+        {
+            total += ranges[i].size;
+        }
+        if (total >= CACHE_SET_WAY_THRESHOLD)
+        {
+            if (op == CACHE_OP_CLEAN)
+            {
+                cache_clean_all();
+            }
+            else
+            {
+                cache_flush_all();
+            }
+            return;
+        }
+    }
+
+    line_size = cache_dline_size();
+    line_mask = ~((uintptr_t)line_size - 1U);
+
+    for (i = 0U; i < count; i++)
+    {
+        if (ranges[i].size == 0U)
+        {
+            continue;
+        }
+        start = (uintptr_t)ranges[i].addr & line_mask;
+        end = ((uintptr_t)ranges[i].addr + ranges[i].size + line_size - 1U) &
+                line_mask;
+
+        if (in_run && (start <= run_end) && (end >= run_start))
+        {
+            /* Touching or overlapping the current run, extend it */
+            if (start < run_start)
+            {
+                run_start = start;
+            }
+            if (end > run_end)
+            {
+                run_end = end;
+            }
+            continue;
+        }
+        if (in_run)
+        {
+            cache_op_run(op, run_start, run_end);
+        }
+        run_start = start;
+        run_end = end;
+        in_run = true;
+    }
+    if (in_run)
+    {
+        cache_op_run(op, run_start, run_end);
+    }
+
+    __asm volatile ("DSB SY" ::: "memory");
+}
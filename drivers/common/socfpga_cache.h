@@ -11,6 +11,33 @@
 #define __SOCFPGA_CACHE_H__
 #include <stddef.h>
 
+/**
+ * @brief Total size, in bytes, above which a clean or flush of a range list
+ * falls back to whole-cache maintenance by set/way.
+ */
+#ifndef CACHE_SET_WAY_THRESHOLD
+#define CACHE_SET_WAY_THRESHOLD    (256U * 1024U)
+#endif
+
+/**
+ * @brief Maintenance operation applied to a range list.
+ */
+typedef enum
+{
+    CACHE_OP_CLEAN = 0,    /*!< Write back dirty lines to memory */
+    CACHE_OP_INVALIDATE,   /*!< Discard lines without write-back */
+    CACHE_OP_FLUSH         /*!< Write back and then discard lines */
+} cache_op_t;
+
+/**
+ * @brief Memory region used in a range list.
+ */
+typedef struct
+{
+    void *addr;     /*!< Starting address of the region */
+    size_t size;    /*!< Size of the region, in bytes */
+} cache_range_t;
+
 /**
  * @brief Force write-back of a specified cache region to main memory.
  *
@@ -49,4 +76,43 @@ void cache_force_invalidate(void *addr, size_t sz);
  */
 void cache_flush(void *addr, size_t sz);
 
+/**
+ * @brief Clean the whole data cache by set/way.
+ *
+ * Writes back every dirty line in the data and unified caches up to the
+ * level of coherency, followed by a DSB. Only the caches of the calling
+ * core and the shared levels are affected.
+ */
+void cache_clean_all(void);
+
+/**
+ * @brief Clean and invalidate the whole data cache by set/way.
+ *
+ * Same as cache_clean_all() but also discards the lines after the
+ * write-back.
+ */
+void cache_flush_all(void);
+
+/**
+ * @brief Apply a cache maintenance operation to a list of memory regions.
+ *
+ * The regions are expanded to cache line boundaries and consecutive
+ * entries that touch or overlap are merged, so that every line is
+ * maintained only once. Entries are not sorted; callers get the best
+ * result by passing them in address order. A single DSB is issued after
+ * the last line, so the caller does not need its own barrier before
+ * handing the memory to a device.
+ *
+ * When the total size of a clean or flush reaches CACHE_SET_WAY_THRESHOLD,
+ * the whole data cache is maintained by set/way instead, which is cheaper
+ * than walking a large range by address. Invalidation is always done by
+ * address, since discarding the whole cache would lose unrelated data.
+ *
+ * @param[in] op     Maintenance operation to apply.
+ * @param[in] ranges Array of memory regions; zero sized entries are skipped.
+ * @param[in] count  Number of entries in the array.
+ */
+void cache_range_list_op(cache_op_t op, const cache_range_t *ranges,
+        size_t count);
+
 #endif
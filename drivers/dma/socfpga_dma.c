@@ -12,6 +12,7 @@
 #include "socfpga_cache.h"
 #include "socfpga_interrupt.h"
 #include "socfpga_rst_mngr.h"
+#include "osal.h"
 #include "osal_log.h"
 
 
@@ -57,6 +58,29 @@ static socfpga_hpu_interrupt_t interrupt_id[DMA_MAX_INSTANCE][MAX_CHANNEL_NUM] =
     }
 };
 
+/* Bookkeeping of one ring descriptor in queue mode */
+struct dma_async_slot
+{
+    void *cookie;
+    bool last;
+};
+
+/* Queue mode state of a channel */
+struct dma_async_ring
+{
+    BaseType_t active;
+    BaseType_t running;
+    BaseType_t stalled;
+    uint32_t head;
+    uint32_t tail;
+    uint32_t src_width;
+    uint64_t ctl;
+    struct dma_channel_reg_list *lli;
+    struct dma_async_slot slot[DMA_ASYNC_RING_SIZE];
+    dma_async_callback_t callback;
+    void *user_context;
+};
+
 struct dma_ch_cntxt
 {
     BaseType_t is_open;
@@ -75,6 +99,8 @@ struct dma_ch_cntxt
     uint64_t interrupt_en;
     /* Callback function for interrupts */
     dma_callback_t xp_dma_callback;
+    /* Descriptor ring when in queue mode */
+    struct dma_async_ring async;
 };
 
 static struct dma_ch_cntxt hdma_default[DMA_MAX_INSTANCE][MAX_CHANNEL_NUM];
@@ -83,6 +109,10 @@ static struct dma_ch_cntxt hdma_default[DMA_MAX_INSTANCE][MAX_CHANNEL_NUM];
 static struct dma_channel_reg_list plinked_list_chain[DMA_MAX_INSTANCE]
 [MAX_CHANNEL_NUM * MAX_LLI_PER_CHANNEL] __attribute__ ((aligned (64)));
 
+/* Descriptor rings of the channels in queue mode */
+static struct dma_channel_reg_list dma_async_lli[DMA_MAX_INSTANCE]
+[MAX_CHANNEL_NUM][DMA_ASYNC_RING_SIZE] __attribute__ ((aligned (64)));
+
 void pdma_irq_handler(void *data);
 
 dma_handle_t dma_open(uint32_t instance, uint32_t ch)
@@ -130,6 +160,7 @@ dma_handle_t dma_open(uint32_t instance, uint32_t ch)
     phandle->channel_num = ch;
     phandle->linked_list_base = &plinked_list_chain[instance][(ch *
                     MAX_LLI_PER_CHANNEL)];
+    phandle->async.lli = &dma_async_lli[instance][ch][0];
     phandle->is_open = 1;
     /*Setup and enable interrupts in GIC*/
     int_ret = interrupt_register_isr(phandle->intr_id, pdma_irq_handler, phandle);
@@ -164,6 +195,25 @@ static void dma_get_burst_len(dma_handle_t const hdma, dma_burst_len_t *src_burs
     }
 }
 
+/**
+ * @brief Get the control word of a linked list descriptor
+ */
+static uint64_t dma_lli_ctl(dma_handle_t const hdma, dma_xfer_width_t src_width,
+        dma_xfer_width_t dst_width)
+{
+    dma_burst_len_t src_burst_len, dst_burst_len;
+    uint64_t ctl;
+
+    dma_get_burst_len(hdma, &src_burst_len, &dst_burst_len);
+    ctl = (((uint64_t)src_width << DMA_CH_CTL_SRC_TR_WIDTH_POS) |
+            ((uint64_t)dst_width << DMA_CH_CTL_DST_TR_WIDTH_POS));
+    ctl |= (((uint64_t)src_burst_len << DMA_CH_CTL_SRC_MSIZE_POS) |
+            ((uint64_t)dst_burst_len << DMA_CH_CTL_DST_MSIZE_POS));
+    ctl |= ((DMA_CH_CTL_DST_STAT_EN_MASK | DMA_CH_CTL_SRC_STAT_EN_MASK) |
+            DMA_CH_CTL_IOC_BLKTFR_MASK);
+    return ctl;
+}
+
 int32_t dma_config(dma_handle_t const hdma, dma_config_t *pcfg)
 {
 
@@ -217,7 +267,6 @@ int32_t dma_setup_transfer(dma_handle_t const hdma, dma_xfer_cfg_t *xfer_list, u
     uint64_t val;
     uint64_t transfer_size;
     uint32_t i;
-    dma_burst_len_t src_burst_len, dst_burst_len;
     struct dma_channel_reg_list *plinked_list;
     dma_xfer_cfg_t *ptransfer_cfg;
     if (hdma == NULL)
@@ -262,14 +311,7 @@ int32_t dma_setup_transfer(dma_handle_t const hdma, dma_xfer_cfg_t *xfer_list, u
 
     for (i = 0U; i < num_xfers; i++)
     {
-        dma_get_burst_len(hdma, &src_burst_len, &dst_burst_len);
-        transfer_size = (((uint64_t)src_width << DMA_CH_CTL_SRC_TR_WIDTH_POS) |
-                ((uint64_t)dst_width << DMA_CH_CTL_DST_TR_WIDTH_POS));
-        transfer_size |=
-                (((uint64_t)src_burst_len <<
-                DMA_CH_CTL_SRC_MSIZE_POS) | ((uint64_t)dst_burst_len << DMA_CH_CTL_DST_MSIZE_POS));
-        transfer_size |= ((DMA_CH_CTL_DST_STAT_EN_MASK |
-                DMA_CH_CTL_SRC_STAT_EN_MASK) | DMA_CH_CTL_IOC_BLKTFR_MASK);
+        transfer_size = dma_lli_ctl(hdma, src_width, dst_width);
 
         if (((1UL << (uint64_t)src_width) == 0U) || (ptransfer_cfg == NULL))
         {
@@ -280,6 +322,14 @@ int32_t dma_setup_transfer(dma_handle_t const hdma, dma_xfer_cfg_t *xfer_list, u
         plinked_list->sar = ptransfer_cfg->src;
         plinked_list->dar = ptransfer_cfg->dst;
         plinked_list->ctl = transfer_size;
+        if (ptransfer_cfg->src_fixed)
+        {
+            plinked_list->ctl |= DMA_CH_CTL_SINC_MASK;
+        }
+        if (ptransfer_cfg->dst_fixed)
+        {
+            plinked_list->ctl |= DMA_CH_CTL_DINC_MASK;
+        }
         plinked_list->block_ts =
                 ((uint64_t)ptransfer_cfg->blk_size / (1UL << (uint64_t)src_width)) - 1UL;
         if (plinked_list->block_ts > MAX_BLOCK_SIZE)
@@ -410,6 +460,295 @@ int32_t dma_stop_transfer(dma_handle_t const hdma)
 }
 
 
+/**
+ * @brief Number of ring descriptors in use
+ */
+static uint32_t dma_async_used(const struct dma_async_ring *ring)
+{
+    return (ring->head + DMA_ASYNC_RING_SIZE - ring->tail) %
+           DMA_ASYNC_RING_SIZE;
+}
+
+/**
+ * @brief Enable the channel or let it fetch the descriptor it stopped at
+ */
+static void dma_async_kick(dma_handle_t const hdma)
+{
+    struct dma_async_ring *ring = &hdma->async;
+    uint64_t val;
+
+    if (dma_async_used(ring) == 0U)
+    {
+        return;
+    }
+    if (ring->running == 0)
+    {
+        val = RD_REG64(hdma->base_address + DMA_DMAC_CFGREG);
+        val |= (DMA_DMAC_CFGREG_INT_EN_MASK | DMA_DMAC_CFGREG_DMAC_EN_MASK);
+        WR_REG64(hdma->base_address + DMA_DMAC_CFGREG, val);
+        WR_REG64((hdma->ch_offset + DMA_CH_CFG2), hdma->config);
+        WR_REG64(hdma->ch_offset + DMA_CH_INTSTATUS_ENABLEREG,
+                hdma->interrupt_en);
+        WR_REG64(hdma->ch_offset + DMA_CH_INTSIGNAL_ENABLEREG,
+                hdma->interrupt_en);
+        WR_REG64(hdma->ch_offset + DMA_CH_LLP,
+                (uint64_t)(uintptr_t)&ring->lli[ring->tail]);
+        val = RD_REG64(hdma->base_address + DMA_DMAC_CHENREG);
+        val |= (1UL << (hdma->channel_num + CHENREG_CH_EN_POS));
+        val |= (1UL << (hdma->channel_num + CHENREG_CH_EN_WE_POS));
+        WR_REG64(hdma->base_address + DMA_DMAC_CHENREG, val);
+        hdma->channel_state = DMA_CH_ACTIVE;
+        ring->running = 1;
+    }
+    else if (ring->stalled != 0)
+    {
+        /* The descriptor it stopped at is valid now, fetch it again */
+        ring->stalled = 0;
+        WR_REG64(hdma->ch_offset + DMA_CH_BLK_TFR_RESUMEREQREG,
+                DMA_CH_BLK_TFR_RESUMEREQREG_BLK_TFR_RESUMEREQ_MASK);
+    }
+}
+
+/**
+ * @brief Collect the descriptors the DMAC has written back as done
+ */
+static uint32_t dma_async_reap(dma_handle_t const hdma, dma_completion_t *done)
+{
+    struct dma_async_ring *ring = &hdma->async;
+    struct dma_channel_reg_list *plli;
+    uint32_t count = 0U;
+
+    while (ring->tail != ring->head)
+    {
+        plli = &ring->lli[ring->tail];
+        cache_force_invalidate((void *)plli, sizeof(*plli));
+        if ((plli->ctl & DMA_CH_CTL_SHADOWREG_OR_LLI_VALID_MASK) != 0U)
+        {
+            break;
+        }
+        if (ring->slot[ring->tail].last)
+        {
+            done[count].cookie = ring->slot[ring->tail].cookie;
+            done[count].status = 0;
+            count++;
+        }
+        ring->tail = (ring->tail + 1U) % DMA_ASYNC_RING_SIZE;
+    }
+    return count;
+}
+
+/**
+ * @brief Interrupt handling of a channel in queue mode
+ */
+static void dma_async_irq(dma_handle_t const hdma)
+{
+    struct dma_async_ring *ring = &hdma->async;
+    dma_completion_t done[DMA_ASYNC_RING_SIZE];
+    uint32_t count;
+    uint64_t val;
+
+    val = RD_REG64(hdma->ch_offset + DMA_CH_INTSTATUS);
+    WR_REG64((hdma->ch_offset + DMA_CH_INTCLEARREG), val &
+            hdma->interrupt_en);
+
+    count = dma_async_reap(hdma, done);
+    if ((val & DMA_CH_INTSTATUS_SHADOWREG_OR_LLI_INVALID_ERR_INTSTAT_MASK) !=
+            0U)
+    {
+        /* Reached the end marker, resume at once if work was added since */
+        ring->stalled = 1;
+        dma_async_kick(hdma);
+    }
+    if (count > 0U)
+    {
+        ring->callback(hdma, done, count, ring->user_context);
+    }
+}
+
+int32_t dma_async_start(dma_handle_t const hdma, dma_xfer_width_t src_width,
+        dma_xfer_width_t dst_width, dma_async_callback_t callback,
+        void *puser_context)
+{
+    struct dma_async_ring *ring;
+    uint32_t i;
+
+    if ((hdma == NULL) || (callback == NULL))
+    {
+        ERROR("DMAC handle and callback cannot be NULL ");
+        return -EINVAL;
+    }
+    if (hdma->is_open != 1)
+    {
+        ERROR("DMAC channel should be opened before queue mode \n");
+        return -EIO;
+    }
+    ring = &hdma->async;
+    if ((hdma->channel_state != DMA_CH_IDLE) || (ring->active != 0))
+    {
+        ERROR("DMAC Channel is in active state ");
+        return -EBUSY;
+    }
+
+    /* A closed ring of invalid descriptors, the DMAC stops at the first */
+    for (i = 0U; i < DMA_ASYNC_RING_SIZE; i++)
+    {
+        ring->lli[i].ctl = 0U;
+        ring->lli[i].llp = (uint64_t)(uintptr_t)&ring->lli[(i + 1U) %
+                DMA_ASYNC_RING_SIZE];
+        ring->slot[i].cookie = NULL;
+        ring->slot[i].last = false;
+    }
+    cache_force_write_back((void *)ring->lli, sizeof(dma_async_lli[0][0]));
+
+    ring->head = 0U;
+    ring->tail = 0U;
+    ring->running = 0;
+    ring->stalled = 0;
+    ring->src_width = (uint32_t)src_width;
+    ring->ctl = dma_lli_ctl(hdma, src_width, dst_width) |
+            DMA_CH_CTL_SHADOWREG_OR_LLI_VALID_MASK;
+    ring->callback = callback;
+    ring->user_context = puser_context;
+    hdma->interrupt_en = (DMA_CH_INTSTATUS_BLOCK_TFR_DONE_INTSTAT_MASK |
+            DMA_CH_INTSTATUS_SHADOWREG_OR_LLI_INVALID_ERR_INTSTAT_MASK);
+    ring->active = 1;
+    return 0;
+}
+
+int32_t dma_async_submit(dma_handle_t const hdma,
+        const dma_async_xfer_t *xfers, uint32_t count)
+{
+    struct dma_async_ring *ring;
+    struct dma_channel_reg_list *plli;
+    uint64_t max_bytes, src, dst, len;
+    uint32_t needed = 0U, i;
+    uint64_t left;
+
+    if ((hdma == NULL) || (xfers == NULL) || (hdma->async.active == 0))
+    {
+        ERROR("DMAC channel is not in queue mode");
+        return -EINVAL;
+    }
+    ring = &hdma->async;
+    max_bytes = ((uint64_t)MAX_BLOCK_SIZE + 1U) << ring->src_width;
+    for (i = 0U; i < count; i++)
+    {
+        if ((xfers[i].size == 0U) ||
+                ((xfers[i].size & ((1U << ring->src_width) - 1U)) != 0U))
+        {
+            ERROR("Transfer size must be a multiple of the source width");
+            return -EINVAL;
+        }
+        needed += (uint32_t)(((uint64_t)xfers[i].size + max_bytes - 1U) /
+                max_bytes);
+    }
+
+    osal_enter_critical();
+    if (needed > (DMA_ASYNC_RING_SIZE - 1U - dma_async_used(ring)))
+    {
+        osal_exit_critical();
+        return -ENOSPC;
+    }
+    for (i = 0U; i < count; i++)
+    {
+        src = xfers[i].src;
+        dst = xfers[i].dst;
+        left = xfers[i].size;
+        while (left > 0U)
+        {
+            len = (left < max_bytes) ? left : max_bytes;
+            plli = &ring->lli[ring->head];
+            plli->sar = src;
+            plli->dar = dst;
+            plli->block_ts = (len >> ring->src_width) - 1U;
+            plli->ctl = ring->ctl;
+            if (xfers[i].src_fixed)
+            {
+                plli->ctl |= DMA_CH_CTL_SINC_MASK;
+            }
+            else
+            {
+                src += len;
+            }
+            if (xfers[i].dst_fixed)
+            {
+                plli->ctl |= DMA_CH_CTL_DINC_MASK;
+            }
+            else
+            {
+                dst += len;
+            }
+            left -= len;
+            ring->slot[ring->head].cookie = xfers[i].cookie;
+            ring->slot[ring->head].last = (left == 0U);
+            cache_force_write_back((void *)plli, sizeof(*plli));
+            ring->head = (ring->head + 1U) % DMA_ASYNC_RING_SIZE;
+        }
+    }
+    __asm volatile ("DSB SY" ::: "memory");
+    dma_async_kick(hdma);
+    osal_exit_critical();
+    return 0;
+}
+
+uint32_t dma_async_free(dma_handle_t const hdma)
+{
+    uint32_t used;
+
+    if ((hdma == NULL) || (hdma->async.active == 0))
+    {
+        return 0U;
+    }
+    osal_enter_critical();
+    used = dma_async_used(&hdma->async);
+    osal_exit_critical();
+    return DMA_ASYNC_RING_SIZE - 1U - used;
+}
+
+int32_t dma_async_stop(dma_handle_t const hdma)
+{
+    struct dma_async_ring *ring;
+    dma_completion_t done[DMA_ASYNC_RING_SIZE];
+    uint32_t count, ndrop = 0U;
+    int32_t ret = 0;
+
+    if ((hdma == NULL) || (hdma->async.active == 0))
+    {
+        ERROR("DMAC channel is not in queue mode");
+        return -EINVAL;
+    }
+    ring = &hdma->async;
+    if ((ring->running != 0) && (dma_stop_transfer(hdma) != 0))
+    {
+        ERROR("Failed to stop the DMAC channel");
+        ret = -EIO;
+    }
+    WR_REG64(hdma->ch_offset + DMA_CH_INTSIGNAL_ENABLEREG, 0U);
+    WR_REG64(hdma->ch_offset + DMA_CH_INTCLEARREG, hdma->interrupt_en);
+
+    /* Report what finished before the stop, then drop the rest */
+    count = dma_async_reap(hdma, done);
+    while (ring->tail != ring->head)
+    {
+        if (ring->slot[ring->tail].last)
+        {
+            done[count + ndrop].cookie = ring->slot[ring->tail].cookie;
+            done[count + ndrop].status = -ECANCELED;
+            ndrop++;
+        }
+        ring->tail = (ring->tail + 1U) % DMA_ASYNC_RING_SIZE;
+    }
+    ring->active = 0;
+    ring->running = 0;
+    hdma->channel_state = DMA_CH_IDLE;
+    hdma->interrupt_en = 0U;
+    if ((count + ndrop) > 0U)
+    {
+        ring->callback(hdma, done, count + ndrop, ring->user_context);
+    }
+    return ret;
+}
+
 int32_t dma_close(dma_handle_t const hdma)
 {
     if (hdma == NULL)
@@ -428,6 +767,11 @@ void pdma_irq_handler(void *data)
 {
     uint64_t val;
     dma_handle_t phandle = (dma_handle_t)data;
+    if (phandle->async.active != 0)
+    {
+        dma_async_irq(phandle);
+        return;
+    }
     val = RD_REG64(phandle->ch_offset + DMA_CH_INTSTATUS);
     if ((val & TFR_DONE_MASK) == TFR_DONE_MASK)
     {
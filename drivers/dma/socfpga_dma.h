@@ -9,6 +9,9 @@
 #ifndef __SOCFPGA_DMA_H__
 #define __SOCFPGA_DMA_H__
 
+#include <stdint.h>
+#include <stdbool.h>
+
 /**
  * @file socfpga_dma.h
  * @brief Header file for DMA HAL driver
@@ -68,6 +71,10 @@
 #define DMA_CH2    1U       /*!<DMA Channel 2*/
 #define DMA_CH3    2U       /*!<DMA Channel 3*/
 #define DMA_CH4    3U       /*!<DMA Channel 4*/
+
+#ifndef DMA_ASYNC_RING_SIZE
+#define DMA_ASYNC_RING_SIZE    16U  /*!<Descriptors per channel in queue mode, one is kept as the end marker*/
+#endif
 /**
  * @}
  */
@@ -245,12 +252,47 @@ typedef struct dma_xfer_cfg
     uint64_t dst; /*!< Destination address for the DMA transfer */
     uint32_t blk_size; /*!< Size of the block to be transferred in bytes */
     struct dma_xfer_cfg *next_trnsfr_cfg; /*!< Pointer to the next block transfer configuration*/
+    bool src_fixed; /*!< Keep the source address fixed, for reads from a peripheral data port */
+    bool dst_fixed; /*!< Keep the destination address fixed, for writes to a peripheral data port */
 
 } dma_xfer_cfg_t;
+
+/**
+ * @brief A transfer submitted to a channel in queue mode.
+ *
+ * Transfers longer than one DMA block are split over several descriptors.
+ */
+typedef struct dma_async_xfer
+{
+    uint64_t src; /*!< Source address for the DMA transfer */
+    uint64_t dst; /*!< Destination address for the DMA transfer */
+    uint32_t size; /*!< Size of the transfer in bytes, a multiple of the source width */
+    bool src_fixed; /*!< Keep the source address fixed */
+    bool dst_fixed; /*!< Keep the destination address fixed */
+    void *cookie; /*!< Returned with the completion of the transfer */
+} dma_async_xfer_t;
+
+/**
+ * @brief Completion of a transfer submitted in queue mode.
+ */
+typedef struct dma_completion
+{
+    void *cookie; /*!< Cookie of the completed transfer */
+    int32_t status; /*!< 0 if done, -ECANCELED if dropped by dma_async_stop() */
+} dma_completion_t;
 /**
  * @}
  */
 
+/**
+ * Function pointer for completions in queue mode. Receives every transfer
+ * completed since the previous call, in submission order. Called from the
+ * DMA interrupt, or from dma_async_stop() for dropped transfers.
+ * @ingroup dma_fns
+ */
+typedef void (*dma_async_callback_t)(dma_handle_t pdma_handle,
+        const dma_completion_t *done, uint32_t count, void *puser_context);
+
 /**
  * @addtogroup dma_fns
  * @{
@@ -361,6 +403,73 @@ int32_t dma_stop_transfer(dma_handle_t const hdma);
  * - -EINVAL: if hdma is NULL
  */
 int32_t dma_close(dma_handle_t const hdma);
+
+/**
+ * @brief Put a channel into queue mode
+ *
+ * In queue mode the channel runs a ring of DMA_ASYNC_RING_SIZE linked list
+ * descriptors. Submitted transfers are appended to the ring while the
+ * channel runs, the channel only waits when the ring runs empty. The
+ * channel must be configured with dma_config() first, its callback is not
+ * used in queue mode.
+ *
+ * @param[in] hdma          Handle to the channel returned by the Open()
+ * @param[in] src_width     The source transfer width
+ * @param[in] dst_width     The destination transfer width
+ * @param[in] callback      Completion callback
+ * @param[in] puser_context User context passed to the callback
+ *
+ * @return
+ * - 0, on success
+ * - -EINVAL: if hdma or callback is NULL
+ * - -EIO:    if the channel is not open
+ * - -EBUSY:  if a transfer is in progress or queue mode is already on
+ */
+int32_t dma_async_start(dma_handle_t const hdma, dma_xfer_width_t src_width,
+        dma_xfer_width_t dst_width, dma_async_callback_t callback,
+        void *puser_context);
+
+/**
+ * @brief Append transfers to a channel in queue mode
+ *
+ * The transfers are added as a whole or not at all. May be called from
+ * the completion callback.
+ *
+ * @param[in] hdma  Handle to the channel returned by the Open()
+ * @param[in] xfers Transfers to append
+ * @param[in] count Number of transfers
+ *
+ * @return
+ * - 0, on success
+ * - -EINVAL: if an argument is invalid or queue mode is off
+ * - -ENOSPC: if the ring has not enough free descriptors
+ */
+int32_t dma_async_submit(dma_handle_t const hdma,
+        const dma_async_xfer_t *xfers, uint32_t count);
+
+/**
+ * @brief Number of descriptors free in the ring of a channel in queue mode
+ *
+ * @param[in] hdma Handle to the channel returned by the Open()
+ *
+ * @return Free descriptors, 0 if queue mode is off
+ */
+uint32_t dma_async_free(dma_handle_t const hdma);
+
+/**
+ * @brief Leave queue mode
+ *
+ * Stops the channel. Transfers not completed are reported to the callback
+ * with -ECANCELED.
+ *
+ * @param[in] hdma Handle to the channel returned by the Open()
+ *
+ * @return
+ * - 0, on success
+ * - -EINVAL: if hdma is NULL or queue mode is off
+ * - -EIO:    if the channel failed to stop
+ */
+int32_t dma_async_stop(dma_handle_t const hdma);
 /**
  * @}
  */
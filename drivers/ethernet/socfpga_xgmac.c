@@ -78,23 +78,24 @@
 #include "socfpga_xgmac_ll.h"
 #include "socfpga_interrupt.h"
 #include "socfpga_xgmac_configs.h"
+#include "socfpga_clk_mngr.h"
 #include "osal.h"
 #include "osal_log.h"
+#include "timers.h"
 
 #define XGMAC_EMAC_STARTED     0x1
 #define XGMAC_EMAC_STOPPED     0x0
 #define XGMAC_CSUM_BY_HW       1U
 #define XGMAC_DMA_DESC_SIZE    16UL
+#define XGMAC_RX_FLUSH_BATCH   16U
 
 #define SOCFGPA_CACHE_LINE_WIDTH    64U
 
-struct xgmac_desc_t
+/* Transmit and receive ring of one DMA channel */
+struct xgmac_dma_chan_t
 {
-    xgmac_base_addr_t xgmac_inst_base_addr;       /*!< XGMAC instance base address */
-    xgmac_base_addr_t xgmac_inst_dma_base_addr;    /*!< XGMAC DMA base address */
-    int32_t instance;                           /*!< Instance number */
-    uint8_t csum_mode;                      /*!< Checksum mode */
-    uint8_t phy_type;                           /*!< PHY type */
+    struct xgmac_desc_t *hxgmac;          /*!< Owning XGMAC instance */
+    uint8_t index;                        /*!< DMA channel number */
 
     xgmac_buf_desc_t *tx_bd_ring;        /*!< Transmit buffer descriptor ring */
     xgmac_buf_desc_t *rx_bd_ring;        /*!< Receive buffer descriptor ring */
@@ -110,7 +111,36 @@ struct xgmac_desc_t
     volatile int32_t tx_desc_head;                /*!< Transmit descriptor head index */
     volatile int32_t tx_desc_tail;                /*!< Transmit descriptor tail index */
     volatile int32_t rx_desc_head;                /*!< Receive descriptor head index */
-    volatile int32_t rx_desc_tail;                /*!< Receive descriptor tail index */
+    volatile int32_t rx_desc_tail;                /*!< Next receive descriptor to refill */
+    uint32_t rx_unfilled;                 /*!< Received descriptors waiting for a refill */
+    uint8_t rx_ctxt_slot[XGMAC_NUM_RX_DESC]; /*!< Descriptor was used for a timestamp context */
+
+    osal_semaphore_t tx_sem;           /*!< Transmit synchronization semaphore */
+    osal_semaphore_t tx_mutex;           /*!< Transmit synchronization mutex */
+
+    uint32_t tx_coal_count;               /*!< Frames queued since the last IOC */
+    TimerHandle_t tx_coal_timer;          /*!< Tx completion watchdog timer */
+    volatile int8_t tx_coal_armed;        /*!< Watchdog is running */
+
+    uint32_t rx_coal_count;               /*!< Descriptors refilled since the last IOC */
+};
+
+struct xgmac_desc_t
+{
+    xgmac_base_addr_t xgmac_inst_base_addr;       /*!< XGMAC instance base address */
+    xgmac_base_addr_t xgmac_inst_dma_base_addr;    /*!< XGMAC DMA base address */
+    int32_t instance;                           /*!< Instance number */
+    uint8_t csum_mode;                      /*!< Checksum mode */
+    uint8_t phy_type;                           /*!< PHY type */
+
+    /*!< Per DMA channel rings, the highest channel has the highest priority */
+    struct xgmac_dma_chan_t chan[XGMAC_NUM_DMA_CHANNELS];
+
+    uint8_t rx_prio_chan[XGMAC_NUM_PRIORITIES];   /*!< Rx DMA channel of each VLAN priority */
+    uint8_t tx_prio_chan[XGMAC_NUM_PRIORITIES];   /*!< Tx DMA channel of each priority */
+    uint8_t l3l4_filter_mask;             /*!< L3/L4 filters in use */
+    uint8_t ptp_enabled;                  /*!< System time unit is running */
+    uint64_t ptp_default_addend;          /*!< Addend giving the nominal clock rate, 32.32 fixed point */
 
     xgmac_callback_t callback;           /*!< Callback function */
     void *pcntxt;                          /*!< User context pointer */
@@ -120,11 +150,16 @@ struct xgmac_desc_t
     int8_t is_started;                            /*!< Indicates if device is started */
     int8_t is_ready;                              /*!< Indicates if device is ready */
 
-    osal_semaphore_t tx_sem;           /*!< Transmit synchronization semaphore */
-    osal_semaphore_t tx_mutex;           /*!< Transmit synchronization mutex */
+    uint32_t tx_coal_frames;              /*!< Frames per Tx completion interrupt */
+    uint32_t tx_coal_timeout_ms;          /*!< Tx completion watchdog timeout */
+
+    uint32_t rx_coal_frames;              /*!< Frames per Rx completion interrupt */
+    uint32_t rx_coal_timeout_us;          /*!< Rx interrupt watchdog (RIWT) timeout */
 
 };
 
+typedef struct xgmac_dma_chan_t *xgmac_chan_t;
+
 static struct xgmac_desc_t *xgmac_descriptors = NULL;
 
 /* Static functions */
@@ -132,14 +167,27 @@ static Basetype_t dma_soft_reset(xgmac_base_addr_t emac_base_addr);
 static Basetype_t dma_set_descriptors(xgmac_handle_t hxgmac);
 static void dma_channel_init(xgmac_handle_t hxgmac, const
         xgmac_dev_config_str_t *xgmac_dev_config);
-void dma_setup_tx_descriptor_list(xgmac_handle_t hxgmac);
-void dma_setup_rx_descriptor_list(xgmac_handle_t hxgmac);
+void dma_setup_tx_descriptor_list(xgmac_chan_t pchan);
+void dma_setup_rx_descriptor_list(xgmac_chan_t pchan);
 static Basetype_t dma_enable_interrupts(xgmac_handle_t hxgmac, const
         xgmac_dev_config_str_t *xgmac_dev_config);
 static Basetype_t dma_disable_interrupts(xgmac_handle_t hxgmac, const
         xgmac_dev_config_str_t *xgmac_dev_config);
 static Basetype_t dma_register_isr(xgmac_handle_t hxgmac);
 static Basetype_t dma_un_register_isr(xgmac_handle_t hxgmac);
+static int32_t tx_reserve_desc(xgmac_chan_t pchan, uint32_t count);
+static void tx_flush_frags(const xgmac_tx_buf_t *frags, uint32_t nfrags);
+static xgmac_buf_desc_t *tx_set_buf_desc(xgmac_chan_t pchan, int32_t indx,
+        uint8_t *buf, uint32_t size, uint8_t release_buf);
+static void tx_coal_request_ioc(xgmac_chan_t pchan, xgmac_buf_desc_t *plast_tx_desc);
+static int32_t tx_post_frame(xgmac_chan_t pchan, xgmac_buf_desc_t *pfirst_tx_desc,
+        int32_t head_indx);
+static void tx_coal_arm_watchdog(xgmac_chan_t pchan);
+static void tx_coal_watchdog_expired(TimerHandle_t timer);
+static void dma_set_rx_watchdog(xgmac_handle_t hxgmac);
+static void mac_set_prio_steering(xgmac_handle_t hxgmac);
+static uint64_t xgmac_ptp_nominal_addend(uint32_t ssinc);
+static uint32_t xgmac_ptp_round_addend(uint64_t addend);
 void socfpga_xgmac_dma_isr(void *param);
 
 static socfpga_hpu_interrupt_t get_emac_intr_id(int32_t instance)
@@ -216,13 +264,37 @@ xgmac_handle_t xgmac_emac_init(xgmac_config_t *cfg)
     /* Enable Hardware checksum */
     hxgmac->csum_mode = XGMAC_CSUM_BY_HW;
 
-    /* Initialize Tx and Rx BD Ring to zero */
-    hxgmac->tx_bd_ring = NULL;
-    hxgmac->rx_bd_ring = NULL;
+    for (uint8_t ch = 0; ch < XGMAC_NUM_DMA_CHANNELS; ch++)
+    {
+        hxgmac->chan[ch].hxgmac = hxgmac;
+        hxgmac->chan[ch].index = ch;
+
+        /* Initialize Tx and Rx BD Ring to zero */
+        hxgmac->chan[ch].tx_bd_ring = NULL;
+        hxgmac->chan[ch].rx_bd_ring = NULL;
+
+        /* Initialize TransmitSemaphore and TransmitMutex to NULL */
+        hxgmac->chan[ch].tx_sem = NULL;
+        hxgmac->chan[ch].tx_mutex = NULL;
+        hxgmac->chan[ch].tx_coal_timer = NULL;
+    }
+
+    /* Spread the user priorities evenly across the channels, the highest
+     * priorities on the highest channel */
+    for (uint8_t prio = 0; prio < XGMAC_NUM_PRIORITIES; prio++)
+    {
+        hxgmac->rx_prio_chan[prio] = (uint8_t)((prio * XGMAC_NUM_DMA_CHANNELS) /
+                XGMAC_NUM_PRIORITIES);
+        hxgmac->tx_prio_chan[prio] = hxgmac->rx_prio_chan[prio];
+    }
+
+    /* Default Tx interrupt coalescing parameters */
+    hxgmac->tx_coal_frames = XGMAC_TX_COAL_FRAMES;
+    hxgmac->tx_coal_timeout_ms = XGMAC_TX_COAL_TIMEOUT_MS;
 
-    /* Initialize TransmitSemaphore and TransmitMutex to NULL */
-    hxgmac->tx_sem = NULL;
-    hxgmac->tx_mutex = NULL;
+    /* Default Rx interrupt moderation parameters */
+    hxgmac->rx_coal_frames = XGMAC_RX_COAL_FRAMES;
+    hxgmac->rx_coal_timeout_us = XGMAC_RX_COAL_TIMEOUT_US;
 
     hxgmac->is_initialized = TRUE;
 
@@ -259,6 +331,9 @@ int32_t xgmac_emac_start(xgmac_handle_t hxgmac)
     /* Program MTL configuration registers for Tx and Rx */
     xgmac_mtl_init(mtl_base_addr, &xgmac_dev_config_str);
 
+    /* Steer tagged frames to the Rx queues by VLAN priority */
+    mac_set_prio_steering(hxgmac);
+
     /* Setup the MAC Address in MAC High and MAC Low Registers */
     xgmac_set_macaddress(emac_base_addr, (void *)bytes, MAC_ADRRESS_INDEX1);
 
@@ -309,6 +384,9 @@ int32_t xgmac_dma_initialize(xgmac_handle_t hxgmac)
     /* Initialize DMA channel */
     dma_channel_init(hxgmac, &xgmac_dev_config_str);
 
+    /* Program the Rx interrupt watchdog used for interrupt moderation */
+    dma_set_rx_watchdog(hxgmac);
+
     /* Start Receive and Transmit DMA */
     xgmac_start_dma_dev(dma_base_addr, &xgmac_dev_config_str);
 
@@ -343,126 +421,117 @@ xgmac_err_info_t *xgmac_get_err_info(xgmac_handle_t hxgmac)
 
 int32_t xgmac_dma_transmit(xgmac_handle_t hxgmac, xgmac_tx_buf_t *dma_tx_buf)
 {
-    TickType_t block_time_ticks = pdMS_TO_TICKS(5000U);
+    return xgmac_dma_transmit_ch(hxgmac, XGMAC_DMA_CH0, dma_tx_buf);
+}
+
+int32_t xgmac_dma_transmit_ch(xgmac_handle_t hxgmac, uint8_t chan,
+        xgmac_tx_buf_t *dma_tx_buf)
+{
+    return xgmac_dma_transmit_sg(hxgmac, chan, dma_tx_buf, 1U);
+}
+
+int32_t xgmac_dma_transmit_sg(xgmac_handle_t hxgmac, uint8_t chan,
+        xgmac_tx_buf_t *frags, uint32_t nfrags)
+{
+    xgmac_chan_t pchan;
     xgmac_buf_desc_t *pdma_tx_desc;
-    int32_t head_indx = hxgmac->tx_desc_head;
-    uint32_t data_length;
-    uint32_t last_tx_desc;
-    xgmac_base_addr_t dma_base_addr;
+    xgmac_buf_desc_t *pfirst_tx_desc;
+    int32_t head_indx;
+    uint32_t frame_length = 0U;
+    uint32_t des3_flags;
     uint8_t ckecksum_insertion;
-    uint32_t low_addr, high_addr;
-    uintptr_t buffer_addr;
-    int32_t ret_status = 0;
-
-    dma_base_addr = hxgmac->xgmac_inst_dma_base_addr;
+    int32_t ret_status;
 
-    /* Do while once and break in case of error */
-    do
+    if ((hxgmac == NULL) || (chan >= XGMAC_NUM_DMA_CHANNELS) ||
+            (frags == NULL) || (nfrags == 0U) || (nfrags > XGMAC_MAX_TX_FRAGS))
     {
-        if (hxgmac->tx_sem == NULL)
-        {
-            ret_status = -EIO;
-            break;
-        }
+        return -EINVAL;
+    }
 
-        if (osal_semaphore_wait(hxgmac->tx_sem, block_time_ticks) != pdPASS)
+    /* Each fragment takes one descriptor and its buffer-1 length field */
+    for (uint32_t i = 0; i < nfrags; i++)
+    {
+        if ((frags[i].buf == NULL) || (frags[i].size == 0U) ||
+                (frags[i].size > TDES2_NORM_RD_HL_B1L_MASL))
         {
-            ERROR("xgmac_dma_transmit: Time-out TX buffer not available.");
-            ret_status = -EIO;
-            break;
+            return -EINVAL;
         }
+        frame_length += frags[i].size;
+    }
+    if (frame_length > TDES3_NORM_RD_FL_TPL_MASK)
+    {
+        return -EINVAL;
+    }
 
-        if (osal_semaphore_wait(hxgmac->tx_mutex, block_time_ticks) != pdFAIL)
-        {
-
-            pdma_tx_desc = &(hxgmac->tx_bd_ring[head_indx]);
-            if (pdma_tx_desc == NULL)
-            {
-                return -EINVAL;
-            }
-
-            /* Assign NW Buffer address to Desc0 address */
-            buffer_addr = (uintptr_t)dma_tx_buf->buf;
-            low_addr = (uint32_t)buffer_addr;
-            high_addr = (uint32_t)(buffer_addr >> 32);
-
-            /* The Application will set this flag if it wants to release buffers after Tx done.
-             * Hence copy the buffer address later to be used in TX Done function */
-            if (dma_tx_buf->release_buf != 0U)
-            {
-                hxgmac->ptx_dma_buf1_ap[head_indx] = (uint8_t *)buffer_addr;
-            }
-            else
-            {
-                hxgmac->ptx_dma_buf1_ap[head_indx] = NULL;
-            }
-
-            /* Assign BufferAP address to Desc0 and Desc1  */
-            pdma_tx_desc->des0 = low_addr;
-            pdma_tx_desc->des1 = high_addr;
-
-            data_length = dma_tx_buf->size;
-            xgmac_flush_buffer((void *)(uintptr_t)buffer_addr, data_length);
-
-            /* Set Buffer-1 Length */
-            pdma_tx_desc->des2 = (data_length & TDES2_NORM_RD_HL_B1L_MASL);
-
-            /* Enable Interrupt On Completion */
-            pdma_tx_desc->des2 |= TDES2_NORM_RD_IOC_MASK;
-
-            /* Prepare transmit descriptors to give to DMA. */
+    pchan = &(hxgmac->chan[chan]);
 
-            /* Set the IPv4 checksum */
-            ckecksum_insertion = hxgmac->csum_mode;
-            if (ckecksum_insertion == XGMAC_CSUM_BY_HW)
-            {
-                pdma_tx_desc->des3 |= TDES3_NORM_RD_CIC_TPL_MASK;
-            }
+    ret_status = tx_reserve_desc(pchan, nfrags);
+    if (ret_status != 0)
+    {
+        return ret_status;
+    }
 
-            /* Set first and last descriptor mask */
-            /* Set Own bit of the Tx descriptor to give the buffer back to DMA */
-            pdma_tx_desc->des3 |= TDES3_NORM_RD_FD_MASK |
-                    TDES3_NORM_RD_LD_MASK | TDES3_NORM_RD_OWN_MASK;
+    tx_flush_frags(frags, nfrags);
 
-            /* Issue synchronization barrier instruction */
-            __asm volatile ("DSB SY");
+    head_indx = pchan->tx_desc_head;
+    pfirst_tx_desc = &(pchan->tx_bd_ring[head_indx]);
 
-            /* Point to next descriptor */
-            head_indx++;
-            if (head_indx == XGMAC_NUM_TX_DESC)
-            {
-                head_indx = 0;
-            }
+    /* Every descriptor of the frame carries its total length */
+    des3_flags = frame_length & TDES3_NORM_RD_FL_TPL_MASK;
 
-            /* Update the TX-head index */
-            hxgmac->tx_desc_head = head_indx;
+    /* Set the IPv4 checksum */
+    ckecksum_insertion = hxgmac->csum_mode;
+    if (ckecksum_insertion == XGMAC_CSUM_BY_HW)
+    {
+        des3_flags |= TDES3_NORM_RD_CIC_TPL_MASK;
+    }
 
-            /* Program the  Tx Tail Pointer Register */
-            last_tx_desc = (uint32_t)(uintptr_t)&(hxgmac->tx_bd_ring[head_indx]);
-            WR_DMA_CHNL_REG32(dma_base_addr, XGMAC_DMA_CH0, XGMAC_DMA_CH_TXDESC_TAIL_LPOINTER,
-                    last_tx_desc);
+    for (uint32_t i = 0; i < nfrags; i++)
+    {
+        pdma_tx_desc = tx_set_buf_desc(pchan, head_indx, frags[i].buf,
+                frags[i].size, frags[i].release_buf);
 
-            /* Release the Mutex. */
-            if (osal_semaphore_post(hxgmac->tx_mutex) == false)
+        /* Prepare transmit descriptors to give to DMA. */
+        pdma_tx_desc->des3 = des3_flags;
+        if (i == 0U)
+        {
+            pdma_tx_desc->des3 |= TDES3_NORM_RD_FD_MASK;
+            if ((frags[0].timestamp != 0U) && (hxgmac->ptp_enabled != 0U))
             {
-                ret_status = -EIO;
-                break;
+                pdma_tx_desc->des2 |= TDES2_NORM_RD_TTSE_TMWD_MASK;
             }
         }
         else
         {
-            ret_status = -EIO;
-            break;
+            /* The first descriptor is handed over last */
+            pdma_tx_desc->des3 |= TDES3_NORM_RD_OWN_MASK;
         }
-    } while(false);
 
-    return ret_status;
+        if (i == (nfrags - 1U))
+        {
+            pdma_tx_desc->des3 |= TDES3_NORM_RD_LD_MASK;
+            tx_coal_request_ioc(pchan, pdma_tx_desc);
+        }
+
+        head_indx = (head_indx + 1) % XGMAC_NUM_TX_DESC;
+    }
+
+    return tx_post_frame(pchan, pfirst_tx_desc, head_indx);
 }
 
 int32_t xgmac_dma_receive(xgmac_handle_t hxgmac, xgmac_rx_buf_t *dma_rx_buf)
 {
+    return xgmac_dma_receive_ch(hxgmac, XGMAC_DMA_CH0, dma_rx_buf);
+}
+
+int32_t xgmac_dma_receive_ch(xgmac_handle_t hxgmac, uint8_t chan,
+        xgmac_rx_buf_t *dma_rx_buf)
+{
+    xgmac_chan_t pchan;
     xgmac_buf_desc_t *pdma_rx_desc;
-    int32_t head_indx = hxgmac->rx_desc_head;
+    xgmac_buf_desc_t *pctxt_desc = NULL;
+    int32_t head_indx;
+    int32_t ctxt_indx = 0;
     uint8_t *pethernet_buffer;
     BaseType_t received_packet_length;
     BaseType_t dma_inv_length;
@@ -470,7 +539,20 @@ int32_t xgmac_dma_receive(xgmac_handle_t hxgmac, xgmac_rx_buf_t *dma_rx_buf)
 
     ret_status = 0;
 
-    pdma_rx_desc = &(hxgmac->rx_bd_ring[head_indx]);
+    if ((hxgmac == NULL) || (chan >= XGMAC_NUM_DMA_CHANNELS))
+    {
+        return -EINVAL;
+    }
+    pchan = &(hxgmac->chan[chan]);
+    head_indx = pchan->rx_desc_head;
+
+    /* Every descriptor was received and none refilled yet */
+    if (pchan->rx_unfilled >= (uint32_t)XGMAC_NUM_RX_DESC)
+    {
+        return -EAGAIN;
+    }
+
+    pdma_rx_desc = &(pchan->rx_bd_ring[head_indx]);
     if (pdma_rx_desc == NULL)
     {
         return -EINVAL;
@@ -478,8 +560,21 @@ int32_t xgmac_dma_receive(xgmac_handle_t hxgmac, xgmac_rx_buf_t *dma_rx_buf)
 
     if ((pdma_rx_desc->des3 & XGMAC_RDES3_OWN) == 0u)
     {
+        /* The receive timestamp follows the frame in a context descriptor,
+         * leave the frame in the ring until that one is written back too */
+        if ((pdma_rx_desc->des3 & (RDES3_NORM_WR_LD_MASK | RDES3_NORM_WR_CDA_MASK)) ==
+                (RDES3_NORM_WR_LD_MASK | RDES3_NORM_WR_CDA_MASK))
+        {
+            ctxt_indx = (head_indx + 1) % XGMAC_NUM_RX_DESC;
+            pctxt_desc = &(pchan->rx_bd_ring[ctxt_indx]);
+            if ((pctxt_desc->des3 & XGMAC_RDES3_OWN) != 0U)
+            {
+                return -EAGAIN;
+            }
+        }
+
         /* Parse the buffer address from RxBufAP Array  */
-        pethernet_buffer = hxgmac->prx_dma_buf1_ap[head_indx];
+        pethernet_buffer = pchan->prx_dma_buf1_ap[head_indx];
         if (pethernet_buffer == NULL)
         {
             return -EINVAL;
@@ -498,7 +593,31 @@ int32_t xgmac_dma_receive(xgmac_handle_t hxgmac, xgmac_rx_buf_t *dma_rx_buf)
         dma_rx_buf->buf = pethernet_buffer;
         dma_rx_buf->size = received_packet_length;
         dma_rx_buf->packet_status = pdma_rx_desc->des3;
+        dma_rx_buf->timestamp_valid = 0U;
+
+        /* The descriptor now waits for a refill */
+        pchan->rx_desc_head = (head_indx + 1) % XGMAC_NUM_RX_DESC;
+        pchan->rx_unfilled++;
+
+        if (pctxt_desc != NULL)
+        {
+            if (((pctxt_desc->des3 & RDES3_NORM_WR_CTXT_MASK) != 0U) &&
+                    ((pctxt_desc->des3 & (RDES3_CTXT_WR_TSA_MASK |
+                    RDES3_CTXT_WR_TSD_MASK)) == RDES3_CTXT_WR_TSA_MASK) &&
+                    ((pctxt_desc->des0 != 0xFFFFFFFFU) ||
+                    (pctxt_desc->des1 != 0xFFFFFFFFU)))
+            {
+                dma_rx_buf->timestamp.nsec = pctxt_desc->des0 & RDES0_CTXT_WR_RTSL_MASK;
+                dma_rx_buf->timestamp.sec = pctxt_desc->des1 & RDES1_CTXT_WR_RTSH_MASK;
+                dma_rx_buf->timestamp_valid = 1U;
+            }
 
+            /* The context descriptor keeps its buffer, the refill path
+             * hands it back to the DMA without a new one */
+            pchan->rx_ctxt_slot[ctxt_indx] = 1U;
+            pchan->rx_desc_head = (ctxt_indx + 1) % XGMAC_NUM_RX_DESC;
+            pchan->rx_unfilled++;
+        }
     }
     else
     {
@@ -510,52 +629,142 @@ int32_t xgmac_dma_receive(xgmac_handle_t hxgmac, xgmac_rx_buf_t *dma_rx_buf)
 
 int32_t xgmac_refill_rx_descriptor(xgmac_handle_t hxgmac, uint8_t *buf)
 {
-    xgmac_buf_desc_t *pdma_rx_desc;
-    int32_t head_indx = hxgmac->rx_desc_head;
+    return xgmac_refill_rx_descriptor_ch(hxgmac, XGMAC_DMA_CH0, buf);
+}
+
+int32_t xgmac_refill_rx_descriptor_ch(xgmac_handle_t hxgmac, uint8_t chan,
+        uint8_t *buf)
+{
+    return (xgmac_refill_rx_descriptors_ch(hxgmac, chan, &buf, 1U) == 1) ? 0 : -1;
+}
+
+int32_t xgmac_refill_rx_descriptors_ch(xgmac_handle_t hxgmac, uint8_t chan,
+        uint8_t *const *bufs, uint32_t count)
+{
+    xgmac_chan_t pchan;
+    xgmac_buf_desc_t *pdma_rx_desc = NULL;
+    int32_t tail_indx;
     xgmac_base_addr_t dma_base_addr;
+    uint8_t *buf;
     uint32_t last_rx_desc;
+    uint32_t refilled = 0U;
+    uint32_t slots = 0U;
+    cache_range_t ranges[XGMAC_RX_FLUSH_BATCH];
+    uint32_t nranges = 0U;
 
+    if ((hxgmac == NULL) || (chan >= XGMAC_NUM_DMA_CHANNELS) || (bufs == NULL))
+    {
+        return -EINVAL;
+    }
+    pchan = &(hxgmac->chan[chan]);
     dma_base_addr = hxgmac->xgmac_inst_dma_base_addr;
-    pdma_rx_desc = &(hxgmac->rx_bd_ring[head_indx]);
-    if ((dma_base_addr == 0U) || (pdma_rx_desc == NULL))
+    if (dma_base_addr == 0U)
+    {
+        return -EINVAL;
+    }
+
+    if (count == 0U)
     {
-        return -1;
+        return 0;
     }
-    if (buf != NULL)
+
+    /* Attach the buffers and clean them from the data cache. There is a
+     * possibility that a buffer is cached in L1 but not in L4. Since the
+     * peripherals use L4 cache, it could see stale data. Only the
+     * descriptors handed out by the receive path can be refilled. */
+    tail_indx = pchan->rx_desc_tail;
+    while (slots < pchan->rx_unfilled)
     {
+        if (pchan->rx_ctxt_slot[tail_indx] != 0U)
+        {
+            /* A timestamp context descriptor, its buffer was not written
+             * by the DMA nor seen by the caller and is reused as is */
+            buf = pchan->prx_dma_buf1_ap[tail_indx];
+            pchan->rx_ctxt_slot[tail_indx] = 0U;
+        }
+        else
+        {
+            if (refilled == count)
+            {
+                break;
+            }
+
+            /* A NULL buffer reuses the one already attached to the descriptor */
+            buf = (bufs[refilled] != NULL) ? bufs[refilled] :
+                    pchan->prx_dma_buf1_ap[tail_indx];
+            if (buf == NULL)
+            {
+                break;
+            }
+            refilled++;
+
+            ranges[nranges].addr = buf;
+            ranges[nranges].size = XGMAC_MAX_PACKET_SIZE;
+            nranges++;
+            if (nranges == XGMAC_RX_FLUSH_BATCH)
+            {
+                xgmac_flush_buffer_list(ranges, nranges);
+                nranges = 0U;
+            }
+        }
+
+        pdma_rx_desc = &(pchan->rx_bd_ring[tail_indx]);
         pdma_rx_desc->des0 = (uint32_t)(uintptr_t)buf;
         pdma_rx_desc->des1 = (uint32_t)((uintptr_t)buf >> 32);
+        pdma_rx_desc->des2 = 0;
+        pchan->prx_dma_buf1_ap[tail_indx] = buf;
 
-        hxgmac->prx_dma_buf1_ap[head_indx] = (uint8_t *)buf;
+        slots++;
+        tail_indx = (tail_indx + 1) % XGMAC_NUM_RX_DESC;
     }
-    /*
-     * There is a possibility that the buffer is cached in L1 but not in L4.
-     * Since the peripherals use L4 cache, it could see stale data
-     */
-     xgmac_flush_buffer(buf, XGMAC_MAX_PACKET_SIZE);
 
-    /* Release descriptors to DMA */
-    pdma_rx_desc->des2 = 0;
-    pdma_rx_desc->des3 = 0;
+    /* Clean what is left of the batch, the list flush ends with the
+     * barrier that orders the cache maintenance before the OWN bits */
+    xgmac_flush_buffer_list(ranges, nranges);
+    if (slots == 0U)
+    {
+        return -EINVAL;
+    }
+
+    /* Release descriptors to DMA. Set Own bit of the Rx descriptor Status.
+     * IOC is set once every rx_coal_frames descriptors, the Rx interrupt
+     * watchdog reports the frames received into the others. */
+    tail_indx = pchan->rx_desc_tail;
+    for (uint32_t i = 0U; i < slots; i++)
+    {
+        pdma_rx_desc = &(pchan->rx_bd_ring[tail_indx]);
+
+        pchan->rx_coal_count++;
+        if (pchan->rx_coal_count >= hxgmac->rx_coal_frames)
+        {
+            pdma_rx_desc->des3 = XGMAC_RDES3_OWN | XGMAC_RDES3_IOC;
+            pchan->rx_coal_count = 0;
+        }
+        else
+        {
+            pdma_rx_desc->des3 = XGMAC_RDES3_OWN;
+        }
 
-    /* Set Own bit and IOC bit of of the Rx descriptor Status */
-    pdma_rx_desc->des3 = XGMAC_RDES3_OWN | XGMAC_RDES3_IOC;
+        tail_indx = (tail_indx + 1) % XGMAC_NUM_RX_DESC;
+    }
 
-    head_indx = (head_indx + 1) % XGMAC_NUM_RX_DESC;
+    pchan->rx_desc_tail = tail_indx;
+    pchan->rx_unfilled -= slots;
 
-    hxgmac->rx_desc_head = head_indx;
+    /* Issue synchronization barrier instruction */
+    __asm volatile ("DSB SY");
 
-    /* Update the tail pointer register */
+    /* Update the tail pointer register once for the batch */
     /*
      * Tail pointer should be always ahead of current pointer
      * Setting the tail to recently processed descriptor gives better chance
      * to avoid current catching up to tail (since it is a ring buffer)
      */
     last_rx_desc = (uint32_t)(uintptr_t)pdma_rx_desc;
-    WR_DMA_CHNL_REG32(dma_base_addr, XGMAC_DMA_CH0, XGMAC_DMA_CH_RXDESC_TAIL_LPOINTER,
+    WR_DMA_CHNL_REG32(dma_base_addr, chan, XGMAC_DMA_CH_RXDESC_TAIL_LPOINTER,
             last_rx_desc);
 
-    return 0;
+    return (int32_t)refilled;
 }
 
 int32_t xgmac_set_callback(xgmac_handle_t hxgmac, xgmac_callback_t callback, void *pcntxt)
@@ -576,166 +785,950 @@ int32_t xgmac_set_callback(xgmac_handle_t hxgmac, xgmac_callback_t callback, voi
     return 0;
 }
 
-int32_t xgmac_dma_tx_done(xgmac_handle_t hxgmac, uint8_t **release_buffer)
+int32_t xgmac_dma_tx_done(xgmac_handle_t hxgmac, uint8_t **release_buffer,
+        uint32_t *count)
+{
+    return xgmac_dma_tx_done_ch(hxgmac, XGMAC_DMA_CH0, release_buffer, count);
+}
+
+int32_t xgmac_dma_tx_done_ch(xgmac_handle_t hxgmac, uint8_t chan,
+        uint8_t **release_buffer, uint32_t *count)
 {
-    int tail_indx = hxgmac->tx_desc_tail;
-    int head_indx = hxgmac->tx_desc_head;
     TickType_t block_time_ticks = pdMS_TO_TICKS(5000U);
-    int32_t ret_status;
+    xgmac_chan_t pchan;
+    xgmac_buf_desc_t *pdma_tx_desc;
+    int32_t tail_indx;
+    uint32_t in_flight;
+    uint32_t max_count;
+    uint32_t reclaimed = 0;
+    int32_t ret_status = 0;
 
-    ret_status = 0;
+    if ((hxgmac == NULL) || (chan >= XGMAC_NUM_DMA_CHANNELS) ||
+            (release_buffer == NULL) || (count == NULL) || (*count == 0U))
+    {
+        return -EINVAL;
+    }
+    pchan = &(hxgmac->chan[chan]);
+    max_count = *count;
+    *count = 0;
 
-    xgmac_buf_desc_t *pdma_tx_desc;
+    if (osal_semaphore_wait(pchan->tx_mutex, block_time_ticks) == pdFAIL)
+    {
+        return -EINVAL;
+    }
 
-    size_t ux_count = ((UBaseType_t)XGMAC_NUM_TX_DESC) -
-            uxSemaphoreGetCount(hxgmac->tx_sem);
+    /* Count the descriptors handed to the DMA. The semaphore count cannot be
+     * used, a transmit may hold a slot without having posted it yet. */
+    tail_indx = pchan->tx_desc_tail;
+    in_flight = (uint32_t)((pchan->tx_desc_head - tail_indx +
+            XGMAC_NUM_TX_DESC) % XGMAC_NUM_TX_DESC);
+    if ((in_flight == 0U) && (pchan->tx_bd_ring[tail_indx].des3 != 0U))
+    {
+        /* Head caught up with tail, the ring is full */
+        in_flight = (uint32_t)XGMAC_NUM_TX_DESC;
+    }
 
-    if (osal_semaphore_wait(hxgmac->tx_mutex, block_time_ticks) != pdFAIL)
+    /* Reclaim every descriptor the DMA has handed back. The DMA completes the
+     * ring in order, so stop at the first one it still owns. */
+    while ((in_flight > 0U) && (reclaimed < max_count))
     {
-        pdma_tx_desc = &(hxgmac->tx_bd_ring[tail_indx]);
-        if (pdma_tx_desc == NULL)
+        pdma_tx_desc = &(pchan->tx_bd_ring[tail_indx]);
+        if ((pdma_tx_desc->des3 & TDES3_NORM_RD_OWN_MASK) != 0U)
         {
-            return -EINVAL;
+            break;
         }
 
-        if (ux_count > 0UL)
-        {
-            if ((tail_indx == head_indx) && (ux_count !=
-                    (uint32_t)XGMAC_NUM_TX_DESC))
-            {
-                return -EINVAL;
-            }
+        release_buffer[reclaimed] = pchan->ptx_dma_buf1_ap[tail_indx];
+        pchan->ptx_dma_buf1_ap[tail_indx] = NULL;
+
+        /* Reset all descriptor values */
+        pdma_tx_desc->des0 = 0;
+        pdma_tx_desc->des1 = 0;
+        pdma_tx_desc->des2 = 0;
+        pdma_tx_desc->des3 = 0;
 
-            *release_buffer = (uint8_t *)hxgmac->ptx_dma_buf1_ap[tail_indx];
+        reclaimed++;
+        in_flight--;
 
-            /* Reset all descriptor values */
-            pdma_tx_desc->des0 = 0;
-            pdma_tx_desc->des1 = 0;
-            pdma_tx_desc->des2 = 0;
-            pdma_tx_desc->des3 = 0;
+        ++tail_indx;
+        if (tail_indx == XGMAC_NUM_TX_DESC)
+        {
+            tail_indx = 0;
+        }
+    }
 
-            /* Issue synchronization barrier instruction */
-            __asm volatile ("DSB SY");
+    if (reclaimed > 0U)
+    {
+        /* Issue synchronization barrier instruction */
+        __asm volatile ("DSB SY");
 
-            ux_count--;
+        pchan->tx_desc_tail = tail_indx;
 
-            /* Give back counting semaphore */
-            if (osal_semaphore_post(hxgmac->tx_sem) == false)
+        /* Give back counting semaphore */
+        for (uint32_t i = 0; i < reclaimed; i++)
+        {
+            if (osal_semaphore_post(pchan->tx_sem) == false)
             {
                 ret_status = -EIO;
             }
-
-            ++tail_indx;
-            if (tail_indx == XGMAC_NUM_TX_DESC)
-            {
-                tail_indx = 0;
-            }
-
-            hxgmac->tx_desc_tail = tail_indx;
-        }
-        else
-        {
-            ret_status = -EAGAIN;
-        }
-
-        if (osal_semaphore_post(hxgmac->tx_mutex) == false)
-        {
-            ret_status = -EIO;
         }
     }
     else
     {
-        ret_status = -EINVAL;
+        ret_status = -EAGAIN;
     }
 
-    return ret_status;
-}
-
-static Basetype_t dma_soft_reset(xgmac_base_addr_t emac_base_addr)
-{
-    uint8_t elapsed_time = 0;
-    uint8_t timeout = 100;
-
-    if (xgmac_dma_software_reset(emac_base_addr) != XGMAC_LL_RETVAL_SUCCESS)
+    /* Frames still owned by the DMA may not be followed by an IOC frame, keep
+     * the watchdog running so that they are reclaimed eventually. */
+    if ((in_flight > 0U) && (reclaimed < max_count))
     {
-        return false;
+        tx_coal_arm_watchdog(pchan);
     }
-    /* Poll for reset for completion */
-    while (!xgmac_is_dma_reset_done(emac_base_addr))
+
+    if (osal_semaphore_post(pchan->tx_mutex) == false)
     {
-        if (elapsed_time >= timeout)
-        {
-            return false;
-        }
-        /* Wait for some delay */
-        DELAY_MS(1);
-        elapsed_time += 1U;
+        ret_status = -EIO;
     }
-    return true;
+
+    *count = reclaimed;
+
+    return ret_status;
 }
-static Basetype_t dma_set_descriptors(xgmac_handle_t hxgmac)
 
+int32_t xgmac_set_tx_coalesce(xgmac_handle_t hxgmac, uint32_t frames,
+        uint32_t timeout_ms)
 {
-    /* Initialize the Tx and Rx Head and Tail to 0*/
-    hxgmac->tx_desc_head = 0;
-    hxgmac->rx_desc_head = 0;
-
-    hxgmac->tx_desc_tail = 0;
-    hxgmac->rx_desc_tail = 0;
+    TickType_t block_time_ticks = pdMS_TO_TICKS(5000U);
+    xgmac_chan_t pchan;
+    int32_t ret_status = 0;
 
-    /* Create Descriptor list for Tx and Rx */
-    if (hxgmac->tx_bd_ring == NULL)
+    if ((hxgmac == NULL) || (frames == 0U) ||
+            (frames >= (uint32_t)XGMAC_NUM_TX_DESC))
     {
-        hxgmac->tx_bd_ring = hxgmac->axBufferDescTx;
+        return -EINVAL;
     }
 
-    if (hxgmac->rx_bd_ring == NULL)
+    /* Coalescing without a watchdog could leave the last frames unreclaimed */
+    if ((frames > 1U) && (timeout_ms == 0U))
     {
-        hxgmac->rx_bd_ring = hxgmac->axBufferDescRx;
+        return -EINVAL;
     }
 
-    /* Set all field values to zero */
-    (void)memset(hxgmac->tx_bd_ring, '\0', sizeof(xgmac_buf_desc_t));
-    (void)memset(hxgmac->rx_bd_ring, '\0', sizeof(xgmac_buf_desc_t));
-
-    /* Setup Tx Descriptor Table Parameters */
-    dma_setup_tx_descriptor_list(hxgmac);
+    hxgmac->tx_coal_frames = frames;
+    hxgmac->tx_coal_timeout_ms = timeout_ms;
 
-    /* Create the Tx Buffer Descriptor Semaphore  */
-    if (hxgmac->tx_sem == NULL)
+    for (uint8_t ch = 0; ch < XGMAC_NUM_DMA_CHANNELS; ch++)
     {
-        hxgmac->tx_sem =
-                osal_semaphore_counting_create(NULL, (UBaseType_t)XGMAC_NUM_TX_DESC,
-                (UBaseType_t)XGMAC_NUM_TX_DESC);
-        configASSERT(hxgmac->tx_sem != NULL);
-    }
+        pchan = &(hxgmac->chan[ch]);
+        if (pchan->tx_mutex == NULL)
+        {
+            continue;
+        }
 
-    /* Create the Tx Descriptor Mutex   */
-    if (hxgmac->tx_mutex == NULL)
-    {
-        hxgmac->tx_mutex = osal_mutex_create(NULL);
-        configASSERT(hxgmac->tx_mutex != NULL);
-    }
+        if (osal_semaphore_wait(pchan->tx_mutex, block_time_ticks) == pdFAIL)
+        {
+            ret_status = -EBUSY;
+            continue;
+        }
+
+        if ((pchan->tx_coal_timer != NULL) && (timeout_ms != 0U))
+        {
+            /* Also starts the timer, any frames in flight get covered by it */
+            if (xTimerChangePeriod(pchan->tx_coal_timer,
+                    pdMS_TO_TICKS(timeout_ms) + 1U, 0U) == pdPASS)
+            {
+                pchan->tx_coal_armed = TRUE;
+            }
+        }
 
-    /* Setup Rx Descriptor Table Parameters */
-    dma_setup_rx_descriptor_list(hxgmac);
+        if (osal_semaphore_post(pchan->tx_mutex) == false)
+        {
+            ret_status = -EIO;
+        }
+    }
 
-    return true;
+    return ret_status;
 }
 
-void dma_setup_tx_descriptor_list(xgmac_handle_t hxgmac)
+int32_t xgmac_get_tx_coalesce(xgmac_handle_t hxgmac, uint32_t *frames,
+        uint32_t *timeout_ms)
+{
+    if ((hxgmac == NULL) || (frames == NULL) || (timeout_ms == NULL))
+    {
+        return -EINVAL;
+    }
+
+    *frames = hxgmac->tx_coal_frames;
+    *timeout_ms = hxgmac->tx_coal_timeout_ms;
+
+    return 0;
+}
+
+/* Called with tx_mutex of the channel held */
+static int32_t tx_reserve_desc(xgmac_chan_t pchan, uint32_t count)
+{
+    TickType_t block_time_ticks = pdMS_TO_TICKS(5000U);
+    uint32_t slots;
+
+    if (pchan->tx_sem == NULL)
+    {
+        return -EIO;
+    }
+
+    /* Reserve a descriptor for every buffer of the frame before touching
+     * the ring, a frame is never handed to the DMA partially. */
+    for (slots = 0U; slots < count; slots++)
+    {
+        if (osal_semaphore_wait(pchan->tx_sem, block_time_ticks) != pdPASS)
+        {
+            break;
+        }
+    }
+
+    if ((slots == count) &&
+            (osal_semaphore_wait(pchan->tx_mutex, block_time_ticks) != pdFAIL))
+    {
+        return 0;
+    }
+
+    if (slots < count)
+    {
+        ERROR("xgmac_dma_transmit: Time-out TX buffer not available.");
+    }
+
+    /* Give back the descriptors reserved for a frame that was not queued */
+    while (slots > 0U)
+    {
+        (void)osal_semaphore_post(pchan->tx_sem);
+        slots--;
+    }
+
+    return -EIO;
+}
+
+static void tx_flush_frags(const xgmac_tx_buf_t *frags, uint32_t nfrags)
+{
+    cache_range_t ranges[XGMAC_MAX_TX_FRAGS];
+
+    /* Clean all the fragments of the frame in one pass, fragments that
+     * share a cache line (e.g. headers in front of the payload) are only
+     * written back once */
+    for (uint32_t i = 0; i < nfrags; i++)
+    {
+        ranges[i].addr = frags[i].buf;
+        ranges[i].size = frags[i].size;
+    }
+    xgmac_flush_buffer_list(ranges, nfrags);
+}
+
+static xgmac_buf_desc_t *tx_set_buf_desc(xgmac_chan_t pchan, int32_t indx,
+        uint8_t *buf, uint32_t size, uint8_t release_buf)
+{
+    xgmac_buf_desc_t *pdma_tx_desc = &(pchan->tx_bd_ring[indx]);
+    uintptr_t buffer_addr = (uintptr_t)buf;
+
+    /* The Application will set this flag if it wants to release buffers after Tx done.
+     * Hence copy the buffer address later to be used in TX Done function */
+    pchan->ptx_dma_buf1_ap[indx] = (release_buf != 0U) ? buf : NULL;
+
+    /* Assign BufferAP address to Desc0 and Desc1  */
+    pdma_tx_desc->des0 = (uint32_t)buffer_addr;
+    pdma_tx_desc->des1 = (uint32_t)(buffer_addr >> 32);
+
+    /* Set Buffer-1 Length */
+    pdma_tx_desc->des2 = (size & TDES2_NORM_RD_HL_B1L_MASL);
+
+    return pdma_tx_desc;
+}
+
+static void tx_coal_request_ioc(xgmac_chan_t pchan, xgmac_buf_desc_t *plast_tx_desc)
+{
+    /* Request a completion interrupt once every tx_coal_frames frames,
+     * or when the ring is about to run out of free descriptors. The
+     * frames in between are reclaimed along with the IOC frame or by
+     * the coalescing watchdog. */
+    pchan->tx_coal_count++;
+    if ((pchan->tx_coal_count >= pchan->hxgmac->tx_coal_frames) ||
+            (uxSemaphoreGetCount(pchan->tx_sem) == 0U))
+    {
+        plast_tx_desc->des2 |= TDES2_NORM_RD_IOC_MASK;
+        pchan->tx_coal_count = 0;
+    }
+    else
+    {
+        tx_coal_arm_watchdog(pchan);
+    }
+}
+
+static int32_t tx_post_frame(xgmac_chan_t pchan, xgmac_buf_desc_t *pfirst_tx_desc,
+        int32_t head_indx)
+{
+    uint32_t last_tx_desc;
+
+    /* Issue synchronization barrier instruction */
+    __asm volatile ("DSB SY");
+
+    /* Set Own bit of the first Tx descriptor to give the frame to DMA */
+    pfirst_tx_desc->des3 |= TDES3_NORM_RD_OWN_MASK;
+
+    /* Issue synchronization barrier instruction */
+    __asm volatile ("DSB SY");
+
+    /* Update the TX-head index, the descriptors are now owned by the
+     * ring until tx done reclaims them */
+    pchan->tx_desc_head = head_indx;
+
+    /* Program the  Tx Tail Pointer Register */
+    last_tx_desc = (uint32_t)(uintptr_t)&(pchan->tx_bd_ring[head_indx]);
+    WR_DMA_CHNL_REG32(pchan->hxgmac->xgmac_inst_dma_base_addr, pchan->index,
+            XGMAC_DMA_CH_TXDESC_TAIL_LPOINTER, last_tx_desc);
+
+    /* Release the Mutex. */
+    if (osal_semaphore_post(pchan->tx_mutex) == false)
+    {
+        return -EIO;
+    }
+
+    return 0;
+}
+
+static void tx_coal_arm_watchdog(xgmac_chan_t pchan)
+{
+    if ((pchan->tx_coal_timer == NULL) || (pchan->tx_coal_armed == TRUE))
+    {
+        return;
+    }
+
+    /* A full timer command queue is retried on the next frame */
+    if (xTimerStart(pchan->tx_coal_timer, 0U) == pdPASS)
+    {
+        pchan->tx_coal_armed = TRUE;
+    }
+}
+
+static void tx_coal_watchdog_expired(TimerHandle_t timer)
+{
+    xgmac_chan_t pchan = (xgmac_chan_t)pvTimerGetTimerID(timer);
+    xgmac_handle_t hxgmac = pchan->hxgmac;
+
+    /*
+     * This runs in the timer daemon, blocking here would hold up every
+     * software timer. If a transmitter holds the channel, try again one
+     * period later; it stays armed meanwhile.
+     */
+    if (osal_semaphore_wait(pchan->tx_mutex, OSAL_TIMEOUT_NOTIMEOUT) ==
+            pdFAIL)
+    {
+        (void)xTimerStart(timer, 0U);
+        return;
+    }
+
+    /* Frames queued from here on re-arm the watchdog */
+    pchan->tx_coal_armed = FALSE;
+    pchan->tx_coal_count = 0;
+
+    (void)osal_semaphore_post(pchan->tx_mutex);
+
+    /* Report a completion as the missing IOC would have done */
+    if (hxgmac->callback != NULL)
+    {
+        hxgmac->callback(XGMAC_TX_DONE_EVENT, hxgmac->pcntxt);
+    }
+}
+
+int32_t xgmac_set_rx_coalesce(xgmac_handle_t hxgmac, uint32_t frames,
+        uint32_t timeout_us)
+{
+    if ((hxgmac == NULL) || (frames == 0U) ||
+            (frames >= (uint32_t)XGMAC_NUM_RX_DESC))
+    {
+        return -EINVAL;
+    }
+
+    /* Without the watchdog frames in descriptors without IOC are not reported */
+    if ((frames > 1U) && (timeout_us == 0U))
+    {
+        return -EINVAL;
+    }
+
+    hxgmac->rx_coal_frames = frames;
+    hxgmac->rx_coal_timeout_us = timeout_us;
+    for (uint8_t ch = 0; ch < XGMAC_NUM_DMA_CHANNELS; ch++)
+    {
+        hxgmac->chan[ch].rx_coal_count = 0;
+    }
+
+    if (hxgmac->xgmac_inst_dma_base_addr != 0U)
+    {
+        dma_set_rx_watchdog(hxgmac);
+    }
+
+    return 0;
+}
+
+int32_t xgmac_get_rx_coalesce(xgmac_handle_t hxgmac, uint32_t *frames,
+        uint32_t *timeout_us)
+{
+    if ((hxgmac == NULL) || (frames == NULL) || (timeout_us == NULL))
+    {
+        return -EINVAL;
+    }
+
+    *frames = hxgmac->rx_coal_frames;
+    *timeout_us = hxgmac->rx_coal_timeout_us;
+
+    return 0;
+}
+
+int32_t xgmac_dma_rx_irq_enable(xgmac_handle_t hxgmac, bool enable)
+{
+    xgmac_base_addr_t dma_base_addr;
+    int32_t ret_val = XGMAC_LL_RETVAL_SUCCESS;
+
+    if (hxgmac == NULL)
+    {
+        return -EINVAL;
+    }
+
+    dma_base_addr = hxgmac->xgmac_inst_dma_base_addr;
+    if (dma_base_addr == 0U)
+    {
+        return -EINVAL;
+    }
+
+    /* Reception is polled for all channels at once */
+    for (uint8_t ch = 0; ch < XGMAC_NUM_DMA_CHANNELS; ch++)
+    {
+        if (enable == true)
+        {
+            if (xgmac_enable_dma_interrupt(dma_base_addr, ch, INTERRUPT_RI) !=
+                    XGMAC_LL_RETVAL_SUCCESS)
+            {
+                ret_val = XGMAC_LL_RETVAL_FAIL;
+            }
+        }
+        else
+        {
+            if (xgmac_disable_dma_interrupt(dma_base_addr, ch, INTERRUPT_RI) !=
+                    XGMAC_LL_RETVAL_SUCCESS)
+            {
+                ret_val = XGMAC_LL_RETVAL_FAIL;
+            }
+        }
+    }
+
+    return (ret_val == XGMAC_LL_RETVAL_SUCCESS) ? 0 : -EIO;
+}
+
+int32_t xgmac_set_rx_prio_chan(xgmac_handle_t hxgmac, uint8_t prio,
+        uint8_t chan)
+{
+    if ((hxgmac == NULL) || (prio >= XGMAC_NUM_PRIORITIES) ||
+            (chan >= XGMAC_NUM_DMA_CHANNELS))
+    {
+        return -EINVAL;
+    }
+
+    hxgmac->rx_prio_chan[prio] = chan;
+
+    if (hxgmac->is_started == XGMAC_EMAC_STARTED)
+    {
+        mac_set_prio_steering(hxgmac);
+    }
+
+    return 0;
+}
+
+int32_t xgmac_set_tx_prio_chan(xgmac_handle_t hxgmac, uint8_t prio,
+        uint8_t chan)
+{
+    if ((hxgmac == NULL) || (prio >= XGMAC_NUM_PRIORITIES) ||
+            (chan >= XGMAC_NUM_DMA_CHANNELS))
+    {
+        return -EINVAL;
+    }
+
+    hxgmac->tx_prio_chan[prio] = chan;
+
+    return 0;
+}
+
+uint8_t xgmac_get_tx_prio_chan(xgmac_handle_t hxgmac, uint8_t prio)
+{
+    if ((hxgmac == NULL) || (prio >= XGMAC_NUM_PRIORITIES))
+    {
+        return XGMAC_DMA_CH0;
+    }
+
+    return hxgmac->tx_prio_chan[prio];
+}
+
+int32_t xgmac_set_l3l4_filter(xgmac_handle_t hxgmac, uint8_t index,
+        const xgmac_l3l4_filter_t *filter)
+{
+    xgmac_base_addr_t emac_base_addr;
+    uint32_t ctrl = 0;
+    int32_t ret_val;
+
+    if ((hxgmac == NULL) || (index >= XGMAC_NUM_L3L4_FILTERS))
+    {
+        return -EINVAL;
+    }
+
+    emac_base_addr = hxgmac->xgmac_inst_base_addr;
+    if (emac_base_addr == 0U)
+    {
+        return -EINVAL;
+    }
+
+    if (filter != NULL)
+    {
+        if ((filter->chan >= XGMAC_NUM_DMA_CHANNELS) ||
+                ((filter->l4_proto != 0U) &&
+                (filter->l4_proto != XGMAC_L4_PROTO_TCP) &&
+                (filter->l4_proto != XGMAC_L4_PROTO_UDP)))
+        {
+            return -EINVAL;
+        }
+
+        /* Compare the full IPv4 addresses and ports which are set. The
+         * addresses are programmed in host order as the MAC compares the
+         * header fields most significant byte first */
+        if (filter->src_ip != 0U)
+        {
+            ctrl |= XGMAC_MAC_L3_L4_CONTROL0_L3SAM0_MASK;
+        }
+        if (filter->dst_ip != 0U)
+        {
+            ctrl |= XGMAC_MAC_L3_L4_CONTROL0_L3DAM0_MASK;
+        }
+        if (filter->l4_proto == XGMAC_L4_PROTO_UDP)
+        {
+            ctrl |= XGMAC_MAC_L3_L4_CONTROL0_L4PEN0_MASK;
+        }
+        if ((filter->l4_proto != 0U) && (filter->src_port != 0U))
+        {
+            ctrl |= XGMAC_MAC_L3_L4_CONTROL0_L4SPM0_MASK;
+        }
+        if ((filter->l4_proto != 0U) && (filter->dst_port != 0U))
+        {
+            ctrl |= XGMAC_MAC_L3_L4_CONTROL0_L4DPM0_MASK;
+        }
+        if ((ctrl & ~XGMAC_MAC_L3_L4_CONTROL0_L4PEN0_MASK) == 0U)
+        {
+            /* A filter without any field would match every frame */
+            return -EINVAL;
+        }
+
+        /* Route matching frames to the DMA channel of the filter */
+        ctrl |= XGMAC_MAC_L3_L4_CONTROL0_DMCHEN_MASK;
+        ctrl |= ((uint32_t)filter->chan << XGMAC_MAC_L3_L4_CONTROL0_DMCHN_POS) &
+                XGMAC_MAC_L3_L4_CONTROL0_DMCHN_MASK;
+
+        ret_val = xgmac_write_l3l4_filter_reg(emac_base_addr, index,
+                XGMAC_L3L4_REG_L3_ADDR0, __builtin_bswap32(filter->src_ip));
+        if (ret_val == XGMAC_LL_RETVAL_SUCCESS)
+        {
+            ret_val = xgmac_write_l3l4_filter_reg(emac_base_addr, index,
+                    XGMAC_L3L4_REG_L3_ADDR1, __builtin_bswap32(filter->dst_ip));
+        }
+        if (ret_val == XGMAC_LL_RETVAL_SUCCESS)
+        {
+            ret_val = xgmac_write_l3l4_filter_reg(emac_base_addr, index,
+                    XGMAC_L3L4_REG_L4_ADDRESS,
+                    ((uint32_t)filter->dst_port <<
+                    XGMAC_MAC_LAYER4_ADDRESS0_L4DP0_POS) |
+                    ((uint32_t)filter->src_port <<
+                    XGMAC_MAC_LAYER4_ADDRESS0_L4SP0_POS));
+        }
+        if (ret_val != XGMAC_LL_RETVAL_SUCCESS)
+        {
+            return -EIO;
+        }
+    }
+
+    /* Writing the control register last arms the filter */
+    if (xgmac_write_l3l4_filter_reg(emac_base_addr, index,
+            XGMAC_L3L4_REG_CONTROL, ctrl) != XGMAC_LL_RETVAL_SUCCESS)
+    {
+        return -EIO;
+    }
+
+    if (filter != NULL)
+    {
+        hxgmac->l3l4_filter_mask |= (uint8_t)(1U << index);
+    }
+    else
+    {
+        hxgmac->l3l4_filter_mask &= (uint8_t)~(1U << index);
+    }
+
+    /* L3/L4 filtering only runs while a filter is in use. Receive all stays
+     * set, so frames which match no filter are still received on the queue
+     * picked by the VLAN priority steering */
+    xgmac_enable_l3l4_filtering(emac_base_addr, (hxgmac->l3l4_filter_mask != 0U));
+
+    return 0;
+}
+
+/* Addend for an accumulator overflowing every ssinc nanoseconds, that is
+ * 2^32 * 10^9 / (ssinc * XGMAC_PTP_CLK_HZ), with 32 fraction bits */
+static uint64_t xgmac_ptp_nominal_addend(uint32_t ssinc)
+{
+    uint64_t num = (uint64_t)XGMAC_PTP_NSEC_PER_SEC << 32;
+    uint64_t den = (uint64_t)ssinc * XGMAC_PTP_CLK_HZ;
+
+    return ((num / den) << 32) | (((num % den) << 32) / den);
+}
+
+/* Addend register value nearest to a 32.32 fixed point addend */
+static uint32_t xgmac_ptp_round_addend(uint64_t addend)
+{
+    return (uint32_t)((addend + 0x80000000U) >> 32);
+}
+
+int32_t xgmac_ptp_enable(xgmac_handle_t hxgmac, xgmac_ts_rx_filter_t rx_filter)
+{
+    xgmac_base_addr_t emac_base_addr;
+    uint32_t ts_ctrl;
+    uint32_t ssinc;
+
+    if ((hxgmac == NULL) || (rx_filter > XGMAC_TS_RX_ALL))
+    {
+        return -EINVAL;
+    }
+    emac_base_addr = hxgmac->xgmac_inst_base_addr;
+    if (emac_base_addr == 0U)
+    {
+        return -EINVAL;
+    }
+
+    if ((RD_REG32(emac_base_addr + XGMAC_MAC_HW_FEATURE0) &
+            XGMAC_MAC_HW_FEATURE0_TSSEL_MASK) == 0U)
+    {
+        return -ENOTSUP;
+    }
+
+    if (rx_filter == XGMAC_TS_RX_NONE)
+    {
+        hxgmac->ptp_enabled = 0U;
+        xgmac_ptp_config(emac_base_addr, 0U, 0U);
+        return 0;
+    }
+
+    /* Digital rollover, the nanoseconds field wraps at 10^9 */
+    ts_ctrl = XGMAC_MAC_TIMESTAMP_CONTROL_TSENA_MASK |
+            XGMAC_MAC_TIMESTAMP_CONTROL_TSCFUPDT_MASK |
+            XGMAC_MAC_TIMESTAMP_CONTROL_TSCTRLSSR_MASK;
+    if (rx_filter == XGMAC_TS_RX_ALL)
+    {
+        ts_ctrl |= XGMAC_MAC_TIMESTAMP_CONTROL_TSENALL_MASK;
+    }
+    else
+    {
+        /* PTPv2 over Ethernet, UDP/IPv4 and UDP/IPv6, snapshot type 1
+         * timestamps every message type */
+        ts_ctrl |= XGMAC_MAC_TIMESTAMP_CONTROL_TSVER2ENA_MASK |
+                XGMAC_MAC_TIMESTAMP_CONTROL_TSIPENA_MASK |
+                XGMAC_MAC_TIMESTAMP_CONTROL_TSIPV4ENA_MASK |
+                XGMAC_MAC_TIMESTAMP_CONTROL_TSIPV6ENA_MASK |
+                ((1U << XGMAC_MAC_TIMESTAMP_CONTROL_SNAPTYPSEL_POS) &
+                XGMAC_MAC_TIMESTAMP_CONTROL_SNAPTYPSEL_MASK);
+    }
+
+    /* With fine correction the addend accumulator advances the time at half
+     * the reference clock rate, each step adding two reference periods. The
+     * addend is then 2^31 and can be trimmed either way. */
+    ssinc = (2U * XGMAC_PTP_NSEC_PER_SEC) / XGMAC_PTP_CLK_HZ;
+    hxgmac->ptp_default_addend = xgmac_ptp_nominal_addend(ssinc);
+
+    xgmac_ptp_config(emac_base_addr, ts_ctrl, ssinc);
+    if ((xgmac_ptp_set_addend(emac_base_addr,
+            xgmac_ptp_round_addend(hxgmac->ptp_default_addend)) !=
+            XGMAC_LL_RETVAL_SUCCESS) ||
+            (xgmac_ptp_init_time(emac_base_addr, 0U, 0U) != XGMAC_LL_RETVAL_SUCCESS))
+    {
+        ERROR("SOCFPGA_XGMAC: Unable to start the system time.");
+        return -EIO;
+    }
+
+    hxgmac->ptp_enabled = 1U;
+
+    return 0;
+}
+
+int32_t xgmac_ptp_gettime(xgmac_handle_t hxgmac, xgmac_timestamp_t *ts)
+{
+    if ((hxgmac == NULL) || (ts == NULL) || (hxgmac->ptp_enabled == 0U))
+    {
+        return -EINVAL;
+    }
+
+    xgmac_ptp_get_time(hxgmac->xgmac_inst_base_addr, &(ts->sec), &(ts->nsec));
+
+    return 0;
+}
+
+int32_t xgmac_ptp_settime(xgmac_handle_t hxgmac, const xgmac_timestamp_t *ts)
+{
+    if ((hxgmac == NULL) || (ts == NULL) || (hxgmac->ptp_enabled == 0U) ||
+            (ts->nsec >= XGMAC_PTP_NSEC_PER_SEC))
+    {
+        return -EINVAL;
+    }
+
+    if (xgmac_ptp_init_time(hxgmac->xgmac_inst_base_addr, ts->sec, ts->nsec) !=
+            XGMAC_LL_RETVAL_SUCCESS)
+    {
+        return -EIO;
+    }
+
+    return 0;
+}
+
+int32_t xgmac_ptp_adjtime(xgmac_handle_t hxgmac, int64_t delta_ns)
+{
+    uint64_t magnitude;
+    bool subtract;
+
+    if ((hxgmac == NULL) || (hxgmac->ptp_enabled == 0U))
+    {
+        return -EINVAL;
+    }
+
+    subtract = (delta_ns < 0);
+    magnitude = subtract ? ((uint64_t)(-(delta_ns + 1)) + 1U) : (uint64_t)delta_ns;
+
+    /* The update register holds 32 bits of seconds */
+    if ((magnitude / XGMAC_PTP_NSEC_PER_SEC) > 0xFFFFFFFFU)
+    {
+        return -EINVAL;
+    }
+
+    if (xgmac_ptp_update_time(hxgmac->xgmac_inst_base_addr,
+            magnitude / XGMAC_PTP_NSEC_PER_SEC,
+            (uint32_t)(magnitude % XGMAC_PTP_NSEC_PER_SEC), subtract) !=
+            XGMAC_LL_RETVAL_SUCCESS)
+    {
+        return -EIO;
+    }
+
+    return 0;
+}
+
+int32_t xgmac_ptp_adjfreq(xgmac_handle_t hxgmac, int32_t ppb)
+{
+    uint64_t diff, base, mag;
+
+    if ((hxgmac == NULL) || (hxgmac->ptp_enabled == 0U) ||
+            (ppb > XGMAC_PTP_MAX_ADJ_PPB) || (ppb < -XGMAC_PTP_MAX_ADJ_PPB))
+    {
+        return -EINVAL;
+    }
+
+    /* The time advances in proportion to the addend. The product is split
+     * so that it fits 64 bits, and the fraction is kept until rounding. */
+    base = hxgmac->ptp_default_addend;
+    mag = (uint64_t)((ppb < 0) ? -(int64_t)ppb : (int64_t)ppb);
+    diff = ((base / XGMAC_PTP_NSEC_PER_SEC) * mag) +
+            (((base % XGMAC_PTP_NSEC_PER_SEC) * mag) / XGMAC_PTP_NSEC_PER_SEC);
+    base = (ppb < 0) ? (base - diff) : (base + diff);
+
+    if (xgmac_ptp_set_addend(hxgmac->xgmac_inst_base_addr,
+            xgmac_ptp_round_addend(base)) !=
+            XGMAC_LL_RETVAL_SUCCESS)
+    {
+        return -EIO;
+    }
+
+    return 0;
+}
+
+int32_t xgmac_ptp_get_tx_timestamp(xgmac_handle_t hxgmac, xgmac_timestamp_t *ts)
+{
+    if ((hxgmac == NULL) || (ts == NULL) || (hxgmac->ptp_enabled == 0U))
+    {
+        return -EINVAL;
+    }
+
+    if (xgmac_ptp_get_tx_time(hxgmac->xgmac_inst_base_addr, &(ts->sec),
+            &(ts->nsec)) != XGMAC_LL_RETVAL_SUCCESS)
+    {
+        return -EAGAIN;
+    }
+
+    return 0;
+}
+
+static void mac_set_prio_steering(xgmac_handle_t hxgmac)
+{
+    uint8_t prio_mask;
+
+    for (uint8_t ch = 0; ch < XGMAC_NUM_DMA_CHANNELS; ch++)
+    {
+        prio_mask = 0;
+        for (uint8_t prio = 0; prio < XGMAC_NUM_PRIORITIES; prio++)
+        {
+            if (hxgmac->rx_prio_chan[prio] == ch)
+            {
+                prio_mask |= (uint8_t)(1U << prio);
+            }
+        }
+
+        /* Rx queue n is mapped to DMA channel n */
+        xgmac_set_rxq_prio(hxgmac->xgmac_inst_base_addr, ch, prio_mask);
+    }
+}
+
+static void dma_set_rx_watchdog(xgmac_handle_t hxgmac)
+{
+    uint32_t clk_rate;
+    uint64_t cycles;
+    uint64_t rwt = 0;
+    uint8_t rwtu = 0;
+
+    if ((hxgmac->rx_coal_frames > 1U) && (hxgmac->rx_coal_timeout_us != 0U))
+    {
+        if (clk_mngr_get_clk(CLOCK_L4MAIN, &clk_rate) != 0)
+        {
+            ERROR("SOCFPGA_XGMAC: Unable to get clock for Rx watchdog.");
+            return;
+        }
+
+        /* RIWT counts in units of 256 << RWTU system clock cycles, pick the
+         * finest unit which can hold the timeout */
+        cycles = ((uint64_t)clk_rate * hxgmac->rx_coal_timeout_us) / 1000000U;
+        for (rwtu = 0; rwtu < 4U; rwtu++)
+        {
+            rwt = (cycles + (256U << rwtu) - 1U) / (256U << rwtu);
+            if (rwt <= 0xFFU)
+            {
+                break;
+            }
+        }
+        if (rwtu == 4U)
+        {
+            rwtu = 3;
+            rwt = 0xFF;
+        }
+        if (rwt == 0U)
+        {
+            rwt = 1;
+        }
+    }
+
+    for (uint8_t ch = 0; ch < XGMAC_NUM_DMA_CHANNELS; ch++)
+    {
+        xgmac_set_rx_int_watchdog(hxgmac->xgmac_inst_dma_base_addr, ch,
+                (uint8_t)rwt, rwtu);
+    }
+}
+
+static Basetype_t dma_soft_reset(xgmac_base_addr_t emac_base_addr)
+{
+    uint8_t elapsed_time = 0;
+    uint8_t timeout = 100;
+
+    if (xgmac_dma_software_reset(emac_base_addr) != XGMAC_LL_RETVAL_SUCCESS)
+    {
+        return false;
+    }
+    /* Poll for reset for completion */
+    while (!xgmac_is_dma_reset_done(emac_base_addr))
+    {
+        if (elapsed_time >= timeout)
+        {
+            return false;
+        }
+        /* Wait for some delay */
+        DELAY_MS(1);
+        elapsed_time += 1U;
+    }
+    return true;
+}
+static Basetype_t dma_set_descriptors(xgmac_handle_t hxgmac)
+
+{
+    xgmac_chan_t pchan;
+
+    for (uint8_t ch = 0; ch < XGMAC_NUM_DMA_CHANNELS; ch++)
+    {
+        pchan = &(hxgmac->chan[ch]);
+
+        /* Initialize the Tx and Rx Head and Tail to 0*/
+        pchan->tx_desc_head = 0;
+        pchan->rx_desc_head = 0;
+
+        pchan->tx_desc_tail = 0;
+        pchan->rx_desc_tail = 0;
+        pchan->rx_unfilled = (uint32_t)XGMAC_NUM_RX_DESC;
+
+        /* Create Descriptor list for Tx and Rx */
+        if (pchan->tx_bd_ring == NULL)
+        {
+            pchan->tx_bd_ring = pchan->axBufferDescTx;
+        }
+
+        if (pchan->rx_bd_ring == NULL)
+        {
+            pchan->rx_bd_ring = pchan->axBufferDescRx;
+        }
+
+        /* Set all field values to zero */
+        (void)memset(pchan->tx_bd_ring, '\0', sizeof(xgmac_buf_desc_t));
+        (void)memset(pchan->rx_bd_ring, '\0', sizeof(xgmac_buf_desc_t));
+
+        /* Setup Tx Descriptor Table Parameters */
+        dma_setup_tx_descriptor_list(pchan);
+
+        /* Create the Tx Buffer Descriptor Semaphore  */
+        if (pchan->tx_sem == NULL)
+        {
+            pchan->tx_sem =
+                    osal_semaphore_counting_create(NULL, (UBaseType_t)XGMAC_NUM_TX_DESC,
+                    (UBaseType_t)XGMAC_NUM_TX_DESC);
+            configASSERT(pchan->tx_sem != NULL);
+        }
+
+        /* Create the Tx Descriptor Mutex   */
+        if (pchan->tx_mutex == NULL)
+        {
+            pchan->tx_mutex = osal_mutex_create(NULL);
+            configASSERT(pchan->tx_mutex != NULL);
+        }
+
+        /* Create the Tx completion watchdog used with interrupt coalescing */
+        if (pchan->tx_coal_timer == NULL)
+        {
+            pchan->tx_coal_timer = xTimerCreate("xgmac_txc",
+                    pdMS_TO_TICKS(hxgmac->tx_coal_timeout_ms) + 1U, pdFALSE,
+                    (void *)pchan, tx_coal_watchdog_expired);
+            configASSERT(pchan->tx_coal_timer != NULL);
+        }
+        pchan->tx_coal_count = 0;
+        pchan->tx_coal_armed = FALSE;
+        pchan->rx_coal_count = 0;
+
+        /* Setup Rx Descriptor Table Parameters */
+        dma_setup_rx_descriptor_list(pchan);
+    }
+
+    return true;
+}
+
+void dma_setup_tx_descriptor_list(xgmac_chan_t pchan)
 {
     xgmac_buf_desc_t *pdma_descriptor;
     int16_t index;
 
     /* Initialize the Tx buffer descriptor pointer */
-    pdma_descriptor = hxgmac->tx_bd_ring;
+    pdma_descriptor = pchan->tx_bd_ring;
 
     /* Initialize the Tx buffer descriptor parameters - Desc0, Desc1, Desc2, Desc3 */
     for (index = 0; index < XGMAC_NUM_TX_DESC; index++)
     {
         /* Initialize Buffer1 address pointer in Handle TxDMA Buffer Pointer Array to NULL */
-        hxgmac->ptx_dma_buf1_ap[index] = NULL;
+        pchan->ptx_dma_buf1_ap[index] = NULL;
 
         /* Initialize all Descriptors to 0 */
         pdma_descriptor[index].des0 = 0;
@@ -745,19 +1738,19 @@ void dma_setup_tx_descriptor_list(xgmac_handle_t hxgmac)
     }
 }
 
-void dma_setup_rx_descriptor_list(xgmac_handle_t hxgmac)
+void dma_setup_rx_descriptor_list(xgmac_chan_t pchan)
 {
     xgmac_buf_desc_t *pdma_descriptor;
     int16_t index;
 
     /* Initialize the Rx buffer descriptor pointer */
-    pdma_descriptor = hxgmac->rx_bd_ring;
+    pdma_descriptor = pchan->rx_bd_ring;
 
     /* Initialize the Rx buffer descriptor parameters - Desc0, Desc1, Desc2, Desc3 */
     for (index = 0; index < XGMAC_NUM_RX_DESC; index++)
     {
         /* Initialize Buffer1 address pointer in Handle RxDMA Buffer Pointer Array to NULL */
-        hxgmac->prx_dma_buf1_ap[index] = NULL;
+        pchan->prx_dma_buf1_ap[index] = NULL;
 
         /* Initialize all Descriptors to 0. These will be set in Refill Descriptor */
         pdma_descriptor[index].des0 = 0;
@@ -773,7 +1766,7 @@ static void dma_channel_init(xgmac_handle_t hxgmac, const
     xgmac_dma_desc_addr_t dma_desc_addr_params;
     xgmac_buf_desc_t *pax_buffer_desc_tx;
     xgmac_buf_desc_t *pax_buffer_desc_rx;
-    uint8_t dma_ch_index = XGMAC_DMA_CH0;
+    uint8_t dma_ch_index;
 
     dma_base_addr = hxgmac->xgmac_inst_dma_base_addr;
     if (dma_base_addr == 0U)
@@ -781,34 +1774,33 @@ static void dma_channel_init(xgmac_handle_t hxgmac, const
         return;
     }
 
-    /* Program the DMA channel Descriptor Registers */
-    pax_buffer_desc_tx = hxgmac->tx_bd_ring;
-    pax_buffer_desc_rx = hxgmac->rx_bd_ring;
-
-    dma_desc_addr_params.tx_ring_len = (uint32_t)(XGMAC_NUM_TX_DESC - 1);
-    dma_desc_addr_params.rx_ring_len = (uint32_t)(XGMAC_NUM_RX_DESC - 1);
-    dma_desc_addr_params.tx_desc_low_addr = (uint32_t)(uintptr_t)pax_buffer_desc_tx;
-    dma_desc_addr_params.tx_desc_high_addr = (uint32_t)((uintptr_t)pax_buffer_desc_tx >> 32);
-    dma_desc_addr_params.rx_desc_low_addr = (uint32_t)(uintptr_t)pax_buffer_desc_rx;
-    dma_desc_addr_params.rx_desc_high_addr = (uint32_t)((uintptr_t)pax_buffer_desc_rx >> 32);
-    dma_desc_addr_params.tx_last_desc_addr =
-            (uint32_t)(uintptr_t)&(pax_buffer_desc_tx[XGMAC_NUM_TX_DESC -
-            1]);
-    dma_desc_addr_params.rx_last_desc_addr =
-            (uint32_t)(uintptr_t)&(pax_buffer_desc_rx[XGMAC_NUM_RX_DESC -
-            1]);
-
-    /* Set DMA Tx/Rx Descriptor Address */
-    xgmac_init_dma_channel_desc_reg(dma_base_addr, dma_ch_index, &dma_desc_addr_params);
-
-    if (dma_base_addr == 0U)
+    for (dma_ch_index = 0; dma_ch_index < XGMAC_NUM_DMA_CHANNELS; dma_ch_index++)
     {
-        return;
+        /* Program the DMA channel Descriptor Registers */
+        pax_buffer_desc_tx = hxgmac->chan[dma_ch_index].tx_bd_ring;
+        pax_buffer_desc_rx = hxgmac->chan[dma_ch_index].rx_bd_ring;
+
+        dma_desc_addr_params.tx_ring_len = (uint32_t)(XGMAC_NUM_TX_DESC - 1);
+        dma_desc_addr_params.rx_ring_len = (uint32_t)(XGMAC_NUM_RX_DESC - 1);
+        dma_desc_addr_params.tx_desc_low_addr = (uint32_t)(uintptr_t)pax_buffer_desc_tx;
+        dma_desc_addr_params.tx_desc_high_addr = (uint32_t)((uintptr_t)pax_buffer_desc_tx >> 32);
+        dma_desc_addr_params.rx_desc_low_addr = (uint32_t)(uintptr_t)pax_buffer_desc_rx;
+        dma_desc_addr_params.rx_desc_high_addr = (uint32_t)((uintptr_t)pax_buffer_desc_rx >> 32);
+        dma_desc_addr_params.tx_last_desc_addr =
+                (uint32_t)(uintptr_t)&(pax_buffer_desc_tx[XGMAC_NUM_TX_DESC -
+                1]);
+        dma_desc_addr_params.rx_last_desc_addr =
+                (uint32_t)(uintptr_t)&(pax_buffer_desc_rx[XGMAC_NUM_RX_DESC -
+                1]);
+
+        /* Set DMA Tx/Rx Descriptor Address */
+        xgmac_init_dma_channel_desc_reg(dma_base_addr, dma_ch_index, &dma_desc_addr_params);
+
+        /* Program  DMA channel Control Settings */
+        xgmac_config_dma_channel_control(dma_base_addr, dma_ch_index, (const
+                xgmacdma_chanl_config_t *)(uintptr_t)xgmac_dev_config->
+                dma_channel_config);
     }
-    /* Program  DMA channel Control Settings */
-    xgmac_config_dma_channel_control(dma_base_addr, dma_ch_index, (const
-            xgmacdma_chanl_config_t *)(uintptr_t)xgmac_dev_config->
-            dma_channel_config);
 }
 
 static Basetype_t dma_enable_interrupts(xgmac_handle_t hxgmac, const
@@ -889,75 +1881,73 @@ void socfpga_xgmac_dma_isr(void *param)
 {
     xgmac_handle_t hxgmac = (xgmac_handle_t)param;
     xgmac_base_addr_t dma_base_addr;
-    xgmac_dma_interrupt_id_t id;
     xgmac_err_t err_type = XGMAC_ERR_UNHANDLED;
-    xgmac_int_status_t int_status = XGMAC_ERR_EVENT;
-    uint32_t base_dma_chnl_address;
+    uint32_t status[XGMAC_NUM_DMA_CHANNELS];
+    uint32_t all_status = 0;
     uint8_t dmachnum;
 
     dma_base_addr = hxgmac->xgmac_inst_dma_base_addr;
-    dmachnum = XGMAC_DMA_CH0;
-    base_dma_chnl_address = ((uint32_t)(uintptr_t)dma_base_addr +
-            XGMAC_DMA_CHANNEL_BASE +
-            ((uint32_t)dmachnum * XGMAC_DMA_CHANNEL_INC));
 
-    id = check_and_clear_xgmac_interrupt_status(base_dma_chnl_address);
+    /* Handle every pending source of every channel, Tx completions and
+     * received frames are often reported by the same interrupt */
+    for (dmachnum = 0; dmachnum < XGMAC_NUM_DMA_CHANNELS; dmachnum++)
+    {
+        status[dmachnum] = xgmac_get_and_clear_dma_status(dma_base_addr, dmachnum);
+        all_status |= status[dmachnum];
+    }
+
+    if (hxgmac->callback == NULL)
+    {
+        return;
+    }
 
-    switch (id)
+    /* The events are not per channel, the handler scans all rings */
+    if ((all_status & XGMAC_DMA_INTR_MASK_TI) != 0U)
     {
-        case INTERRUPT_TI:
-            int_status = XGMAC_TX_DONE_EVENT;
-            break;
+        hxgmac->callback(XGMAC_TX_DONE_EVENT, hxgmac->pcntxt);
+    }
 
-        case INTERRUPT_RI:
-            int_status = XGMAC_RX_EVENT;
-            break;
+    if ((all_status & XGMAC_DMA_INTR_MASK_RI) != 0U)
+    {
+        hxgmac->callback(XGMAC_RX_EVENT, hxgmac->pcntxt);
+    }
 
-        case INTERRUPT_FBE:
-        case INTERRUPT_TXS:
-        case INTERRUPT_RBU:
-        case INTERRUPT_RS:
-        case INTERRUPT_DDE:
-        case INTERRUPT_UNHANDLED:
+    for (dmachnum = 0; dmachnum < XGMAC_NUM_DMA_CHANNELS; dmachnum++)
+    {
+        if ((status[dmachnum] & (XGMAC_DMA_INTR_MASK_FBE | XGMAC_DMA_INTR_MASK_TXS |
+                XGMAC_DMA_INTR_MASK_RBU | XGMAC_DMA_INTR_MASK_RS |
+                XGMAC_DMA_INTR_MASK_DDE)) != 0U)
+        {
+            xgmac_err_info_t *pIntData = (xgmac_err_info_t *)hxgmac->pcntxt;
+
+            /* Re-mapping the error type to handle in the Network Interface Layer */
+            if ((status[dmachnum] & XGMAC_DMA_INTR_MASK_FBE) != 0U)
             {
-                xgmac_err_info_t *pIntData = (xgmac_err_info_t *)hxgmac->pcntxt;
-                int_status = XGMAC_ERR_EVENT;
-
-                /* Re-mapping the error type to handle in the Network Interface Layer */
-                switch (id)
-                {
-                    case INTERRUPT_FBE:
-                        err_type = XGMAC_ERR_FATAL_BUS;
-                        break;
-                    case INTERRUPT_TXS:
-                        err_type = XGMAC_ERR_TX_STOPPED;
-                        break;
-                    case INTERRUPT_RBU:
-                        err_type = XGMAC_ERR_RX_BUF_UNAVAILABLE;
-                        break;
-                    case INTERRUPT_RS:
-                        err_type = XGMAC_ERR_RX_STOPPED;
-                        break;
-                    case INTERRUPT_DDE:
-                        err_type = XGMAC_ERR_DESC_DEFINE;
-                        break;
-                    default: /*do nothing*/
-                        break;
-                }
-
-                pIntData->err_ch = dmachnum;
-                pIntData->err_type = (uint8_t)err_type;
-                break;
+                err_type = XGMAC_ERR_FATAL_BUS;
+            }
+            else if ((status[dmachnum] & XGMAC_DMA_INTR_MASK_TXS) != 0U)
+            {
+                err_type = XGMAC_ERR_TX_STOPPED;
+            }
+            else if ((status[dmachnum] & XGMAC_DMA_INTR_MASK_RBU) != 0U)
+            {
+                err_type = XGMAC_ERR_RX_BUF_UNAVAILABLE;
+            }
+            else if ((status[dmachnum] & XGMAC_DMA_INTR_MASK_RS) != 0U)
+            {
+                err_type = XGMAC_ERR_RX_STOPPED;
+            }
+            else
+            {
+                err_type = XGMAC_ERR_DESC_DEFINE;
             }
 
-        default: /*do nothing*/
-            break;
+            pIntData->err_ch = dmachnum;
+            pIntData->err_type = (uint8_t)err_type;
+            hxgmac->callback(XGMAC_ERR_EVENT, hxgmac->pcntxt);
+        }
     }
 
-    if (hxgmac->callback != NULL)
-    {
-        hxgmac->callback(int_status, hxgmac->pcntxt);
-        check_and_clear_link_interrupt_status((uint32_t)((uintptr_t)hxgmac
-                ->xgmac_inst_base_addr));
-    }
+    check_and_clear_link_interrupt_status((uint32_t)((uintptr_t)hxgmac
+            ->xgmac_inst_base_addr));
 }
@@ -38,6 +38,9 @@ extern "C"
  * - Supports 10/100 Mbps Ethernet
  * - Link status detection and monitoring
  * - IPv4 and IPv6 compatible
+ * - Multiple Tx/Rx DMA channels with strict priority transmit scheduling
+ *   and receive steering by VLAN priority or L3/L4 filters
+ * - Scatter-gather transmit of frames split across several buffers
  *
  * The driver is normally not used directly. It is used indirectly via the
  * tcp/ip stack.
@@ -83,13 +86,28 @@ extern "C"
 #define XGMAC_MAX_INSTANCE      (3)            /*!< Maximum number of XGMAC instances */
 #define XGMAC_PHY_TYPE_RGMII    1     /*!< PHY type - RGMII */
 
+/*!< Number of Tx/Rx DMA channels, each with its own MTL queue, per EMAC.
+ * When several are used the highest numbered channel has the highest
+ * priority. */
+#ifndef XGMAC_NUM_DMA_CHANNELS
+#define XGMAC_NUM_DMA_CHANNELS    2U
+#endif
+#if (XGMAC_NUM_DMA_CHANNELS < 1U) || (XGMAC_NUM_DMA_CHANNELS > 8U)
+#error "XGMAC_NUM_DMA_CHANNELS must be between 1 and 8"
+#endif
+
 /*!< Descriptor configuration */
-#define XGMAC_NUM_RX_DESC        512     /*!< Number of TX descriptors */
-#define XGMAC_NUM_TX_DESC        512     /*!< Number of RX descriptors */
+#define XGMAC_NUM_RX_DESC        (512 / XGMAC_NUM_DMA_CHANNELS)     /*!< Number of RX descriptors per DMA channel */
+#define XGMAC_NUM_TX_DESC        (512 / XGMAC_NUM_DMA_CHANNELS)     /*!< Number of TX descriptors per DMA channel */
 #define XGMAC_PACKET_SIZE        1536U            /*!< Standard Ethernet packet size */
 #define XGMAC_DMA_ALIGN_BYTES    64U             /*!< DMA alignment size in bytes */
 #define XGMAC_MAX_PACKET_SIZE    (XGMAC_PACKET_SIZE + XGMAC_DMA_ALIGN_BYTES)            /*!< Max packet size including alignment */
 #define XGMAC_DMA_CH0            0U         /*!< DMA channel 0 */
+#define XGMAC_DMA_CH1            1U         /*!< DMA channel 1 */
+
+#define XGMAC_NUM_PRIORITIES     8U         /*!< Number of IEEE 802.1Q user priorities */
+#define XGMAC_NUM_L3L4_FILTERS   8U         /*!< Number of L3/L4 steering filters */
+#define XGMAC_MAX_TX_FRAGS       16U        /*!< Maximum number of buffers gathered into one frame */
 
 /*!< Receive Descriptor RDES3 Bitmasks */
 #define XGMAC_RDES3_OWN          BIT(31)            /*!< Ownership bit */
@@ -98,6 +116,32 @@ extern "C"
 
 #define DELAY_MS(ms)    osal_task_delay((ms))  /*!< Macro to set delay */
 
+/*!< Default number of Tx frames per completion interrupt */
+#ifndef XGMAC_TX_COAL_FRAMES
+#define XGMAC_TX_COAL_FRAMES        16U
+#endif
+/*!< Default Tx completion watchdog timeout in milliseconds */
+#ifndef XGMAC_TX_COAL_TIMEOUT_MS
+#define XGMAC_TX_COAL_TIMEOUT_MS    1U
+#endif
+/*!< Default number of Rx frames per completion interrupt */
+#ifndef XGMAC_RX_COAL_FRAMES
+#define XGMAC_RX_COAL_FRAMES        8U
+#endif
+/*!< Default Rx interrupt watchdog (RIWT) timeout in microseconds */
+#ifndef XGMAC_RX_COAL_TIMEOUT_US
+#define XGMAC_RX_COAL_TIMEOUT_US    50U
+#endif
+
+/*!< Frequency of the PTP reference clock feeding the system time unit */
+#ifndef XGMAC_PTP_CLK_HZ
+#define XGMAC_PTP_CLK_HZ            250000000U
+#endif
+#define XGMAC_PTP_MAX_ADJ_PPB       62500000    /*!< Largest frequency adjustment in parts per billion */
+
+#define XGMAC_L4_PROTO_TCP    6U          /*!< TCP filter protocol */
+#define XGMAC_L4_PROTO_UDP    17U         /*!< UDP filter protocol */
+
 typedef int32_t xgmac_base_addr_t;/*!< XGMAC base address type */
 /**
  * @}
@@ -133,6 +177,16 @@ typedef enum
     XGMAC_ERR_CNTXT_DESC,             /*!< Context Descriptor Error  */
     XGMAC_ERR_UNHANDLED,               /*!< Unhandled Interrupt  */
 } xgmac_err_t;
+
+/**
+ * @brief Received frames which get a hardware timestamp
+ */
+typedef enum
+{
+    XGMAC_TS_RX_NONE,   /*!< No receive timestamps */
+    XGMAC_TS_RX_PTP,    /*!< PTP messages over Ethernet, UDP/IPv4 and UDP/IPv6 */
+    XGMAC_TS_RX_ALL     /*!< Every received frame */
+} xgmac_ts_rx_filter_t;
 /**
  * @}
  */
@@ -159,11 +213,21 @@ typedef struct
     uint32_t des3;   /*!< Descriptor word 3 */
 } xgmac_buf_desc_t;
 
+/**
+ * @brief Time of the system time unit
+ */
+typedef struct
+{
+    uint64_t sec;       /*!< Seconds, 48 bits are kept by the hardware */
+    uint32_t nsec;      /*!< Nanoseconds, below 10^9 */
+} xgmac_timestamp_t;
+
 typedef struct
 {
     uint8_t *buf;       /*!< Pointer to transmit buffer */
     uint32_t size;          /*!< Size of the buffer in bytes */
     uint8_t release_buf;  /*!< Flag to release buffer after transmit */
+    uint8_t timestamp;    /*!< Capture the transmit time, read from the first fragment */
 } xgmac_tx_buf_t;
 
 typedef struct
@@ -171,13 +235,32 @@ typedef struct
     uint8_t *buf;       /*!< Pointer to receive buffer */
     uint32_t size;          /*!< Size of received data in bytes */
     uint32_t packet_status;  /*!< Status of the received packet */
+    xgmac_timestamp_t timestamp;  /*!< Receive time, valid when timestamp_valid is set */
+    uint8_t timestamp_valid;      /*!< A hardware timestamp was captured */
 } xgmac_rx_buf_t;
 
+/**
+ * @brief L3/L4 steering filter
+ *
+ * Matching IPv4 frames are delivered to the receive DMA channel @p chan.
+ * Fields which are zero are not compared.
+ */
+typedef struct
+{
+    uint8_t l4_proto;      /*!< XGMAC_L4_PROTO_TCP or XGMAC_L4_PROTO_UDP, 0 to ignore the ports */
+    uint32_t src_ip;       /*!< IPv4 source address in network byte order */
+    uint32_t dst_ip;       /*!< IPv4 destination address in network byte order */
+    uint16_t src_port;     /*!< Layer 4 source port in host byte order */
+    uint16_t dst_port;     /*!< Layer 4 destination port in host byte order */
+    uint8_t chan;          /*!< Receive DMA channel for matching frames */
+} xgmac_l3l4_filter_t;
+
 /**
  * @}
  */
 /**
- * Function pointer for user callback
+ * Function pointer for user callback. Called from the XGMAC interrupt, and
+ * from the timer service task for Tx coalescing watchdog completions.
  * @ingroup enet_fns
  */
 typedef void (*xgmac_callback_t)(xgmac_int_status_t int_status, void *irq_data);
@@ -361,20 +444,133 @@ int32_t xgmac_dma_deinitialize(xgmac_handle_t hxgmac);
 int32_t xgmac_dma_transmit(xgmac_handle_t hxgmac, xgmac_tx_buf_t *dma_tx_buf);
 
 /**
- * @brief Check if the transmit is done to release the buffer.
+ * @brief Initiate the transmit of a buffer on a given DMA channel.
+ *
+ * Same as xgmac_dma_transmit() but queues the frame on the transmit ring of
+ * @p chan. The MTL serves the queues in strict priority order, the highest
+ * numbered channel first.
+ *
+ * @param[in] hxgmac     The instance of the XGMAC.
+ * @param[in] chan       The transmit DMA channel.
+ * @param[in] dma_tx_buf The buffer to transmit, see xgmac_dma_transmit().
+ *
+ * @return
+ * -  0:      if DMA successfully transmit the buffer.
+ * - -EINVAL: if the channel is invalid.
+ * - -EIO:    if DMA failed to transmit the buffer
+ *
+ */
+int32_t xgmac_dma_transmit_ch(xgmac_handle_t hxgmac, uint8_t chan,
+        xgmac_tx_buf_t *dma_tx_buf);
+
+/**
+ * @brief Initiate the transmit of a frame gathered from several buffers.
+ *
+ * Each fragment is placed in its own descriptor, the first one marked as
+ * first descriptor and the last one as last descriptor, so that headers and
+ * payload held in separate buffers are sent without being copied together.
+ * The frame is handed to the DMA only once all its descriptors are ready.
+ * The release_buf flag is honoured for each fragment separately, a buffer
+ * flagged for release is returned by xgmac_dma_tx_done_ch() once the DMA
+ * is done with its descriptor.
+ *
+ * @param[in] hxgmac The instance of the XGMAC.
+ * @param[in] chan   The transmit DMA channel.
+ * @param[in] frags  The fragments of the frame, in transmit order.
+ * @param[in] nfrags The number of fragments, 1 to XGMAC_MAX_TX_FRAGS.
+ *
+ * @return
+ * -  0:      if DMA successfully transmit the frame.
+ * - -EINVAL: if the channel, a fragment or the frame length is invalid.
+ * - -EIO:    if DMA failed to transmit the frame
+ *
+ */
+int32_t xgmac_dma_transmit_sg(xgmac_handle_t hxgmac, uint8_t chan,
+        xgmac_tx_buf_t *frags, uint32_t nfrags);
+
+/**
+ * @brief Reclaim the transmit descriptors completed by the DMA.
  *
- * The application should call this once it gets an event notification after a dma transmit.
+ * The application should call this once it gets a XGMAC_TX_DONE_EVENT
+ * notification. All descriptors completed since the last call are reclaimed
+ * in one go, up to the capacity of release_buffer. Call it again while it
+ * fills release_buffer completely.
  *
- * @param[in]  hxgmac     The instance of the XGMAC to stop.
- * @param[out] release_buffer The released buffer which will be used for next transmit.
+ * @param[in]     hxgmac         The instance of the XGMAC.
+ * @param[out]    release_buffer Array receiving the buffers of the reclaimed
+ *                               descriptors. Entries are NULL for frames sent
+ *                               without the release_buf flag.
+ * @param[in,out] count          In: capacity of release_buffer. Out: number of
+ *                               descriptors reclaimed.
  *
  * @return
- * -  0:      if successfully obtained the status of buffer transmission.
+ * -  0:      if at least one descriptor was reclaimed.
+ * - -EINVAL: if the arguments are invalid.
  * - -EIO:    if failed to obtain the status of buffer transmission.
- * - -EAGAIN: if application failed to obtain the status of dma descriptor.
+ * - -EAGAIN: if no descriptor has completed.
  *
  */
-int32_t xgmac_dma_tx_done(xgmac_handle_t hxgmac, uint8_t **release_buffer);
+int32_t xgmac_dma_tx_done(xgmac_handle_t hxgmac, uint8_t **release_buffer,
+        uint32_t *count);
+
+/**
+ * @brief Reclaim the transmit descriptors completed on a given DMA channel.
+ *
+ * Same as xgmac_dma_tx_done() for the transmit ring of @p chan. A
+ * XGMAC_TX_DONE_EVENT may stand for completions on any channel.
+ *
+ * @param[in]     hxgmac         The instance of the XGMAC.
+ * @param[in]     chan           The transmit DMA channel.
+ * @param[out]    release_buffer Array receiving the buffers of the reclaimed
+ *                               descriptors.
+ * @param[in,out] count          In: capacity of release_buffer. Out: number of
+ *                               descriptors reclaimed.
+ *
+ * @return
+ * -  0:      if at least one descriptor was reclaimed.
+ * - -EINVAL: if the arguments are invalid.
+ * - -EIO:    if failed to obtain the status of buffer transmission.
+ * - -EAGAIN: if no descriptor has completed.
+ *
+ */
+int32_t xgmac_dma_tx_done_ch(xgmac_handle_t hxgmac, uint8_t chan,
+        uint8_t **release_buffer, uint32_t *count);
+
+/**
+ * @brief Configure Tx completion interrupt coalescing.
+ *
+ * A completion interrupt is requested once every @p frames frames. Frames
+ * which are not followed by an interrupt requesting frame are reported by a
+ * watchdog timer which expires @p timeout_ms after the first of them was
+ * queued. The watchdog reports through the registered callback from the timer
+ * service task rather than from interrupt context. Can be changed while the
+ * interface is running.
+ *
+ * @param[in] hxgmac     The instance of the XGMAC.
+ * @param[in] frames     Frames per completion interrupt, 1 disables coalescing.
+ * @param[in] timeout_ms Watchdog timeout, must be non-zero when coalescing.
+ *
+ * @return
+ * -  0:      on success.
+ * - -EINVAL: if the arguments are invalid.
+ * - -EBUSY:  if the transmit path could not be locked.
+ */
+int32_t xgmac_set_tx_coalesce(xgmac_handle_t hxgmac, uint32_t frames,
+        uint32_t timeout_ms);
+
+/**
+ * @brief Get the Tx completion interrupt coalescing parameters.
+ *
+ * @param[in]  hxgmac     The instance of the XGMAC.
+ * @param[out] frames     Frames per completion interrupt.
+ * @param[out] timeout_ms Watchdog timeout in milliseconds.
+ *
+ * @return
+ * -  0:      on success.
+ * - -EINVAL: if the arguments are invalid.
+ */
+int32_t xgmac_get_tx_coalesce(xgmac_handle_t hxgmac, uint32_t *frames,
+        uint32_t *timeout_ms);
 
 /**
  * @brief Initiate the receive of the buffer via DMA.
@@ -394,6 +590,25 @@ int32_t xgmac_dma_tx_done(xgmac_handle_t hxgmac, uint8_t **release_buffer);
  */
 int32_t xgmac_dma_receive(xgmac_handle_t hxgmac, xgmac_rx_buf_t *dma_rx_buf);
 
+/**
+ * @brief Receive a buffer from a given DMA channel.
+ *
+ * Same as xgmac_dma_receive() for the receive ring of @p chan. A
+ * XGMAC_RX_EVENT may stand for frames received on any channel.
+ *
+ * @param[in]  hxgmac     The instance of the XGMAC.
+ * @param[in]  chan       The receive DMA channel.
+ * @param[out] dma_rx_buf The received buffer, see xgmac_dma_receive().
+ *
+ * @return
+ * -  0:      if DMA successfully receive the buffer.
+ * - -EINVAL: if the channel is invalid.
+ * - -EAGAIN: if DMA failed to receive the buffer
+ *
+ */
+int32_t xgmac_dma_receive_ch(xgmac_handle_t hxgmac, uint8_t chan,
+        xgmac_rx_buf_t *dma_rx_buf);
+
 /**
  * @brief Refill a receive descriptor with a new buffer.
  *
@@ -408,6 +623,260 @@ int32_t xgmac_dma_receive(xgmac_handle_t hxgmac, xgmac_rx_buf_t *dma_rx_buf);
  */
 int32_t xgmac_refill_rx_descriptor(xgmac_handle_t hxgmac, uint8_t *buf);
 
+/**
+ * @brief Refill a receive descriptor of a given DMA channel.
+ *
+ * Same as xgmac_refill_rx_descriptors_ch() for a single buffer.
+ *
+ * @param[in] hxgmac The instance of the XGMAC.
+ * @param[in] chan   The receive DMA channel.
+ * @param[in] buf    Pointer to the new buffer to assign to the RX descriptor.
+ *
+ * @return
+ * - 0:  if the descriptor was successfully refilled.
+ * - -1: if the channel or handle is invalid, or no descriptor is waiting
+ *       for a refill.
+ */
+int32_t xgmac_refill_rx_descriptor_ch(xgmac_handle_t hxgmac, uint8_t chan,
+        uint8_t *buf);
+
+/**
+ * @brief Refill a batch of receive descriptors of a given DMA channel.
+ *
+ * Receiving a frame hands its descriptor back to the caller, which refills
+ * descriptors in the order they were received. The buffers of the batch are
+ * cleaned from the data cache in one pass, then handed to the DMA with one
+ * barrier and one tail pointer update. Descriptors which the DMA used for
+ * receive timestamps are handed back along with the batch without taking
+ * one of the buffers.
+ *
+ * @param[in] hxgmac The instance of the XGMAC.
+ * @param[in] chan   The receive DMA channel.
+ * @param[in] bufs   The buffers, of XGMAC_MAX_PACKET_SIZE bytes each. A NULL
+ *                   entry reuses the buffer already attached to the descriptor.
+ * @param[in] count  The number of buffers.
+ *
+ * @return
+ * - >= 0:    the number of descriptors refilled, lower than count when fewer
+ *            descriptors are waiting for a refill.
+ * - -EINVAL: if the channel or handle is invalid.
+ */
+int32_t xgmac_refill_rx_descriptors_ch(xgmac_handle_t hxgmac, uint8_t chan,
+        uint8_t *const *bufs, uint32_t count);
+
+/**
+ * @brief Configure Rx interrupt moderation.
+ *
+ * Refilled receive descriptors request a completion interrupt once every
+ * @p frames descriptors. Frames received into the other descriptors are
+ * reported by the hardware Rx interrupt watchdog (RIWT) @p timeout_us after
+ * they were received. Can be changed while the interface is running, takes
+ * effect for descriptors refilled afterwards.
+ *
+ * @param[in] hxgmac     The instance of the XGMAC.
+ * @param[in] frames     Frames per completion interrupt, 1 disables moderation.
+ * @param[in] timeout_us Watchdog timeout, must be non-zero when moderating.
+ *
+ * @return
+ * -  0:      on success.
+ * - -EINVAL: if the arguments are invalid.
+ */
+int32_t xgmac_set_rx_coalesce(xgmac_handle_t hxgmac, uint32_t frames,
+        uint32_t timeout_us);
+
+/**
+ * @brief Get the Rx interrupt moderation parameters.
+ *
+ * @param[in]  hxgmac     The instance of the XGMAC.
+ * @param[out] frames     Frames per completion interrupt.
+ * @param[out] timeout_us Watchdog timeout in microseconds.
+ *
+ * @return
+ * -  0:      on success.
+ * - -EINVAL: if the arguments are invalid.
+ */
+int32_t xgmac_get_rx_coalesce(xgmac_handle_t hxgmac, uint32_t *frames,
+        uint32_t *timeout_us);
+
+/**
+ * @brief Mask or unmask the DMA receive interrupt.
+ *
+ * Used to switch between interrupt driven and polled reception. A frame
+ * received while the interrupt is masked raises it as soon as it is unmasked.
+ * Can be called from the interrupt callback.
+ *
+ * @param[in] hxgmac The instance of the XGMAC.
+ * @param[in] enable true to unmask, false to mask the interrupt.
+ *
+ * @return
+ * -  0:      on success.
+ * - -EINVAL: if the handle is invalid.
+ * - -EIO:    if the interrupt could not be updated.
+ */
+int32_t xgmac_dma_rx_irq_enable(xgmac_handle_t hxgmac, bool enable);
+
+/**
+ * @brief Steer received frames of a VLAN user priority to a DMA channel.
+ *
+ * Tagged frames carrying priority @p prio are stored in the receive queue
+ * of @p chan. Untagged frames are received on channel 0. By default the
+ * priorities are spread evenly across the channels, the highest ones on
+ * the highest channel.
+ *
+ * @param[in] hxgmac The instance of the XGMAC.
+ * @param[in] prio   The IEEE 802.1Q user priority, 0 to 7.
+ * @param[in] chan   The receive DMA channel.
+ *
+ * @return
+ * -  0:      on success.
+ * - -EINVAL: if the arguments are invalid.
+ */
+int32_t xgmac_set_rx_prio_chan(xgmac_handle_t hxgmac, uint8_t prio,
+        uint8_t chan);
+
+/**
+ * @brief Select the transmit DMA channel of a user priority.
+ *
+ * Only records the mapping returned by xgmac_get_tx_prio_chan(), the caller
+ * picks the channel passed to xgmac_dma_transmit_ch(). Defaults to the same
+ * mapping as the receive side.
+ *
+ * @param[in] hxgmac The instance of the XGMAC.
+ * @param[in] prio   The IEEE 802.1Q user priority, 0 to 7.
+ * @param[in] chan   The transmit DMA channel.
+ *
+ * @return
+ * -  0:      on success.
+ * - -EINVAL: if the arguments are invalid.
+ */
+int32_t xgmac_set_tx_prio_chan(xgmac_handle_t hxgmac, uint8_t prio,
+        uint8_t chan);
+
+/**
+ * @brief Get the transmit DMA channel of a user priority.
+ *
+ * @param[in] hxgmac The instance of the XGMAC.
+ * @param[in] prio   The IEEE 802.1Q user priority, 0 to 7.
+ *
+ * @return The transmit DMA channel, channel 0 if the arguments are invalid.
+ */
+uint8_t xgmac_get_tx_prio_chan(xgmac_handle_t hxgmac, uint8_t prio);
+
+/**
+ * @brief Program an L3/L4 steering filter.
+ *
+ * IPv4 frames matching all non-zero fields of @p filter are stored in the
+ * receive queue of filter->chan, ahead of the VLAN priority steering.
+ * Passing NULL disables the filter.
+ *
+ * @param[in] hxgmac The instance of the XGMAC.
+ * @param[in] index  The filter index, below XGMAC_NUM_L3L4_FILTERS.
+ * @param[in] filter The filter to program, or NULL.
+ *
+ * @return
+ * -  0:      on success.
+ * - -EINVAL: if the arguments are invalid.
+ * - -EIO:    if the filter registers could not be written.
+ */
+int32_t xgmac_set_l3l4_filter(xgmac_handle_t hxgmac, uint8_t index,
+        const xgmac_l3l4_filter_t *filter);
+
+/**
+ * @brief Start the system time unit and enable hardware timestamps.
+ *
+ * The system time starts at zero and counts in nanoseconds, it is advanced
+ * by the PTP reference clock of XGMAC_PTP_CLK_HZ with fine correction so
+ * that its rate can be trimmed by xgmac_ptp_adjfreq(). Received frames
+ * selected by @p rx_filter carry their receive time in the receive buffer,
+ * frames sent with the timestamp flag set have their transmit time captured
+ * for xgmac_ptp_get_tx_timestamp(). Each instance has its own clock.
+ *
+ * @param[in] hxgmac    The instance of the XGMAC.
+ * @param[in] rx_filter The received frames to timestamp, XGMAC_TS_RX_NONE
+ *                      stops the clock and disables timestamps.
+ *
+ * @return
+ * -  0:       on success.
+ * - -EINVAL:  if the arguments are invalid.
+ * - -ENOTSUP: if the MAC has no system time unit.
+ * - -EIO:     if the system time could not be initialized.
+ */
+int32_t xgmac_ptp_enable(xgmac_handle_t hxgmac, xgmac_ts_rx_filter_t rx_filter);
+
+/**
+ * @brief Read the system time.
+ *
+ * @param[in]  hxgmac The instance of the XGMAC.
+ * @param[out] ts     The current system time.
+ *
+ * @return
+ * -  0:      on success.
+ * - -EINVAL: if the arguments are invalid or the clock is not running.
+ */
+int32_t xgmac_ptp_gettime(xgmac_handle_t hxgmac, xgmac_timestamp_t *ts);
+
+/**
+ * @brief Set the system time.
+ *
+ * @param[in] hxgmac The instance of the XGMAC.
+ * @param[in] ts     The new system time.
+ *
+ * @return
+ * -  0:      on success.
+ * - -EINVAL: if the arguments are invalid or the clock is not running.
+ * - -EIO:    if the system time unit did not take the new time.
+ */
+int32_t xgmac_ptp_settime(xgmac_handle_t hxgmac, const xgmac_timestamp_t *ts);
+
+/**
+ * @brief Step the system time by a signed offset.
+ *
+ * The offset is applied by the hardware in one update, without reading
+ * and writing back the time, so no time is lost in the adjustment.
+ *
+ * @param[in] hxgmac   The instance of the XGMAC.
+ * @param[in] delta_ns The offset in nanoseconds, added to the time.
+ *
+ * @return
+ * -  0:      on success.
+ * - -EINVAL: if the arguments are invalid or the clock is not running.
+ * - -EIO:    if the system time unit did not take the update.
+ */
+int32_t xgmac_ptp_adjtime(xgmac_handle_t hxgmac, int64_t delta_ns);
+
+/**
+ * @brief Adjust the rate of the system time.
+ *
+ * The adjustment is relative to the nominal rate, not to the previous
+ * adjustment.
+ *
+ * @param[in] hxgmac The instance of the XGMAC.
+ * @param[in] ppb    The frequency offset in parts per billion, positive to
+ *                   speed the clock up, within +/-XGMAC_PTP_MAX_ADJ_PPB.
+ *
+ * @return
+ * -  0:      on success.
+ * - -EINVAL: if the arguments are invalid or the clock is not running.
+ * - -EIO:    if the system time unit did not take the new rate.
+ */
+int32_t xgmac_ptp_adjfreq(xgmac_handle_t hxgmac, int32_t ppb);
+
+/**
+ * @brief Read the transmit time of the last timestamped frame.
+ *
+ * The MAC holds one transmit timestamp per instance, the caller should
+ * wait for it before sending the next frame with the timestamp flag set.
+ *
+ * @param[in]  hxgmac The instance of the XGMAC.
+ * @param[out] ts     The time the frame left the MAC.
+ *
+ * @return
+ * -  0:      on success.
+ * - -EINVAL: if the arguments are invalid or the clock is not running.
+ * - -EAGAIN: if no timestamp was captured since the last call.
+ */
+int32_t xgmac_ptp_get_tx_timestamp(xgmac_handle_t hxgmac, xgmac_timestamp_t *ts);
+
 /**
  * @brief Flush the DMA buffers.
  *
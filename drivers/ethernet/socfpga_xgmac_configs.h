@@ -19,6 +19,7 @@ extern "C" {
 #include <stdbool.h>
 
 #include "socfpga_xgmac_ll.h"
+#include "socfpga_xgmac.h"
 
 /**
  * @brief  Configuration parameters for XGMAC DMA Parameters
@@ -63,10 +64,15 @@ static const xgmacdma_chanl_config_t dma_chnl_config = {
  * @brief  Configuration parameters for XGMAC MAC Rx parameters
  */
 static const xgmacmac_rx_q_ctrl_config_t mac_rxq_ctrl_config = {
-    /* MAC RxQ control0 register fields */
+    /* MAC RxQ control0 register fields, one queue per DMA channel */
     .rxq0en = 2,
-
-    /* rxq1end - rxq7en not supported in this version */
+    .rxq1en = (XGMAC_NUM_DMA_CHANNELS > 1U) ? 2 : 0,
+    .rxq2en = (XGMAC_NUM_DMA_CHANNELS > 2U) ? 2 : 0,
+    .rxq3en = (XGMAC_NUM_DMA_CHANNELS > 3U) ? 2 : 0,
+    .rxq4en = (XGMAC_NUM_DMA_CHANNELS > 4U) ? 2 : 0,
+    .rxq5en = (XGMAC_NUM_DMA_CHANNELS > 5U) ? 2 : 0,
+    .rxq6en = (XGMAC_NUM_DMA_CHANNELS > 6U) ? 2 : 0,
+    .rxq7en = (XGMAC_NUM_DMA_CHANNELS > 7U) ? 2 : 0,
 
     /* MAC RxQ control1 register fields */
     .mcbcqen = 1,
@@ -158,9 +164,9 @@ static const xgmacmac_pkt_filter_config_t mac_pkt_filter_config = {
  */
 static const xgmac_dev_config_t mac_dev_config = {
 
-    .nofdmachannels = 1,
-    .noftxqueues = 1,
-    .nofrxqueues = 1,
+    .nofdmachannels = XGMAC_NUM_DMA_CHANNELS,
+    .noftxqueues = XGMAC_NUM_DMA_CHANNELS,
+    .nofrxqueues = XGMAC_NUM_DMA_CHANNELS,
 };
 
 /* Main XGMAC Configuration instance */
@@ -348,9 +348,13 @@ int32_t xgmac_enable_dma_interrupt(uint32_t base_address, uint8_t chindx,
     uint32_t val;
     uint32_t intrmask;
 
-    /* Clear the DMA channel status register bits if set. Its a sticky bit hence write back to clear */
-    val = RD_DMA_CHNL_REG32(base_address, chindx, XGMAC_DMA_CH_STATUS);
-    WR_DMA_CHNL_REG32(base_address, chindx, XGMAC_DMA_CH_STATUS, val);
+    /* Clear the DMA channel status register bits if set. Its a sticky bit hence write back to clear.
+     * Re-enabling a single source keeps its pending status so that it fires right away. */
+    if ((id == INTERRUPT_NIS) || (id == INTERRUPT_AIS))
+    {
+        val = RD_DMA_CHNL_REG32(base_address, chindx, XGMAC_DMA_CH_STATUS);
+        WR_DMA_CHNL_REG32(base_address, chindx, XGMAC_DMA_CH_STATUS, val);
+    }
 
     switch (id)
     {
@@ -359,6 +363,14 @@ int32_t xgmac_enable_dma_interrupt(uint32_t base_address, uint8_t chindx,
                     XGMAC_DMA_INTR_MASK_NIS;
             break;
 
+        case INTERRUPT_TI:
+            intrmask = XGMAC_DMA_INTR_MASK_TI;
+            break;
+
+        case INTERRUPT_RI:
+            intrmask = XGMAC_DMA_INTR_MASK_RI;
+            break;
+
         case INTERRUPT_AIS:
             intrmask = XGMAC_DMA_INTR_MASK_FBE | XGMAC_DMA_INTR_MASK_TXS |
                     XGMAC_DMA_INTR_MASK_RBU | XGMAC_DMA_INTR_MASK_RS |
@@ -381,6 +393,64 @@ int32_t xgmac_enable_dma_interrupt(uint32_t base_address, uint8_t chindx,
     return XGMAC_LL_RETVAL_SUCCESS;
 }
 
+int32_t xgmac_disable_dma_interrupt(uint32_t base_address, uint8_t chindx,
+        xgmac_dma_interrupt_id_t id)
+{
+    uint32_t intrmask;
+
+    switch (id)
+    {
+        case INTERRUPT_NIS:
+            intrmask = XGMAC_DMA_INTR_MASK_TI | XGMAC_DMA_INTR_MASK_RI |
+                    XGMAC_DMA_INTR_MASK_NIS;
+            break;
+
+        case INTERRUPT_AIS:
+            intrmask = XGMAC_DMA_INTR_MASK_FBE | XGMAC_DMA_INTR_MASK_TXS |
+                    XGMAC_DMA_INTR_MASK_RBU | XGMAC_DMA_INTR_MASK_RS |
+                    XGMAC_DMA_INTR_MASK_DDE | XGMAC_DMA_INTR_MASK_AIS;
+            break;
+
+        case INTERRUPT_TI:
+            intrmask = XGMAC_DMA_INTR_MASK_TI;
+            break;
+
+        case INTERRUPT_RI:
+            intrmask = XGMAC_DMA_INTR_MASK_RI;
+            break;
+
+        default:
+            intrmask = 0U;
+            break;
+    }
+    if (intrmask == 0U)
+    {
+        return XGMAC_LL_RETVAL_FAIL;
+    }
+
+    DISABLE_DMA_CHNL_REGBIT(base_address + XGMAC_DMA_CH_INTERRUPT_ENABLE, chindx,
+            intrmask);
+
+    return XGMAC_LL_RETVAL_SUCCESS;
+}
+
+void xgmac_set_rx_int_watchdog(uint32_t base_address, uint8_t chindx,
+        uint8_t rwt, uint8_t rwtu)
+{
+    uint32_t val;
+
+    val = RD_DMA_CHNL_REG32(base_address, chindx,
+            XGMAC_DMA_CH_RX_INTERRUPT_WATCHDOG_TIMER);
+    val &= ~(XGMAC_DMA_CH0_RX_INTERRUPT_WATCHDOG_TIMER_RWT_MASK |
+            XGMAC_DMA_CH0_RX_INTERRUPT_WATCHDOG_TIMER_RWTU_MASK);
+    val |= ((uint32_t)rwt << XGMAC_DMA_CH0_RX_INTERRUPT_WATCHDOG_TIMER_RWT_POS) &
+            XGMAC_DMA_CH0_RX_INTERRUPT_WATCHDOG_TIMER_RWT_MASK;
+    val |= ((uint32_t)rwtu << XGMAC_DMA_CH0_RX_INTERRUPT_WATCHDOG_TIMER_RWTU_POS) &
+            XGMAC_DMA_CH0_RX_INTERRUPT_WATCHDOG_TIMER_RWTU_MASK;
+    WR_DMA_CHNL_REG32(base_address, chindx,
+            XGMAC_DMA_CH_RX_INTERRUPT_WATCHDOG_TIMER, val);
+}
+
 void xgmac_mac_init(uint32_t base_address, const
         xgmac_dev_config_str_t *xgmacdevconfig)
 {
@@ -456,12 +526,26 @@ void xgmac_start_stop_mac_rx(uint32_t base_address, bool stflag)
 void xgmac_config_macrxqctrl_regs(uint32_t base_address, const
         xgmacmac_rx_q_ctrl_config_t *macrxqctrlconfig)
 {
-    /* Clear and set the Receive Queue 0 */
-    DISABLE_BIT(base_address + XGMAC_MAC_RXQ_CTRL0, XGMAC_MAC_RXQ_CTRL0_RXQ0EN_MASK);
+    const uint8_t rxqen[8] =
+    {
+        macrxqctrlconfig->rxq0en, macrxqctrlconfig->rxq1en,
+        macrxqctrlconfig->rxq2en, macrxqctrlconfig->rxq3en,
+        macrxqctrlconfig->rxq4en, macrxqctrlconfig->rxq5en,
+        macrxqctrlconfig->rxq6en, macrxqctrlconfig->rxq7en
+    };
+    uint32_t val;
 
-    /* Enable for data Center Bridging/Generic */
-    ENABLE_BIT(base_address + XGMAC_MAC_RXQ_CTRL0,
-            macrxqctrlconfig->rxq0en << XGMAC_MAC_RXQ_CTRL0_RXQ0EN_POS);
+    /* Clear and set the Receive Queues, each RXQnEN field is two bits wide.
+     * Queues enabled for data Center Bridging/Generic take part in the
+     * priority and L3/L4 steering */
+    val = RD_REG32(base_address + XGMAC_MAC_RXQ_CTRL0);
+    for (uint8_t qindex = 0; qindex < 8U; qindex++)
+    {
+        val &= ~(XGMAC_MAC_RXQ_CTRL0_RXQ0EN_MASK << (qindex * 2U));
+        val |= ((uint32_t)rxqen[qindex] & XGMAC_MAC_RXQ_CTRL0_RXQ0EN_MASK) <<
+                (qindex * 2U);
+    }
+    WR_REG32(base_address + XGMAC_MAC_RXQ_CTRL0, val);
 
     /* Enable/Disable Multicast and Broadcast Queue Enable */
     if (macrxqctrlconfig->mcbcqen == 1)
@@ -837,13 +921,16 @@ void xgmac_mtl_init (uint32_t base_address, const
     const xgmac_dev_config_t *macdevconfig = (const
             xgmac_dev_config_t *)(xgmacdevconfig->mac_dev_config);
 
-    /* Program MTL configuration registers for Tx */
+    /* Program MTL configuration registers for Tx. Each Tx queue is served
+     * by the traffic class of the same number, scheduled in strict priority
+     * order */
     num_queues = macdevconfig->noftxqueues;
     for (qindex = 0; qindex < num_queues; qindex++)
     {
-        xgmac_set_mtl_tx_regs(base_address, qindex, (const
+        xgmac_set_mtl_tx_regs(base_address, qindex, num_queues, (const
                 xgmacmtl_tx_queue_config_t *)
                 xgmacdevconfig->mtl_tx_q_config);
+        xgmac_set_mtl_tx_sched_sp(base_address, qindex);
     }
 
     /* Program MTL configuration registers for Rx */
@@ -854,10 +941,18 @@ void xgmac_mtl_init (uint32_t base_address, const
         {
             return;
         }
-        xgmac_set_mtl_rx_regs(base_address, qindex, (const
+        xgmac_set_mtl_rx_regs(base_address, qindex, num_queues, (const
                 xgmacmtl_rx_queue_config_t *)
                 xgmacdevconfig->mtl_rx_q_config);
+
+        /* Rx queue n is read by the Rx DMA channel n */
+        xgmac_map_mtl_rxq_to_dma(base_address, qindex,
+                qindex % macdevconfig->nofdmachannels);
     }
+
+    /* Read the Rx queues in strict priority order as well. MTL_Operation_Mode
+     * is the first register of the MTL block */
+    DISABLE_BIT(base_address, XGMAC_MTL_OPERATION_MODE_RAA_MASK);
 }
 
 /* XGMAC Device start */
@@ -870,16 +965,16 @@ void xgmac_dev_start(uint32_t base_address)
     xgmac_start_stop_mac_rx(base_address, true);
 }
 
-void xgmac_set_mtl_tx_regs(uint32_t base_address, uint8_t qindx, const
-        xgmacmtl_tx_queue_config_t *mtltxqcfgparams)
+void xgmac_set_mtl_tx_regs(uint32_t base_address, uint8_t qindx, uint8_t
+        num_queues, const xgmacmtl_tx_queue_config_t *mtltxqcfgparams)
 {
     uint32_t val;
     uint32_t reg_val;
     uint32_t tqs;
 
-    /* Compute Tqs */
-    reg_val = RD_REG32(base_address + XGMAC_MAC_HW_FEATURE1);
-    tqs = XGMAC_MTL_TX_FIFO_BLK_CNT(reg_val);
+    /* Compute Tqs, the Tx fifo is shared evenly by the enabled queues */
+    reg_val = RD_REG32(XGMAC_MTL_TO_MAC_BASE(base_address) + XGMAC_MAC_HW_FEATURE1);
+    tqs = XGMAC_MTL_TX_FIFO_Q_BLK_CNT(reg_val, num_queues);
 
     /* Enable Transmit Queue Store and Forward */
     if (mtltxqcfgparams->tsf == 1)
@@ -901,20 +996,22 @@ void xgmac_set_mtl_tx_regs(uint32_t base_address, uint8_t qindx, const
 
     /* Program Transmit Queue Size */
     val = RD_MTL_QX_REG32(base_address, qindx, XGMAC_MTL_TXQ_OPERATION_MODE);
-    val |= tqs << XGMAC_MTL_TXQ0_OPERATION_MODE_TQS_POS;
+    val &= ~XGMAC_MTL_TXQ0_OPERATION_MODE_TQS_MASK;
+    val |= (tqs << XGMAC_MTL_TXQ0_OPERATION_MODE_TQS_POS) &
+            XGMAC_MTL_TXQ0_OPERATION_MODE_TQS_MASK;
     WR_MTL_QX_REG32(base_address, qindx, XGMAC_MTL_TXQ_OPERATION_MODE, val);
 }
 
-void xgmac_set_mtl_rx_regs(uint32_t base_address, uint8_t qindx, const
-        xgmacmtl_rx_queue_config_t *mtlrxqcfgparams)
+void xgmac_set_mtl_rx_regs(uint32_t base_address, uint8_t qindx, uint8_t
+        num_queues, const xgmacmtl_rx_queue_config_t *mtlrxqcfgparams)
 {
     uint32_t val;
     uint32_t reg_val;
     uint32_t rqs;
 
-    /* Compute Rqs */
-    reg_val = RD_REG32(base_address + XGMAC_MAC_HW_FEATURE1);
-    rqs = XGMAC_MTL_RX_FIFO_BLK_CNT(reg_val);
+    /* Compute Rqs, the Rx fifo is shared evenly by the enabled queues */
+    reg_val = RD_REG32(XGMAC_MTL_TO_MAC_BASE(base_address) + XGMAC_MAC_HW_FEATURE1);
+    rqs = XGMAC_MTL_RX_FIFO_Q_BLK_CNT(reg_val, num_queues);
 
     /* Enable Receive Queue Store and Forward */
     if (mtlrxqcfgparams->rsf == 1)
@@ -946,10 +1043,108 @@ void xgmac_set_mtl_rx_regs(uint32_t base_address, uint8_t qindx, const
 
     /* Program Receive Queue Size */
     val = RD_MTL_QX_REG32(base_address, qindx, XGMAC_MTL_RXQ_OPERATION_MODE);
-    val |= rqs << XGMAC_MTL_RXQ_OPERATION_MODE_RQS_POS;
+    val &= ~XGMAC_MTL_RXQ_OPERATION_MODE_RQS_MASK;
+    val |= (rqs << XGMAC_MTL_RXQ_OPERATION_MODE_RQS_POS) &
+            XGMAC_MTL_RXQ_OPERATION_MODE_RQS_MASK;
     WR_MTL_QX_REG32(base_address, qindx, XGMAC_MTL_RXQ_OPERATION_MODE, val);
 }
 
+void xgmac_map_mtl_rxq_to_dma(uint32_t base_address, uint8_t qindx, uint8_t
+        dmachindx)
+{
+    uint32_t reg_addr;
+    uint32_t pos;
+    uint32_t val;
+
+    /* Four queues per map register, one byte each. DDMACH is left clear so
+     * the queue is statically mapped to the channel */
+    reg_addr = base_address + (XGMAC_MTL_RXQ_DMA_MAP0 -
+            XGMAC_MTL_OPERATION_MODE) + ((qindx / 4U) * 4U);
+    pos = (qindx % 4U) * 8U;
+
+    val = RD_REG32(reg_addr);
+    val &= ~(0xFFU << pos);
+    val |= ((uint32_t)dmachindx & XGMAC_MTL_RXQ_DMA_MAP0_Q0MDMACH_MASK) << pos;
+    WR_REG32(reg_addr, val);
+}
+
+void xgmac_set_mtl_tx_sched_sp(uint32_t base_address, uint8_t qindx)
+{
+    uint32_t val;
+
+    /* Serve the Tx queue by the traffic class of the same number */
+    val = RD_MTL_QX_REG32(base_address, qindx, XGMAC_MTL_TXQ_OPERATION_MODE);
+    val &= ~XGMAC_MTL_TXQ_OPERATION_MODE_Q2TCMAP_MASK;
+    val |= ((uint32_t)qindx << XGMAC_MTL_TXQ_OPERATION_MODE_Q2TCMAP_POS) &
+            XGMAC_MTL_TXQ_OPERATION_MODE_Q2TCMAP_MASK;
+    WR_MTL_QX_REG32(base_address, qindx, XGMAC_MTL_TXQ_OPERATION_MODE, val);
+
+    /* Strict priority, a higher traffic class always goes first */
+    val = RD_MTL_QX_REG32(base_address, qindx, XGMAC_MTL_TC_ETS_CONTROL);
+    val &= ~XGMAC_MTL_TC0_ETS_CONTROL_TSA_MASK;
+    val |= XGMAC_MTL_TC_TSA_STRICT_PRIORITY << XGMAC_MTL_TC0_ETS_CONTROL_TSA_POS;
+    WR_MTL_QX_REG32(base_address, qindx, XGMAC_MTL_TC_ETS_CONTROL, val);
+}
+
+void xgmac_set_rxq_prio(uint32_t base_address, uint8_t qindx, uint8_t
+        prio_mask)
+{
+    uint32_t reg_addr;
+    uint32_t pos;
+    uint32_t val;
+
+    /* PSRQn fields, four queues per register */
+    reg_addr = base_address + ((qindx < 4U) ? XGMAC_MAC_RXQ_CTRL2 :
+            XGMAC_MAC_RXQ_CTRL3);
+    pos = (qindx % 4U) * 8U;
+
+    val = RD_REG32(reg_addr);
+    val &= ~(XGMAC_MAC_RXQ_CTRL2_PSRQ0_MASK << pos);
+    val |= (uint32_t)prio_mask << pos;
+    WR_REG32(reg_addr, val);
+}
+
+int32_t xgmac_write_l3l4_filter_reg(uint32_t base_address, uint8_t fnum,
+        uint8_t reg, uint32_t val)
+{
+    uint32_t ctrl;
+    uint32_t timeout = 1000;
+
+    WR_REG32(base_address + XGMAC_MAC_L3_L4_DATA, val);
+
+    /* Start a write transfer (TT clear) to the addressed register */
+    ctrl = (((uint32_t)fnum << XGMAC_L3L4_IDDR_FNUM_POS) | reg) <<
+            XGMAC_MAC_L3_L4_ADDRESS_CONTROL_IDDR_POS;
+    ctrl &= XGMAC_MAC_L3_L4_ADDRESS_CONTROL_IDDR_MASK;
+    ctrl |= XGMAC_MAC_L3_L4_ADDRESS_CONTROL_XB_MASK;
+    WR_REG32(base_address + XGMAC_MAC_L3_L4_ADDRESS_CONTROL, ctrl);
+
+    /* Wait for the transfer to complete */
+    while ((RD_REG32(base_address + XGMAC_MAC_L3_L4_ADDRESS_CONTROL) &
+            XGMAC_MAC_L3_L4_ADDRESS_CONTROL_XB_MASK) != 0U)
+    {
+        if (timeout == 0U)
+        {
+            return XGMAC_LL_RETVAL_FAIL;
+        }
+        timeout--;
+    }
+
+    return XGMAC_LL_RETVAL_SUCCESS;
+}
+
+void xgmac_enable_l3l4_filtering(uint32_t base_address, bool enable)
+{
+    if (enable == true)
+    {
+        ENABLE_BIT(base_address + XGMAC_MAC_PACKET_FILTER, XGMAC_MAC_PACKET_FILTER_IPFE_MASK);
+    }
+    else
+    {
+        DISABLE_BIT(base_address + XGMAC_MAC_PACKET_FILTER, XGMAC_MAC_PACKET_FILTER_IPFE_MASK);
+    }
+}
+
 void xgmac_disable_interrupt(uint32_t base_address)
 {
     /* Read the XGMAC interrupt status register */
@@ -1023,6 +1218,23 @@ xgmac_dma_interrupt_id_t check_and_clear_xgmac_interrupt_status(uint32_t
 
     return res;
 }
+uint32_t xgmac_get_and_clear_dma_status(uint32_t base_address, uint8_t chindx)
+{
+    uint32_t val;
+    uint32_t enabled;
+
+    val = RD_DMA_CHNL_REG32(base_address, chindx, XGMAC_DMA_CH_STATUS);
+    enabled = RD_DMA_CHNL_REG32(base_address, chindx,
+            XGMAC_DMA_CH_INTERRUPT_ENABLE);
+
+    /* Clear only the sources which are enabled, a masked source stays pending
+     * and fires once it is enabled again */
+    val &= (enabled | XGMAC_DMA_INTR_MASK_NIS | XGMAC_DMA_INTR_MASK_AIS);
+    WR_DMA_CHNL_REG32(base_address, chindx, XGMAC_DMA_CH_STATUS, val);
+
+    return val;
+}
+
 void check_and_clear_link_interrupt_status(uint32_t base_address)
 {
     uint32_t val;
@@ -1037,6 +1249,11 @@ void xgmac_flush_buffer(void *buf, size_t size)
     cache_force_write_back(buf, size);
 }
 
+void xgmac_flush_buffer_list(const cache_range_t *ranges, size_t count)
+{
+    cache_range_list_op(CACHE_OP_CLEAN, ranges, count);
+}
+
 void xgmac_invalidate_buffer(void *buf, size_t size)
 {
     cache_force_invalidate(buf, size);
@@ -1053,3 +1270,147 @@ void xgmac_mmc_setup(uint32_t base_address)
      * */
     DISABLE_BIT(base_address + XGMAC_MMC_IPC_RX_INTERRUPT_MASK, XGMAC_MMC_IPC_RX_INTR_MASK_ALL);
 }
+
+static int32_t xgmac_ptp_wait_ctrl(uint32_t base_address, uint32_t mask)
+{
+    uint32_t timeout = 1000;
+
+    /* The command bits clear once the system time unit has taken them */
+    while ((RD_REG32(base_address + XGMAC_MAC_TIMESTAMP_CONTROL) & mask) != 0U)
+    {
+        if (timeout == 0U)
+        {
+            return XGMAC_LL_RETVAL_FAIL;
+        }
+        timeout--;
+    }
+
+    return XGMAC_LL_RETVAL_SUCCESS;
+}
+
+void xgmac_ptp_config(uint32_t base_address, uint32_t ts_ctrl, uint32_t ssinc)
+{
+    WR_REG32(base_address + XGMAC_MAC_SUB_SECOND_INCREMENT,
+            (ssinc << XGMAC_MAC_SUB_SECOND_INCREMENT_SSINC_POS) &
+            XGMAC_MAC_SUB_SECOND_INCREMENT_SSINC_MASK);
+    WR_REG32(base_address + XGMAC_MAC_TIMESTAMP_CONTROL, ts_ctrl);
+}
+
+int32_t xgmac_ptp_init_time(uint32_t base_address, uint64_t sec, uint32_t nsec)
+{
+    if (xgmac_ptp_wait_ctrl(base_address,
+            XGMAC_MAC_TIMESTAMP_CONTROL_TSINIT_MASK) != XGMAC_LL_RETVAL_SUCCESS)
+    {
+        return XGMAC_LL_RETVAL_FAIL;
+    }
+
+    WR_REG32(base_address + XGMAC_MAC_SYSTEM_TIME_SECONDS_UPDATE, (uint32_t)sec);
+    WR_REG32(base_address + XGMAC_MAC_SYSTEM_TIME_NANOSECONDS_UPDATE,
+            nsec & XGMAC_MAC_SYSTEM_TIME_NANOSECONDS_UPDATE_TSSS_MASK);
+    WR_REG32(base_address + XGMAC_MAC_SYSTEM_TIME_HIGHER_WORD_SECONDS,
+            (uint32_t)(sec >> 32) & XGMAC_MAC_SYSTEM_TIME_HIGHER_WORD_SECONDS_TSHWR_MASK);
+
+    ENABLE_BIT(base_address + XGMAC_MAC_TIMESTAMP_CONTROL,
+            XGMAC_MAC_TIMESTAMP_CONTROL_TSINIT_MASK);
+
+    return xgmac_ptp_wait_ctrl(base_address,
+            XGMAC_MAC_TIMESTAMP_CONTROL_TSINIT_MASK);
+}
+
+int32_t xgmac_ptp_update_time(uint32_t base_address, uint64_t sec,
+        uint32_t nsec, bool subtract)
+{
+    uint32_t sec_update = (uint32_t)sec;
+    uint32_t nsec_update = nsec;
+
+    if (xgmac_ptp_wait_ctrl(base_address,
+            XGMAC_MAC_TIMESTAMP_CONTROL_TSUPDT_MASK) != XGMAC_LL_RETVAL_SUCCESS)
+    {
+        return XGMAC_LL_RETVAL_FAIL;
+    }
+
+    if ((sec == 0U) && (nsec == 0U))
+    {
+        return XGMAC_LL_RETVAL_SUCCESS;
+    }
+
+    if (subtract == true)
+    {
+        /* In digital rollover mode a subtraction is programmed as the two's
+         * complement of the seconds and 10^9 minus the nanoseconds, the
+         * unit borrows one second. Whole seconds are written as one second
+         * less and 10^9 nanoseconds to keep the field in range. */
+        if (nsec == 0U)
+        {
+            sec_update--;
+            nsec_update = XGMAC_PTP_NSEC_PER_SEC;
+        }
+        sec_update = (uint32_t)(0U - sec_update);
+        nsec_update = XGMAC_PTP_NSEC_PER_SEC - nsec_update;
+        nsec_update |= XGMAC_MAC_SYSTEM_TIME_NANOSECONDS_UPDATE_ADDSUB_MASK;
+    }
+
+    WR_REG32(base_address + XGMAC_MAC_SYSTEM_TIME_SECONDS_UPDATE, sec_update);
+    WR_REG32(base_address + XGMAC_MAC_SYSTEM_TIME_NANOSECONDS_UPDATE, nsec_update);
+
+    ENABLE_BIT(base_address + XGMAC_MAC_TIMESTAMP_CONTROL,
+            XGMAC_MAC_TIMESTAMP_CONTROL_TSUPDT_MASK);
+
+    return xgmac_ptp_wait_ctrl(base_address,
+            XGMAC_MAC_TIMESTAMP_CONTROL_TSUPDT_MASK);
+}
+
+int32_t xgmac_ptp_set_addend(uint32_t base_address, uint32_t addend)
+{
+    if (xgmac_ptp_wait_ctrl(base_address,
+            XGMAC_MAC_TIMESTAMP_CONTROL_TSADDREG_MASK) != XGMAC_LL_RETVAL_SUCCESS)
+    {
+        return XGMAC_LL_RETVAL_FAIL;
+    }
+
+    WR_REG32(base_address + XGMAC_MAC_TIMESTAMP_ADDEND, addend);
+    ENABLE_BIT(base_address + XGMAC_MAC_TIMESTAMP_CONTROL,
+            XGMAC_MAC_TIMESTAMP_CONTROL_TSADDREG_MASK);
+
+    return xgmac_ptp_wait_ctrl(base_address,
+            XGMAC_MAC_TIMESTAMP_CONTROL_TSADDREG_MASK);
+}
+
+void xgmac_ptp_get_time(uint32_t base_address, uint64_t *sec, uint32_t *nsec)
+{
+    uint32_t ns;
+    uint32_t s;
+    uint32_t s_hi;
+
+    /* Read the seconds again if they rolled over while the nanoseconds
+     * were read */
+    do
+    {
+        s = RD_REG32(base_address + XGMAC_MAC_SYSTEM_TIME_SECONDS);
+        ns = RD_REG32(base_address + XGMAC_MAC_SYSTEM_TIME_NANOSECONDS);
+        s_hi = RD_REG32(base_address + XGMAC_MAC_SYSTEM_TIME_HIGHER_WORD_SECONDS);
+    } while (s != RD_REG32(base_address + XGMAC_MAC_SYSTEM_TIME_SECONDS));
+
+    *sec = ((uint64_t)(s_hi & XGMAC_MAC_SYSTEM_TIME_HIGHER_WORD_SECONDS_TSHWR_MASK)
+            << 32) | s;
+    *nsec = ns & XGMAC_MAC_SYSTEM_TIME_NANOSECONDS_TSSS_MASK;
+}
+
+int32_t xgmac_ptp_get_tx_time(uint32_t base_address, uint64_t *sec,
+        uint32_t *nsec)
+{
+    uint32_t ns;
+
+    /* TXTSC clears on read, the timestamp registers hold the capture */
+    if ((RD_REG32(base_address + XGMAC_MAC_TIMESTAMP_STATUS) &
+            XGMAC_MAC_TIMESTAMP_STATUS_TXTSC_MASK) == 0U)
+    {
+        return XGMAC_LL_RETVAL_FAIL;
+    }
+
+    ns = RD_REG32(base_address + XGMAC_MAC_TX_TIMESTAMP_STATUS_NANOSECONDS);
+    *sec = RD_REG32(base_address + XGMAC_MAC_TX_TIMESTAMP_STATUS_SECONDS);
+    *nsec = ns & XGMAC_MAC_TX_TIMESTAMP_STATUS_NANOSECONDS_TXTSSLO_MASK;
+
+    return XGMAC_LL_RETVAL_SUCCESS;
+}
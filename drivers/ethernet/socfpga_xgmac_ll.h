@@ -35,6 +35,8 @@
 #define XGMAC_LL_RETVAL_SUCCESS    (0x1)
 #define XGMAC_LL_RETVAL_FAIL       (0xFF)
 
+#define XGMAC_PTP_NSEC_PER_SEC     1000000000U
+
 #define XGMAC_PHY_TYPE_GMII          0U
 #define XGMAC_PHY_TYPE_RMII          2U
 #define XGMAC_PHY_TYPE_SGMII         3U
@@ -54,6 +56,10 @@
 #define XGMAC_GET_MTL_BASE_ADDRESS(instance)     ((uint32_t)(XGMAC_EMAC_MTL_BASEADDR + \
     ((uint32_t)(instance) * 0x10000U)))
 
+/* MAC register block of an MTL base address, the MTL block starts at the
+ * MTL_Operation_Mode register */
+#define XGMAC_MTL_TO_MAC_BASE(mtl_base)    ((uint32_t)(mtl_base) - XGMAC_MTL_OPERATION_MODE)
+
 #define XGMAC_DMA_INTR_POS_TI      0U
 #define XGMAC_DMA_INTR_MASK_TI     0x00000001U
 #define XGMAC_DMA_INTR_POS_TXS     1U
@@ -95,6 +101,26 @@
 #define XGMAC_MTL_TX_FIFO_BLK_CNT(feature1_val)    ((XGMAC_MTL_TX_FIFOSZ_BYTES(feature1_val) >> 8) - \
     1U)
 
+/* block count of one queue when the fifo is shared evenly by num_queues queues
+ * */
+#define XGMAC_MTL_RX_FIFO_Q_BLK_CNT(feature1_val, num_queues)    (((XGMAC_MTL_RX_FIFOSZ_BYTES(feature1_val) / \
+    (num_queues)) >> 8) - 1U)
+#define XGMAC_MTL_TX_FIFO_Q_BLK_CNT(feature1_val, num_queues)    (((XGMAC_MTL_TX_FIFOSZ_BYTES(feature1_val) / \
+    (num_queues)) >> 8) - 1U)
+
+/* MTL traffic class transmission selection algorithms */
+#define XGMAC_MTL_TC_TSA_STRICT_PRIORITY    0U
+#define XGMAC_MTL_TC_TSA_ETS                2U
+
+/* Indirectly accessed L3/L4 filter registers, see MAC_L3_L4_Address_Control */
+#define XGMAC_L3L4_IDDR_FNUM_POS      4U
+#define XGMAC_L3L4_REG_CONTROL        0x0U
+#define XGMAC_L3L4_REG_L4_ADDRESS     0x1U
+#define XGMAC_L3L4_REG_L3_ADDR0       0x4U
+#define XGMAC_L3L4_REG_L3_ADDR1       0x5U
+#define XGMAC_L3L4_REG_L3_ADDR2       0x6U
+#define XGMAC_L3L4_REG_L3_ADDR3       0x7U
+
 /* Common register bit set/clear macros */
 #define ENABLE_BIT(address, bit)     (*(uint32_t volatile *)((uintptr_t)(address)) |= (bit))
 #define DISABLE_BIT(address, bit)    (*(uint32_t volatile *)((uintptr_t)(address)) &= ~(bit))
@@ -372,10 +398,18 @@ void xgmac_enable_tx_flow_control(uint32_t base_address, uint8_t qindx, const
 void xgmac_enable_rx_flow_control(uint32_t base_address, const
         xgmacmac_rx_flow_ctrl_config_t *macrxflowctrlconfig);
 
-void xgmac_set_mtl_tx_regs(uint32_t base_address, uint8_t qindx, const
-        xgmacmtl_tx_queue_config_t *mtltxqcfgparams);
-void xgmac_set_mtl_rx_regs(uint32_t base_address, uint8_t qindx, const
-        xgmacmtl_rx_queue_config_t *mtlrxqcfgparams);
+void xgmac_set_mtl_tx_regs(uint32_t base_address, uint8_t qindx, uint8_t
+        num_queues, const xgmacmtl_tx_queue_config_t *mtltxqcfgparams);
+void xgmac_set_mtl_rx_regs(uint32_t base_address, uint8_t qindx, uint8_t
+        num_queues, const xgmacmtl_rx_queue_config_t *mtlrxqcfgparams);
+void xgmac_map_mtl_rxq_to_dma(uint32_t base_address, uint8_t qindx, uint8_t
+        dmachindx);
+void xgmac_set_mtl_tx_sched_sp(uint32_t base_address, uint8_t qindx);
+void xgmac_set_rxq_prio(uint32_t base_address, uint8_t qindx, uint8_t
+        prio_mask);
+int32_t xgmac_write_l3l4_filter_reg(uint32_t base_address, uint8_t fnum,
+        uint8_t reg, uint32_t val);
+void xgmac_enable_l3l4_filtering(uint32_t base_address, bool enable);
 
 /* DMA Function prototypes */
 void xgmac_dma_init(uint32_t base_address, const
@@ -396,6 +430,8 @@ int32_t xgmac_enable_dma_interrupt(uint32_t base_address, uint8_t chindx, xgmac_
         id);
 int32_t xgmac_disable_dma_interrupt(uint32_t base_address, uint8_t chindx, xgmac_dma_interrupt_id_t
         id);
+void xgmac_set_rx_int_watchdog(uint32_t base_address, uint8_t chindx,
+        uint8_t rwt, uint8_t rwtu);
 void xgmac_start_dma_dev(uint32_t base_address, const
         xgmac_dev_config_str_t *xgmacdevconfig);
 void xgmac_stop_dma_dev(uint32_t base_address, const
@@ -411,11 +447,23 @@ void xgmac_dev_stop(uint32_t base_address);
 void xgmac_disable_interrupt(uint32_t base_address);
 xgmac_dma_interrupt_id_t check_and_clear_xgmac_interrupt_status(
     uint32_t base_address);
+uint32_t xgmac_get_and_clear_dma_status(uint32_t base_address, uint8_t chindx);
 void check_and_clear_link_interrupt_status(uint32_t base_address);
 
 void xgmac_invalidate_buffer(void *buf, size_t size);
 void xgmac_flush_buffer(void *buf, size_t size);
+void xgmac_flush_buffer_list(const cache_range_t *ranges, size_t count);
 
 void xgmac_mmc_setup(uint32_t base_address);
 
+/* System time (IEEE 1588) Function prototypes */
+void xgmac_ptp_config(uint32_t base_address, uint32_t ts_ctrl, uint32_t ssinc);
+int32_t xgmac_ptp_init_time(uint32_t base_address, uint64_t sec, uint32_t nsec);
+int32_t xgmac_ptp_update_time(uint32_t base_address, uint64_t sec,
+        uint32_t nsec, bool subtract);
+int32_t xgmac_ptp_set_addend(uint32_t base_address, uint32_t addend);
+void xgmac_ptp_get_time(uint32_t base_address, uint64_t *sec, uint32_t *nsec);
+int32_t xgmac_ptp_get_tx_time(uint32_t base_address, uint64_t *sec,
+        uint32_t *nsec);
+
 #endif
@@ -133,6 +133,12 @@ extern "C" {
 #define RDES3_NORM_WR_RSVD_MASK             0x00004000U
 #define RDES3_NORM_WR_PL_MASK               0x00003FFFU
 
+/* RDES0/RDES1/RDES3 Context Descriptor (Write-Back Format) */
+#define RDES0_CTXT_WR_RTSL_MASK             0xFFFFFFFFU
+#define RDES1_CTXT_WR_RTSH_MASK             0xFFFFFFFFU
+#define RDES3_CTXT_WR_TSD_MASK              0x00000040U
+#define RDES3_CTXT_WR_TSA_MASK              0x00000010U
+
 
 /* EMAC Base Addr Registers */
 #define XGMAC_EMAC_BASEADDR                     \
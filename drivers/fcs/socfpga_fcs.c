@@ -67,6 +67,7 @@
 #include "socfpga_mbox_client.h"
 #include "socfpga_fcs.h"
 #include "socfpga_fcs_ll.h"
+#include "socfpga_smmu.h"
 #include "osal.h"
 #include "osal_log.h"
 
@@ -74,6 +75,41 @@
 #define FCS_BUFFER_SIZE           0x100000U
 #define FCS_CRYPTO_BLOCK_SIZE     0x400000U
 #define FCS_NON_GCM_BLOCK_SIZE    32U
+#ifndef FCS_MAX_REQUESTS
+#define FCS_MAX_REQUESTS          4U
+#endif
+/* every request of the pool may be in flight on one mailbox client */
+#define FCS_MBOX_WINDOW           ((FCS_MAX_REQUESTS > 16U) ? 16U : \
+    FCS_MAX_REQUESTS)
+#define FCS_REQ_BUF_WORDS         (FCS_BUFFER_SIZE / FCS_MAX_REQUESTS)
+#define FCS_REQ_BUF_SIZE          (FCS_REQ_BUF_WORDS * MBOX_WORD_SIZE)
+#define FCS_CACHE_LINE_SIZE       64U
+#ifndef FCS_ZERO_COPY
+#define FCS_ZERO_COPY             1
+#endif
+#ifndef FCS_ZERO_COPY_MIN_SIZE
+#define FCS_ZERO_COPY_MIN_SIZE    0x1000U
+#endif
+/* bytes of one AES update, FCS_BUFFER_SIZE counts words */
+#define FCS_AES_MAX_UPDATE        (FCS_CRYPTO_BLOCK_SIZE - \
+    (FCS_CRYPTO_BLOCK_SIZE % FCS_NON_GCM_BLOCK_SIZE))
+#define FCS_AES_MAX_SEGS          4U
+#ifndef FCS_MAX_STREAMS
+#define FCS_MAX_STREAMS           (FCS_MAX_REQUESTS / 2U)
+#endif
+#ifndef FCS_STREAM_CHUNK_SIZE
+#define FCS_STREAM_CHUNK_SIZE     0x10000U
+#endif
+#define FCS_STREAM_AES            0U
+#define FCS_STREAM_DIGEST         1U
+#define FCS_STREAM_IDLE           0U
+#define FCS_STREAM_BUSY           1U
+#define FCS_STREAM_DONE           2U
+#define FCS_DIGEST_BLOCK_SIZE     8U
+
+#if (FCS_MAX_REQUESTS < 2U)
+#error "FCS streams need at least two requests"
+#endif
 typedef struct
 {
     char uuid[FCS_UUID_SIZE];
@@ -81,9 +117,57 @@ typedef struct
     sdm_client_handle crypto_handle;
 } session_handle_struct;
 
+/* One piece of an AES request, the SDM reads src and writes dest in place */
+typedef struct
+{
+    char *src;
+    uint32_t src_size;
+    char *dest;
+    uint32_t dest_size;
+} fcs_aes_seg_t;
+
+/* One request in flight, with its own completion and bounce buffers */
+typedef struct
+{
+    osal_semaphore_t done;
+    uint32_t *inp;
+    uint32_t *out;
+} fcs_request_t;
+
+/*
+ * A streaming AES or digest operation. It owns two requests and ping-pongs
+ * between them, one is in the SDM while the other is staged by the caller.
+ */
+struct fcs_stream_context
+{
+    bool in_use;
+    uint8_t type;
+    char *uuid;
+    uint32_t context_id;
+    uint32_t crypt_mode;
+    uint32_t block_mode;
+    uint32_t block_size;
+    uint32_t chunk_size;
+    uint32_t cur;
+    int error;
+    fcs_request_t *req[2];
+    uint8_t state[2];
+    int status[2];
+    char *dest[2];
+    uint32_t dest_len[2];
+    uint32_t out_len[2];
+    uint64_t resp[2][2];
+    fcs_stream_callback_t callback;
+    void *cb_context;
+};
+
 struct fcs_service_descriptor
 {
-    osal_semaphore_t fcs_sem;
+    osal_semaphore_t req_free;
+    osal_mutex_t session_lock;
+    osal_mutex_t stream_lock;
+    uint32_t req_busy;
+    fcs_request_t requests[FCS_MAX_REQUESTS];
     session_handle_struct session_map[FCS_MAX_INSTANCES];
     sdm_client_handle security_handle;
     int session_count;
@@ -91,12 +175,108 @@ struct fcs_service_descriptor
 
 static struct fcs_service_descriptor *fcs_descriptor = NULL;
 /** @cond DOXYGEN_IGNORE */
-/* Statically allocating 4MB of data, 64 byte alignment for cache operations */
-static uint32_t fcs_inp_ops_buffer[FCS_BUFFER_SIZE] __attribute__((aligned(64)));
-static uint32_t fcs_out_ops_buffer[FCS_BUFFER_SIZE] __attribute__((aligned(64)));
+/*
+ * Statically allocating 4MB of data, split evenly between the requests,
+ * 64 byte alignment for cache operations
+ */
+static uint32_t fcs_inp_ops_buffer[FCS_MAX_REQUESTS][FCS_REQ_BUF_WORDS]
+__attribute__((aligned(64)));
+static uint32_t fcs_out_ops_buffer[FCS_MAX_REQUESTS][FCS_REQ_BUF_WORDS]
+__attribute__((aligned(64)));
+static struct fcs_stream_context fcs_streams[FCS_MAX_STREAMS];
 /** @endcond */
 
-void fcs_callback(uint64_t *resp_values);
+void fcs_callback(uint64_t *resp_values, void *context);
+
+/*
+ * @brief Take a free request from the pool, blocks till one is available
+ */
+static fcs_request_t *fcs_request_get(void)
+{
+    fcs_request_t *req = NULL;
+    uint32_t i;
+
+    (void)osal_semaphore_wait(fcs_descriptor->req_free,
+            OSAL_TIMEOUT_WAIT_FOREVER);
+    osal_enter_critical();
+    for (i = 0U; i < FCS_MAX_REQUESTS; i++)
+    {
+        if ((fcs_descriptor->req_busy & (1U << i)) == 0U)
+        {
+            fcs_descriptor->req_busy |= (1U << i);
+            req = &fcs_descriptor->requests[i];
+            break;
+        }
+    }
+    osal_exit_critical();
+    return req;
+}
+
+/*
+ * @brief Return a request to the pool
+ */
+static void fcs_request_put(fcs_request_t *req)
+{
+    uint32_t i = (uint32_t)(req - fcs_descriptor->requests);
+
+    osal_enter_critical();
+    fcs_descriptor->req_busy &= ~(1U << i);
+    osal_exit_critical();
+    (void)osal_semaphore_post(fcs_descriptor->req_free);
+}
+
+static int fcs_request_pool_init(void)
+{
+    uint32_t i;
+
+    fcs_descriptor->req_busy = 0U;
+    fcs_descriptor->req_free = osal_semaphore_counting_create(NULL,
+            FCS_MAX_REQUESTS, FCS_MAX_REQUESTS);
+    fcs_descriptor->session_lock = osal_mutex_create(NULL);
+    fcs_descriptor->stream_lock = osal_mutex_create(NULL);
+    if ((fcs_descriptor->req_free == NULL) ||
+            (fcs_descriptor->session_lock == NULL) ||
+            (fcs_descriptor->stream_lock == NULL))
+    {
+        return -ENOMEM;
+    }
+    for (i = 0U; i < FCS_MAX_REQUESTS; i++)
+    {
+        fcs_descriptor->requests[i].done = osal_semaphore_create(NULL);
+        if (fcs_descriptor->requests[i].done == NULL)
+        {
+            return -ENOMEM;
+        }
+        fcs_descriptor->requests[i].inp = fcs_inp_ops_buffer[i];
+        fcs_descriptor->requests[i].out = fcs_out_ops_buffer[i];
+    }
+    return 0;
+}
+
+static void fcs_request_pool_deinit(void)
+{
+    uint32_t i;
+
+    for (i = 0U; i < FCS_MAX_REQUESTS; i++)
+    {
+        if (fcs_descriptor->requests[i].done != NULL)
+        {
+            (void)osal_semaphore_delete(fcs_descriptor->requests[i].done);
+        }
+    }
+    if (fcs_descriptor->req_free != NULL)
+    {
+        (void)osal_semaphore_delete(fcs_descriptor->req_free);
+    }
+    if (fcs_descriptor->session_lock != NULL)
+    {
+        (void)osal_mutex_delete(fcs_descriptor->session_lock);
+    }
+    if (fcs_descriptor->stream_lock != NULL)
+    {
+        (void)osal_mutex_delete(fcs_descriptor->stream_lock);
+    }
+}
 
 int fcs_init(void)
 {
@@ -109,9 +289,8 @@ int fcs_init(void)
             ERROR("Failed to initialise FCS");
             return -ENOMEM;
         }
-        fcs_descriptor->session_count = 0;
-        (void)memset(fcs_descriptor->session_map, 0,
-                sizeof(fcs_descriptor->session_map));
+        (void)memset(fcs_descriptor, 0,
+                sizeof(struct fcs_service_descriptor));
         ret = mbox_init();
         if (ret != 0)
         {
@@ -134,11 +313,17 @@ int fcs_init(void)
             fcs_descriptor = NULL;
             return -EIO;
         }
-        ret = mbox_set_callback(fcs_descriptor->security_handle, fcs_callback);
-        fcs_descriptor->fcs_sem = osal_semaphore_create(NULL);
-        if ((fcs_descriptor->fcs_sem == NULL) || (ret != 0))
+        ret = mbox_set_ctx_callback(fcs_descriptor->security_handle,
+                fcs_callback);
+        if (ret == 0)
+        {
+            ret = mbox_set_window(fcs_descriptor->security_handle,
+                    (uint8_t)FCS_MBOX_WINDOW);
+        }
+        if ((fcs_request_pool_init() != 0) || (ret != 0))
         {
             ERROR("Failed to initialise semaphore");
+            fcs_request_pool_deinit();
             (void)memset(fcs_descriptor, 0, sizeof(struct
                     fcs_service_descriptor));
             vPortFree(fcs_descriptor);
@@ -179,6 +364,7 @@ int fcs_deinit(void)
             WARN("Failed to free mailbox resources");
         }
 
+        fcs_request_pool_deinit();
         (void)memset(fcs_descriptor, 0, sizeof(struct fcs_service_descriptor));
         vPortFree(fcs_descriptor);
         fcs_descriptor = NULL;
@@ -211,8 +397,8 @@ static sdm_client_handle get_client_handle(char *uuid, uint32_t *session_id)
 }
 
 /* @brief Use the random number generator to generate a UUID for the session ID */
-static void generate_uuid(sdm_client_handle fcs_handle, uint32_t session_id,
-        char *uuid)
+static void generate_uuid(fcs_request_t *req, sdm_client_handle fcs_handle,
+        uint32_t session_id, char *uuid)
 {
     uint64_t rng_args[4], rng_resp[2] =
     {
@@ -221,24 +407,24 @@ static void generate_uuid(sdm_client_handle fcs_handle, uint32_t session_id,
     int ret;
     rng_args[0] = session_id;
     rng_args[1] = 1;
-    rng_args[2] = (uint64_t)fcs_out_ops_buffer;
+    rng_args[2] = (uint64_t)req->out;
     rng_args[3] = FCS_UUID_SIZE;
-    cache_force_invalidate(fcs_out_ops_buffer, FCS_UUID_SIZE +
+    cache_force_invalidate(req->out, FCS_UUID_SIZE +
             FCS_RESP_HEADER_SIZE);
 
-    ret = sip_svc_send(fcs_handle, FCS_RANDOM_NUMBER, rng_args,
-            sizeof(rng_args), rng_resp, sizeof(rng_resp));
+    ret = sip_svc_send_ctx(fcs_handle, FCS_RANDOM_NUMBER, rng_args,
+            sizeof(rng_args), rng_resp, sizeof(rng_resp), req);
     if (ret == 0)
     {
-        if (osal_semaphore_wait(fcs_descriptor->fcs_sem,
+        if (osal_semaphore_wait(req->done,
                 OSAL_TIMEOUT_WAIT_FOREVER) == true)
         {
             if (rng_resp[FCS_RESP_STATUS] == 0UL)
             {
-                cache_force_invalidate(fcs_out_ops_buffer, FCS_UUID_SIZE +
+                cache_force_invalidate(req->out, FCS_UUID_SIZE +
                         FCS_RESP_HEADER_SIZE);
                 (void)memcpy((void *)uuid,
-                        (void *)&fcs_out_ops_buffer[FCS_RESP_DATA],
+                        (void *)&req->out[FCS_RESP_DATA],
                         FCS_UUID_SIZE);
             }
         }
@@ -246,6 +432,7 @@ static void generate_uuid(sdm_client_handle fcs_handle, uint32_t session_id,
 }
 int run_fcs_open_service_session(char *uuid)
 {
+    fcs_request_t *req;
     int ret, i;
     uint16_t status;
     uint64_t open_session_resp[2] =
@@ -265,39 +452,49 @@ int run_fcs_open_service_session(char *uuid)
         ERROR("Invalid parameters");
         return -EINVAL;
     }
-    /* Session ID is tied with a client, find a client with no session*/
+    /*
+     * Session ID is tied with a client, find a client with no session.
+     * The slot is claimed under the lock so that sessions can be opened
+     * from several tasks at once.
+     */
+    fcs_handle = NULL;
+    (void)osal_mutex_lock(fcs_descriptor->session_lock,
+            OSAL_TIMEOUT_WAIT_FOREVER);
     for (i = 0; i < (int)FCS_MAX_INSTANCES; i++)
     {
-        if (fcs_descriptor->session_map[i].session_id == 0U)
+        if (fcs_descriptor->session_map[i].crypto_handle == NULL)
         {
+            fcs_handle = mbox_open_client();
+            fcs_descriptor->session_map[i].crypto_handle = fcs_handle;
             break;
         }
     }
-    fcs_descriptor->session_map[i].crypto_handle = mbox_open_client();
-    if (fcs_descriptor->session_map[i].crypto_handle == NULL)
+    (void)osal_mutex_unlock(fcs_descriptor->session_lock);
+    if (fcs_handle == NULL)
     {
         ERROR("Failed to open Mailbox Client");
         return -EIO;
     }
-    fcs_handle = fcs_descriptor->session_map[fcs_descriptor->session_count].
-            crypto_handle;
-    if (fcs_handle == NULL)
+    ret = mbox_set_ctx_callback(fcs_handle, fcs_callback);
+    if (ret == 0)
     {
-        return -EINVAL;
+        ret = mbox_set_window(fcs_handle, (uint8_t)FCS_MBOX_WINDOW);
     }
-    ret = mbox_set_callback(fcs_handle, fcs_callback);
     if (ret != 0)
     {
         ERROR("Failed to allocate memory");
+        (void)mbox_close_client(fcs_handle);
+        fcs_descriptor->session_map[i].crypto_handle = NULL;
         return -ENOMEM;
     }
 
     DEBUG("Open_session: No args");
-    ret = sip_svc_send(fcs_handle, FCS_OPEN_SESSION, NULL, 0, open_session_resp,
-            sizeof(open_session_resp));
+    req = fcs_request_get();
+    ret = sip_svc_send_ctx(fcs_handle, FCS_OPEN_SESSION, NULL, 0,
+            open_session_resp, sizeof(open_session_resp), req);
     if (ret == 0)
     {
-        if (osal_semaphore_wait(fcs_descriptor->fcs_sem,
+        if (osal_semaphore_wait(req->done,
                 OSAL_TIMEOUT_WAIT_FOREVER) == true)
         {
             DEBUG("SIP_SVC response x1: %lx, x2: %lx", open_session_resp[0],
@@ -307,32 +504,34 @@ int run_fcs_open_service_session(char *uuid)
                 session_id = (uint32_t)open_session_resp[FCS_RESP_SIZE];
                 fcs_descriptor->session_map[i].session_id = session_id;
                 INFO("Generating UUID");
-                generate_uuid(fcs_handle, session_id, uuid);
-                if (uuid == NULL)
-                {
-                    ERROR("Failed to generate UUID");
-                    return -EIO;
-                }
+                generate_uuid(req, fcs_handle, session_id, uuid);
                 /* UUID v4 formatting */
                 uuid[6] = (char)(((uint8_t)uuid[6] & 0x0FU) | 0x40U);
                 uuid[8] = (char)(((uint8_t)uuid[8] & 0x3FU) | 0x80U);
                 (void)memcpy(fcs_descriptor->session_map[i].uuid, uuid,
                         FCS_UUID_SIZE);
+                (void)osal_mutex_lock(fcs_descriptor->session_lock,
+                        OSAL_TIMEOUT_WAIT_FOREVER);
                 fcs_descriptor->session_count++;
+                (void)osal_mutex_unlock(fcs_descriptor->session_lock);
             }
             status = (uint16_t)(open_session_resp[FCS_RESP_STATUS] &
                     FCS_STATUS_MASK);
-            return (int)status;
+            ret = (int)status;
         }
     }
-    else
+    fcs_request_put(req);
+    if (fcs_descriptor->session_map[i].session_id == 0U)
     {
+        /* No session on this client, give the slot back */
         (void)mbox_close_client(fcs_handle);
+        fcs_descriptor->session_map[i].crypto_handle = NULL;
     }
     return ret;
 }
 int run_fcs_close_service_session(char *uuid)
 {
+    fcs_request_t *req;
     int ret, i;
     uint16_t status;
     uint64_t close_session_arg, resp_err = 0UL;
@@ -347,12 +546,13 @@ int run_fcs_close_service_session(char *uuid)
     }
     close_session_arg = session_id;
     DEBUG("Close_session: session_id: %lu", close_session_arg);
-    ret = sip_svc_send(fcs_handle, FCS_CLOSE_SESSION, &close_session_arg,
-            sizeof(close_session_arg), &resp_err, sizeof(resp_err));
+    req = fcs_request_get();
+    ret = sip_svc_send_ctx(fcs_handle, FCS_CLOSE_SESSION, &close_session_arg,
+            sizeof(close_session_arg), &resp_err, sizeof(resp_err), req);
 
     if (ret == 0)
     {
-        if (osal_semaphore_wait(fcs_descriptor->fcs_sem,
+        if (osal_semaphore_wait(req->done,
                 OSAL_TIMEOUT_WAIT_FOREVER) == true)
         {
             DEBUG("SIP_SVC response: x1: %lx", resp_err);
@@ -366,8 +566,11 @@ int run_fcs_close_service_session(char *uuid)
                 else
                 {
                     ERROR("Failed to close client");
+                    fcs_request_put(req);
                     return ret;
                 }
+                (void)osal_mutex_lock(fcs_descriptor->session_lock,
+                        OSAL_TIMEOUT_WAIT_FOREVER);
                 for (i = 0; i < (int)FCS_MAX_INSTANCES; i++)
                 {
                     if (fcs_descriptor->session_map[i].session_id == session_id)
@@ -378,17 +581,20 @@ int run_fcs_close_service_session(char *uuid)
                         fcs_descriptor->session_count--;
                     }
                 }
+                (void)osal_mutex_unlock(fcs_descriptor->session_lock);
             }
             status = (uint16_t)resp_err;
-            return (int)status;
+            ret = (int)status;
         }
     }
+    fcs_request_put(req);
     return ret;
 }
 
 int run_fcs_random_number_ext(char *rand_buf, char *uuid,
         uint32_t context_id, uint32_t rand_size)
 {
+    fcs_request_t *req;
     sdm_client_handle fcs_handle;
     uint64_t rng_args[4], rng_resp[2] =
     {
@@ -416,39 +622,42 @@ int run_fcs_random_number_ext(char *rand_buf, char *uuid,
     }
     rng_args[0] = session_id;
     rng_args[1] = context_id;
-    rng_args[2] = (uint64_t)fcs_out_ops_buffer;
+    req = fcs_request_get();
+    rng_args[2] = (uint64_t)req->out;
     rng_args[3] = (uint64_t)rand_size + (uint64_t)extra_data;
-    cache_force_invalidate(fcs_out_ops_buffer, rand_size +
+    cache_force_invalidate(req->out, rand_size +
             FCS_RESP_HEADER_SIZE);
 
     DEBUG("Random_number_ext: rand_size: %lu", rand_size + extra_data);
-    ret = sip_svc_send(fcs_handle, FCS_RANDOM_NUMBER, rng_args,
-            sizeof(rng_args), rng_resp, sizeof(rng_resp));
+    ret = sip_svc_send_ctx(fcs_handle, FCS_RANDOM_NUMBER, rng_args,
+            sizeof(rng_args), rng_resp, sizeof(rng_resp), req);
     if (ret == 0)
     {
-        if (osal_semaphore_wait(fcs_descriptor->fcs_sem,
+        if (osal_semaphore_wait(req->done,
                 OSAL_TIMEOUT_WAIT_FOREVER) == true)
         {
             DEBUG("SIP_SVC response x1: %lx, x2: %lx", rng_resp[0],
                     rng_resp[1]);
             if (rng_resp[FCS_RESP_STATUS] == 0UL)
             {
-                cache_force_invalidate(fcs_out_ops_buffer, rand_size +
+                cache_force_invalidate(req->out, rand_size +
                         FCS_RESP_HEADER_SIZE);
                 status = (uint16_t)rng_resp[FCS_RESP_STATUS];
                 ret = (int)status;
                 /* We dont copy the extra data */
                 (void)memcpy((void *)rand_buf,
-                        (void *)&fcs_out_ops_buffer[FCS_RESP_DATA], rand_size);
+                        (void *)&req->out[FCS_RESP_DATA], rand_size);
             }
         }
     }
+    fcs_request_put(req);
     return ret;
 }
 
 int run_fcs_import_service_key(char *uuid, char *key,
         uint32_t key_size, char *status, unsigned int *status_size)
 {
+    fcs_request_t *req;
     sdm_client_handle fcs_handle;
     uint64_t import_key_args[2], import_key_resp[2] =
     {
@@ -470,26 +679,28 @@ int run_fcs_import_service_key(char *uuid, char *key,
     {
         return -EINVAL;
     }
-    (void)memset(fcs_inp_ops_buffer, 0, ((size_t)key_size +
+    req = fcs_request_get();
+    (void)memset(req->inp, 0, ((size_t)key_size +
             FCS_KEY_HEADER_SIZE));
 
-    fcs_inp_ops_buffer[0] = session_id;
+    req->inp[0] = session_id;
     /* The mailbox requires 8 bytes reserved after session id */
-    (void)memcpy((void *)&fcs_inp_ops_buffer[3], (void *)key, key_size);
+    (void)memcpy((void *)&req->inp[3], (void *)key, key_size);
 
-    import_key_args[0] = (uint64_t)fcs_inp_ops_buffer;
+    import_key_args[0] = (uint64_t)req->inp;
     import_key_args[1] = (uint64_t)key_size + FCS_KEY_HEADER_SIZE;
-    cache_force_write_back((void *)fcs_inp_ops_buffer, ((size_t)key_size +
+    cache_force_write_back((void *)req->inp, ((size_t)key_size +
             FCS_KEY_HEADER_SIZE));
 
     DEBUG("Import_service_key: key_buffer: %lx, key_size: %lu", (uint64_t)key,
             key_size);
-    ret = sip_svc_send(fcs_handle, FCS_IMPORT_SERVICE_KEY, import_key_args,
-            sizeof(import_key_args), import_key_resp, sizeof(import_key_resp));
+    ret = sip_svc_send_ctx(fcs_handle, FCS_IMPORT_SERVICE_KEY, import_key_args,
+            sizeof(import_key_args), import_key_resp, sizeof(import_key_resp),
+            req);
 
     if (ret == 0)
     {
-        if (osal_semaphore_wait(fcs_descriptor->fcs_sem,
+        if (osal_semaphore_wait(req->done,
                 OSAL_TIMEOUT_WAIT_FOREVER) == true)
         {
             DEBUG("SIP_SVC response x1: %lx, x2: %lx", import_key_resp[0],
@@ -502,12 +713,14 @@ int run_fcs_import_service_key(char *uuid, char *key,
             ret = (int)resp_stat;
         }
     }
+    fcs_request_put(req);
     return ret;
 }
 
 int run_fcs_export_service_key(char *uuid, uint32_t key_id,
         char *key_dest, unsigned int *key_size)
 {
+    fcs_request_t *req;
     sdm_client_handle fcs_handle;
     uint32_t session_id = 0U, *key_data;
     uint64_t export_key_args[4], export_key_resp[2] =
@@ -529,40 +742,44 @@ int run_fcs_export_service_key(char *uuid, uint32_t key_id,
     }
     export_key_args[0] = session_id;
     export_key_args[1] = key_id;
-    export_key_args[2] = (uint64_t)fcs_out_ops_buffer;
+    req = fcs_request_get();
+    export_key_args[2] = (uint64_t)req->out;
     export_key_args[3] = *key_size;
-    cache_force_invalidate(fcs_out_ops_buffer, FCS_EXPORT_KEY_MAX_SIZE);
+    cache_force_invalidate(req->out, FCS_EXPORT_KEY_MAX_SIZE);
 
     DEBUG("Export_service_key: key_id: %lu", key_id);
-    ret = sip_svc_send(fcs_handle, FCS_EXPORT_SERVICE_KEY, export_key_args,
-            sizeof(export_key_args), export_key_resp, sizeof(export_key_resp));
+    ret = sip_svc_send_ctx(fcs_handle, FCS_EXPORT_SERVICE_KEY, export_key_args,
+            sizeof(export_key_args), export_key_resp, sizeof(export_key_resp),
+            req);
 
     if (ret == 0)
     {
-        if (osal_semaphore_wait(fcs_descriptor->fcs_sem,
+        if (osal_semaphore_wait(req->done,
                 OSAL_TIMEOUT_WAIT_FOREVER) == true)
         {
             DEBUG("SIP_SVC response x1: %lx, x2: %lx", export_key_resp[0],
                     export_key_resp[1]);
             if (export_key_resp[FCS_RESP_STATUS] == 0UL)
             {
-                cache_force_invalidate((void *)fcs_out_ops_buffer,
+                cache_force_invalidate((void *)req->out,
                         (size_t)export_key_resp[FCS_RESP_SIZE]);
                 /* Ignoring the key status word of size 4 at the
                  * beginning of the response */
                 *key_size = (uint32_t)export_key_resp[FCS_RESP_SIZE] -
                         MBOX_WORD_SIZE;
-                (void)memcpy((void *)key_dest, (void *)&fcs_out_ops_buffer[1],
+                (void)memcpy((void *)key_dest, (void *)&req->out[1],
                         *key_size);
             }
             status = (uint16_t)export_key_resp[FCS_RESP_STATUS];
             ret = (int)status;
         }
     }
+    fcs_request_put(req);
     return ret;
 }
 int run_fcs_remove_service_key(char *uuid, uint32_t key_id)
 {
+    fcs_request_t *req;
     sdm_client_handle fcs_handle;
     uint64_t remove_key_args[2], remove_key_resp[2] =
     {
@@ -582,12 +799,14 @@ int run_fcs_remove_service_key(char *uuid, uint32_t key_id)
     remove_key_args[1] = key_id;
 
     DEBUG("Remove_service_key: key_id: %lu", key_id);
-    ret = sip_svc_send(fcs_handle, FCS_REMOVE_SERVICE_KEY, remove_key_args,
-            sizeof(remove_key_args), remove_key_resp, sizeof(remove_key_resp));
+    req = fcs_request_get();
+    ret = sip_svc_send_ctx(fcs_handle, FCS_REMOVE_SERVICE_KEY, remove_key_args,
+            sizeof(remove_key_args), remove_key_resp, sizeof(remove_key_resp),
+            req);
 
     if (ret == 0)
     {
-        if (osal_semaphore_wait(fcs_descriptor->fcs_sem,
+        if (osal_semaphore_wait(req->done,
                 OSAL_TIMEOUT_WAIT_FOREVER) == true)
         {
             DEBUG("SIP_SVC response x1: %lx, x2: %lx", remove_key_resp[0],
@@ -597,11 +816,13 @@ int run_fcs_remove_service_key(char *uuid, uint32_t key_id)
         }
     }
 
+    fcs_request_put(req);
     return ret;
 }
 int run_fcs_get_service_key_info(char *uuid, uint32_t key_id,
         char *key_info, unsigned int *key_info_size)
 {
+    fcs_request_t *req;
     sdm_client_handle fcs_handle;
     uint64_t get_key_info_args[4], get_key_info_resp[2] =
     {
@@ -629,13 +850,14 @@ int run_fcs_get_service_key_info(char *uuid, uint32_t key_id,
     cache_force_write_back(key_info, FCS_KEY_INFO_MAX_RESP);
 
     DEBUG("Get_service_key_info: key_id: %lu", key_id);
-    ret = sip_svc_send(fcs_handle, FCS_GET_SERVICE_KEY_INFO, get_key_info_args,
-            sizeof(get_key_info_args), get_key_info_resp,
-            sizeof(get_key_info_resp));
+    req = fcs_request_get();
+    ret = sip_svc_send_ctx(fcs_handle, FCS_GET_SERVICE_KEY_INFO,
+            get_key_info_args, sizeof(get_key_info_args), get_key_info_resp,
+            sizeof(get_key_info_resp), req);
 
     if (ret == 0)
     {
-        if (osal_semaphore_wait(fcs_descriptor->fcs_sem,
+        if (osal_semaphore_wait(req->done,
                 OSAL_TIMEOUT_WAIT_FOREVER) == true)
         {
             DEBUG("SIP_SVC response x1: %lx, x2: %lx", get_key_info_resp[0],
@@ -647,14 +869,16 @@ int run_fcs_get_service_key_info(char *uuid, uint32_t key_id,
             }
             status = (uint16_t)(get_key_info_resp[FCS_RESP_STATUS] &
                     FCS_STATUS_MASK);
-            return (int)status;
+            ret = (int)status;
         }
     }
+    fcs_request_put(req);
     return ret;
 }
 int run_fcs_create_service_key(char *uuid, char *key,
         uint32_t key_size, char *status, unsigned int *status_size)
 {
+    fcs_request_t *req;
     sdm_client_handle fcs_handle;
     uint64_t create_key_args[2], create_key_resp[2] =
     {
@@ -679,25 +903,27 @@ int run_fcs_create_service_key(char *uuid, char *key,
         ERROR("Key size exceeds maximum limit");
         return -EINVAL;
     }
-    (void)memset(fcs_inp_ops_buffer, 0, ((size_t)key_size +
+    req = fcs_request_get();
+    (void)memset(req->inp, 0, ((size_t)key_size +
             FCS_KEY_HEADER_SIZE));
-    fcs_inp_ops_buffer[0] = session_id;
+    req->inp[0] = session_id;
     /* The mailbox requires 8 bytes reserved after session id */
-    (void)memcpy((void *)&fcs_inp_ops_buffer[3], (void *)key, key_size);
+    (void)memcpy((void *)&req->inp[3], (void *)key, key_size);
 
-    create_key_args[0] = (uint64_t)fcs_inp_ops_buffer;
+    create_key_args[0] = (uint64_t)req->inp;
     create_key_args[1] = ((uint64_t)key_size + FCS_KEY_HEADER_SIZE);
-    cache_force_write_back((void *)fcs_inp_ops_buffer, ((size_t)key_size +
+    cache_force_write_back((void *)req->inp, ((size_t)key_size +
             FCS_KEY_HEADER_SIZE));
 
     DEBUG("Create_service_key: key_buffer: %lx, key_size: %lu", (uint64_t)key,
             key_size);
-    ret = sip_svc_send(fcs_handle, FCS_CREATE_SERVICE_KEY, create_key_args,
-            sizeof(create_key_args), create_key_resp, sizeof(create_key_resp));
+    ret = sip_svc_send_ctx(fcs_handle, FCS_CREATE_SERVICE_KEY, create_key_args,
+            sizeof(create_key_args), create_key_resp, sizeof(create_key_resp),
+            req);
 
     if (ret == 0)
     {
-        if (osal_semaphore_wait(fcs_descriptor->fcs_sem,
+        if (osal_semaphore_wait(req->done,
                 OSAL_TIMEOUT_WAIT_FOREVER) == true)
         {
             DEBUG("SIP_SVC response x1: %lx, x2: %lx", create_key_resp[0],
@@ -708,15 +934,17 @@ int run_fcs_create_service_key(char *uuid, char *key,
                     *status_size);
             resp_stat = (uint16_t)(create_key_resp[FCS_RESP_STATUS] &
                     FCS_STATUS_MASK);
-            return (int)resp_stat;
+            ret = (int)resp_stat;
         }
     }
+    fcs_request_put(req);
     return ret;
 }
 
 int run_fcs_service_get_provision_data(char *prov_data,
         uint32_t *prov_data_size)
 {
+    fcs_request_t *req;
     int ret;
     uint16_t status;
     uint64_t prov_data_arg, prov_data_resp[2] =
@@ -737,13 +965,14 @@ int run_fcs_service_get_provision_data(char *prov_data,
 
     prov_data_arg = (uint64_t)prov_data;
     DEBUG("Get_provision_data: prov_data_buffer: %x", (uint32_t)prov_data);
-    ret = sip_svc_send(fcs_descriptor->security_handle, FCS_GET_PROVISION_DATA,
-            &prov_data_arg, sizeof(prov_data_arg), prov_data_resp,
-            sizeof(prov_data_resp));
+    req = fcs_request_get();
+    ret = sip_svc_send_ctx(fcs_descriptor->security_handle,
+            FCS_GET_PROVISION_DATA, &prov_data_arg, sizeof(prov_data_arg),
+            prov_data_resp, sizeof(prov_data_resp), req);
 
     if (ret == 0)
     {
-        if (osal_semaphore_wait(fcs_descriptor->fcs_sem,
+        if (osal_semaphore_wait(req->done,
                 OSAL_TIMEOUT_WAIT_FOREVER) == true)
         {
             DEBUG("SIP_SVC response x1: %lx, x2: %lx", prov_data_resp[0],
@@ -757,11 +986,13 @@ int run_fcs_service_get_provision_data(char *prov_data,
             ret = (int)status;
         }
     }
+    fcs_request_put(req);
     return ret;
 }
 int run_fcs_send_certificate(char *cert_data, uint32_t cert_size,
         uint32_t *status)
 {
+    fcs_request_t *req;
     uint64_t send_cert_args[3], send_cert_resp[2] =
     {
         0
@@ -769,29 +1000,36 @@ int run_fcs_send_certificate(char *cert_data, uint32_t cert_size,
     int ret;
     uint16_t resp_stat;
 
-    /* First 4 bytes are for test word(reserved in our case as its provided
-     * in the certificate) */
-    (void)memset(fcs_inp_ops_buffer, 0, cert_size + sizeof(uint32_t));
-    (void)memcpy((void *)&fcs_inp_ops_buffer[1], (void *)cert_data, cert_size);
     if (fcs_descriptor->security_handle == NULL)
     {
         ERROR("Security driver not initialised");
         return -EIO;
     }
+    if ((cert_size + sizeof(uint32_t)) > FCS_REQ_BUF_SIZE)
+    {
+        ERROR("Certificate too large");
+        return -EINVAL;
+    }
 
-    send_cert_args[0] = (uint64_t)fcs_inp_ops_buffer;
+    req = fcs_request_get();
+    /* First 4 bytes are for test word(reserved in our case as its provided
+     * in the certificate) */
+    (void)memset(req->inp, 0, cert_size + sizeof(uint32_t));
+    (void)memcpy((void *)&req->inp[1], (void *)cert_data, cert_size);
+
+    send_cert_args[0] = (uint64_t)req->inp;
     send_cert_args[1] = (uint64_t)cert_size + sizeof(uint32_t);
-    cache_force_write_back(fcs_inp_ops_buffer, cert_size + sizeof(uint32_t));
+    cache_force_write_back(req->inp, cert_size + sizeof(uint32_t));
 
     DEBUG("Send_certificate: cert_buffer: %lx, cert_size: %lu",
             (uint64_t)cert_data, cert_size);
-    ret = sip_svc_send(fcs_descriptor->security_handle, FCS_SEND_CERTIFICATE,
-            send_cert_args, sizeof(send_cert_args), send_cert_resp,
-            sizeof(send_cert_resp));
+    ret = sip_svc_send_ctx(fcs_descriptor->security_handle,
+            FCS_SEND_CERTIFICATE, send_cert_args, sizeof(send_cert_args),
+            send_cert_resp, sizeof(send_cert_resp), req);
 
     if (ret == 0)
     {
-        if (osal_semaphore_wait(fcs_descriptor->fcs_sem,
+        if (osal_semaphore_wait(req->done,
                 OSAL_TIMEOUT_WAIT_FOREVER) == true)
         {
             DEBUG("SIP_SVC response x1: %lx, x2: %lx", send_cert_resp[0],
@@ -804,14 +1042,16 @@ int run_fcs_send_certificate(char *cert_data, uint32_t cert_size,
             }
             resp_stat = (uint16_t)(send_cert_resp[FCS_RESP_STATUS] &
                     FCS_STATUS_MASK);
-            return (int)resp_stat;
+            ret = (int)resp_stat;
         }
     }
+    fcs_request_put(req);
     return ret;
 }
 int run_fcs_service_counter_set_preauthorized(uint8_t type, uint32_t value,
         uint32_t test)
 {
+    fcs_request_t *req;
     uint64_t cntr_set_preauth_args[3], cntr_set_preauth_err =
     {
         0
@@ -830,20 +1070,23 @@ int run_fcs_service_counter_set_preauthorized(uint8_t type, uint32_t value,
 
     DEBUG("Counter_set_preauthorized: type: %lu, value: %lu, test: %lu", type,
             value, test);
-    ret = sip_svc_send(fcs_descriptor->security_handle, FCS_CNTR_SET_PREAUTH,
-            cntr_set_preauth_args, sizeof(cntr_set_preauth_args),
-            &cntr_set_preauth_err, sizeof(cntr_set_preauth_err));
+    req = fcs_request_get();
+    ret = sip_svc_send_ctx(fcs_descriptor->security_handle,
+            FCS_CNTR_SET_PREAUTH, cntr_set_preauth_args,
+            sizeof(cntr_set_preauth_args), &cntr_set_preauth_err,
+            sizeof(cntr_set_preauth_err), req);
 
     if (ret == 0)
     {
-        if (osal_semaphore_wait(fcs_descriptor->fcs_sem,
+        if (osal_semaphore_wait(req->done,
                 OSAL_TIMEOUT_WAIT_FOREVER) == true)
         {
             DEBUG("SIP_SVC response x1: %lx", cntr_set_preauth_err);
             status = (uint16_t)(cntr_set_preauth_err & FCS_STATUS_MASK);
-            return (int)status;
+            ret = (int)status;
         }
     }
+    fcs_request_put(req);
     return ret;
 }
 
@@ -894,10 +1137,9 @@ static int run_fcs_get_digest_init(char *uuid,
             sizeof(fcs_digest_init_args), NULL, 0);
 }
 
-static int run_fcs_get_digest_update(char *uuid, uint32_t context_id,
-        char *src_data, uint32_t src_size,
-        char *digest_data, uint32_t *digest_size,
-        uint8_t final)
+static int run_fcs_get_digest_update(fcs_request_t *req, char *uuid,
+        uint32_t context_id, char *src_data, uint32_t src_size,
+        char *digest_data, uint32_t *digest_size, uint8_t final)
 {
     int ret;
     uint16_t status;
@@ -923,31 +1165,33 @@ static int run_fcs_get_digest_update(char *uuid, uint32_t context_id,
      */
     fcs_digest_update_args[2] = (uint64_t)src_data;
     fcs_digest_update_args[3] = src_size;
-    fcs_digest_update_args[4] = (uint64_t)fcs_out_ops_buffer;
+    fcs_digest_update_args[4] = (uint64_t)req->out;
     fcs_digest_update_args[5] = FCS_DIGEST_MAX_RESP;
     fcs_digest_update_args[6] = (uint64_t)FCS_SMMU_GET_ADDR(src_data);
-    cache_force_invalidate(fcs_out_ops_buffer, FCS_DIGEST_MAX_RESP);
+    cache_force_invalidate(req->out, FCS_DIGEST_MAX_RESP);
     cache_force_write_back(src_data, src_size);
 
     if (final == FCS_FINALIZE)
     {
         DEBUG("Get_digest_finalize: src_addrr: %x, src_size: %lu",
                 (uint64_t)src_data, src_size);
-        ret = sip_svc_send(fcs_handle, FCS_GET_DIGEST_FINALIZE,
+        ret = sip_svc_send_ctx(fcs_handle, FCS_GET_DIGEST_FINALIZE,
                 fcs_digest_update_args, sizeof(fcs_digest_update_args),
-                fcs_digest_update_smc_resp, sizeof(fcs_digest_update_smc_resp));
+                fcs_digest_update_smc_resp, sizeof(fcs_digest_update_smc_resp),
+                req);
     }
     else
     {
         DEBUG("Get_digest_update: src_addrr: %x, src_size: %lu",
                 (uint64_t)src_data, src_size);
-        ret = sip_svc_send(fcs_handle, FCS_GET_DIGEST_UPDATE,
+        ret = sip_svc_send_ctx(fcs_handle, FCS_GET_DIGEST_UPDATE,
                 fcs_digest_update_args, sizeof(fcs_digest_update_args),
-                fcs_digest_update_smc_resp, sizeof(fcs_digest_update_smc_resp));
+                fcs_digest_update_smc_resp, sizeof(fcs_digest_update_smc_resp),
+                req);
     }
     if (ret == 0)
     {
-        if (osal_semaphore_wait(fcs_descriptor->fcs_sem,
+        if (osal_semaphore_wait(req->done,
                 OSAL_TIMEOUT_WAIT_FOREVER) == true)
         {
             DEBUG("SIP_SVC response x1: %lx, x2: %lx",
@@ -957,7 +1201,7 @@ static int run_fcs_get_digest_update(char *uuid, uint32_t context_id,
             if ((fcs_digest_update_smc_resp[FCS_RESP_STATUS] == 0UL) &&
                     (final == FCS_FINALIZE))
             {
-                cache_force_invalidate((void *)fcs_out_ops_buffer,
+                cache_force_invalidate((void *)req->out,
                         (size_t)fcs_digest_update_smc_resp[FCS_RESP_SIZE]);
                 /* Ignore the FCS response header in the response,
                  * copy only the required data */
@@ -965,7 +1209,7 @@ static int run_fcs_get_digest_update(char *uuid, uint32_t context_id,
                         (uint32_t)fcs_digest_update_smc_resp[FCS_RESP_SIZE] -
                         FCS_RESP_HEADER_SIZE;
                 (void)memcpy((void *)digest_data,
-                        (void *)&fcs_out_ops_buffer[FCS_RESP_DATA],
+                        (void *)&req->out[FCS_RESP_DATA],
                         *digest_size);
             }
             status = (uint16_t)fcs_digest_update_smc_resp[FCS_RESP_STATUS];
@@ -979,6 +1223,7 @@ int run_fcs_get_digest(char *uuid, uint32_t context_id,
         char *src_data, uint32_t src_size, char *digest_data,
         uint32_t *digest_size)
 {
+    fcs_request_t *req;
     int ret;
     uint32_t session_id = 0U, remaining_data = src_size, data_written;
     sdm_client_handle fcs_handle;
@@ -1013,19 +1258,20 @@ int run_fcs_get_digest(char *uuid, uint32_t context_id,
         return ret;
     }
 
+    req = fcs_request_get();
     while (remaining_data > 0U)
     {
         if (remaining_data > FCS_CRYPTO_BLOCK_SIZE)
         {
             data_written = FCS_CRYPTO_BLOCK_SIZE;
-            ret = run_fcs_get_digest_update(uuid, context_id, src_data,
+            ret = run_fcs_get_digest_update(req, uuid, context_id, src_data,
                     FCS_CRYPTO_BLOCK_SIZE, digest_data, digest_size,
                     FCS_UPDATE);
         }
         else
         {
             data_written = remaining_data;
-            ret = run_fcs_get_digest_update(uuid, context_id, src_data,
+            ret = run_fcs_get_digest_update(req, uuid, context_id, src_data,
                     remaining_data, digest_data, digest_size, FCS_FINALIZE);
         }
         if (ret == 0)
@@ -1036,9 +1282,10 @@ int run_fcs_get_digest(char *uuid, uint32_t context_id,
         else
         {
             ERROR("GET_DIGEST failed");
-            return ret;
+            break;
         }
     }
+    fcs_request_put(req);
     return ret;
 }
 static int run_fcs_mac_verify_init(char *uuid, uint32_t context_id,
@@ -1066,10 +1313,9 @@ static int run_fcs_mac_verify_init(char *uuid, uint32_t context_id,
             fcs_mac_verify_init_args, sizeof(fcs_mac_verify_init_args), NULL,
             0);
 }
-static int run_fcs_mac_verify_update(char *uuid, uint32_t context_id,
-        char *src_addr, uint32_t src_size,
-        char *mac_data, uint32_t mac_data_size,
-        char *dest_data, uint32_t *dest_size,
+static int run_fcs_mac_verify_update(fcs_request_t *req, char *uuid,
+        uint32_t context_id, char *src_addr, uint32_t src_size, char *mac_data,
+        uint32_t mac_data_size, char *dest_data, uint32_t *dest_size,
         uint8_t final)
 {
     (void)mac_data;
@@ -1093,46 +1339,46 @@ static int run_fcs_mac_verify_update(char *uuid, uint32_t context_id,
     fcs_mac_verify_args[1] = context_id;
     fcs_mac_verify_args[2] = (uint64_t)src_addr;
     fcs_mac_verify_args[3] = (uint64_t)src_size + (uint64_t)mac_data_size;
-    fcs_mac_verify_args[4] = (uint64_t)fcs_out_ops_buffer;
+    fcs_mac_verify_args[4] = (uint64_t)req->out;
     fcs_mac_verify_args[5] = FCS_MAC_VERIFY_RESP;
     fcs_mac_verify_args[6] = src_size;
     fcs_mac_verify_args[7] = (uint64_t)FCS_SMMU_GET_ADDR(src_addr);
 
     cache_force_write_back(src_addr, src_size + mac_data_size);
-    cache_force_invalidate(fcs_out_ops_buffer, FCS_MAC_VERIFY_RESP);
+    cache_force_invalidate(req->out, FCS_MAC_VERIFY_RESP);
 
     if (final == FCS_UPDATE)
     {
         DEBUG("Mac_verify_update: src_addr: %lx, src_size: %lu, "
                 "mac_data_size: %lu", (uint64_t)src_addr, src_size,
                 mac_data_size);
-        ret = sip_svc_send(fcs_handle, FCS_MAC_VERIFY_UPDATE,
+        ret = sip_svc_send_ctx(fcs_handle, FCS_MAC_VERIFY_UPDATE,
                 fcs_mac_verify_args, sizeof(fcs_mac_verify_args),
-                mac_verify_smc_resp, sizeof(mac_verify_smc_resp));
+                mac_verify_smc_resp, sizeof(mac_verify_smc_resp), req);
     }
     else
     {
         DEBUG("Mac_verify_finalize: src_addr: %lx, src_size: %lu, "
                 "mac_data_size: %lu", (uint64_t)src_addr, src_size,
                 mac_data_size);
-        ret = sip_svc_send(fcs_handle, FCS_MAC_VERIFY_FINALIZE,
+        ret = sip_svc_send_ctx(fcs_handle, FCS_MAC_VERIFY_FINALIZE,
                 fcs_mac_verify_args, sizeof(fcs_mac_verify_args),
-                mac_verify_smc_resp, sizeof(mac_verify_smc_resp));
+                mac_verify_smc_resp, sizeof(mac_verify_smc_resp), req);
     }
     if (ret == 0)
     {
-        if (osal_semaphore_wait(fcs_descriptor->fcs_sem,
+        if (osal_semaphore_wait(req->done,
                 OSAL_TIMEOUT_WAIT_FOREVER) == true)
         {
             DEBUG("SIP_SVC response x1: %lx, x2: %lx", mac_verify_smc_resp[0],
                     mac_verify_smc_resp[1]);
             if (mac_verify_smc_resp[FCS_RESP_STATUS] == 0UL)
             {
-                cache_flush((void *)fcs_out_ops_buffer,
+                cache_flush((void *)req->out,
                         (size_t)mac_verify_smc_resp[FCS_RESP_SIZE]);
                 *dest_size = (uint32_t)mac_verify_smc_resp[FCS_RESP_SIZE];
                 (void)memcpy((void *)dest_data,
-                        (void *)&fcs_out_ops_buffer[FCS_RESP_DATA], *dest_size);
+                        (void *)&req->out[FCS_RESP_DATA], *dest_size);
             }
         }
         status = (uint16_t)mac_verify_smc_resp[FCS_RESP_STATUS];
@@ -1145,6 +1391,7 @@ int run_fcs_mac_verify(char *uuid, uint32_t context_id,
         uint32_t src_size, char *dest_data, uint32_t *dest_size,
         uint32_t user_data_size)
 {
+    fcs_request_t *req;
     uint32_t session_id = 0U, remaining_data = src_size, data_written,
             mac_size;
     int ret;
@@ -1185,6 +1432,7 @@ int run_fcs_mac_verify(char *uuid, uint32_t context_id,
     }
     mac_data = src_data + user_data_size;
     mac_size = src_size - user_data_size;
+    req = fcs_request_get();
     while (remaining_data > 0U)
     {
         if (remaining_data > FCS_CRYPTO_BLOCK_SIZE)
@@ -1193,7 +1441,7 @@ int run_fcs_mac_verify(char *uuid, uint32_t context_id,
             if ((remaining_data - FCS_CRYPTO_BLOCK_SIZE) >= (8U + mac_size))
             {
                 data_written = FCS_CRYPTO_BLOCK_SIZE;
-                ret = run_fcs_mac_verify_update(uuid, context_id, src_data,
+                ret = run_fcs_mac_verify_update(req, uuid, context_id, src_data,
                         data_written, mac_data, 0U, dest_data, dest_size,
                         FCS_UPDATE);
 
@@ -1201,7 +1449,7 @@ int run_fcs_mac_verify(char *uuid, uint32_t context_id,
             else
             {
                 data_written = remaining_data - (8U + mac_size);
-                ret = run_fcs_mac_verify_update(uuid, context_id, src_data,
+                ret = run_fcs_mac_verify_update(req, uuid, context_id, src_data,
                         data_written, mac_data, 0U, dest_data, dest_size,
                         FCS_UPDATE);
             }
@@ -1209,7 +1457,7 @@ int run_fcs_mac_verify(char *uuid, uint32_t context_id,
         else
         {
             data_written = remaining_data;
-            ret = run_fcs_mac_verify_update(uuid, context_id, src_data,
+            ret = run_fcs_mac_verify_update(req, uuid, context_id, src_data,
                     remaining_data - mac_size, mac_data, mac_size, dest_data,
                     dest_size, FCS_FINALIZE);
         }
@@ -1221,9 +1469,10 @@ int run_fcs_mac_verify(char *uuid, uint32_t context_id,
         else
         {
             ERROR("mac_verify failed");
-            return ret;
+            break;
         }
     }
+    fcs_request_put(req);
     return ret;
 }
 
@@ -1231,6 +1480,7 @@ int run_fcs_sdos_encrypt(char *uuid, uint32_t context_id,
         char *src_data, uint32_t src_size, char *resp_data,
         uint32_t *resp_size)
 {
+    fcs_request_t *req;
     int ret;
     uint16_t status;
     sdm_client_handle fcs_handle;
@@ -1275,12 +1525,14 @@ int run_fcs_sdos_encrypt(char *uuid, uint32_t context_id,
 
     DEBUG("Sdos_encrypt: src_addr: %lx, src_size: %lu, resp_addr: %lx",
             (uint64_t)src_data, src_size, (uint64_t)resp_data);
-    ret = sip_svc_send(fcs_handle, FCS_SDOS_CRYPTION, sdos_encrypt_args,
-            sizeof(sdos_encrypt_args), sdos_smc_resp, sizeof(sdos_smc_resp));
+    req = fcs_request_get();
+    ret = sip_svc_send_ctx(fcs_handle, FCS_SDOS_CRYPTION, sdos_encrypt_args,
+            sizeof(sdos_encrypt_args), sdos_smc_resp, sizeof(sdos_smc_resp),
+            req);
 
     if (ret == 0)
     {
-        if (osal_semaphore_wait(fcs_descriptor->fcs_sem,
+        if (osal_semaphore_wait(req->done,
                 OSAL_TIMEOUT_WAIT_FOREVER) == true)
         {
             DEBUG("SIP_SVC response x1: %lx, x2: %lx", sdos_smc_resp[0],
@@ -1294,6 +1546,7 @@ int run_fcs_sdos_encrypt(char *uuid, uint32_t context_id,
             ret = (int)status;
         }
     }
+    fcs_request_put(req);
     return ret;
 }
 
@@ -1301,6 +1554,7 @@ int run_fcs_sdos_decrypt(char *uuid, uint32_t context_id,
         char *src_data, uint32_t src_size, char *resp_data,
         uint32_t *resp_size, uint64_t owner_flag)
 {
+    fcs_request_t *req;
     int ret;
     uint16_t status;
     sdm_client_handle fcs_handle;
@@ -1345,12 +1599,14 @@ int run_fcs_sdos_decrypt(char *uuid, uint32_t context_id,
             "Sdos_decrypt: owner_flag: %d, src_addr: %lx, src_size: %lu, resp_addr: %lx",
             owner_flag, (uint64_t)src_data, src_size, (uint64_t)resp_data,
             *resp_size);
-    ret = sip_svc_send(fcs_handle, FCS_SDOS_CRYPTION, sdos_decrypt_args,
-            sizeof(sdos_decrypt_args), sdos_smc_resp, sizeof(sdos_smc_resp));
+    req = fcs_request_get();
+    ret = sip_svc_send_ctx(fcs_handle, FCS_SDOS_CRYPTION, sdos_decrypt_args,
+            sizeof(sdos_decrypt_args), sdos_smc_resp, sizeof(sdos_smc_resp),
+            req);
 
     if (ret == 0)
     {
-        if (osal_semaphore_wait(fcs_descriptor->fcs_sem,
+        if (osal_semaphore_wait(req->done,
                 OSAL_TIMEOUT_WAIT_FOREVER) == true)
         {
             DEBUG("SIP_SVC response x1: %lx, x2: %lx", sdos_smc_resp[0],
@@ -1364,6 +1620,7 @@ int run_fcs_sdos_decrypt(char *uuid, uint32_t context_id,
             ret = (int)status;
         }
     }
+    fcs_request_put(req);
     return ret;
 }
 
@@ -1371,6 +1628,7 @@ int run_fcs_hkdf_request(char *uuid, uint32_t key_id,
         uint32_t step_type, uint32_t mac_mode, char *input_buffer,
         uint32_t output_key_size, uint32_t *hkdf_status)
 {
+    fcs_request_t *req;
     int ret;
     uint16_t status;
     sdm_client_handle fcs_handle;
@@ -1415,12 +1673,13 @@ int run_fcs_hkdf_request(char *uuid, uint32_t key_id,
     DEBUG("HKDF_request: key_id: %lu, step_type: %lu, "
             "mac_mode: %lu, input_buffer: %lx, output_key_size: %lu", key_id,
             step_type, mac_mode, (uint64_t)input_buffer, output_key_size);
-    ret = sip_svc_send(fcs_handle, FCS_HKDF_REQUEST, hkdf_args,
-            sizeof(hkdf_args), hkdf_resp, sizeof(hkdf_resp));
+    req = fcs_request_get();
+    ret = sip_svc_send_ctx(fcs_handle, FCS_HKDF_REQUEST, hkdf_args,
+            sizeof(hkdf_args), hkdf_resp, sizeof(hkdf_resp), req);
 
     if (ret == 0)
     {
-        if (osal_semaphore_wait(fcs_descriptor->fcs_sem,
+        if (osal_semaphore_wait(req->done,
                 OSAL_TIMEOUT_WAIT_FOREVER) == true)
         {
             DEBUG("SIP_SVC response x1: %lx, x2: %lx", hkdf_resp[0],
@@ -1431,16 +1690,18 @@ int run_fcs_hkdf_request(char *uuid, uint32_t key_id,
                         FCS_STATUS_MASK);
                 *hkdf_status = (uint32_t)(hkdf_resp[FCS_RESP_KEY_STATUS] &
                         FCS_STATUS_MASK);
-                return (int)status;
+                ret = (int)status;
             }
         }
     }
+    fcs_request_put(req);
     return ret;
 }
 
 int run_fcs_get_chip_id(uint32_t *chip_low,
         uint32_t *chip_high)
 {
+    fcs_request_t *req;
     uint64_t get_chip_id_resp[FCS_RESP_DATA] =
     {
         0
@@ -1454,12 +1715,13 @@ int run_fcs_get_chip_id(uint32_t *chip_low,
     }
 
     DEBUG("Get_chip_id: No args");
-    ret = sip_svc_send(fcs_descriptor->security_handle, FCS_GET_CHIP_ID, NULL,
-            0, get_chip_id_resp, sizeof(get_chip_id_resp));
+    req = fcs_request_get();
+    ret = sip_svc_send_ctx(fcs_descriptor->security_handle, FCS_GET_CHIP_ID,
+            NULL, 0, get_chip_id_resp, sizeof(get_chip_id_resp), req);
 
     if (ret == 0)
     {
-        if (osal_semaphore_wait(fcs_descriptor->fcs_sem,
+        if (osal_semaphore_wait(req->done,
                 OSAL_TIMEOUT_WAIT_FOREVER) == true)
         {
             DEBUG("SIP_SVC response x0: %lx, x1: %lx, x2: %lx",
@@ -1472,15 +1734,17 @@ int run_fcs_get_chip_id(uint32_t *chip_low,
             }
             status = (uint16_t)(get_chip_id_resp[FCS_RESP_STATUS] &
                     FCS_STATUS_MASK);
-            return (int)status;
+            ret = (int)status;
         }
     }
+    fcs_request_put(req);
     return ret;
 }
 
 int run_fcs_attestation_get_certificate(int cert_req, char *cert_data,
         uint32_t *cert_size)
 {
+    fcs_request_t *req;
     uint64_t get_attestation_cert_args[3], get_attestation_cert_resp[2] =
     {
         0
@@ -1505,14 +1769,15 @@ int run_fcs_attestation_get_certificate(int cert_req, char *cert_data,
 
     DEBUG("Get_attestation_certificate: cert_req: %d, "
             "cert_data: %lx", cert_req, (uint64_t)cert_data);
-    ret = sip_svc_send(fcs_descriptor->security_handle,
+    req = fcs_request_get();
+    ret = sip_svc_send_ctx(fcs_descriptor->security_handle,
             FCS_GET_ATTESTATION_CERT, get_attestation_cert_args,
             sizeof(get_attestation_cert_args), get_attestation_cert_resp,
-            sizeof(get_attestation_cert_resp));
+            sizeof(get_attestation_cert_resp), req);
 
     if (ret == 0)
     {
-        if (osal_semaphore_wait(fcs_descriptor->fcs_sem,
+        if (osal_semaphore_wait(req->done,
                 OSAL_TIMEOUT_WAIT_FOREVER) == true)
         {
             DEBUG("SIP_SVC response x1: %lx, x2: %lx",
@@ -1524,14 +1789,16 @@ int run_fcs_attestation_get_certificate(int cert_req, char *cert_data,
             }
             status = (uint16_t)(get_attestation_cert_resp[FCS_RESP_STATUS] &
                     FCS_STATUS_MASK);
-            return (int)status;
+            ret = (int)status;
         }
     }
+    fcs_request_put(req);
     return ret;
 }
 
 int run_fcs_attestation_certificate_reload(int cert_req)
 {
+    fcs_request_t *req;
     uint64_t cert_on_reload_args[3], cert_reload_err = 0UL;
     int ret;
     uint16_t status;
@@ -1543,27 +1810,30 @@ int run_fcs_attestation_certificate_reload(int cert_req)
     cert_on_reload_args[0] = (uint64_t)cert_req;
 
     DEBUG("Cert_on_reload: cert_req: %d", cert_req);
-    ret = sip_svc_send(fcs_descriptor->security_handle,
+    req = fcs_request_get();
+    ret = sip_svc_send_ctx(fcs_descriptor->security_handle,
             FCS_CREATE_CERT_ON_RELOAD, cert_on_reload_args,
             sizeof(cert_on_reload_args), &cert_reload_err,
-            sizeof(cert_reload_err));
+            sizeof(cert_reload_err), req);
     if (ret == 0)
     {
-        if (osal_semaphore_wait(fcs_descriptor->fcs_sem,
+        if (osal_semaphore_wait(req->done,
                 OSAL_TIMEOUT_WAIT_FOREVER) == true)
         {
             DEBUG("SIP_SVC response x1: %lx", cert_reload_err);
             status = (uint16_t)cert_reload_err;
-            return (int)status;
+            ret = (int)status;
         }
     }
 
+    fcs_request_put(req);
     return ret;
 }
 
 int run_fcs_mctp_cmd_send(char *src_data, uint32_t src_size, char *resp_data,
         uint32_t *resp_size)
 {
+    fcs_request_t *req;
     uint64_t mctp_send_args[3], mctp_send_resp[2] =
     {
         0
@@ -1590,13 +1860,14 @@ int run_fcs_mctp_cmd_send(char *src_data, uint32_t src_size, char *resp_data,
 
     DEBUG("Mctp_send: src_data: %lx, src_size: %lu, resp_data: %lx",
             (uint64_t)src_data, src_size, (uint64_t)resp_data);
-    ret = sip_svc_send(fcs_descriptor->security_handle, FCS_MCTP_SEND_MSG,
+    req = fcs_request_get();
+    ret = sip_svc_send_ctx(fcs_descriptor->security_handle, FCS_MCTP_SEND_MSG,
             mctp_send_args, sizeof(mctp_send_args), mctp_send_resp,
-            sizeof(mctp_send_resp));
+            sizeof(mctp_send_resp), req);
 
     if (ret == 0)
     {
-        if (osal_semaphore_wait(fcs_descriptor->fcs_sem,
+        if (osal_semaphore_wait(req->done,
                 OSAL_TIMEOUT_WAIT_FOREVER) == true)
         {
             DEBUG("SIP_SVC response x1: %lx, x2: %lx", mctp_send_resp[0],
@@ -1608,14 +1879,16 @@ int run_fcs_mctp_cmd_send(char *src_data, uint32_t src_size, char *resp_data,
             }
             status = (uint16_t)(mctp_send_resp[FCS_RESP_STATUS] &
                     FCS_STATUS_MASK);
-            return (int)status;
+            ret = (int)status;
         }
     }
+    fcs_request_put(req);
     return ret;
 }
 
 int run_fcs_get_jtag_idcode(uint32_t *jtag_id_code)
 {
+    fcs_request_t *req;
     uint64_t get_idcode_resp[2] =
     {
         0
@@ -1629,11 +1902,12 @@ int run_fcs_get_jtag_idcode(uint32_t *jtag_id_code)
     }
 
     DEBUG("Get_jtag_idcode: No args");
-    ret = sip_svc_send(fcs_descriptor->security_handle, FCS_GET_IDCODE, NULL, 0,
-            get_idcode_resp, sizeof(get_idcode_resp));
+    req = fcs_request_get();
+    ret = sip_svc_send_ctx(fcs_descriptor->security_handle, FCS_GET_IDCODE,
+            NULL, 0, get_idcode_resp, sizeof(get_idcode_resp), req);
     if (ret == 0)
     {
-        if (osal_semaphore_wait(fcs_descriptor->fcs_sem,
+        if (osal_semaphore_wait(req->done,
                 OSAL_TIMEOUT_WAIT_FOREVER) == true)
         {
             DEBUG("SIP_SVC response x1: %lx, x2: %lx", get_idcode_resp[0],
@@ -1644,15 +1918,17 @@ int run_fcs_get_jtag_idcode(uint32_t *jtag_id_code)
             }
             status = (uint16_t)(get_idcode_resp[FCS_RESP_STATUS] &
                     FCS_STATUS_MASK);
-            return (int)status;
+            ret = (int)status;
         }
     }
 
+    fcs_request_put(req);
     return ret;
 }
 
 int run_fcs_get_device_identity(char *dev_identity, uint32_t *dev_id_size)
 {
+    fcs_request_t *req;
     uint64_t get_device_identity_args[1], get_device_identity_resp[2] =
     {
         0
@@ -1670,13 +1946,15 @@ int run_fcs_get_device_identity(char *dev_identity, uint32_t *dev_id_size)
 
     DEBUG("Get_device_identity: dev_identity_buffer: %lx",
             (uint64_t)dev_identity);
-    ret = sip_svc_send(fcs_descriptor->security_handle, FCS_GET_DEVICE_IDENTITY,
-            get_device_identity_args, sizeof(get_device_identity_args),
-            get_device_identity_resp, sizeof(get_device_identity_resp));
+    req = fcs_request_get();
+    ret = sip_svc_send_ctx(fcs_descriptor->security_handle,
+            FCS_GET_DEVICE_IDENTITY, get_device_identity_args,
+            sizeof(get_device_identity_args), get_device_identity_resp,
+            sizeof(get_device_identity_resp), req);
 
     if (ret == 0)
     {
-        if (osal_semaphore_wait(fcs_descriptor->fcs_sem,
+        if (osal_semaphore_wait(req->done,
                 OSAL_TIMEOUT_WAIT_FOREVER) == true)
         {
             DEBUG("SIP_SVC response x1: %lx, x2: %lx",
@@ -1689,9 +1967,10 @@ int run_fcs_get_device_identity(char *dev_identity, uint32_t *dev_id_size)
             }
             status = (uint16_t)(get_device_identity_resp[FCS_RESP_STATUS] &
                     FCS_STATUS_MASK);
-            return (int)status;
+            ret = (int)status;
         }
     }
+    fcs_request_put(req);
     return ret;
 }
 
@@ -1754,9 +2033,9 @@ static int fcs_aes_set_params(uint32_t block_mode, uint32_t crypt_mode,
     (void)memcpy((void *)&param_data[3], (void *)iv_data, FCS_AES_IV_SIZE);
     return 0;
 }
-static int run_fcs_aes_crypt_init(char *uuid, uint32_t context_id,
-        uint32_t key_id, uint32_t block_mode, uint32_t crypt_mode,
-        uint32_t iv_src, char *iv_data, uint32_t tag_size,
+static int run_fcs_aes_crypt_init(fcs_request_t *req, char *uuid,
+        uint32_t context_id, uint32_t key_id, uint32_t block_mode,
+        uint32_t crypt_mode, uint32_t iv_src, char *iv_data, uint32_t tag_size,
         uint32_t aad_size)
 {
     int ret;
@@ -1771,7 +2050,7 @@ static int run_fcs_aes_crypt_init(char *uuid, uint32_t context_id,
         return -EIO;
     }
     ret = fcs_aes_set_params(block_mode, crypt_mode, iv_src, iv_data, tag_size,
-            aad_size, fcs_inp_ops_buffer, &param_size);
+            aad_size, req->inp, &param_size);
     DEBUG("AES params: block_mode: %d, crypt_mode: %d, iv_src: %d, "
             "tag_size: %d, aad_size: %d", block_mode, crypt_mode, iv_src,
             tag_size, aad_size);
@@ -1780,12 +2059,12 @@ static int run_fcs_aes_crypt_init(char *uuid, uint32_t context_id,
         ERROR("Failed to set AES params");
         return -EINVAL;
     }
-    cache_force_write_back(fcs_inp_ops_buffer, param_size);
+    cache_force_write_back(req->inp, param_size);
 
     fcs_aes_init_args[0] = session_id;
     fcs_aes_init_args[1] = context_id;
     fcs_aes_init_args[2] = key_id;
-    fcs_aes_init_args[3] = (uint64_t)fcs_inp_ops_buffer;
+    fcs_aes_init_args[3] = (uint64_t)req->inp;
     fcs_aes_init_args[4] = param_size;
 
     ret = sip_svc_send(fcs_handle, FCS_AES_INIT, fcs_aes_init_args,
@@ -1793,14 +2072,17 @@ static int run_fcs_aes_crypt_init(char *uuid, uint32_t context_id,
 
     return ret;
 }
-static int run_fcs_aes_update(char *uuid, uint32_t context_id,
-        char *src_addr, uint32_t src_size, char *dest_addr,
-        uint32_t dest_size, uint32_t padding_size,
+/*
+ * @brief Send one AES update, no cache maintenance is done here
+ */
+static int fcs_aes_submit(fcs_request_t *req, char *uuid,
+        uint32_t context_id, const fcs_aes_seg_t *seg, uint32_t padding_size,
         uint8_t final)
 {
     int ret;
     uint16_t status;
     sdm_client_handle fcs_handle;
+    uint64_t src_sdm, dest_sdm;
     uint64_t fcs_aes_update_args[9], fcs_aes_update_resp[2] =
     {
         0
@@ -1812,71 +2094,267 @@ static int run_fcs_aes_update(char *uuid, uint32_t context_id,
         ERROR("Failed to locate client");
         return -EIO;
     }
-    cache_force_write_back(src_addr, src_size);
-    cache_force_invalidate(dest_addr, dest_size);
+    /* SMMU address is used by the mailbox */
+    if ((smmu_sdm_map(seg->src, seg->src_size, &src_sdm) != 0) ||
+            (smmu_sdm_map(seg->dest, seg->dest_size, &dest_sdm) != 0))
+    {
+        ERROR("AES buffer is outside the SDM address window");
+        return -EINVAL;
+    }
 
     fcs_aes_update_args[0] = session_id;
     fcs_aes_update_args[1] = context_id;
-    fcs_aes_update_args[2] = (uint64_t)(uintptr_t)src_addr;
-    fcs_aes_update_args[3] = src_size;
-    fcs_aes_update_args[4] = (uint64_t)(uintptr_t)dest_addr;
-    fcs_aes_update_args[5] = dest_size;
+    fcs_aes_update_args[2] = (uint64_t)(uintptr_t)seg->src;
+    fcs_aes_update_args[3] = seg->src_size;
+    fcs_aes_update_args[4] = (uint64_t)(uintptr_t)seg->dest;
+    fcs_aes_update_args[5] = seg->dest_size;
     fcs_aes_update_args[6] = padding_size;
-
-    /* SMMU address is used by the mailbox */
-    fcs_aes_update_args[7] = FCS_SMMU_GET_ADDR(src_addr);
-    fcs_aes_update_args[8] = FCS_SMMU_GET_ADDR(dest_addr);
+    fcs_aes_update_args[7] = src_sdm;
+    fcs_aes_update_args[8] = dest_sdm;
     if (final == FCS_UPDATE)
     {
         DEBUG("AES update: src_addr: %lx, src_size: %u, "
                 "dest_addr: %lx, dest_size: %u, padding_size: %u",
-                (uint64_t)src_addr, src_size, (uint64_t)dest_addr, dest_size,
-                padding_size);
-        ret = sip_svc_send(fcs_handle, FCS_AES_UPDATE, fcs_aes_update_args,
+                (uint64_t)seg->src, seg->src_size, (uint64_t)seg->dest,
+                seg->dest_size, padding_size);
+        ret = sip_svc_send_ctx(fcs_handle, FCS_AES_UPDATE, fcs_aes_update_args,
                 sizeof(fcs_aes_update_args), fcs_aes_update_resp,
-                sizeof(fcs_aes_update_resp));
+                sizeof(fcs_aes_update_resp), req);
     }
     else
     {
         DEBUG("AES finalize: src_addr: %lx, src_size: %u, "
                 "dest_addr: %lx, dest_size: %u, padding_size: %u",
-                (uint64_t)src_addr, src_size, (uint64_t)dest_addr, dest_size,
-                padding_size);
-        ret = sip_svc_send(fcs_handle, FCS_AES_FINALIZE, fcs_aes_update_args,
-                sizeof(fcs_aes_update_args), fcs_aes_update_resp,
-                sizeof(fcs_aes_update_resp));
+                (uint64_t)seg->src, seg->src_size, (uint64_t)seg->dest,
+                seg->dest_size, padding_size);
+        ret = sip_svc_send_ctx(fcs_handle, FCS_AES_FINALIZE,
+                fcs_aes_update_args, sizeof(fcs_aes_update_args),
+                fcs_aes_update_resp, sizeof(fcs_aes_update_resp), req);
     }
     if (ret == 0)
     {
-        if (osal_semaphore_wait(fcs_descriptor->fcs_sem,
+        if (osal_semaphore_wait(req->done,
                 OSAL_TIMEOUT_WAIT_FOREVER) == true)
         {
             DEBUG("SIP_SVC response x1: %lx, x2: %lx", fcs_aes_update_resp[0],
                     fcs_aes_update_resp[1]);
-            if (fcs_aes_update_resp[FCS_RESP_STATUS] == 0U)
-            {
-                cache_force_invalidate(dest_addr, dest_size);
-            }
             status = (uint16_t)(fcs_aes_update_resp[FCS_RESP_STATUS] &
                     FCS_STATUS_MASK);
-            return (int)status;
+            ret = (int)status;
         }
     }
 
     return ret;
 }
 
+static int run_fcs_aes_update(fcs_request_t *req, char *uuid,
+        uint32_t context_id, char *src_addr, uint32_t src_size, char *dest_addr,
+        uint32_t dest_size, uint32_t padding_size, uint8_t final)
+{
+    int ret;
+    fcs_aes_seg_t seg;
+
+    seg.src = src_addr;
+    seg.src_size = src_size;
+    seg.dest = dest_addr;
+    seg.dest_size = dest_size;
+    cache_force_write_back(src_addr, src_size);
+    cache_force_invalidate(dest_addr, dest_size);
+    ret = fcs_aes_submit(req, uuid, context_id, &seg, padding_size, final);
+    if (ret == 0)
+    {
+        cache_force_invalidate(dest_addr, dest_size);
+    }
+    return ret;
+}
+
+/*
+ * @brief Check if the caller buffers can be handed to the SDM as they are
+ */
+static bool fcs_aes_direct_ok(uint32_t block_mode, char *aad_data,
+        uint32_t aad_size, char *input_data, uint32_t input_size,
+        char *output_data)
+{
+    uint64_t sdm_addr;
+
+    if ((FCS_ZERO_COPY == 0) || (input_size < FCS_ZERO_COPY_MIN_SIZE))
+    {
+        return false;
+    }
+    if (smmu_sdm_map(input_data, input_size, &sdm_addr) != 0)
+    {
+        return false;
+    }
+    if (((block_mode == FCS_AES_GCM) || (block_mode == FCS_AES_GCM_GHASH)) &&
+            (smmu_sdm_map(aad_data, aad_size, &sdm_addr) != 0))
+    {
+        return false;
+    }
+    if (block_mode == FCS_AES_GCM_GHASH)
+    {
+        return true;
+    }
+    /*
+     * The output lines are invalidated after the SDM writes them, a first
+     * or last line shared with other data would lose the caller's
+     * neighbouring bytes
+     */
+    if ((((uintptr_t)output_data % FCS_CACHE_LINE_SIZE) != 0U) ||
+            ((((uintptr_t)output_data + input_size) % FCS_CACHE_LINE_SIZE) !=
+            0U))
+    {
+        return false;
+    }
+    return (smmu_sdm_map(output_data, input_size, &sdm_addr) == 0);
+}
+
+/*
+ * @brief Zero copy AES, the SDM reads and writes the caller buffers directly
+ *
+ * The request is described as a scatter list of at most four segments:
+ * the block aligned part of the AAD, the AAD tail with its padding, the
+ * block aligned part of the input and a final segment holding the input
+ * tail, its padding and the tag. Only the two short tails go through the
+ * request buffers, everything else is mapped through the SMMU.
+ */
+static int fcs_aes_cryption_direct(fcs_request_t *req, char *uuid,
+        uint32_t context_id, uint32_t crypt_mode, uint32_t block_mode,
+        uint32_t aad_size, char *aad_data, char *tag_data, char *input_data,
+        uint32_t input_size, char *output_data)
+{
+    fcs_aes_seg_t seg[FCS_AES_MAX_SEGS], part;
+    cache_range_t inp_ranges[3], out_ranges[2];
+    char *stage_aad = (char *)req->inp;
+    char *stage_tail = (char *)req->inp + FCS_CACHE_LINE_SIZE;
+    char *stage_out = (char *)req->out;
+    uint32_t block, aad_body = 0U, aad_tail = 0U, body, tail, padding,
+            input_tag = 0U, out_tag = 0U, n_seg = 0U, i, len, done;
+    bool gcm, ghash, last;
+    int ret = 0;
+
+    ghash = (block_mode == FCS_AES_GCM_GHASH);
+    gcm = ((block_mode == FCS_AES_GCM) || ghash);
+    block = gcm ? FCS_GCM_BLOCK_SIZE : FCS_NON_GCM_BLOCK_SIZE;
+    if (gcm)
+    {
+        aad_body = aad_size - (aad_size % FCS_GCM_BLOCK_SIZE);
+        aad_tail = aad_size - aad_body;
+        if (((crypt_mode == FCS_AES_DECRYPT_MODE) &&
+                (block_mode == FCS_AES_GCM)) || ghash)
+        {
+            input_tag = FCS_GCM_TAG_SIZE;
+        }
+        else
+        {
+            out_tag = FCS_GCM_TAG_SIZE;
+        }
+    }
+    /* the final segment always carries between 1 and block bytes */
+    body = ((input_size - 1U) / block) * block;
+    tail = input_size - body;
+    padding = (block - (tail % block)) % block;
+
+    if (aad_body != 0U)
+    {
+        seg[n_seg].src = aad_data;
+        seg[n_seg].src_size = aad_body;
+        seg[n_seg].dest = NULL;
+        seg[n_seg].dest_size = 0U;
+        n_seg++;
+    }
+    if (aad_tail != 0U)
+    {
+        (void)memcpy(stage_aad, aad_data + aad_body, aad_tail);
+        (void)memset(stage_aad + aad_tail, 0, FCS_GCM_BLOCK_SIZE - aad_tail);
+        seg[n_seg].src = stage_aad;
+        seg[n_seg].src_size = FCS_GCM_BLOCK_SIZE;
+        seg[n_seg].dest = NULL;
+        seg[n_seg].dest_size = 0U;
+        n_seg++;
+    }
+    if (body != 0U)
+    {
+        seg[n_seg].src = input_data;
+        seg[n_seg].src_size = body;
+        seg[n_seg].dest = ghash ? NULL : output_data;
+        seg[n_seg].dest_size = ghash ? 0U : body;
+        n_seg++;
+    }
+    (void)memcpy(stage_tail, input_data + body, tail);
+    (void)memset(stage_tail + tail, 0, padding);
+    (void)memcpy(stage_tail + tail + padding, tag_data, input_tag);
+    seg[n_seg].src = stage_tail;
+    seg[n_seg].src_size = tail + padding + input_tag;
+    seg[n_seg].dest = ghash ? NULL : stage_out;
+    seg[n_seg].dest_size = ghash ? 0U : (tail + padding + out_tag);
+    n_seg++;
+
+    /* one clean of every input and one flush of every output up front */
+    inp_ranges[0].addr = aad_data;
+    inp_ranges[0].size = aad_body;
+    inp_ranges[1].addr = req->inp;
+    inp_ranges[1].size = FCS_CACHE_LINE_SIZE + seg[n_seg - 1U].src_size;
+    inp_ranges[2].addr = input_data;
+    inp_ranges[2].size = body;
+    out_ranges[0].addr = ghash ? NULL : output_data;
+    out_ranges[0].size = ghash ? 0U : body;
+    out_ranges[1].addr = stage_out;
+    out_ranges[1].size = seg[n_seg - 1U].dest_size;
+    cache_range_list_op(CACHE_OP_CLEAN, inp_ranges, 3U);
+    cache_range_list_op(CACHE_OP_FLUSH, out_ranges, 2U);
+
+    for (i = 0U; (i < n_seg) && (ret == 0); i++)
+    {
+        done = 0U;
+        do
+        {
+            len = seg[i].src_size - done;
+            if (len > FCS_AES_MAX_UPDATE)
+            {
+                len = FCS_AES_MAX_UPDATE;
+            }
+            last = ((i == (n_seg - 1U)) && ((done + len) == seg[i].src_size));
+            part.src = seg[i].src + done;
+            part.src_size = len;
+            part.dest = (seg[i].dest == NULL) ? NULL : (seg[i].dest + done);
+            part.dest_size = (seg[i].dest == NULL) ? 0U :
+                    (last ? seg[i].dest_size : len);
+            ret = fcs_aes_submit(req, uuid, context_id, &part,
+                    last ? padding : 0U, last ? FCS_FINALIZE : FCS_UPDATE);
+            done += len;
+        } while ((ret == 0) && (done < seg[i].src_size));
+    }
+    if (ret != 0)
+    {
+        ERROR("AES_CRYPTION failed");
+        return ret;
+    }
+
+    cache_range_list_op(CACHE_OP_INVALIDATE, out_ranges, 2U);
+    if (!ghash)
+    {
+        (void)memcpy(output_data + body, stage_out, tail);
+        if (out_tag != 0U)
+        {
+            (void)memcpy(tag_data, stage_out + tail + padding, out_tag);
+        }
+    }
+    return 0;
+}
+
 int run_fcs_aes_cryption(char *uuid, uint32_t key_id,
         uint32_t context_id, uint32_t crypt_mode, uint32_t block_mode,
         uint32_t iv_src, char *iv_data, uint32_t tag_size,
         uint32_t aad_size, char *aad_data, char *tag_data, char *input_data,
         uint32_t input_size, char *output_data, uint32_t output_size)
 {
+    fcs_request_t *req;
     int ret;
     int finalized = 0;
     uint32_t session_id = 0U, data_rem, padding1,
-            padding2, aes_input_size, aes_output_size, input_tag = 0U;
-    char *aes_input_data, *aes_output_data, *temp = NULL;
+            padding2, aes_input_size, aes_output_size, input_tag = 0U,
+            input_rem, head, chunk, block;
+    char *aes_input_data, *aes_output_data;
     sdm_client_handle fcs_handle = get_client_handle(uuid, &session_id);
     if (fcs_handle == NULL)
     {
@@ -1926,11 +2404,28 @@ int run_fcs_aes_cryption(char *uuid, uint32_t key_id,
         aes_input_size += FCS_GCM_TAG_SIZE;
         input_tag = FCS_GCM_TAG_SIZE;
     }
-    ret = run_fcs_aes_crypt_init(uuid, context_id, key_id, block_mode,
+    /* The aad data has to go with the first update */
+    if ((aad_size + padding1) > FCS_REQ_BUF_SIZE)
+    {
+        ERROR("AAD data larger than the request buffer");
+        return -EINVAL;
+    }
+    req = fcs_request_get();
+    ret = run_fcs_aes_crypt_init(req, uuid, context_id, key_id, block_mode,
             crypt_mode, iv_src, iv_data, tag_size, aad_size);
     if (ret != 0)
     {
         ERROR("Failed to initialise AES sequence");
+        fcs_request_put(req);
+        return ret;
+    }
+    if (fcs_aes_direct_ok(block_mode, aad_data, aad_size, input_data,
+            input_size, output_data) == true)
+    {
+        ret = fcs_aes_cryption_direct(req, uuid, context_id, crypt_mode,
+                block_mode, aad_size, aad_data, tag_data, input_data,
+                input_size, output_data);
+        fcs_request_put(req);
         return ret;
     }
     /*
@@ -1940,134 +2435,555 @@ int run_fcs_aes_cryption(char *uuid, uint32_t key_id,
      */
 
     /* Setting initial data */
-    aes_input_data = (char *)fcs_inp_ops_buffer;
-    aes_output_data = (char *)fcs_out_ops_buffer;
+    aes_input_data = (char *)req->inp;
+    aes_output_data = (char *)req->out;
     (void)memcpy(aes_input_data, aad_data, aad_size);
     (void)memset(aes_input_data + aad_size, 0, padding1);
 
+    /*
+     * Updates before the last one carry whole blocks of input only, the
+     * input tail, padding2 and the tag all go with the final update.
+     * aes_input_data stays at the start of the request buffer, input_data
+     * and output_data move on by what each update consumed.
+     */
+    block = ((block_mode == FCS_AES_GCM) || (block_mode ==
+            FCS_AES_GCM_GHASH)) ? FCS_GCM_BLOCK_SIZE : FCS_NON_GCM_BLOCK_SIZE;
     data_rem = aes_input_size;
+    input_rem = input_size;
     while (data_rem > 0U)
     {
-        if (data_rem > FCS_CRYPTO_BLOCK_SIZE)
+        /* aad data and padding1 are 0 after the first update */
+        head = aad_size + padding1;
+        if (data_rem > FCS_REQ_BUF_SIZE)
         {
-            aes_input_size = FCS_CRYPTO_BLOCK_SIZE;
-            if (block_mode == FCS_AES_GCM_GHASH)
+            chunk = input_rem - (input_rem % block);
+            if (chunk > (FCS_REQ_BUF_SIZE - head))
             {
-                aes_output_size = 0;
+                chunk = FCS_REQ_BUF_SIZE - head;
             }
-            else
-            {
-                /*
-                 * padding1 and aad_size is 0 for non GCM modes so only
-                 * input size is taken
-                 */
-                aes_output_size = aes_input_size - (aad_size + padding1);
-            }
-            (void)memcpy(aes_input_data + aad_size + padding1, input_data,
-                    aes_input_size - (aad_size + padding1));
-            ret = run_fcs_aes_update(uuid, context_id, aes_input_data,
-                    aes_input_size, aes_output_data, aes_output_size, 0,
-                    FCS_UPDATE);
-            /* aad data and padding written to SDM if applicable */
-            aad_size = 0;
-            padding1 = 0;
+            aes_input_size = head + chunk;
+            aes_output_size = chunk;
+            (void)memcpy(aes_input_data + head, input_data, chunk);
+            ret = run_fcs_aes_update(req, uuid, context_id, aes_input_data,
+                    aes_input_size, aes_output_data,
+                    (block_mode == FCS_AES_GCM_GHASH) ? 0U : aes_output_size,
+                    0, FCS_UPDATE);
         }
         else
         {
-            if (((crypt_mode == FCS_AES_DECRYPT_MODE) && (block_mode ==
-                    FCS_AES_GCM)) || (block_mode == FCS_AES_GCM_GHASH))
-            {
-                if (data_rem > (FCS_CRYPTO_BLOCK_SIZE - FCS_GCM_TAG_SIZE))
-                {
-                    /* Sending all data except the tag data in last update*/
-                    aes_input_size = FCS_CRYPTO_BLOCK_SIZE - FCS_GCM_TAG_SIZE;
-                    if (block_mode == FCS_AES_GCM_GHASH)
-                    {
-                        aes_output_size = 0;
-                    }
-                    else
-                    {
-                        aes_output_size = FCS_CRYPTO_BLOCK_SIZE -
-                                (FCS_GCM_TAG_SIZE + aad_size + padding1);
-                    }
-                    (void)memcpy(aes_input_data + aad_size + padding1,
-                            input_data, aes_input_size - (aad_size + padding1));
-
-                    ret = run_fcs_aes_update(uuid, context_id, aes_input_data,
-                            aes_input_size, aes_output_data, aes_output_size,
-                            padding2, FCS_UPDATE);
-                    if (ret == 0)
-                    {
-                        data_rem -= aes_input_size;
-                        aes_input_data += aes_input_size;
-                        output_data += aes_output_size;
-                    }
-                    else
-                    {
-                        ERROR("AES_CRYPTION failed");
-                        break;
-                    }
-                }
-                /* If false, we just send all the data at once */
-            }
-            /* doesn't affect non GCM modes */
+            chunk = input_rem;
             aes_input_size = data_rem;
-            if (block_mode == FCS_AES_GCM_GHASH)
-            {
-                aes_output_size = 0;
-            }
-            else
-            {
-                aes_output_size = aes_input_size - (aad_size + padding1 +
-                        input_tag);
-            }
+            aes_output_size = chunk + padding2;
             if ((block_mode == FCS_AES_GCM) && (crypt_mode ==
                     FCS_AES_ENCRYPT_MODE))
             {
                 aes_output_size += FCS_GCM_TAG_SIZE;
             }
             finalized = 1;
-            /* Copy input data to the input buffer */
-            (void)memcpy(aes_input_data + aad_size + padding1, input_data,
-                    aes_input_size);
-            (void)memset(aes_input_data + aad_size + padding1 + input_size
-                    , 0, padding2);
-            /* Copying tag data */
-            (void)memcpy(
-                    aes_input_data + aad_size + padding1 + input_size +
-                    padding2, tag_data, input_tag);
-
-            ret = run_fcs_aes_update(uuid, context_id, aes_input_data,
-                    aes_input_size, aes_output_data, aes_output_size, padding2,
-                    FCS_FINALIZE);
+            /* Copy input data, padding2 and tag data to the input buffer */
+            (void)memcpy(aes_input_data + head, input_data, chunk);
+            (void)memset(aes_input_data + head + chunk, 0, padding2);
+            (void)memcpy(aes_input_data + head + chunk + padding2, tag_data,
+                    input_tag);
+
+            ret = run_fcs_aes_update(req, uuid, context_id, aes_input_data,
+                    aes_input_size, aes_output_data,
+                    (block_mode == FCS_AES_GCM_GHASH) ? 0U : aes_output_size,
+                    padding2, FCS_FINALIZE);
         }
         if (ret == 0)
         {
+            if (block_mode != FCS_AES_GCM_GHASH)
+            {
+                /* Only the real input bytes are returned, not the padding */
+                (void)memcpy(output_data, aes_output_data, chunk);
+            }
             if ((block_mode == FCS_AES_GCM) && (crypt_mode ==
                     FCS_AES_ENCRYPT_MODE) && (finalized == 1))
             {
                 /* GCM mode, tag is appended to output data */
-                (void)memcpy(output_data, aes_output_data, aes_output_size -
+                (void)memcpy(tag_data, aes_output_data + chunk + padding2,
                         FCS_GCM_TAG_SIZE);
-                (void)memcpy(tag_data, aes_output_data + aes_output_size -
-                        FCS_GCM_TAG_SIZE, FCS_GCM_TAG_SIZE);
-            }
-            else
-            {
-                (void)memcpy(output_data, aes_output_data, aes_output_size);
             }
             /* Increment the block */
             data_rem -= aes_input_size;
-            output_data += aes_output_size;
+            input_rem -= chunk;
+            input_data += chunk;
+            output_data += chunk;
+            aad_size = 0;
+            padding1 = 0;
         }
         else
         {
             ERROR("AES_CRYPTION failed");
             break;
         }
-        memset(fcs_inp_ops_buffer, 0, sizeof(fcs_inp_ops_buffer));
+        memset(req->inp, 0, FCS_REQ_BUF_SIZE);
     }
-    aes_input_data = temp;
+    fcs_request_put(req);
+    return ret;
+}
+
+/*
+ * @brief Claim a stream and its two requests
+ *
+ * Both requests are taken under stream_lock so that two streams can never
+ * end up holding one request each while waiting for their second.
+ */
+static struct fcs_stream_context *fcs_stream_get(void)
+{
+    struct fcs_stream_context *stream = NULL;
+    uint32_t i;
+
+    osal_enter_critical();
+    for (i = 0U; i < FCS_MAX_STREAMS; i++)
+    {
+        if (fcs_streams[i].in_use == false)
+        {
+            fcs_streams[i].in_use = true;
+            stream = &fcs_streams[i];
+            break;
+        }
+    }
+    osal_exit_critical();
+    if (stream == NULL)
+    {
+        return NULL;
+    }
+    (void)osal_mutex_lock(fcs_descriptor->stream_lock,
+            OSAL_TIMEOUT_WAIT_FOREVER);
+    stream->req[0] = fcs_request_get();
+    stream->req[1] = fcs_request_get();
+    (void)osal_mutex_unlock(fcs_descriptor->stream_lock);
+    stream->cur = 0U;
+    stream->error = 0;
+    for (i = 0U; i < 2U; i++)
+    {
+        stream->state[i] = FCS_STREAM_IDLE;
+        stream->status[i] = 0;
+        stream->dest[i] = NULL;
+        stream->dest_len[i] = 0U;
+        stream->out_len[i] = 0U;
+    }
+    return stream;
+}
+
+static void fcs_stream_put(struct fcs_stream_context *stream)
+{
+    fcs_request_put(stream->req[0]);
+    fcs_request_put(stream->req[1]);
+    stream->req[0] = NULL;
+    stream->req[1] = NULL;
+    osal_enter_critical();
+    stream->in_use = false;
+    osal_exit_critical();
+}
+
+/*
+ * @brief Wait for the chunk in a buffer to leave the SDM
+ */
+static int fcs_stream_wait(struct fcs_stream_context *stream, uint32_t idx)
+{
+    if (stream->state[idx] == FCS_STREAM_BUSY)
+    {
+        (void)osal_semaphore_wait(stream->req[idx]->done,
+                OSAL_TIMEOUT_WAIT_FOREVER);
+        stream->status[idx] = (int)(uint16_t)(
+            stream->resp[idx][FCS_RESP_STATUS] & FCS_STATUS_MASK);
+        stream->state[idx] = FCS_STREAM_DONE;
+    }
+    return (stream->state[idx] == FCS_STREAM_DONE) ? stream->status[idx] : 0;
+}
+
+/*
+ * @brief Copy out a completed chunk and report it
+ */
+static void fcs_stream_retire(struct fcs_stream_context *stream, uint32_t idx)
+{
+    fcs_request_t *req = stream->req[idx];
+
+    if (stream->state[idx] != FCS_STREAM_DONE)
+    {
+        return;
+    }
+    if ((stream->status[idx] == 0) && (stream->dest[idx] != NULL))
+    {
+        cache_force_invalidate(req->out, stream->out_len[idx]);
+        (void)memcpy(stream->dest[idx], req->out, stream->dest_len[idx]);
+    }
+    if (stream->callback != NULL)
+    {
+        stream->callback(stream->cb_context, stream->status[idx],
+                stream->dest[idx], stream->dest_len[idx]);
+    }
+    stream->state[idx] = FCS_STREAM_IDLE;
+}
+
+/*
+ * @brief Hand a staged chunk to the SDM without waiting for it
+ */
+static int fcs_stream_send(struct fcs_stream_context *stream, uint32_t idx,
+        char *src, uint32_t src_size, uint32_t padding, uint8_t final)
+{
+    fcs_request_t *req = stream->req[idx];
+    sdm_client_handle fcs_handle;
+    uint64_t args[9], src_sdm, dest_sdm;
+    uint32_t session_id = 0U, arg_len;
+    uint64_t func_id;
+
+    fcs_handle = get_client_handle(stream->uuid, &session_id);
+    if (fcs_handle == NULL)
+    {
+        ERROR("Failed to locate client");
+        return -EIO;
+    }
+    if ((smmu_sdm_map(src, src_size, &src_sdm) != 0) ||
+            (smmu_sdm_map(req->out, stream->out_len[idx], &dest_sdm) != 0))
+    {
+        ERROR("Stream buffer is outside the SDM address window");
+        return -EINVAL;
+    }
+    args[0] = session_id;
+    args[1] = stream->context_id;
+    args[2] = (uint64_t)(uintptr_t)src;
+    args[3] = src_size;
+    args[4] = (uint64_t)(uintptr_t)req->out;
+    args[5] = stream->out_len[idx];
+    if (stream->type == FCS_STREAM_AES)
+    {
+        args[6] = padding;
+        args[7] = src_sdm;
+        args[8] = dest_sdm;
+        arg_len = (uint32_t)sizeof(args);
+        func_id = (final == FCS_FINALIZE) ? FCS_AES_FINALIZE : FCS_AES_UPDATE;
+    }
+    else
+    {
+        args[6] = src_sdm;
+        arg_len = (uint32_t)(7U * sizeof(uint64_t));
+        func_id = (final == FCS_FINALIZE) ? FCS_GET_DIGEST_FINALIZE :
+                FCS_GET_DIGEST_UPDATE;
+    }
+    stream->resp[idx][0] = 0U;
+    stream->resp[idx][1] = 0U;
+    DEBUG("Stream chunk: src_addr: %lx, src_size: %u, final: %u",
+            (uint64_t)src, src_size, final);
+    return sip_svc_send_ctx(fcs_handle, func_id, args, arg_len,
+            stream->resp[idx], sizeof(stream->resp[idx]), req);
+}
+
+/*
+ * @brief Stage one chunk and keep the pipeline two deep
+ *
+ * The chunk is copied and cleaned while the previous one is still in the
+ * SDM. Only then is the previous chunk waited for, the new one sent, and
+ * the previous output copied out while the SDM works on the new one.
+ */
+static int fcs_stream_push(struct fcs_stream_context *stream, char *data,
+        uint32_t size, uint32_t padding, char *tail, uint32_t tail_size,
+        char *dest, uint32_t out_len, uint8_t final)
+{
+    uint32_t idx = stream->cur, prev = stream->cur ^ 1U;
+    fcs_request_t *req = stream->req[idx];
+    uint32_t in_len = size + padding + tail_size;
+    uint64_t sdm_addr;
+    char *src;
+    int ret;
+
+    if ((stream->type == FCS_STREAM_DIGEST) && (tail_size == 0U) &&
+            (smmu_sdm_map(data, size, &sdm_addr) == 0))
+    {
+        /* digests read the caller data in place */
+        src = data;
+    }
+    else
+    {
+        src = (char *)req->inp;
+        (void)memcpy(src, data, size);
+        (void)memset(src + size, 0, padding);
+        (void)memcpy(src + size + padding, tail, tail_size);
+    }
+    cache_force_write_back(src, in_len);
+    stream->dest[idx] = dest;
+    stream->dest_len[idx] = (dest == NULL) ? 0U : size;
+    stream->out_len[idx] = out_len;
+    if (out_len != 0U)
+    {
+        cache_force_invalidate(req->out, out_len);
+    }
+
+    ret = fcs_stream_wait(stream, prev);
+    if (ret == 0)
+    {
+        ret = fcs_stream_send(stream, idx, src, in_len, padding, final);
+        if (ret == 0)
+        {
+            stream->state[idx] = FCS_STREAM_BUSY;
+        }
+    }
+    fcs_stream_retire(stream, prev);
+    stream->cur = prev;
+    if (ret != 0)
+    {
+        ERROR("FCS stream chunk failed");
+        stream->error = ret;
+    }
+    return ret;
+}
+
+static uint32_t fcs_stream_chunk(uint32_t chunk_size)
+{
+    if (chunk_size == 0U)
+    {
+        chunk_size = FCS_STREAM_CHUNK_SIZE;
+    }
+    if (chunk_size > (FCS_REQ_BUF_SIZE - FCS_CACHE_LINE_SIZE))
+    {
+        chunk_size = FCS_REQ_BUF_SIZE - FCS_CACHE_LINE_SIZE;
+    }
+    /* a multiple of every block size, so chunk boundaries never split one */
+    return chunk_size - (chunk_size % FCS_NON_GCM_BLOCK_SIZE);
+}
+
+int fcs_stream_aes_init(fcs_stream_handle *handle, char *uuid,
+        uint32_t key_id, uint32_t context_id, uint32_t crypt_mode,
+        uint32_t block_mode, uint32_t iv_src, char *iv_data, uint32_t tag_size,
+        uint32_t aad_size, char *aad_data, uint32_t chunk_size,
+        fcs_stream_callback_t callback, void *cb_context)
+{
+    struct fcs_stream_context *stream;
+    uint32_t session_id = 0U, padding = 0U;
+    bool gcm;
+    int ret;
+
+    if ((handle == NULL) || (uuid == NULL) ||
+            (get_client_handle(uuid, &session_id) == NULL))
+    {
+        return -EINVAL;
+    }
+    gcm = ((block_mode == FCS_AES_GCM) || (block_mode == FCS_AES_GCM_GHASH));
+    if (gcm == false)
+    {
+        aad_size = 0U;
+    }
+    if ((aad_size != 0U) && (aad_data == NULL))
+    {
+        return -EINVAL;
+    }
+    stream = fcs_stream_get();
+    if (stream == NULL)
+    {
+        ERROR("No free FCS stream");
+        return -EBUSY;
+    }
+    stream->type = FCS_STREAM_AES;
+    stream->uuid = uuid;
+    stream->context_id = context_id;
+    stream->crypt_mode = crypt_mode;
+    stream->block_mode = block_mode;
+    stream->block_size = gcm ? FCS_GCM_BLOCK_SIZE : FCS_NON_GCM_BLOCK_SIZE;
+    stream->chunk_size = fcs_stream_chunk(chunk_size);
+    stream->callback = callback;
+    stream->cb_context = cb_context;
+
+    /*
+     * The parameters are staged in the second buffer, the first chunk only
+     * reuses it after the init has completed in the SDM
+     */
+    ret = run_fcs_aes_crypt_init(stream->req[1], uuid, context_id, key_id,
+            block_mode, crypt_mode, iv_src, iv_data, tag_size, aad_size);
+    if ((ret == 0) && (aad_size != 0U))
+    {
+        /* the AAD goes first, padded to a whole GCM block */
+        if ((aad_size % FCS_GCM_BLOCK_SIZE) != 0U)
+        {
+            padding = FCS_GCM_BLOCK_SIZE - (aad_size % FCS_GCM_BLOCK_SIZE);
+        }
+        ret = fcs_stream_push(stream, aad_data, aad_size, padding, NULL, 0U,
+                NULL, 0U, FCS_UPDATE);
+    }
+    if (ret != 0)
+    {
+        ERROR("Failed to initialise AES stream");
+        fcs_stream_put(stream);
+        return ret;
+    }
+    *handle = stream;
+    return 0;
+}
+
+int fcs_stream_digest_init(fcs_stream_handle *handle, char *uuid,
+        uint32_t context_id, uint32_t key_id, uint32_t op_mode,
+        uint32_t dig_size, uint32_t chunk_size,
+        fcs_stream_callback_t callback, void *cb_context)
+{
+    struct fcs_stream_context *stream;
+    int ret;
+
+    if ((handle == NULL) || (uuid == NULL))
+    {
+        return -EINVAL;
+    }
+    ret = run_fcs_get_digest_init(uuid, context_id, key_id, op_mode,
+            dig_size);
+    if (ret != 0)
+    {
+        ERROR("Failed to initialise digest stream");
+        return ret;
+    }
+    stream = fcs_stream_get();
+    if (stream == NULL)
+    {
+        ERROR("No free FCS stream");
+        return -EBUSY;
+    }
+    stream->type = FCS_STREAM_DIGEST;
+    stream->uuid = uuid;
+    stream->context_id = context_id;
+    stream->crypt_mode = 0U;
+    stream->block_mode = 0U;
+    stream->block_size = FCS_DIGEST_BLOCK_SIZE;
+    stream->chunk_size = fcs_stream_chunk(chunk_size);
+    stream->callback = callback;
+    stream->cb_context = cb_context;
+    *handle = stream;
+    return 0;
+}
+
+int fcs_stream_submit(fcs_stream_handle stream, char *data, uint32_t size,
+        char *out)
+{
+    uint32_t len;
+    bool has_out;
+    int ret = 0;
+
+    if ((stream == NULL) || (stream->in_use == false) || (data == NULL) ||
+            ((size % stream->block_size) != 0U))
+    {
+        return -EINVAL;
+    }
+    if (stream->error != 0)
+    {
+        return stream->error;
+    }
+    has_out = ((stream->type == FCS_STREAM_AES) &&
+            (stream->block_mode != FCS_AES_GCM_GHASH));
+    if (has_out && (out == NULL))
+    {
+        return -EINVAL;
+    }
+    while ((size > 0U) && (ret == 0))
+    {
+        len = (size > stream->chunk_size) ? stream->chunk_size : size;
+        if (has_out)
+        {
+            ret = fcs_stream_push(stream, data, len, 0U, NULL, 0U, out, len,
+                    FCS_UPDATE);
+            out += len;
+        }
+        else
+        {
+            ret = fcs_stream_push(stream, data, len, 0U, NULL, 0U, NULL,
+                    (stream->type == FCS_STREAM_DIGEST) ?
+                    (uint32_t)FCS_DIGEST_MAX_RESP : 0U, FCS_UPDATE);
+        }
+        data += len;
+        size -= len;
+    }
+    return ret;
+}
+
+int fcs_stream_finalize(fcs_stream_handle stream, char *data, uint32_t size,
+        char *out, char *tag_data, uint32_t *out_size)
+{
+    fcs_request_t *req;
+    uint32_t padding = 0U, in_tag = 0U, out_tag = 0U, out_len, last, i;
+    bool ghash;
+    int ret;
+
+    if ((stream == NULL) || (stream->in_use == false))
+    {
+        return -EINVAL;
+    }
+    ret = stream->error;
+    ghash = (stream->block_mode == FCS_AES_GCM_GHASH);
+    if ((ret == 0) && ((data == NULL) || (size == 0U) ||
+            (size > stream->chunk_size) ||
+            ((stream->type == FCS_STREAM_DIGEST) &&
+            (((size % FCS_DIGEST_BLOCK_SIZE) != 0U) || (out == NULL) ||
+            (out_size == NULL))) ||
+            ((stream->type == FCS_STREAM_AES) && (ghash == false) &&
+            (out == NULL))))
+    {
+        ret = -EINVAL;
+    }
+    if ((ret == 0) && (stream->type == FCS_STREAM_AES))
+    {
+        if ((size % stream->block_size) != 0U)
+        {
+            padding = stream->block_size - (size % stream->block_size);
+        }
+        if (((stream->crypt_mode == FCS_AES_DECRYPT_MODE) &&
+                (stream->block_mode == FCS_AES_GCM)) || ghash)
+        {
+            in_tag = FCS_GCM_TAG_SIZE;
+        }
+        else if (stream->block_mode == FCS_AES_GCM)
+        {
+            out_tag = FCS_GCM_TAG_SIZE;
+        }
+        if ((in_tag + out_tag) != 0U)
+        {
+            ret = (tag_data == NULL) ? -EINVAL : 0;
+        }
+        out_len = ghash ? 0U : (size + padding + out_tag);
+        if (ret == 0)
+        {
+            ret = fcs_stream_push(stream, data, size, padding, tag_data,
+                    in_tag, ghash ? NULL : out, out_len, FCS_FINALIZE);
+        }
+    }
+    else if (ret == 0)
+    {
+        ret = fcs_stream_push(stream, data, size, 0U, NULL, 0U, NULL,
+                FCS_DIGEST_MAX_RESP, FCS_FINALIZE);
+    }
+
+    /* drain, the final chunk is in the buffer before cur */
+    last = stream->cur ^ 1U;
+    for (i = 0U; i < 2U; i++)
+    {
+        if ((fcs_stream_wait(stream, i) != 0) && (ret == 0))
+        {
+            ret = stream->status[i];
+        }
+        fcs_stream_retire(stream, i);
+    }
+    if (ret == 0)
+    {
+        req = stream->req[last];
+        if (stream->type == FCS_STREAM_DIGEST)
+        {
+            cache_force_invalidate(req->out,
+                    (size_t)stream->resp[last][FCS_RESP_SIZE]);
+            *out_size = (uint32_t)stream->resp[last][FCS_RESP_SIZE] -
+                    FCS_RESP_HEADER_SIZE;
+            (void)memcpy(out, &req->out[FCS_RESP_DATA], *out_size);
+        }
+        else
+        {
+            if (out_tag != 0U)
+            {
+                (void)memcpy(tag_data, (char *)req->out + size + padding,
+                        out_tag);
+            }
+            if (out_size != NULL)
+            {
+                *out_size = ghash ? 0U : size;
+            }
+        }
+    }
+    fcs_stream_put(stream);
     return ret;
 }
 
@@ -2075,6 +2991,7 @@ int run_fcs_ecdsa_hash_sign(char *uuid, uint32_t context_id, uint32_t key_id,
         uint32_t ecc_algo, char *hash_data, uint32_t hash_data_size,
         char *signed_data, uint32_t *signed_data_size)
 {
+    fcs_request_t *req;
     int ret;
     uint16_t status;
     sdm_client_handle fcs_handle;
@@ -2110,44 +3027,46 @@ int run_fcs_ecdsa_hash_sign(char *uuid, uint32_t context_id, uint32_t key_id,
         return ret;
     }
     cache_force_write_back(hash_data, hash_data_size);
-    cache_force_invalidate(fcs_out_ops_buffer, FCS_ECDSA_HASH_SIGN_MAX_RESP);
+    req = fcs_request_get();
+    cache_force_invalidate(req->out, FCS_ECDSA_HASH_SIGN_MAX_RESP);
 
     fcs_hash_sign_args[0] = session_id;
     fcs_hash_sign_args[1] = context_id;
     fcs_hash_sign_args[2] = (uint64_t)hash_data;
     fcs_hash_sign_args[3] = hash_data_size;
-    fcs_hash_sign_args[4] = (uint64_t)fcs_out_ops_buffer;
+    fcs_hash_sign_args[4] = (uint64_t)req->out;
     fcs_hash_sign_args[5] = FCS_ECDSA_HASH_SIGN_MAX_RESP;
 
     DEBUG("Hash data sign finalize: Hash data: %lx, Hash data size: %u",
             hash_data, hash_data_size);
-    ret = sip_svc_send(fcs_handle, FCS_ECDSA_HASH_SIGN_FINALIZE,
+    ret = sip_svc_send_ctx(fcs_handle, FCS_ECDSA_HASH_SIGN_FINALIZE,
             fcs_hash_sign_args, sizeof(fcs_hash_sign_args), hash_sign_smc_resp,
-            sizeof(hash_sign_smc_resp));
+            sizeof(hash_sign_smc_resp), req);
 
     if (ret == 0)
     {
-        if (osal_semaphore_wait(fcs_descriptor->fcs_sem,
+        if (osal_semaphore_wait(req->done,
                 OSAL_TIMEOUT_WAIT_FOREVER) == true)
         {
             DEBUG("SIP_SVC response x1: %lx, x2: %lx", hash_sign_smc_resp[0],
                     hash_sign_smc_resp[1]);
             if (hash_sign_smc_resp[FCS_RESP_STATUS] == 0U)
             {
-                cache_force_invalidate((void *)fcs_out_ops_buffer,
+                cache_force_invalidate((void *)req->out,
                         (size_t)hash_sign_smc_resp[FCS_RESP_SIZE]);
                 /* Ignoring the FCS response header */
                 *signed_data_size =
                         (uint32_t)hash_sign_smc_resp[FCS_RESP_SIZE] -
                         FCS_RESP_HEADER_SIZE;
                 (void)memcpy((void *)signed_data,
-                        (void *)&fcs_out_ops_buffer[FCS_RESP_DATA],
+                        (void *)&req->out[FCS_RESP_DATA],
                         *signed_data_size);
             }
             status = (uint16_t)hash_sign_smc_resp[FCS_RESP_STATUS];
             ret = (int)status;
         }
     }
+    fcs_request_put(req);
     return ret;
 }
 int run_fcs_ecdsa_hash_verify(char *uuid, uint32_t context_id,
@@ -2156,6 +3075,7 @@ int run_fcs_ecdsa_hash_verify(char *uuid, uint32_t context_id,
         char *pub_key_data, uint32_t pub_key_size, char *dest_data,
         uint32_t *dest_size)
 {
+    fcs_request_t *req;
     int ret;
     uint16_t status;
     sdm_client_handle fcs_handle;
@@ -2196,24 +3116,25 @@ int run_fcs_ecdsa_hash_verify(char *uuid, uint32_t context_id,
         return ret;
     }
 
-    (void)memcpy(fcs_inp_ops_buffer, hash_data, hash_data_size);
-    (void)memcpy(fcs_inp_ops_buffer + (hash_data_size / sizeof(uint32_t)),
+    req = fcs_request_get();
+    (void)memcpy(req->inp, hash_data, hash_data_size);
+    (void)memcpy(req->inp + (hash_data_size / sizeof(uint32_t)),
             sig_data, sig_size);
     mbox_arg_size = hash_data_size + sig_size;
     if ((pub_key_data != NULL) && (pub_key_size != 0U))
     {
-        (void)memcpy(fcs_inp_ops_buffer + ((hash_data_size + sig_size) /
+        (void)memcpy(req->inp + ((hash_data_size + sig_size) /
                 sizeof(uint32_t)), pub_key_data, pub_key_size);
         mbox_arg_size += pub_key_size;
     }
-    cache_force_write_back(fcs_inp_ops_buffer, mbox_arg_size);
-    cache_force_invalidate(fcs_out_ops_buffer, FCS_ECDSA_HASH_VERIFY_RESP);
+    cache_force_write_back(req->inp, mbox_arg_size);
+    cache_force_invalidate(req->out, FCS_ECDSA_HASH_VERIFY_RESP);
 
     fcs_hash_sign_verify_args[0] = session_id;
     fcs_hash_sign_verify_args[1] = context_id;
-    fcs_hash_sign_verify_args[2] = (uint64_t)fcs_inp_ops_buffer;
+    fcs_hash_sign_verify_args[2] = (uint64_t)req->inp;
     fcs_hash_sign_verify_args[3] = mbox_arg_size;
-    fcs_hash_sign_verify_args[4] = (uint64_t)fcs_out_ops_buffer;
+    fcs_hash_sign_verify_args[4] = (uint64_t)req->out;
     fcs_hash_sign_verify_args[5] = FCS_ECDSA_HASH_VERIFY_RESP;
 
     DEBUG("Hash data sign verify finalize: Hash data: %lx, "
@@ -2222,32 +3143,33 @@ int run_fcs_ecdsa_hash_verify(char *uuid, uint32_t context_id,
             hash_data_size, (uint64_t)sig_data, sig_size,
             (uint64_t)pub_key_data, pub_key_size);
 
-    ret = sip_svc_send(fcs_handle, FCS_ECDSA_HASH_SIGN_VERIFY_FINALIZE,
+    ret = sip_svc_send_ctx(fcs_handle, FCS_ECDSA_HASH_SIGN_VERIFY_FINALIZE,
             fcs_hash_sign_verify_args, sizeof(fcs_hash_sign_verify_args),
-            hash_sign_verify_smc_resp, sizeof(hash_sign_verify_smc_resp));
+            hash_sign_verify_smc_resp, sizeof(hash_sign_verify_smc_resp), req);
 
     if (ret == 0)
     {
-        if (osal_semaphore_wait(fcs_descriptor->fcs_sem,
+        if (osal_semaphore_wait(req->done,
                 OSAL_TIMEOUT_WAIT_FOREVER) == true)
         {
             DEBUG("SIP_SVC response: x1: %lx, x2: %lx",
                     hash_sign_verify_smc_resp[0], hash_sign_verify_smc_resp[1]);
             if (hash_sign_verify_smc_resp[FCS_RESP_STATUS] == 0UL)
             {
-                cache_force_invalidate((void *)fcs_out_ops_buffer,
+                cache_force_invalidate((void *)req->out,
                         (size_t)hash_sign_verify_smc_resp[FCS_RESP_SIZE]);
                 /* Ignoring the FCS response header */
                 *dest_size =
                         (uint32_t)hash_sign_verify_smc_resp[FCS_RESP_SIZE] -
                         FCS_RESP_HEADER_SIZE;
                 (void)memcpy((void *)dest_data,
-                        (void *)&fcs_out_ops_buffer[FCS_RESP_DATA], *dest_size);
+                        (void *)&req->out[FCS_RESP_DATA], *dest_size);
             }
             status = (uint16_t)hash_sign_verify_smc_resp[FCS_RESP_STATUS];
             ret = (int)status;
         }
     }
+    fcs_request_put(req);
     return ret;
 }
 
@@ -2285,7 +3207,7 @@ static int run_fcs_ecdsa_sha2_data_sign_init(char *uuid,
     return ret;
 }
 
-static int run_fcs_ecdsa_sha2_data_sign_update(char *uuid,
+static int run_fcs_ecdsa_sha2_data_sign_update(fcs_request_t *req, char *uuid,
         uint32_t context_id, char *src_addr, uint32_t src_size,
         char *dest_data, uint32_t *dest_size, uint8_t final)
 {
@@ -2304,7 +3226,7 @@ static int run_fcs_ecdsa_sha2_data_sign_update(char *uuid,
         return -EIO;
     }
 
-    cache_force_invalidate(fcs_out_ops_buffer,
+    cache_force_invalidate(req->out,
             FCS_ECDSA_HASH_SHA2_SIGN_MAX_RESP);
     cache_force_write_back(src_addr, src_size);
 
@@ -2312,7 +3234,7 @@ static int run_fcs_ecdsa_sha2_data_sign_update(char *uuid,
     fcs_sha2_sign_args[1] = context_id;
     fcs_sha2_sign_args[2] = (uint64_t)src_addr;
     fcs_sha2_sign_args[3] = src_size;
-    fcs_sha2_sign_args[4] = (uint64_t)fcs_out_ops_buffer;
+    fcs_sha2_sign_args[4] = (uint64_t)req->out;
     fcs_sha2_sign_args[5] = FCS_ECDSA_HASH_SHA2_SIGN_MAX_RESP;
     fcs_sha2_sign_args[6] = FCS_SMMU_GET_ADDR(src_addr);
 
@@ -2320,21 +3242,21 @@ static int run_fcs_ecdsa_sha2_data_sign_update(char *uuid,
     {
         DEBUG("ECDSA SHA2 sign update: src_addr: %lx, "
                 "src_size: %u", (uint64_t)src_addr, src_size);
-        ret = sip_svc_send(fcs_handle, FCS_ECDSA_SHA2_SIGN_UPDATE,
+        ret = sip_svc_send_ctx(fcs_handle, FCS_ECDSA_SHA2_SIGN_UPDATE,
                 fcs_sha2_sign_args, sizeof(fcs_sha2_sign_args),
-                sha2_sign_smc_resp, sizeof(sha2_sign_smc_resp));
+                sha2_sign_smc_resp, sizeof(sha2_sign_smc_resp), req);
     }
     else
     {
         DEBUG("ECDSA SHA2 sign finalize: src_addr: %lx, "
                 "src_size: %u", (uint64_t)src_addr, src_size);
-        ret = sip_svc_send(fcs_handle, FCS_ECDSA_SHA2_SIGN_FINALIZE,
+        ret = sip_svc_send_ctx(fcs_handle, FCS_ECDSA_SHA2_SIGN_FINALIZE,
                 fcs_sha2_sign_args, sizeof(fcs_sha2_sign_args),
-                sha2_sign_smc_resp, sizeof(sha2_sign_smc_resp));
+                sha2_sign_smc_resp, sizeof(sha2_sign_smc_resp), req);
     }
     if (ret == 0)
     {
-        if (osal_semaphore_wait(fcs_descriptor->fcs_sem,
+        if (osal_semaphore_wait(req->done,
                 OSAL_TIMEOUT_WAIT_FOREVER) == true)
         {
             DEBUG("SIP_SVC response: x1: %lx, x2: %lx", sha2_sign_smc_resp[0],
@@ -2342,13 +3264,13 @@ static int run_fcs_ecdsa_sha2_data_sign_update(char *uuid,
             if ((sha2_sign_smc_resp[FCS_RESP_STATUS] == 0UL) && (final ==
                     FCS_FINALIZE))
             {
-                cache_force_invalidate((void *)fcs_out_ops_buffer,
+                cache_force_invalidate((void *)req->out,
                         (size_t)sha2_sign_smc_resp[FCS_RESP_SIZE]);
                 /* Ignoring the FCS response header */
                 *dest_size = (uint32_t)sha2_sign_smc_resp[FCS_RESP_SIZE] -
                         FCS_RESP_HEADER_SIZE;
                 (void)memcpy((void *)dest_data,
-                        (void *)&fcs_out_ops_buffer[FCS_RESP_DATA], *dest_size);
+                        (void *)&req->out[FCS_RESP_DATA], *dest_size);
             }
             status = (uint16_t)sha2_sign_smc_resp[FCS_RESP_STATUS];
             ret = (int)status;
@@ -2360,6 +3282,7 @@ int run_fcs_ecdsa_sha2_data_sign(char *uuid, uint32_t context_id,
         uint32_t key_id, uint32_t ecc_algo, char *src_data,
         uint32_t src_size, char *dest_data, uint32_t *dest_size)
 {
+    fcs_request_t *req;
     uint32_t session_id = 0U, remaining_data = src_size, data_written;
     int ret;
     sdm_client_handle fcs_handle = get_client_handle(uuid, &session_id);
@@ -2396,20 +3319,21 @@ int run_fcs_ecdsa_sha2_data_sign(char *uuid, uint32_t context_id,
         ERROR("Failed to initialise sha2_data_sign");
         return ret;
     }
+    req = fcs_request_get();
     while (remaining_data > 0U)
     {
         /* Splitting the data into a maximum block size of 4MB */
         if (remaining_data > FCS_CRYPTO_BLOCK_SIZE)
         {
             data_written = FCS_CRYPTO_BLOCK_SIZE;
-            ret = run_fcs_ecdsa_sha2_data_sign_update(uuid, context_id,
+            ret = run_fcs_ecdsa_sha2_data_sign_update(req, uuid, context_id,
                     src_data, FCS_CRYPTO_BLOCK_SIZE, dest_data, dest_size,
                     FCS_UPDATE);
         }
         else
         {
             data_written = remaining_data;
-            ret = run_fcs_ecdsa_sha2_data_sign_update(uuid, context_id,
+            ret = run_fcs_ecdsa_sha2_data_sign_update(req, uuid, context_id,
                     src_data, remaining_data, dest_data, dest_size,
                     FCS_FINALIZE);
         }
@@ -2420,9 +3344,10 @@ int run_fcs_ecdsa_sha2_data_sign(char *uuid, uint32_t context_id,
         }
         else
         {
-            return ret;
+            break;
         }
     }
+    fcs_request_put(req);
     return ret;
 }
 static int run_fcs_ecdsa_sha2_data_sign_verify_init(char *uuid,
@@ -2461,11 +3386,11 @@ static int run_fcs_ecdsa_sha2_data_sign_verify_init(char *uuid,
  * Signature data should be stored after the input data
  * If pubkey is provided, ensure its after the signature to be verified
  */
-static int run_fcs_ecdsa_sha2_data_sign_verify_update(char *uuid,
-        uint32_t context_id, char *src_addr, uint32_t src_size,
+static int run_fcs_ecdsa_sha2_data_sign_verify_update(fcs_request_t *req,
+        char *uuid, uint32_t context_id, char *src_addr, uint32_t src_size,
         char *signed_data, uint32_t sig_size, char *pub_key_data,
-        uint32_t pub_key_size, char *dest_data,
-        uint32_t *dest_size, uint8_t final)
+        uint32_t pub_key_size, char *dest_data, uint32_t *dest_size,
+        uint8_t final)
 {
     int ret;
     uint16_t status;
@@ -2484,28 +3409,28 @@ static int run_fcs_ecdsa_sha2_data_sign_verify_update(char *uuid,
         return -EIO;
     }
 
-    (void)memcpy(fcs_inp_ops_buffer, (char *)(uintptr_t)src_addr, src_size);
-    (void)memcpy(fcs_inp_ops_buffer + (src_size / sizeof(uint32_t)),
+    (void)memcpy(req->inp, (char *)(uintptr_t)src_addr, src_size);
+    (void)memcpy(req->inp + (src_size / sizeof(uint32_t)),
             signed_data, sig_size);
     payload_size = src_size + sig_size;
     if (pub_key_data != NULL)
     {
-        (void)memcpy(fcs_inp_ops_buffer + (payload_size /
+        (void)memcpy(req->inp + (payload_size /
                 sizeof(uint32_t)), pub_key_data, pub_key_size);
         payload_size += pub_key_size;
     }
-    cache_force_invalidate(fcs_out_ops_buffer, FCS_ECDSA_HASH_SHA2_VERIFY_RESP);
-    cache_force_write_back(fcs_inp_ops_buffer, payload_size);
+    cache_force_invalidate(req->out, FCS_ECDSA_HASH_SHA2_VERIFY_RESP);
+    cache_force_write_back(req->inp, payload_size);
 
     fcs_sha2_sign_verify_args[0] = session_id;
     fcs_sha2_sign_verify_args[1] = context_id;
-    fcs_sha2_sign_verify_args[2] = (uint64_t)fcs_inp_ops_buffer;
+    fcs_sha2_sign_verify_args[2] = (uint64_t)req->inp;
     fcs_sha2_sign_verify_args[3] = payload_size;
-    fcs_sha2_sign_verify_args[4] = (uint64_t)fcs_out_ops_buffer;
+    fcs_sha2_sign_verify_args[4] = (uint64_t)req->out;
     fcs_sha2_sign_verify_args[5] = FCS_ECDSA_HASH_SHA2_VERIFY_RESP;
     fcs_sha2_sign_verify_args[6] = src_size;
     fcs_sha2_sign_verify_args[7] = FCS_SMMU_GET_ADDR(
-            (uint64_t)fcs_inp_ops_buffer);
+            (uint64_t)req->inp);
 
     if (final == FCS_UPDATE)
     {
@@ -2518,19 +3443,21 @@ static int run_fcs_ecdsa_sha2_data_sign_verify_update(char *uuid,
                     (uint64_t)pub_key_data, pub_key_size);
         }
 
-        ret = sip_svc_send(fcs_handle, FCS_ECDSA_SHA2_SIGN_VERIFY_UPDATE,
+        ret = sip_svc_send_ctx(fcs_handle, FCS_ECDSA_SHA2_SIGN_VERIFY_UPDATE,
                 fcs_sha2_sign_verify_args, sizeof(fcs_sha2_sign_verify_args),
-                sha2_sign_verify_smc_resp, sizeof(sha2_sign_verify_smc_resp));
+                sha2_sign_verify_smc_resp, sizeof(sha2_sign_verify_smc_resp),
+                req);
     }
     else
     {
-        ret = sip_svc_send(fcs_handle, FCS_ECDSA_SHA2_SIGN_VERIFY_FINALIZE,
+        ret = sip_svc_send_ctx(fcs_handle, FCS_ECDSA_SHA2_SIGN_VERIFY_FINALIZE,
                 fcs_sha2_sign_verify_args, sizeof(fcs_sha2_sign_verify_args),
-                sha2_sign_verify_smc_resp, sizeof(sha2_sign_verify_smc_resp));
+                sha2_sign_verify_smc_resp, sizeof(sha2_sign_verify_smc_resp),
+                req);
     }
     if (ret == 0)
     {
-        if (osal_semaphore_wait(fcs_descriptor->fcs_sem,
+        if (osal_semaphore_wait(req->done,
                 OSAL_TIMEOUT_WAIT_FOREVER) == true)
         {
             DEBUG("SIP SVC response: x1: %lx, x2: %lx",
@@ -2538,14 +3465,14 @@ static int run_fcs_ecdsa_sha2_data_sign_verify_update(char *uuid,
             if ((sha2_sign_verify_smc_resp[FCS_RESP_STATUS] == 0UL) && (final ==
                     FCS_FINALIZE))
             {
-                cache_flush((void *)fcs_out_ops_buffer,
+                cache_flush((void *)req->out,
                         (size_t)sha2_sign_verify_smc_resp[FCS_RESP_SIZE]);
                 /* Ignoring the FCS response header */
                 *dest_size =
                         (uint32_t)sha2_sign_verify_smc_resp[FCS_RESP_SIZE] -
                         FCS_RESP_HEADER_SIZE;
                 (void)memcpy((void *)dest_data,
-                        (void *)&fcs_out_ops_buffer[FCS_RESP_DATA], *dest_size);
+                        (void *)&req->out[FCS_RESP_DATA], *dest_size);
             }
             status = (uint16_t)sha2_sign_verify_smc_resp[FCS_RESP_STATUS];
             ret = (int)status;
@@ -2559,6 +3486,7 @@ int run_fcs_ecdsa_sha2_data_sign_verify(char *uuid,
         uint32_t sig_size, char *pub_key_data, uint32_t pub_key_size,
         char *dest_data, uint32_t *dest_size)
 {
+    fcs_request_t *req;
     uint32_t session_id = 0U,
             remaining_data = src_size + sig_size + pub_key_size, data_written;
     int ret;
@@ -2598,35 +3526,38 @@ int run_fcs_ecdsa_sha2_data_sign_verify(char *uuid,
         ERROR("Failed to initialise sha_data_sign_verify");
         return ret;
     }
+    /* The update payload is staged in the request buffer */
+    req = fcs_request_get();
     while (remaining_data > 0U)
     {
-        if (remaining_data > FCS_CRYPTO_BLOCK_SIZE)
+        if (remaining_data > FCS_REQ_BUF_SIZE)
         {
             /*
              * We shall send the 8bytes of input data, signature and the public key
              * in a finalize operation. Now we continue to send the input data
              * till enough data is available for a finalize operation
              */
-            if ((remaining_data - FCS_CRYPTO_BLOCK_SIZE) >= (8U + sig_size +
+            if ((remaining_data - FCS_REQ_BUF_SIZE) >= (8U + sig_size +
                     pub_key_size))
             {
-                data_written = FCS_CRYPTO_BLOCK_SIZE;
+                data_written = FCS_REQ_BUF_SIZE;
             }
             else
             {
                 data_written = remaining_data - (8U + sig_size + pub_key_size);
             }
-            ret = run_fcs_ecdsa_sha2_data_sign_verify_update(uuid, context_id,
-                    src_data, data_written, signed_data, 0U, pub_key_data, 0U,
-                    dest_data, dest_size, FCS_UPDATE);
+            ret = run_fcs_ecdsa_sha2_data_sign_verify_update(req, uuid,
+                    context_id, src_data, data_written, signed_data, 0U,
+                    pub_key_data, 0U, dest_data, dest_size, FCS_UPDATE);
         }
         else
         {
             data_written = remaining_data;
             src_size = data_written - (sig_size + pub_key_size);
-            ret = run_fcs_ecdsa_sha2_data_sign_verify_update(uuid, context_id,
-                    src_data, src_size, signed_data, sig_size, pub_key_data,
-                    pub_key_size, dest_data, dest_size, FCS_FINALIZE);
+            ret = run_fcs_ecdsa_sha2_data_sign_verify_update(req, uuid,
+                    context_id, src_data, src_size, signed_data, sig_size,
+                    pub_key_data, pub_key_size, dest_data, dest_size,
+                    FCS_FINALIZE);
         }
         if (ret == 0)
         {
@@ -2635,9 +3566,10 @@ int run_fcs_ecdsa_sha2_data_sign_verify(char *uuid,
         }
         else
         {
-            return ret;
+            break;
         }
     }
+    fcs_request_put(req);
     return ret;
 }
 
@@ -2645,6 +3577,7 @@ int run_fcs_ecdsa_get_public_key(char *uuid, uint32_t context_id,
         uint32_t key_id, uint32_t ecc_algo, char *pub_key_data,
         uint32_t *pub_key_size)
 {
+    fcs_request_t *req;
     int ret;
     uint16_t status;
     sdm_client_handle fcs_handle;
@@ -2681,19 +3614,20 @@ int run_fcs_ecdsa_get_public_key(char *uuid, uint32_t context_id,
         return ret;
     }
 
-    cache_force_invalidate(fcs_out_ops_buffer, FCS_GET_PUBKEY_RESP);
+    req = fcs_request_get();
+    cache_force_invalidate(req->out, FCS_GET_PUBKEY_RESP);
 
     fcs_get_pubkey_args[0] = session_id;
     fcs_get_pubkey_args[1] = context_id;
-    fcs_get_pubkey_args[2] = (uint64_t)fcs_out_ops_buffer;
+    fcs_get_pubkey_args[2] = (uint64_t)req->out;
     fcs_get_pubkey_args[3] = FCS_GET_PUBKEY_RESP;
-    ret = sip_svc_send(fcs_handle, FCS_GET_PUBKEY_FINALIZE, fcs_get_pubkey_args,
-            sizeof(fcs_get_pubkey_args), get_pubkey_smc_resp,
-            sizeof(get_pubkey_smc_resp));
+    ret = sip_svc_send_ctx(fcs_handle, FCS_GET_PUBKEY_FINALIZE,
+            fcs_get_pubkey_args, sizeof(fcs_get_pubkey_args),
+            get_pubkey_smc_resp, sizeof(get_pubkey_smc_resp), req);
 
     if (ret == 0)
     {
-        if (osal_semaphore_wait(fcs_descriptor->fcs_sem,
+        if (osal_semaphore_wait(req->done,
                 OSAL_TIMEOUT_WAIT_FOREVER) == true)
         {
             DEBUG("SIP_SVC response: x1 %lx, x2 %lx",
@@ -2702,18 +3636,19 @@ int run_fcs_ecdsa_get_public_key(char *uuid, uint32_t context_id,
             if (get_pubkey_smc_resp[FCS_RESP_STATUS] == 0UL)
             {
                 /* Ignoring the FCS response header */
-                cache_force_invalidate(fcs_out_ops_buffer,
+                cache_force_invalidate(req->out,
                         (size_t)get_pubkey_smc_resp[FCS_RESP_SIZE]);
                 *pub_key_size = (uint32_t)get_pubkey_smc_resp[FCS_RESP_SIZE] -
                         FCS_RESP_HEADER_SIZE;
                 (void)memcpy((void *)pub_key_data,
-                        (void *)&fcs_out_ops_buffer[FCS_RESP_DATA],
+                        (void *)&req->out[FCS_RESP_DATA],
                         *pub_key_size);
             }
             status = (uint16_t)get_pubkey_smc_resp[FCS_RESP_STATUS];
             ret = (int)status;
         }
     }
+    fcs_request_put(req);
     return ret;
 }
 
@@ -2722,6 +3657,7 @@ int run_fcs_ecdh_request(char *uuid, uint32_t key_id,
         uint32_t pub_key_size, char *shared_sec_data,
         uint32_t *shared_sec_size)
 {
+    fcs_request_t *req;
     int ret;
     uint16_t status;
     sdm_client_handle fcs_handle;
@@ -2763,7 +3699,8 @@ int run_fcs_ecdh_request(char *uuid, uint32_t key_id,
         return ret;
     }
 
-    cache_force_invalidate(fcs_out_ops_buffer, FCS_ECDH_MAX_RESP);
+    req = fcs_request_get();
+    cache_force_invalidate(req->out, FCS_ECDH_MAX_RESP);
     cache_force_write_back(pub_key_data, pub_key_size);
 
     *shared_sec_size = FCS_ECDH_MAX_RESP;
@@ -2771,17 +3708,17 @@ int run_fcs_ecdh_request(char *uuid, uint32_t key_id,
     fcs_ecdh_args[1] = context_id;
     fcs_ecdh_args[2] = (uint64_t)pub_key_data;
     fcs_ecdh_args[3] = pub_key_size;
-    fcs_ecdh_args[4] = (uint64_t)fcs_out_ops_buffer;
+    fcs_ecdh_args[4] = (uint64_t)req->out;
     fcs_ecdh_args[5] = FCS_ECDH_MAX_RESP;
 
     DEBUG("ECDH finalize: pub_key_addr: %x, pub_key_size: %u", pub_key_data,
             pub_key_size);
-    ret = sip_svc_send(fcs_handle, FCS_ECDH_FINALIZE, fcs_ecdh_args,
-            sizeof(fcs_ecdh_args), ecdh_smc_resp, sizeof(ecdh_smc_resp));
+    ret = sip_svc_send_ctx(fcs_handle, FCS_ECDH_FINALIZE, fcs_ecdh_args,
+            sizeof(fcs_ecdh_args), ecdh_smc_resp, sizeof(ecdh_smc_resp), req);
 
     if (ret == 0)
     {
-        if (osal_semaphore_wait(fcs_descriptor->fcs_sem,
+        if (osal_semaphore_wait(req->done,
                 OSAL_TIMEOUT_WAIT_FOREVER) == true)
         {
             DEBUG("SIP_SVC response: x1 %lx, x2 %lx",
@@ -2789,23 +3726,25 @@ int run_fcs_ecdh_request(char *uuid, uint32_t key_id,
                     ecdh_smc_resp[FCS_RESP_SIZE]);
             if (ecdh_smc_resp[FCS_RESP_STATUS] == 0UL)
             {
-                cache_force_invalidate((void *)fcs_out_ops_buffer,
+                cache_force_invalidate((void *)req->out,
                         (size_t)ecdh_smc_resp[FCS_RESP_SIZE]);
                 /* Ignoring the FCS response header */
                 *shared_sec_size = (uint32_t)ecdh_smc_resp[FCS_RESP_SIZE] -
                         FCS_RESP_HEADER_SIZE;
                 (void)memcpy((void *)shared_sec_data,
-                        (void *)&fcs_out_ops_buffer[FCS_RESP_DATA],
+                        (void *)&req->out[FCS_RESP_DATA],
                         *shared_sec_size);
             }
             status = (uint16_t)ecdh_smc_resp[FCS_RESP_STATUS];
             ret = (int)status;
         }
     }
+    fcs_request_put(req);
     return ret;
 }
 int run_fcs_qspi_open(void)
 {
+    fcs_request_t *req;
     int ret;
     uint16_t status;
     uint64_t qspi_open_err = 0UL;
@@ -2815,12 +3754,13 @@ int run_fcs_qspi_open(void)
         return -EIO;
     }
     DEBUG("QSPI open: No args");
-    ret = sip_svc_send(fcs_descriptor->security_handle, FCS_QSPI_OPEN, NULL, 0,
-            &qspi_open_err, sizeof(qspi_open_err));
+    req = fcs_request_get();
+    ret = sip_svc_send_ctx(fcs_descriptor->security_handle, FCS_QSPI_OPEN, NULL,
+            0, &qspi_open_err, sizeof(qspi_open_err), req);
 
     if (ret == 0)
     {
-        if (osal_semaphore_wait(fcs_descriptor->fcs_sem,
+        if (osal_semaphore_wait(req->done,
                 OSAL_TIMEOUT_WAIT_FOREVER) == true)
         {
             DEBUG("SIP_SVC response: x1 %lx", qspi_open_err);
@@ -2828,10 +3768,12 @@ int run_fcs_qspi_open(void)
             ret = (int)status;
         }
     }
+    fcs_request_put(req);
     return ret;
 }
 int run_fcs_qspi_close(void)
 {
+    fcs_request_t *req;
     int ret;
     uint16_t status;
     uint64_t qspi_close_err = 0UL;
@@ -2841,12 +3783,13 @@ int run_fcs_qspi_close(void)
         return -EIO;
     }
     DEBUG("QSPI close: No args");
-    ret = sip_svc_send(fcs_descriptor->security_handle, FCS_QSPI_CLOSE, NULL, 0,
-            &qspi_close_err, sizeof(qspi_close_err));
+    req = fcs_request_get();
+    ret = sip_svc_send_ctx(fcs_descriptor->security_handle, FCS_QSPI_CLOSE,
+            NULL, 0, &qspi_close_err, sizeof(qspi_close_err), req);
 
     if (ret == 0)
     {
-        if (osal_semaphore_wait(fcs_descriptor->fcs_sem,
+        if (osal_semaphore_wait(req->done,
                 OSAL_TIMEOUT_WAIT_FOREVER) == true)
         {
             DEBUG("SIP_SVC response: x1 %lx", qspi_close_err);
@@ -2854,10 +3797,12 @@ int run_fcs_qspi_close(void)
             ret = (int)status;
         }
     }
+    fcs_request_put(req);
     return ret;
 }
 int run_fcs_qspi_set_cs(uint32_t chip_sel_info)
 {
+    fcs_request_t *req;
     int ret;
     uint16_t status;
     uint64_t qspi_chip_sel_args[3], qspi_chip_sel_err = 0UL;
@@ -2873,13 +3818,15 @@ int run_fcs_qspi_set_cs(uint32_t chip_sel_info)
             "QSPI chip select: Chip Select: %ld, Combined Address: %ld, Mode: %ld",
             qspi_chip_sel_args[0], qspi_chip_sel_args[1],
             qspi_chip_sel_args[2]);
-    ret = sip_svc_send(fcs_descriptor->security_handle, FCS_QSPI_CHIP_SELECT,
-            qspi_chip_sel_args, sizeof(qspi_chip_sel_args), &qspi_chip_sel_err,
-            sizeof(qspi_chip_sel_err));
+    req = fcs_request_get();
+    ret = sip_svc_send_ctx(fcs_descriptor->security_handle,
+            FCS_QSPI_CHIP_SELECT, qspi_chip_sel_args,
+            sizeof(qspi_chip_sel_args), &qspi_chip_sel_err,
+            sizeof(qspi_chip_sel_err), req);
 
     if (ret == 0)
     {
-        if (osal_semaphore_wait(fcs_descriptor->fcs_sem,
+        if (osal_semaphore_wait(req->done,
                 OSAL_TIMEOUT_WAIT_FOREVER) == true)
         {
             DEBUG("SIP_SVC response: x1 %lx", qspi_chip_sel_err);
@@ -2887,10 +3834,12 @@ int run_fcs_qspi_set_cs(uint32_t chip_sel_info)
             ret = (int)status;
         }
     }
+    fcs_request_put(req);
     return ret;
 }
 int run_fcs_qspi_read(uint32_t qspi_addr, uint32_t data_len, char *buffer)
 {
+    fcs_request_t *req;
     int ret;
     uint16_t status;
     uint64_t qspi_read_args[3], qspi_read_resp[2] =
@@ -2924,13 +3873,14 @@ int run_fcs_qspi_read(uint32_t qspi_addr, uint32_t data_len, char *buffer)
     cache_force_invalidate(buffer, data_len * MBOX_WORD_SIZE);
     DEBUG("QSPI read: QSPI Address: %lx, Size: %ld, Buffer: %lx",
             qspi_read_args[0], qspi_read_args[2], (uint64_t)buffer);
-    ret = sip_svc_send(fcs_descriptor->security_handle, FCS_QSPI_READ,
+    req = fcs_request_get();
+    ret = sip_svc_send_ctx(fcs_descriptor->security_handle, FCS_QSPI_READ,
             qspi_read_args, sizeof(qspi_read_args), qspi_read_resp,
-            sizeof(qspi_read_resp));
+            sizeof(qspi_read_resp), req);
 
     if (ret == 0)
     {
-        if (osal_semaphore_wait(fcs_descriptor->fcs_sem,
+        if (osal_semaphore_wait(req->done,
                 OSAL_TIMEOUT_WAIT_FOREVER) == true)
         {
             DEBUG("SIP_SVC response: x1 %lx, x2 %lx", qspi_read_resp[0],
@@ -2944,10 +3894,12 @@ int run_fcs_qspi_read(uint32_t qspi_addr, uint32_t data_len, char *buffer)
             }
         }
     }
+    fcs_request_put(req);
     return ret;
 }
 int run_fcs_qspi_write(uint32_t qspi_addr, uint32_t data_len, char *buffer)
 {
+    fcs_request_t *req;
     int ret;
     uint16_t status;
     uint64_t qspi_write_args[2], qspi_write_err;
@@ -2971,30 +3923,31 @@ int run_fcs_qspi_write(uint32_t qspi_addr, uint32_t data_len, char *buffer)
         ERROR("No buffer provided");
         return -EINVAL;
     }
+    req = fcs_request_get();
     /*
      * Allocate memory to store the address, number of words and the words
      * to be written
      */
     /* Formatting the payload */
-    fcs_inp_ops_buffer[0] = qspi_addr;
-    fcs_inp_ops_buffer[1] = data_len;
-    (void)memcpy((void *)&fcs_inp_ops_buffer[2], (void *)buffer, data_len *
+    req->inp[0] = qspi_addr;
+    req->inp[1] = data_len;
+    (void)memcpy((void *)&req->inp[2], (void *)buffer, data_len *
             MBOX_WORD_SIZE);
 
-    qspi_write_args[0] = (uint64_t)fcs_inp_ops_buffer;
+    qspi_write_args[0] = (uint64_t)req->inp;
     /* Adding two to account for the size of the qspi_addr and data_len */
     qspi_write_args[1] = MBOX_WORD_SIZE * ((uint64_t)data_len + 2UL);
-    cache_force_write_back(fcs_inp_ops_buffer, data_len * MBOX_WORD_SIZE);
+    cache_force_write_back(req->inp, data_len * MBOX_WORD_SIZE);
 
     INFO("QSPI write: Address: %lx, Size: %ld, Buffer: %lx", qspi_write_args[0],
             qspi_write_args[1], (uint64_t)buffer);
-    ret = sip_svc_send(fcs_descriptor->security_handle, FCS_QSPI_WRITE,
+    ret = sip_svc_send_ctx(fcs_descriptor->security_handle, FCS_QSPI_WRITE,
             qspi_write_args, sizeof(qspi_write_args), &qspi_write_err,
-            sizeof(qspi_write_err));
+            sizeof(qspi_write_err), req);
 
     if (ret == 0)
     {
-        if (osal_semaphore_wait(fcs_descriptor->fcs_sem,
+        if (osal_semaphore_wait(req->done,
                 OSAL_TIMEOUT_WAIT_FOREVER) == true)
         {
             DEBUG("SIP_SVC response: x1 %lx", qspi_write_err);
@@ -3002,10 +3955,12 @@ int run_fcs_qspi_write(uint32_t qspi_addr, uint32_t data_len, char *buffer)
             ret = (int)status;
         }
     }
+    fcs_request_put(req);
     return ret;
 }
 int run_fcs_qspi_erase(uint32_t qspi_addr, uint32_t data_len)
 {
+    fcs_request_t *req;
     int ret;
     uint16_t status;
     uint64_t qspi_erase_args[2], qspi_erase_err = 0UL;
@@ -3030,13 +3985,14 @@ int run_fcs_qspi_erase(uint32_t qspi_addr, uint32_t data_len)
 
     INFO("QSPI erase: Address: %lx, Size: %ld", qspi_erase_args[0],
             qspi_erase_args[1]);
-    ret = sip_svc_send(fcs_descriptor->security_handle, FCS_QSPI_ERASE,
+    req = fcs_request_get();
+    ret = sip_svc_send_ctx(fcs_descriptor->security_handle, FCS_QSPI_ERASE,
             qspi_erase_args, sizeof(qspi_erase_args), &qspi_erase_err,
-            sizeof(qspi_erase_err));
+            sizeof(qspi_erase_err), req);
 
     if (ret == 0)
     {
-        if (osal_semaphore_wait(fcs_descriptor->fcs_sem,
+        if (osal_semaphore_wait(req->done,
                 OSAL_TIMEOUT_WAIT_FOREVER) == true)
         {
             DEBUG("SIP_SVC response: x1 %lx", qspi_erase_err);
@@ -3044,11 +4000,14 @@ int run_fcs_qspi_erase(uint32_t qspi_addr, uint32_t data_len)
             ret = (int)status;
         }
     }
+    fcs_request_put(req);
     return ret;
 }
 
-void fcs_callback(uint64_t *resp_values)
+void fcs_callback(uint64_t *resp_values, void *context)
 {
+    fcs_request_t *req = (fcs_request_t *)context;
+
     (void)resp_values;
-    (void)osal_semaphore_post(fcs_descriptor->fcs_sem);
+    (void)osal_semaphore_post(req->done);
 }
@@ -27,6 +27,10 @@
  * wrapper layer to interact with the FCS driver, which in turn communicates
  * with SIP_SVC subsystem and provides the response to the corresponding
  * cryptographic operation.
+ * Each session uses its own mailbox client, and each call takes a request
+ * with its own completion and bounce buffers from a pool of
+ * FCS_MAX_REQUESTS. Calls on different sessions therefore run their SDM
+ * round trips in parallel.
  * To see example usage, see @ref fcs_sample "FCS Sample Application".
  * @{
  */
@@ -125,6 +129,25 @@ struct fcs_sdos_crypt_header
     uint32_t hdr_pad;
     uint8_t iv_field[16];
 };
+
+/**
+ * @brief Handle of a streaming AES or digest operation.
+ */
+typedef struct fcs_stream_context *fcs_stream_handle;
+
+/**
+ * @brief Completion callback of a streamed chunk.
+ *
+ * Called from the task that drives the stream, once the SDM is done with a
+ * chunk and its output, if any, has been copied to the caller buffer.
+ *
+ * @param[in] context  Context pointer given at stream init.
+ * @param[in] status   0 on success, or the SDM error status.
+ * @param[in] out      Caller buffer that received the output, or NULL.
+ * @param[in] out_size Number of bytes written to out.
+ */
+typedef void (*fcs_stream_callback_t)(void *context, int status, char *out,
+        uint32_t out_size);
 /**
  * @}
  */
@@ -548,6 +571,12 @@ int run_fcs_get_device_identity(char *dev_identity, uint32_t *dev_id_size);
  *
  * This function performs AES encryption or decryption on the provided input data using the specified parameters.
  *
+ * Bulk requests whose input, AAD and output buffers lie in the SDM address
+ * window are processed in place: the SDM reads and writes the caller
+ * buffers through the SMMU and only the unaligned AAD and input tails are
+ * staged. The output buffer must start and end on a 64 byte cache line
+ * for this, otherwise the data is copied through the driver buffers.
+ *
  * @param[in]  uuid        The session ID associated with the FCS service.
  * @param[in]  key_id      The ID of the key to be used for the operation.
  * @param[in]  context_id  The context ID for the AES operation.
@@ -575,6 +604,108 @@ int run_fcs_aes_cryption(char *uuid, uint32_t key_id, uint32_t context_id,
         char *tag_data, char *input_data, uint32_t input_size,
         char *output_data, uint32_t output_size);
 
+/**
+ * @brief Start a streaming AES operation.
+ *
+ * A stream takes two request buffers from the pool and keeps two chunks
+ * in flight: while the SDM processes one chunk, the next is copied and
+ * cleaned on the CPU. The data is passed with fcs_stream_submit() and the
+ * last piece with fcs_stream_finalize().
+ *
+ * @param[out] handle      Stream handle on success.
+ * @param[in]  uuid        The session ID associated with the FCS service.
+ * @param[in]  key_id      The ID of the key to be used for the operation.
+ * @param[in]  context_id  The context ID for the AES operation.
+ * @param[in]  crypt_mode  The cryptographic mode (e.g., encrypt or decrypt).
+ * @param[in]  block_mode  The block mode for AES (e.g., ECB, CBC, GCM).
+ * @param[in]  iv_src      The source of the initialization vector (IV).
+ * @param[in]  iv_data     Pointer to the IV data.
+ * @param[in]  tag_size    Length of the authentication tag (for GCM mode).
+ * @param[in]  aad_size    Length of the AAD, GCM modes only.
+ * @param[in]  aad_data    Pointer to the AAD data.
+ * @param[in]  chunk_size  Bytes per SDM update, 0 selects the default.
+ * @param[in]  callback    Optional per chunk completion callback.
+ * @param[in]  cb_context  Context pointer passed to the callback.
+ *
+ * @return
+ * - 0: on success, or an error code on failure:
+ * - -EINVAL: If invalid parameters are provided.
+ * - -EBUSY:  If all streams are in use.
+ */
+int fcs_stream_aes_init(fcs_stream_handle *handle, char *uuid,
+        uint32_t key_id, uint32_t context_id, uint32_t crypt_mode,
+        uint32_t block_mode, uint32_t iv_src, char *iv_data, uint32_t tag_size,
+        uint32_t aad_size, char *aad_data, uint32_t chunk_size,
+        fcs_stream_callback_t callback, void *cb_context);
+
+/**
+ * @brief Start a streaming digest operation.
+ *
+ * Chunks that lie in the SDM address window are read in place; they must
+ * stay unchanged until the following submit or finalize call returns.
+ *
+ * @param[out] handle      Stream handle on success.
+ * @param[in]  uuid        The session ID associated with the FCS service.
+ * @param[in]  context_id  The context ID for the digest operation.
+ * @param[in]  key_id      The ID of the key, used for HMAC only.
+ * @param[in]  op_mode     The operation mode (SHA2 or HMAC).
+ * @param[in]  dig_size    The digest size.
+ * @param[in]  chunk_size  Bytes per SDM update, 0 selects the default.
+ * @param[in]  callback    Optional per chunk completion callback.
+ * @param[in]  cb_context  Context pointer passed to the callback.
+ *
+ * @return
+ * - 0: on success, or an error code on failure:
+ * - -EINVAL: If invalid parameters are provided.
+ * - -EBUSY:  If all streams are in use.
+ */
+int fcs_stream_digest_init(fcs_stream_handle *handle, char *uuid,
+        uint32_t context_id, uint32_t key_id, uint32_t op_mode,
+        uint32_t dig_size, uint32_t chunk_size,
+        fcs_stream_callback_t callback, void *cb_context);
+
+/**
+ * @brief Submit data to a stream.
+ *
+ * The data is split into chunks of the stream chunk size. The call returns
+ * once its last chunk has been handed to the SDM, so the output of that
+ * chunk is written to out during the next submit or finalize call.
+ *
+ * @param[in]  stream Stream handle.
+ * @param[in]  data   Input data, a multiple of the AES block size (32 bytes,
+ *                    16 for GCM) or of 8 bytes for digests.
+ * @param[in]  size   Size of the input data.
+ * @param[out] out    AES output buffer of size bytes, unused for digests
+ *                    and GHASH.
+ *
+ * @return
+ * - 0: on success, or an error code on failure. After a failure the
+ *   stream must still be closed with fcs_stream_finalize().
+ */
+int fcs_stream_submit(fcs_stream_handle stream, char *data, uint32_t size,
+        char *out);
+
+/**
+ * @brief Submit the last data of a stream, wait for it and close the stream.
+ *
+ * The stream is released in all cases, including on error.
+ *
+ * @param[in]  stream   Stream handle.
+ * @param[in]  data     Last piece of input, not larger than the chunk size.
+ *                      AES input is padded to a block, digest input must be
+ *                      a multiple of 8 bytes.
+ * @param[in]  size     Size of the last piece, must not be 0.
+ * @param[out] out      AES output for the last piece, or the digest.
+ * @param[in,out] tag_data GCM tag, read for decrypt and GHASH, written for
+ *                      encrypt.
+ * @param[out] out_size Bytes written to out, optional for AES.
+ *
+ * @return
+ * - 0: on success, or the first error seen by the stream.
+ */
+int fcs_stream_finalize(fcs_stream_handle stream, char *data, uint32_t size,
+        char *out, char *tag_data, uint32_t *out_size);
+
 /**
  * @brief Sign a hash using ECDSA with the FCS service.
  *
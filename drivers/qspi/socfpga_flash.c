@@ -62,6 +62,12 @@
 #include "socfpga_qspi.h"
 
 #define FLASH_MAX_WAIT_TIME    0xFFFFFFFFU        /*!< Maximum wait time for mutex lock. */
+#define FLASH_DMA_ALIGN        64U                /*!< Buffers and sizes in whole cache lines are moved by DMA. */
+#define FLASH_CAL_ADDR         0x0U               /*!< Flash range read back while tuning the read mode. */
+#define FLASH_CAL_SIZE         256U
+#define FLASH_UPD_MAX_BLOCK    0x10000U           /*!< Largest erase block flash_update() uses. */
+#define FLASH_UPD_BUF_SIZE     4096U              /*!< Partly updated blocks are merged here. */
+#define FLASH_UPD_MAX_PAGES    (FLASH_UPD_MAX_BLOCK / QSPI_PAGE_SIZE)
 
 /*The Flash handle*/
 struct flash_handle
@@ -96,6 +102,48 @@ static struct flash_adapter *adapter_list[] =
     /*Add other adapters*/
 };
 
+/*
+ * Reads the Basic Flash Parameter Table, which the first parameter header
+ * points to. As with the headers, each read returns one byte ahead of
+ * the requested data, leaving 7 bytes of every 8.
+ */
+static int flash_read_bfpt(struct sfdp_object *sfdp)
+{
+    struct sfdp_bfpt *bfpt = &sfdp->bfpt;
+    uint32_t raw[2], offset, len, chunk;
+    uint8_t bytes[SFDP_BFPT_MAX_DWORDS * 4U];
+    uint32_t pos = 0U;
+
+    len = (uint32_t)sfdp->param_header[0].parameter_length * 4U;
+    if (len > sizeof(bytes))
+    {
+        len = sizeof(bytes);
+    }
+    offset = sfdp->param_header[0].parameter_table_offset;
+    while (pos < len)
+    {
+        chunk = ((len - pos) < 7U) ? (len - pos) : 7U;
+        if (qspi_read_sfdp(offset + pos, (uint8_t)(chunk + 1U), &raw[0]) !=
+                QSPI_OK)
+        {
+            ERROR("SFDP parameter table read failed");
+            return -EIO;
+        }
+        (void)memcpy(&bytes[pos], ((uint8_t *)raw) + 1U, chunk);
+        pos += chunk;
+    }
+
+    bfpt->num_dwords = (uint8_t)(len / 4U);
+    for (uint32_t i = 0U; i < bfpt->num_dwords; i++)
+    {
+        bfpt->dword[i] = (uint32_t)bytes[4U * i] |
+                ((uint32_t)bytes[(4U * i) + 1U] << 8U) |
+                ((uint32_t)bytes[(4U * i) + 2U] << 16U) |
+                ((uint32_t)bytes[(4U * i) + 3U] << 24U);
+    }
+    return 0;
+}
+
 static int flash_read_sfdp(flash_handle_t pflash)
 {
     uint64_t sfdp_header_raw, param_header_raw;
@@ -130,19 +178,22 @@ static int flash_read_sfdp(flash_handle_t pflash)
             (SFDP_NUM_PARAM_TABLES_POS & SFDP_NUM_PARAM_TABLES_MASK));
 
 
-    ret = qspi_read_sfdp(SFDP_PARAM_START_ADDR, PARAM_HEADER_SIZE,
-            &param_header[0]);
-
-    if (ret != QSPI_OK)
+    /*the header count is zero based*/
+    for (uint8_t i = 0; (i <= sfdp->std_header.num_parameter_tables) &&
+            (i < MAX_PARAM_HEADERS); i++)
     {
-        ERROR("SFDP parameter header read failed");
-        return -EIO;
-    }
+        ret = qspi_read_sfdp(SFDP_PARAM_START_ADDR +
+                ((uint32_t)i * PARAM_HEADER_SIZE), PARAM_HEADER_SIZE,
+                &param_header[0]);
 
-    param_header_raw = (uint64_t)((((uint64_t)param_header[1]) <<
-            SFDP_PARAM_HEADER_MSB_POS) | (uint64_t)param_header[0]);
-    for (uint8_t i = 0; i <  sfdp->std_header.num_parameter_tables; i++)
-    {
+        if (ret != QSPI_OK)
+        {
+            ERROR("SFDP parameter header read failed");
+            return -EIO;
+        }
+
+        param_header_raw = (uint64_t)((((uint64_t)param_header[1]) <<
+                SFDP_PARAM_HEADER_MSB_POS) | (uint64_t)param_header[0]);
         sfdp->param_header[i].parameter_length = (uint8_t)(param_header_raw >>
                 (SFDP_PARAM_LEN_POS &
                 SFDP_PARAM_LEN_MASK));
@@ -151,8 +202,106 @@ static int flash_read_sfdp(flash_handle_t pflash)
                 SFDP_PARAM_TABLE_OFFSET_MASK));
     }
 
+    return flash_read_bfpt(sfdp);
+}
+
+/*keep a direct access mapping valid across an indirect operation*/
+static void flash_xip_sync(uint32_t address, uint32_t size, bool changed)
+{
+    if (changed)
+    {
+        qspi_xip_invalidate(address, size);
+    }
+    if (qspi_xip_restore() != QSPI_OK)
+    {
+        ERROR("Failed to select the mapped bank");
+    }
+}
+
+#if QSPI_ENABLE_DMA_MODE
+static bool flash_use_dma(flash_handle_t flash_handle, const uint8_t *buffer,
+        uint32_t size)
+{
+    /*whole lines, so invalidating the buffer never hits a neighbour*/
+    return (flash_handle->desc.dma != NULL) &&
+           (((((uintptr_t)buffer) | size) & (FLASH_DMA_ALIGN - 1U)) == 0U);
+}
+
+static int flash_dma_sync(flash_handle_t flash_handle)
+{
+    uint32_t address = flash_handle->desc.start_addr;
+    uint32_t size = flash_handle->desc.xfer_size;
+
+    if (qspi_dma_start(&flash_handle->desc) != QSPI_OK)
+    {
+        ERROR("DMA transfer start failed");
+        return -EIO;
+    }
+    if (osal_semaphore_wait(flash_handle->desc.sem, FLASH_MAX_WAIT_TIME) ==
+            false)
+    {
+        ERROR("DMA transfer failed due to timeout");
+        return -ETIMEDOUT;
+    }
+    flash_xip_sync(address, size, flash_handle->desc.is_wr_op != 0);
+    if (flash_handle->desc.xfer_status != QSPI_OK)
+    {
+        ERROR("DMA transfer failed");
+        return -EIO;
+    }
     return 0;
 }
+#endif
+
+/*
+ * Switch to the fastest read instruction that reads the calibration range
+ * back as the single line fast read at the slowest clock does. Nothing
+ * changes if the range holds no pattern to tell bad reads apart.
+ */
+static void flash_tune_read(flash_handle_t flash_handle)
+{
+    qspi_descriptor_t *desc = &flash_handle->desc;
+    qspi_read_mode_t safe = desc->read_mode;
+    static uint8_t ref[FLASH_CAL_SIZE];
+    const uint8_t *win;
+    uint32_t i;
+
+    if (qspi_xip_map(FLASH_CAL_ADDR, FLASH_CAL_SIZE, &win) != QSPI_OK)
+    {
+        WARN("Read calibration skipped, range cannot be mapped");
+        return;
+    }
+    (void)memcpy(ref, win, FLASH_CAL_SIZE);
+    qspi_xip_unmap();
+    i = 1U;
+    while ((i < FLASH_CAL_SIZE) && (ref[i] == ref[0]))
+    {
+        i++;
+    }
+    if (i == FLASH_CAL_SIZE)
+    {
+        WARN("Read calibration skipped, no pattern in the range");
+        return;
+    }
+
+    for (i = 0U; i < desc->num_read_modes; i++)
+    {
+        if (qspi_set_read_mode(desc, &desc->read_modes[i]) != QSPI_OK)
+        {
+            continue;
+        }
+        if (qspi_calibrate_read(desc, FLASH_CAL_ADDR, ref, FLASH_CAL_SIZE) ==
+                QSPI_OK)
+        {
+            INFO("Read opcode 0x%x%s, baud divisor %u, capture delay %u",
+                    desc->read_mode.opcode, desc->read_mode.dtr ? " DTR" : "",
+                    desc->baud_div, desc->read_delay);
+            return;
+        }
+    }
+    WARN("Read calibration failed, keeping the fast read");
+    (void)qspi_set_read_mode(desc, &safe);
+}
 
 flash_handle_t flash_open(uint32_t flash_num)
 {
@@ -211,6 +360,7 @@ flash_handle_t flash_open(uint32_t flash_num)
         ERROR("QSPI init failed");
         return NULL;
     }
+    flash_tune_read(flash_handle);
 
     if (flash_handle->desc.mutex == NULL)
     {
@@ -231,6 +381,12 @@ flash_handle_t flash_open(uint32_t flash_num)
             return NULL;
         }
     }
+#if QSPI_ENABLE_DMA_MODE
+    if (qspi_dma_init(&flash_handle->desc) != QSPI_OK)
+    {
+        WARN("QSPI DMA channel not available, transfers use the CPU");
+    }
+#endif
 
     flash_handle->is_open = 1;
 
@@ -268,6 +424,8 @@ int flash_erase_sectors(flash_handle_t flash_handle, uint32_t address,
     const uint32_t SECTOR_SIZE = 4096U;
     int32_t erase_count = 0;
     uint32_t sector_offset = address & (SECTOR_SIZE - 1U);
+    uint32_t erase_start = address;
+    uint32_t erase_size = size;
     uint32_t remain_len;
 
     if (flash_handle == NULL)
@@ -308,51 +466,53 @@ int flash_erase_sectors(flash_handle_t flash_handle, uint32_t address,
         size = (size > SECTOR_SIZE) ? size - SECTOR_SIZE : SECTOR_SIZE;
         erase_count++;
     }
+    /*whole sectors around the range were erased*/
+    flash_xip_sync(erase_start & ~(SECTOR_SIZE - 1U), erase_size +
+            (2U * SECTOR_SIZE), true);
     INFO("Erase completed");
     return erase_count;
 }
 
-int flash_write_sync(flash_handle_t flash_handle, uint32_t address,
-        uint8_t *data, uint32_t size)
+/*claim the device for one operation, released by clearing is_busy*/
+static int flash_claim(flash_handle_t flash_handle)
 {
-
     int ret = 0;
-    uint32_t w_count = 0;
 
-    if ((flash_handle == NULL) || (data == NULL) || (size == 0U))
+    if (osal_mutex_lock(flash_handle->desc.mutex, FLASH_MAX_WAIT_TIME) ==
+            false)
     {
-        ERROR("Inavlid arguments");
-        return -EINVAL;
+        ERROR("Mutex lock failed");
+        return -ETIMEDOUT;
     }
-    if (osal_mutex_lock(flash_handle->desc.mutex, FLASH_MAX_WAIT_TIME))
+    if ((flash_handle->is_open) == 0)
+    {
+        ERROR("Device is not open");
+        ret = -EINVAL;
+    }
+    else if (flash_handle->desc.is_busy != 0)
+    {
+        ERROR("Device is busy");
+        ret = -EBUSY;
+    }
+    else
     {
-        if ((flash_handle->is_open) == 0)
-        {
-            ERROR("Device is not open");
-            if (osal_mutex_unlock(flash_handle->desc.mutex) == false)
-            {
-                ERROR("Mutex unlock failed");
-                return -ETIMEDOUT;
-            }
-            return -EINVAL;
-        }
-        if (flash_handle->desc.is_busy != 0)
-        {
-            ERROR("Device is busy");
-            if (osal_mutex_unlock(flash_handle->desc.mutex) == false)
-            {
-                ERROR("Mutex unlock failed");
-                return -ETIMEDOUT;
-            }
-            return -EBUSY;
-        }
         flash_handle->desc.is_busy = true;
-        if (osal_mutex_unlock(flash_handle->desc.mutex) == false)
-        {
-            ERROR("Mutex unlock failed");
-            return -ETIMEDOUT;
-        }
     }
+    if (osal_mutex_unlock(flash_handle->desc.mutex) == false)
+    {
+        ERROR("Mutex unlock failed");
+        return -ETIMEDOUT;
+    }
+    return ret;
+}
+
+/*write with the device already claimed, leaves it claimed*/
+static int flash_write_claimed(flash_handle_t flash_handle, uint32_t address,
+        uint8_t *data, uint32_t size)
+{
+    int ret = 0;
+    uint32_t w_count = 0;
+
     flash_handle->desc.is_wr_op = true;
     flash_handle->desc.is_async = false;
 #if QSPI_ENABLE_INT_MODE
@@ -361,6 +521,14 @@ int flash_write_sync(flash_handle_t flash_handle, uint32_t address,
     flash_handle->desc.bytes_left = size;
     flash_handle->desc.start_addr = address;
 
+#if QSPI_ENABLE_DMA_MODE
+    if (flash_use_dma(flash_handle, data, size))
+    {
+        INFO("Write sync started. Writing %d bytes by DMA from offset 0x%x",
+                size, address);
+        return flash_dma_sync(flash_handle);
+    }
+#endif
     INFO("Write sync started.Writing %d bytes of data starting from offset 0x%x",
             size, address);
 
@@ -404,7 +572,344 @@ int flash_write_sync(flash_handle_t flash_handle, uint32_t address,
     }
     INFO("Write sync transfer completed");
 #endif
-    flash_handle->desc.is_busy = false;
+    flash_xip_sync(address, size, true);
+    return ret;
+}
+
+/*flash_update state of one block*/
+struct flash_upd_block
+{
+    uint32_t addr;
+    uint32_t size;
+    uint8_t cmd;
+    uint32_t dirty[FLASH_UPD_MAX_PAGES / 32U];
+};
+
+/*merge buffer of partly updated blocks, cache line aligned for the DMA*/
+static uint8_t flash_upd_buf[FLASH_UPD_BUF_SIZE]
+__attribute__((aligned(FLASH_DMA_ALIGN)));
+
+static bool flash_is_blank(const uint8_t *p, uint32_t size)
+{
+    for (uint32_t i = 0U; i < size; i++)
+    {
+        if (p[i] != 0xFFU)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*index of the smallest erase type, QSPI_MAX_ERASE_TYPES if there is none*/
+static uint32_t flash_upd_min_erase(const qspi_descriptor_t *desc)
+{
+    uint32_t i, min = QSPI_MAX_ERASE_TYPES;
+
+    for (i = 0U; i < QSPI_MAX_ERASE_TYPES; i++)
+    {
+        if ((desc->erase_size[i] != 0U) && ((min == QSPI_MAX_ERASE_TYPES) ||
+                (desc->erase_size[i] < desc->erase_size[min])))
+        {
+            min = i;
+        }
+    }
+    return min;
+}
+
+/*largest erase block starting at address that stays in the range*/
+static void flash_upd_pick_block(const qspi_descriptor_t *desc,
+        uint32_t address, uint32_t end, struct flash_upd_block *blk)
+{
+    uint32_t i, size;
+
+    /*erase types may come in any order, take the largest aligned one*/
+    blk->size = 0U;
+    for (i = 0U; i < QSPI_MAX_ERASE_TYPES; i++)
+    {
+        size = desc->erase_size[i];
+        if ((size == 0U) || (size > FLASH_UPD_MAX_BLOCK) ||
+                (size <= blk->size))
+        {
+            continue;
+        }
+        if (((address & (size - 1U)) == 0U) && (size <= (end - address)))
+        {
+            blk->size = size;
+            blk->cmd = desc->erase_cmd[i];
+        }
+    }
+    if (blk->size == 0U)
+    {
+        /*not aligned or too short, the smallest block is merged*/
+        i = flash_upd_min_erase(desc);
+        blk->size = desc->erase_size[i];
+        blk->cmd = desc->erase_cmd[i];
+    }
+    blk->addr = address & ~(blk->size - 1U);
+}
+
+static void flash_upd_mark(struct flash_upd_block *blk, uint32_t page)
+{
+    blk->dirty[page / 32U] |= ((uint32_t)1U << (page % 32U));
+}
+
+static bool flash_upd_is_marked(const struct flash_upd_block *blk,
+        uint32_t page)
+{
+    return (blk->dirty[page / 32U] & ((uint32_t)1U << (page % 32U))) != 0U;
+}
+
+/*
+ * Brings one erase block to src, NULL meaning blank. Returns 1 if the
+ * block already matched, 0 if it was updated.
+ */
+static int flash_upd_block(flash_handle_t flash_handle,
+        struct flash_upd_block *blk, const uint8_t *src)
+{
+    uint32_t pages = blk->size / QSPI_PAGE_SIZE;
+    uint32_t page, first, off, i;
+    bool erase = false;
+    const uint8_t *old;
+    int ret;
+
+    if (qspi_xip_map(blk->addr, blk->size, &old) != QSPI_OK)
+    {
+        ERROR("Failed to map the block at 0x%x", blk->addr);
+        return -EIO;
+    }
+    if ((src == NULL) ? flash_is_blank(old, blk->size) : (memcmp(old, src,
+            blk->size) == 0))
+    {
+        return 1;
+    }
+
+    (void)memset(blk->dirty, 0, sizeof(blk->dirty));
+    if (src == NULL)
+    {
+        erase = true;
+    }
+    else
+    {
+        /*programming only clears bits*/
+        for (i = 0U; (i < blk->size) && !erase; i++)
+        {
+            erase = (old[i] & src[i]) != src[i];
+        }
+    }
+
+    if (erase)
+    {
+        if (qspi_erase_start(blk->addr, blk->cmd, true) != QSPI_OK)
+        {
+            ERROR("Erase failed");
+            return -EIO;
+        }
+        /*the flash is busy, work out the pages to program meanwhile*/
+        for (page = 0U; (src != NULL) && (page < pages); page++)
+        {
+            if (!flash_is_blank(&src[page * QSPI_PAGE_SIZE], QSPI_PAGE_SIZE))
+            {
+                flash_upd_mark(blk, page);
+            }
+        }
+        if (qspi_erase_wait() != QSPI_OK)
+        {
+            ERROR("Erase failed");
+            return -EIO;
+        }
+        flash_xip_sync(blk->addr, blk->size, true);
+    }
+    else
+    {
+        for (page = 0U; page < pages; page++)
+        {
+            off = page * QSPI_PAGE_SIZE;
+            if (memcmp(&old[off], &src[off], QSPI_PAGE_SIZE) != 0)
+            {
+                flash_upd_mark(blk, page);
+            }
+        }
+    }
+
+    /*program runs of consecutive pages with one transfer each*/
+    page = 0U;
+    while (page < pages)
+    {
+        if (!flash_upd_is_marked(blk, page))
+        {
+            page++;
+            continue;
+        }
+        first = page;
+        while ((page < pages) && flash_upd_is_marked(blk, page))
+        {
+            page++;
+        }
+        off = first * QSPI_PAGE_SIZE;
+        ret = flash_write_claimed(flash_handle, blk->addr + off,
+                (uint8_t *)&src[off], (page - first) * QSPI_PAGE_SIZE);
+        if (ret != 0)
+        {
+            return ret;
+        }
+    }
+
+    /*read back through the window, which the writes kept mapped*/
+    if ((src == NULL) ? !flash_is_blank(old, blk->size) : (memcmp(old, src,
+            blk->size) != 0))
+    {
+        ERROR("Read back of the block at 0x%x failed", blk->addr);
+        return -EIO;
+    }
+    return 0;
+}
+
+/*flash_update with the device claimed, leaves it claimed*/
+static int flash_upd_range(flash_handle_t flash_handle, uint32_t address,
+        const uint8_t *data, uint32_t size, flash_progress_t progress,
+        void *puser_context)
+{
+    struct flash_upd_block blk;
+    uint32_t end = address + size;
+    uint32_t pos = address;
+    uint32_t lo, hi, skipped = 0U;
+    uint64_t chip_size;
+    const uint8_t *src;
+    const uint8_t *old;
+    int ret;
+
+    INFO("Updating %d bytes starting from offset 0x%x", size, address);
+
+    chip_size = flash_handle->adapter->sfdp.param_table[0].flash_size / 8U;
+    if ((data == NULL) && (address == 0U) && ((uint64_t)size == chip_size) &&
+            (flash_handle->desc.chip_erase_cmd != 0U))
+    {
+        if ((qspi_erase_start(0U, flash_handle->desc.chip_erase_cmd, false) !=
+                QSPI_OK) || (qspi_erase_wait() != QSPI_OK))
+        {
+            ERROR("Chip erase failed");
+            return -EIO;
+        }
+        flash_xip_sync(address, size, true);
+        if (progress != NULL)
+        {
+            progress(size, size, puser_context);
+        }
+        return 0;
+    }
+
+    while (pos < end)
+    {
+        flash_upd_pick_block(&flash_handle->desc, pos, end, &blk);
+        lo = pos;
+        hi = ((blk.addr + blk.size) < end) ? (blk.addr + blk.size) : end;
+
+        if ((lo != blk.addr) || (hi != (blk.addr + blk.size)))
+        {
+            /*keep the bytes of the block outside the range*/
+            if (qspi_xip_map(blk.addr, blk.size, &old) != QSPI_OK)
+            {
+                ERROR("Failed to map the block at 0x%x", blk.addr);
+                return -EIO;
+            }
+            (void)memcpy(flash_upd_buf, old, blk.size);
+            if (data != NULL)
+            {
+                (void)memcpy(&flash_upd_buf[lo - blk.addr],
+                        &data[lo - address], hi - lo);
+            }
+            else
+            {
+                (void)memset(&flash_upd_buf[lo - blk.addr], 0xFF, hi - lo);
+            }
+            src = flash_upd_buf;
+        }
+        else
+        {
+            src = (data != NULL) ? &data[lo - address] : NULL;
+        }
+
+        ret = flash_upd_block(flash_handle, &blk, src);
+        if (ret < 0)
+        {
+            qspi_xip_unmap();
+            return ret;
+        }
+        skipped += (ret > 0) ? (hi - lo) : 0U;
+        pos = hi;
+        if (progress != NULL)
+        {
+            progress(pos - address, size, puser_context);
+        }
+    }
+    qspi_xip_unmap();
+    INFO("Update completed, %d of %d bytes already matched", skipped, size);
+    return 0;
+}
+
+int flash_update(flash_handle_t flash_handle, uint32_t address,
+        const uint8_t *data, uint32_t size, flash_progress_t progress,
+        void *puser_context)
+{
+    uint32_t min_erase;
+    int ret;
+
+    if ((flash_handle == NULL) || (size == 0U) ||
+            ((address + size) < address))
+    {
+        ERROR("Invalid arguments");
+        return -EINVAL;
+    }
+    min_erase = flash_upd_min_erase(&flash_handle->desc);
+    if ((min_erase == QSPI_MAX_ERASE_TYPES) ||
+            (flash_handle->desc.erase_size[min_erase] > FLASH_UPD_BUF_SIZE) ||
+            ((flash_handle->desc.erase_size[min_erase] % QSPI_PAGE_SIZE) !=
+            0U))
+    {
+        ERROR("No usable erase size");
+        return -EINVAL;
+    }
+    /*
+     * The device stays claimed for the whole update, so no other caller
+     * can map, read or write it between the erases and the writes
+     */
+    ret = flash_claim(flash_handle);
+    if (ret != 0)
+    {
+        return ret;
+    }
+    ret = flash_upd_range(flash_handle, address, data, size, progress,
+            puser_context);
+    /*a timed out transfer may still be running, keep the device claimed*/
+    if (ret != -ETIMEDOUT)
+    {
+        flash_handle->desc.is_busy = false;
+    }
+    return ret;
+}
+
+int flash_write_sync(flash_handle_t flash_handle, uint32_t address,
+        uint8_t *data, uint32_t size)
+{
+    int ret;
+
+    if ((flash_handle == NULL) || (data == NULL) || (size == 0U))
+    {
+        ERROR("Inavlid arguments");
+        return -EINVAL;
+    }
+    ret = flash_claim(flash_handle);
+    if (ret != 0)
+    {
+        return ret;
+    }
+    ret = flash_write_claimed(flash_handle, address, data, size);
+    /*a timed out transfer may still be running, keep the device claimed*/
+    if (ret != -ETIMEDOUT)
+    {
+        flash_handle->desc.is_busy = false;
+    }
     return ret;
 }
 
@@ -458,6 +963,20 @@ int flash_write_async(flash_handle_t flash_handle, uint32_t address,
     flash_handle->desc.bytes_left = size;
     flash_handle->desc.start_addr = address;
 
+#if QSPI_ENABLE_DMA_MODE
+    if (flash_use_dma(flash_handle, data, size))
+    {
+        INFO("Write async started. Writing %d bytes by DMA from offset 0x%x",
+                size, address);
+        if (qspi_dma_start(&flash_handle->desc) != QSPI_OK)
+        {
+            ERROR("Write failed");
+            flash_handle->desc.is_busy = false;
+            return -EIO;
+        }
+        return 0;
+    }
+#endif
     INFO("Write async started. Writing %d bytes of data starting from offset 0x%x",
             size, address);
 
@@ -535,6 +1054,19 @@ int flash_read_sync(flash_handle_t flash_handle, uint32_t address,
     flash_handle->desc.bytes_left = size;
     flash_handle->desc.start_addr = address;
 
+#if QSPI_ENABLE_DMA_MODE
+    if (flash_use_dma(flash_handle, buffer, size))
+    {
+        INFO("Read sync transfer started. Reading %d bytes by DMA from offset 0x%x",
+                size, address);
+        ret = flash_dma_sync(flash_handle);
+        if (ret != -ETIMEDOUT)
+        {
+            flash_handle->desc.is_busy = false;
+        }
+        return ret;
+    }
+#endif
     INFO("Read sync transfer started. Reading %d bytes of data starting from the offset 0x%x",
             size, address);
     qspi_enable_int(QSPI_INDDONE_AND_XFERBRCH);
@@ -570,6 +1102,7 @@ int flash_read_sync(flash_handle_t flash_handle, uint32_t address,
     }
     INFO("Read sync transfer completed");
 #endif
+    flash_xip_sync(address, size, false);
     flash_handle->desc.is_busy = false;
     return ret;
 }
@@ -622,6 +1155,21 @@ int flash_read_async(flash_handle_t flash_handle, uint32_t address,
     flash_handle->desc.bytes_left = size;
     flash_handle->desc.start_addr = address;
 
+#if QSPI_ENABLE_DMA_MODE
+    if (flash_use_dma(flash_handle, buffer, size))
+    {
+        INFO("Read async transfer started. Reading %d bytes by DMA from offset 0x%x",
+                size, address);
+        if (qspi_dma_start(&flash_handle->desc) != QSPI_OK)
+        {
+            ERROR("Read failed");
+            flash_handle->desc.is_busy = false;
+            return -EIO;
+        }
+        return 0;
+    }
+#endif
+
     qspi_enable_int(QSPI_INDDONE_AND_XFERBRCH);
 
     INFO("Read ssync transfer started. Reading %d bytes of data starting from the offset 0x%x",
@@ -641,6 +1189,67 @@ int flash_read_async(flash_handle_t flash_handle, uint32_t address,
 }
 #endif
 
+int flash_map(flash_handle_t flash_handle, uint32_t address, uint32_t size,
+        const uint8_t **pptr)
+{
+    int ret = 0;
+
+    if ((flash_handle == NULL) || (pptr == NULL) || (size == 0U))
+    {
+        ERROR("Invalid arguments");
+        return -EINVAL;
+    }
+    if (osal_mutex_lock(flash_handle->desc.mutex, FLASH_MAX_WAIT_TIME) ==
+            false)
+    {
+        ERROR("Mutex lock failed");
+        return -ETIMEDOUT;
+    }
+    if ((flash_handle->is_open) == 0)
+    {
+        ERROR("Device is not open");
+        ret = -EINVAL;
+    }
+    else if (flash_handle->desc.is_busy != 0)
+    {
+        ERROR("Device is busy");
+        ret = -EBUSY;
+    }
+    else if (qspi_xip_map(address, size, pptr) != QSPI_OK)
+    {
+        ERROR("Failed to map 0x%x bytes at offset 0x%x", size, address);
+        ret = -EINVAL;
+    }
+    if (osal_mutex_unlock(flash_handle->desc.mutex) == false)
+    {
+        ERROR("Mutex unlock failed");
+        return -ETIMEDOUT;
+    }
+    return ret;
+}
+
+int flash_unmap(flash_handle_t flash_handle)
+{
+    if (flash_handle == NULL)
+    {
+        ERROR("Invalid flash handle");
+        return -EINVAL;
+    }
+    if (osal_mutex_lock(flash_handle->desc.mutex, FLASH_MAX_WAIT_TIME) ==
+            false)
+    {
+        ERROR("Mutex lock failed");
+        return -ETIMEDOUT;
+    }
+    qspi_xip_unmap();
+    if (osal_mutex_unlock(flash_handle->desc.mutex) == false)
+    {
+        ERROR("Mutex unlock failed");
+        return -ETIMEDOUT;
+    }
+    return 0;
+}
+
 int flash_close(flash_handle_t flash_handle)
 {
     if ((flash_handle == NULL))
@@ -660,6 +1269,9 @@ int flash_close(flash_handle_t flash_handle)
         ERROR("QSPI deinit failed");
         return -EIO;
     }
+#if QSPI_ENABLE_DMA_MODE
+    qspi_dma_deinit(&flash_handle->desc);
+#endif
 
     if (osal_mutex_delete(flash_handle->desc.mutex) == false)
     {
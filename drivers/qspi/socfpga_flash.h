@@ -32,9 +32,23 @@
  * The driver supports blocking (sync) and non-blocking (async) functions.
  * The async mode supports registering a callback to get notified on completion.
  *
+ * Transfers whose buffer address and size are multiples of 64 bytes (a
+ * cache line) are moved between the QSPI SRAM and memory by a DMA channel,
+ * paced by the SRAM fill level interrupt. Other transfers are copied by
+ * the CPU. The callback receives 0 on success and a non-zero status if
+ * the transfer failed.
+ *
  * The flash driver uses an adaptation layer which uses the SFDP protocol to fetch
  * vendor specific information for different devices and uses this information
  * for erase, read and write. <br>
+ *
+ * On open, the read instructions listed in the Basic Flash Parameter Table
+ * are tried fastest first: 1-4-4 DTR, 1-4-4, 1-1-4, 1-2-2, 1-1-2 and the
+ * single line fast read. The first one reading the first 256 bytes of the
+ * flash back correctly is kept, at the highest clock and the read data
+ * capture delay found stable for it. The flash must not be blank at that
+ * range for the calibration to run, else the single line fast read at the
+ * default clock stays in use. <br>
  * To see example usage, see @ref qspi_sample "QSPI Sample Application".
  * @{
  */
@@ -66,6 +80,7 @@
 #define FLASH_SECTOR_SIZE    4096U                /*!< Flash  sector size. */
 #define MAX_FLASH_DEV        4U                   /*!< Maximum number of flash devices supported. */
 #define QSPI_DEV0            0U                   /*!< QSPI device number */
+#define FLASH_XIP_WINDOW_SIZE    QSPI_XIP_WINDOW_SIZE    /*!< Largest range flash_map() can map. */
 
 /**
  * @}
@@ -77,6 +92,16 @@
  * @ingroup flash_structs
  */
 typedef struct flash_handle *flash_handle_t;
+
+/**
+ * @brief Progress of flash_update()
+ * @ingroup flash_structs
+ *
+ * Called after each erase block with the bytes of the range handled so
+ * far and the size of the range.
+ */
+typedef void (*flash_progress_t)(uint32_t done, uint32_t total,
+        void *puser_context);
 /**
  * @addtogroup flash_fns
  * @{
@@ -107,6 +132,40 @@ flash_handle_t flash_open(uint32_t flash_num);
 int flash_erase_sectors(flash_handle_t flash_handle, uint32_t address, uint32_t
         size);
 
+/**
+ * @brief Bring a flash range to the given contents.
+ *
+ * Works through the range in erase blocks, using the largest erase size
+ * the SFDP tables list (up to 64 KB) that the block fits in. A block that
+ * already holds the data is skipped. A block whose changes only clear
+ * bits is programmed without an erase. Otherwise the block is erased, and
+ * the pages to program are worked out while the erase runs. Only pages
+ * not left blank are programmed, and each block is read back after.
+ *
+ * Bytes of a partly covered block outside the range are kept. Passing
+ * NULL data erases the range, with a chip erase if the range is the whole
+ * device and the device supports one. Replaces any flash_map() mapping.
+ * The device stays busy until the update returns, other flash calls made
+ * meanwhile, including from the progress callback, fail with -EBUSY.
+ *
+ * @param[in] flash_handle  Flash handle.
+ * @param[in] address       Start address.
+ * @param[in] data          New contents, or NULL to erase.
+ * @param[in] size          Total size in bytes.
+ * @param[in] progress      Progress callback, may be NULL.
+ * @param[in] puser_context User context passed to the callback.
+ *
+ * @return
+ * - 0:          if the range holds the data.
+ * - -EINVAL:    if invalid arguments are passed.
+ * - -EBUSY:     if the device is busy.
+ * - -EIO:       if an erase, program or read back failed.
+ * - -ETIMEDOUT: if a transfer timed out.
+ */
+int flash_update(flash_handle_t flash_handle, uint32_t address,
+        const uint8_t *data, uint32_t size, flash_progress_t progress,
+        void *puser_context);
+
 /**
  * @brief Write data to the QSPI in indirect write mode synchronously.
  *
@@ -159,6 +218,48 @@ int flash_read_sync(flash_handle_t flash_handle, uint32_t address,
 int flash_set_callback(flash_handle_t const flash_handle, flash_callback_t
         callback, void *puser_context);
 
+/**
+ * @brief Map a flash range for reading in place.
+ *
+ * Maps the range into the direct access window of the controller, so
+ * flash structures can be parsed without copying them into RAM. One
+ * range is mapped at a time, mapping another one moves the window and
+ * invalidates pointers into the previous range.
+ *
+ * Writes and erases through this driver keep the mapping valid and drop
+ * stale cached copies of changed contents. Reads through the mapping must
+ * not overlap another flash operation. Asynchronous reads and writes
+ * complete in the interrupt, which does not select the mapped bank again;
+ * call flash_map() again after their callback before reading through the
+ * mapping. Each mapping is ended with flash_unmap().
+ *
+ * @param[in]  flash_handle Flash handle.
+ * @param[in]  address      Start address.
+ * @param[in]  size         Size in bytes, at most FLASH_XIP_WINDOW_SIZE and
+ *                          not crossing a 16 MB boundary.
+ * @param[out] pptr         Address the range can be read at.
+ *
+ * @return
+ * - -EINVAL:    if invalid arguments are passed or the range cannot be mapped.
+ * - -EBUSY:     if a transfer is in progress.
+ * - -ETIMEDOUT: if failed to get or release the lock.
+ * - 0:          if operation succeeded.
+ */
+int flash_map(flash_handle_t flash_handle, uint32_t address, uint32_t size,
+        const uint8_t **pptr);
+
+/**
+ * @brief Remove the mapping made by flash_map().
+ *
+ * @param[in] flash_handle Flash handle.
+ *
+ * @return
+ * - -EINVAL:    if invalid flash handle is used.
+ * - -ETIMEDOUT: if failed to get or release the lock.
+ * - 0:          if operation succeeded.
+ */
+int flash_unmap(flash_handle_t flash_handle);
+
 /**
  * @brief Close the flash descriptor.
  *
@@ -194,6 +295,8 @@ int flash_write_async(flash_handle_t flash_handle, uint32_t address,
 /**
  * @brief Read data from the QSPI in indirect read mode asynchronously.
  *
+ * Completion is reported through the callback set with flash_set_callback().
+ *
  * @param[in] flash_handle Flash handle.
  * @param[in] address      Start address.
  * @param[out] buffer      Pointer to the data buffer.
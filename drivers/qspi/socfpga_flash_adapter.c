@@ -10,66 +10,234 @@
 #include "socfpga_qspi.h"
 #include "socfpga_flash_adapter.h"
 
-int parse_m25_q_parameters(void *phandle, struct sfdp_object *sfdp)
+/*decode one 16 bit fast read field of the BFPT*/
+static void sfdp_decode_read_cmd(struct sfdp_read_cmd *cmd, uint32_t dword,
+        uint32_t shift, uint32_t supported)
 {
-    int ret = 0;
-    uint32_t flash_size[2] =
+    uint32_t field = dword >> shift;
+
+    cmd->supported = (uint8_t)(supported & 1U);
+    cmd->dummy_clocks = (uint8_t)(field & SFDP_BFPT_READ_DUMMY_MASK);
+    cmd->mode_clocks = (uint8_t)((field >> SFDP_BFPT_READ_MODE_POS) &
+            SFDP_BFPT_READ_MODE_MASK);
+    cmd->opcode = (uint8_t)((field >> SFDP_BFPT_READ_OPCODE_POS) &
+            SFDP_BFPT_READ_OPCODE_MASK);
+    if (cmd->opcode == 0U)
     {
-        0
-    }, flash_page_size[2] =
+        cmd->supported = 0U;
+    }
+}
+
+/*decode the fast read instructions and the basic geometry of the BFPT*/
+static int sfdp_decode_bfpt(struct sfdp_object *sfdp)
+{
+    const uint32_t *dw = sfdp->bfpt.dword;
+    struct sfdp_param_table *table = &sfdp->param_table[0];
+    uint32_t density;
+
+    /*JESD216 tables have at least 9 dwords*/
+    if (sfdp->bfpt.num_dwords < 9U)
     {
-        0
-    },
-            flash_page_size_bytes;
-    uint64_t flash_size_raw, flash_size_bits, flash_page_size_raw;
-    uint8_t flash_page_size_bits;
-    qspi_descriptor_t *qspi_handle = (qspi_descriptor_t *)phandle;
-    for (uint8_t i = 0; i < sfdp->std_header.num_parameter_tables; i++)
+        return -EIO;
+    }
+
+    table->address_bytes = (uint8_t)((dw[SFDP_BFPT_DW_FAST_READ] >>
+            SFDP_BFPT_ADDR_BYTES_POS) & SFDP_BFPT_ADDR_BYTES_MASK);
+    table->dtr_mode = (uint8_t)((dw[SFDP_BFPT_DW_FAST_READ] >>
+            SFDP_BFPT_DTR_SUPPORT_POS) & 1U);
+
+    density = dw[SFDP_BFPT_DW_DENSITY];
+    if ((density & SFDP_BFPT_DENSITY_EXP_MASK) != 0U)
+    {
+        density &= ~SFDP_BFPT_DENSITY_EXP_MASK;
+        table->flash_size = (density < 64U) ? ((uint64_t)1U << density) : 0U;
+    }
+    else
+    {
+        table->flash_size = (uint64_t)density + 1U;
+    }
+
+    sfdp_decode_read_cmd(&sfdp->read_cmd[SFDP_READ_1_4_4],
+            dw[SFDP_BFPT_DW_QUAD_READ], 0U, dw[SFDP_BFPT_DW_FAST_READ] >>
+            SFDP_BFPT_144_SUPPORT_POS);
+    sfdp_decode_read_cmd(&sfdp->read_cmd[SFDP_READ_1_1_4],
+            dw[SFDP_BFPT_DW_QUAD_READ], 16U, dw[SFDP_BFPT_DW_FAST_READ] >>
+            SFDP_BFPT_114_SUPPORT_POS);
+    sfdp_decode_read_cmd(&sfdp->read_cmd[SFDP_READ_1_1_2],
+            dw[SFDP_BFPT_DW_DUAL_READ], 0U, dw[SFDP_BFPT_DW_FAST_READ] >>
+            SFDP_BFPT_112_SUPPORT_POS);
+    sfdp_decode_read_cmd(&sfdp->read_cmd[SFDP_READ_1_2_2],
+            dw[SFDP_BFPT_DW_DUAL_READ], 16U, dw[SFDP_BFPT_DW_FAST_READ] >>
+            SFDP_BFPT_122_SUPPORT_POS);
+    sfdp_decode_read_cmd(&sfdp->read_cmd[SFDP_READ_2_2_2],
+            dw[SFDP_BFPT_DW_222_READ], 16U, dw[SFDP_BFPT_DW_FULL_READ] >>
+            SFDP_BFPT_222_SUPPORT_POS);
+    sfdp_decode_read_cmd(&sfdp->read_cmd[SFDP_READ_4_4_4],
+            dw[SFDP_BFPT_DW_444_READ], 16U, dw[SFDP_BFPT_DW_FULL_READ] >>
+            SFDP_BFPT_444_SUPPORT_POS);
+
+    /*erase types in order of size, unused ones have size 0*/
+    for (uint32_t i = 0U; i < SFDP_ERASE_TYPES; i++)
+    {
+        uint32_t field = dw[SFDP_BFPT_DW_ERASE_1_2 + (i / 2U)] >>
+                ((i % 2U) * SFDP_ERASE_TYPE_BITS);
+        uint32_t exp = field & SFDP_ERASE_SIZE_MASK;
+
+        sfdp->erase[i].size = ((exp != 0U) && (exp < 32U)) ?
+                ((uint32_t)1U << exp) : 0U;
+        sfdp->erase[i].opcode = (uint8_t)(field >> SFDP_ERASE_OPCODE_POS);
+    }
+
+    table->read_mode_interface = 0U;
+    for (uint32_t i = 0U; i < (uint32_t)SFDP_READ_MAX; i++)
+    {
+        table->read_mode_interface |= (uint8_t)(sfdp->read_cmd[i].supported <<
+                i);
+    }
+    return 0;
+}
+
+/*
+ * List the read instructions to try, fastest first. The instruction is
+ * always sent on one line, 2-2-2 and 4-4-4 would need every command in
+ * that width and are left out. Quad modes are left out if the flash needs
+ * a quad enable bit, which is not set. A non-zero DTR dummy count adds the
+ * 1-4-4 DTR read, whose timing the BFPT does not describe.
+ */
+static void sfdp_build_read_modes(const struct sfdp_object *sfdp,
+        qspi_descriptor_t *qspi_handle, uint8_t dtr_dummy)
+{
+    static const struct
+    {
+        enum sfdp_read_type type;
+        uint8_t addr_width;
+        uint8_t data_width;
+    } order[] =
+    {
+        { SFDP_READ_1_4_4, 2U, 2U },
+        { SFDP_READ_1_1_4, 0U, 2U },
+        { SFDP_READ_1_2_2, 1U, 1U },
+        { SFDP_READ_1_1_2, 0U, 1U },
+    };
+    const struct sfdp_read_cmd *cmd;
+    qspi_read_mode_t *mode;
+    bool quad = true;
+    uint32_t n = 0U;
+
+    if ((sfdp->bfpt.num_dwords > SFDP_BFPT_DW_QUAD_ENABLE) &&
+            (((sfdp->bfpt.dword[SFDP_BFPT_DW_QUAD_ENABLE] >>
+            SFDP_BFPT_QER_POS) & SFDP_BFPT_QER_MASK) != SFDP_BFPT_QER_NONE))
     {
-        if (i == 0U)
-        {               /*Get the flash size*/
-            ret = qspi_read_sfdp(SFDP_PARAM_FLASHSIZE_ADDR,
-                    SFDP_PARAM_FLASHSIZE_SIZE, &flash_size[0]);
-            if (ret != QSPI_OK)
-            {
-                return -EIO;
-            }
-
-            flash_size_raw =
-                    (uint64_t)((((uint64_t)flash_size[1]) <<
-                    SFDP_PARAM_FLASHSIZE_MSB_POS) | (uint64_t)flash_size[0]);
-            flash_size_bits = ((flash_size_raw >> SFDP_PARAM_FLASHSIZE_POS) &
-                    SFDP_PARAM_FLASHSIZE_MASK) + 1U;
-            qspi_handle->flash_size = (flash_size_bits >> 30);
-            sfdp->param_table[i].flash_size = (flash_size_bits >> 30);
-
-            /*Get the page size*/
-            ret = qspi_read_sfdp(SFDP_PARAM_PAGESIZE_ADDR,
-                    SFDP_PARAM_PAGESIZE_SIZE, &flash_page_size[0]);
-            if (ret != QSPI_OK)
-            {
-                return -EIO;
-            }
-
-            flash_page_size_raw =
-                    (uint64_t)((((uint64_t)flash_page_size[1]) << 32) |
-                    (uint64_t)flash_page_size[0]);
-            flash_page_size_bits =
-                    (uint8_t)((flash_page_size_raw >> SFDP_PARAM_PAGESIZE_POS) &
-                    SFDP_PARAM_PAGESIZE_MASK);
-            flash_page_size_bytes =
-                    ((uint32_t)1U << (uint32_t)flash_page_size_bits);
-            qspi_handle->page_size = flash_page_size_bytes;
-            sfdp->param_table[i].page_size = (uint8_t)qspi_handle->page_size;
+        quad = false;
+    }
+
+    if (quad && (dtr_dummy != 0U) && (sfdp->param_table[0].dtr_mode != 0U) &&
+            (sfdp->read_cmd[SFDP_READ_1_4_4].supported != 0U))
+    {
+        mode = &qspi_handle->read_modes[n++];
+        mode->opcode = SFDP_DTR_144_READ_CMD;
+        mode->inst_width = 0U;
+        mode->addr_width = 2U;
+        mode->data_width = 2U;
+        mode->mode_clocks = 0U;
+        mode->dummy_clocks = dtr_dummy;
+        mode->dtr = true;
+    }
+    for (uint32_t i = 0U; i < (sizeof(order) / sizeof(order[0])); i++)
+    {
+        cmd = &sfdp->read_cmd[order[i].type];
+        if ((cmd->supported == 0U) || ((order[i].data_width == 2U) && !quad))
+        {
+            continue;
+        }
+        mode = &qspi_handle->read_modes[n++];
+        mode->opcode = cmd->opcode;
+        mode->inst_width = 0U;
+        mode->addr_width = order[i].addr_width;
+        mode->data_width = order[i].data_width;
+        mode->mode_clocks = cmd->mode_clocks;
+        mode->dummy_clocks = cmd->dummy_clocks;
+        mode->dtr = false;
+    }
+
+    /*single line fast read, supported by every device*/
+    mode = &qspi_handle->read_modes[n++];
+    mode->opcode = QSPI_FAST_READ_CMD;
+    mode->inst_width = 0U;
+    mode->addr_width = 0U;
+    mode->data_width = 0U;
+    mode->mode_clocks = 0U;
+    mode->dummy_clocks = QSPI_FAST_READ_DUMMY;
+    mode->dtr = false;
+    qspi_handle->read_mode = *mode;
+    qspi_handle->num_read_modes = n;
+}
+
+/*hand the erase types to the flash layer, smallest first*/
+static void sfdp_build_erase_types(const struct sfdp_object *sfdp,
+        qspi_descriptor_t *qspi_handle)
+{
+    uint32_t n = 0U, j;
+
+    for (uint32_t i = 0U; i < SFDP_ERASE_TYPES; i++)
+    {
+        if (sfdp->erase[i].size == 0U)
+        {
+            continue;
+        }
+        j = n;
+        while ((j > 0U) && (qspi_handle->erase_size[j - 1U] >
+                sfdp->erase[i].size))
+        {
+            qspi_handle->erase_size[j] = qspi_handle->erase_size[j - 1U];
+            qspi_handle->erase_cmd[j] = qspi_handle->erase_cmd[j - 1U];
+            j--;
         }
+        qspi_handle->erase_size[j] = sfdp->erase[i].size;
+        qspi_handle->erase_cmd[j] = sfdp->erase[i].opcode;
+        n++;
+    }
+    while (n < QSPI_MAX_ERASE_TYPES)
+    {
+        qspi_handle->erase_size[n] = 0U;
+        qspi_handle->erase_cmd[n] = 0U;
+        n++;
     }
+}
+
+int parse_m25_q_parameters(void *phandle, struct sfdp_object *sfdp)
+{
+    uint32_t page_bits = SFDP_PARAM_PAGESIZE_DEFAULT;
+    qspi_descriptor_t *qspi_handle = (qspi_descriptor_t *)phandle;
+
+    if (sfdp_decode_bfpt(sfdp) != 0)
+    {
+        return -EIO;
+    }
+
+    /*Get the flash size*/
+    qspi_handle->flash_size = (sfdp->param_table[0].flash_size >> 30);
+
+    /*Get the page size*/
+    if (sfdp->bfpt.num_dwords > SFDP_BFPT_DW_PAGE)
+    {
+        page_bits = (sfdp->bfpt.dword[SFDP_BFPT_DW_PAGE] >>
+                SFDP_BFPT_PAGE_POS) & SFDP_BFPT_PAGE_MASK;
+    }
+    qspi_handle->page_size = ((uint32_t)1U << page_bits);
+    sfdp->param_table[0].page_size = (uint8_t)page_bits;
+
+    sfdp_build_read_modes(sfdp, qspi_handle, M25Q_DTR_DUMMY_CYCLES);
+    sfdp_build_erase_types(sfdp, qspi_handle);
+    qspi_handle->chip_erase_cmd = ((sfdp->param_table[0].flash_size / 8U) <=
+            M25Q_CHIP_ERASE_MAX) ? QSPI_CHIP_ERASE_CMD : 0U;
+
     /*These parameters are to be used with the
      * Micron M25Q flash chip
      */
     qspi_handle->inst_width = M25Q_INST_WIDTH;
-    qspi_handle->data_width = M25Q_DATA_WIDTH;
-    qspi_handle->addr_width = M25Q_ADDR_WIDTH;
     qspi_handle->baud_div = M25Q_BAUDDIV;
+    qspi_handle->read_delay = 0U;
     qspi_handle->sector_size = M25Q_SECTOR_SIZE;
     qspi_handle->clock_freq = M25Q_CLOCK_FREQ;
     qspi_handle->nss_delay = M25Q_NSS_DEALY;
@@ -77,9 +245,7 @@ int parse_m25_q_parameters(void *phandle, struct sfdp_object *sfdp)
     qspi_handle->btwn_delay = M25Q_BTWN_DELAY;
     qspi_handle->after_delay = M25Q_AFTER_DELAY;
     qspi_handle->num_addr_bytes = M25Q_NUM_ADDR_BYTES;
-    qspi_handle->dummy_cycles = M25Q_DUMMY_CYCLES;
     qspi_handle->qspi_mode = M25Q_QSPI_MODE;
 
-    return ret;
+    return 0;
 }
-
@@ -34,21 +34,48 @@
 #define SFDP_PARAM_TABLE_OFFSET_POS     40U
 #define SFDP_PARAM_TABLE_OFFSET_MASK    0xffffffU
 
-
-#define SFDP_PARAM_FLASHSIZE_ADDR       0x34U
-#define SFDP_PARAM_FLASHSIZE_SIZE       5U
-#define SFDP_PARAM_FLASHSIZE_MSB_POS    32U
-#define SFDP_PARAM_FLASHSIZE_POS        8U
-#define SFDP_PARAM_FLASHSIZE_MASK       0xffffffffU
-#define SFDP_PARAM_PAGESIZE_ADDR        0x58U
-#define SFDP_PARAM_PAGESIZE_SIZE        5U
-#define SFDP_PARAM_PAGESIZE_POS         12U
-#define SFDP_PARAM_PAGESIZE_MASK        0x0fU
+/*Basic Flash Parameter Table, JESD216*/
+#define SFDP_BFPT_MAX_DWORDS            16U
+#define SFDP_BFPT_DW_FAST_READ          0U
+#define SFDP_BFPT_DW_DENSITY            1U
+#define SFDP_BFPT_DW_QUAD_READ          2U
+#define SFDP_BFPT_DW_DUAL_READ          3U
+#define SFDP_BFPT_DW_FULL_READ          4U
+#define SFDP_BFPT_DW_222_READ           5U
+#define SFDP_BFPT_DW_444_READ           6U
+#define SFDP_BFPT_DW_ERASE_1_2          7U
+#define SFDP_BFPT_DW_ERASE_3_4          8U
+#define SFDP_BFPT_DW_PAGE               10U
+#define SFDP_BFPT_DW_QUAD_ENABLE        14U
+#define SFDP_BFPT_112_SUPPORT_POS       16U
+#define SFDP_BFPT_ADDR_BYTES_POS        17U
+#define SFDP_BFPT_ADDR_BYTES_MASK       0x3U
+#define SFDP_BFPT_DTR_SUPPORT_POS       19U
+#define SFDP_BFPT_122_SUPPORT_POS       20U
+#define SFDP_BFPT_144_SUPPORT_POS       21U
+#define SFDP_BFPT_114_SUPPORT_POS       22U
+#define SFDP_BFPT_222_SUPPORT_POS       0U
+#define SFDP_BFPT_444_SUPPORT_POS       4U
+#define SFDP_BFPT_DENSITY_EXP_MASK      0x80000000U
+#define SFDP_BFPT_READ_DUMMY_MASK       0x1fU
+#define SFDP_BFPT_READ_MODE_POS         5U
+#define SFDP_BFPT_READ_MODE_MASK        0x7U
+#define SFDP_BFPT_READ_OPCODE_POS       8U
+#define SFDP_BFPT_READ_OPCODE_MASK      0xffU
+#define SFDP_BFPT_PAGE_POS              4U
+#define SFDP_BFPT_PAGE_MASK             0xfU
+#define SFDP_BFPT_QER_POS               20U
+#define SFDP_BFPT_QER_MASK              0x7U
+#define SFDP_BFPT_QER_NONE              0U
+#define SFDP_DTR_144_READ_CMD           0xedU
+#define SFDP_PARAM_PAGESIZE_DEFAULT     8U
+#define SFDP_ERASE_TYPES                4U
+#define SFDP_ERASE_SIZE_MASK            0xffU
+#define SFDP_ERASE_OPCODE_POS           8U
+#define SFDP_ERASE_TYPE_BITS            16U
 
 
 #define M25Q_INST_WIDTH        0U
-#define M25Q_DATA_WIDTH        0U
-#define M25Q_ADDR_WIDTH        0U
 #define M25Q_BAUDDIV           0xfU
 #define M25Q_SECTOR_SIZE       4096U
 #define M25Q_CLOCK_FREQ        100000000U
@@ -57,8 +84,9 @@
 #define M25Q_BTWN_DELAY        0x14U
 #define M25Q_AFTER_DELAY       0xffU
 #define M25Q_NUM_ADDR_BYTES    2U
-#define M25Q_DUMMY_CYCLES      0U
 #define M25Q_QSPI_MODE         4U
+#define M25Q_DTR_DUMMY_CYCLES  8U   /*default of the volatile configuration*/
+#define M25Q_CHIP_ERASE_MAX    0x4000000U  /*larger parts only have die erase*/
 
 /*@brief The SFDP header structure
  *
@@ -105,6 +133,49 @@ struct sfdp_param_table
 
 };
 
+/*@brief Fast read instructions described by the BFPT
+ *
+ */
+enum sfdp_read_type
+{
+    SFDP_READ_1_1_2 = 0,
+    SFDP_READ_1_2_2,
+    SFDP_READ_1_1_4,
+    SFDP_READ_1_4_4,
+    SFDP_READ_2_2_2,
+    SFDP_READ_4_4_4,
+    SFDP_READ_MAX
+};
+
+/*@brief A fast read instruction of the BFPT
+ *
+ */
+struct sfdp_read_cmd
+{
+    uint8_t supported;
+    uint8_t opcode;
+    uint8_t mode_clocks;
+    uint8_t dummy_clocks;
+};
+
+/*@brief An erase instruction of the BFPT
+ *
+ */
+struct sfdp_erase_type
+{
+    uint32_t size;
+    uint8_t opcode;
+};
+
+/*@brief The Basic Flash Parameter Table
+ *
+ */
+struct sfdp_bfpt
+{
+    uint32_t dword[SFDP_BFPT_MAX_DWORDS];
+    uint8_t num_dwords;
+};
+
 /*@brief The Flash Adapter structure
  *
  */
@@ -113,6 +184,9 @@ struct sfdp_object
     struct sfdp_header std_header;
     struct sfdp_param_header param_header[MAX_PARAM_HEADERS];
     struct sfdp_param_table param_table[MAX_PARAM_TABLES];
+    struct sfdp_bfpt bfpt;
+    struct sfdp_read_cmd read_cmd[SFDP_READ_MAX];
+    struct sfdp_erase_type erase[SFDP_ERASE_TYPES];
 };
 
 /*@brief Function pointer to the SFDP parsing
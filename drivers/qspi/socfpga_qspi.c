@@ -8,15 +8,33 @@
 
 #include <stdint.h>
 #include <stdio.h>
+#include <string.h>
 #include "socfpga_qspi.h"
 #include "socfpga_interrupt.h"
 #include "socfpga_qspi_reg.h"
 #include "socfpga_qspi_ll.h"
 #include "socfpga_flash.h"
+#include "socfpga_cache.h"
 
 #define DEFAULT_REMAP_ADDR    0U
+#define BANK_UNKNOWN          0xFFFFFFFFU
 static uint32_t prev_bank_addr = 0x00;
 
+/*direct access mapping and the bank last selected in the flash*/
+static struct
+{
+    bool mapped;
+    uint32_t start;
+    uint32_t size;
+    uint32_t bank;
+} xip;
+static uint32_t cur_bank = BANK_UNKNOWN;
+
+#if QSPI_ENABLE_DMA_MODE
+/*the DMA callback carries no context, one controller is driven*/
+static qspi_descriptor_t *qspi_dma_desc;
+#endif
+
 /**
  * @brief Enable interrupt
  */
@@ -51,6 +69,290 @@ int32_t  qspi_set_callback(qspi_descriptor_t *qspi_handle, qspi_callback_t
     return QSPI_OK;
 }
 
+#if QSPI_ENABLE_DMA_MODE
+static void qspi_dma_done(qspi_descriptor_t *pqspi, int32_t status)
+{
+    qspi_disable_int(QSPI_XFER_LVLBRCH | QSPI_IND_OPDONE);
+    if (pqspi->is_wr_op != 0U)
+    {
+        qspi_xip_invalidate(pqspi->start_addr - (pqspi->xfer_size -
+                pqspi->bytes_left), pqspi->xfer_size - pqspi->bytes_left);
+    }
+    /*the bank switch polls the flash, the caller restores it in its task*/
+    pqspi->is_dma = false;
+    pqspi->xfer_status = status;
+    if (pqspi->is_async != 0U)
+    {
+        pqspi->is_busy = false;
+        if ((pqspi->xqspi_callback != NULL) &&
+                (*pqspi->xqspi_callback != NULL))
+        {
+            (*pqspi->xqspi_callback)((uint32_t)status, pqspi->cb_usercontext);
+        }
+    }
+    else
+    {
+        (void)osal_semaphore_post(pqspi->sem);
+    }
+}
+
+/*move len bytes between the buffer and the SRAM data port*/
+static int32_t qspi_dma_copy(qspi_descriptor_t *pqspi, uint32_t len)
+{
+    dma_xfer_cfg_t xfer = { 0 };
+
+    if (pqspi->is_wr_op != 0U)
+    {
+        xfer.src = (uint64_t)(uintptr_t)pqspi->buffer;
+        xfer.dst = (uint64_t)QSPI_DATA_BASE;
+        xfer.dst_fixed = true;
+    }
+    else
+    {
+        xfer.src = (uint64_t)QSPI_DATA_BASE;
+        xfer.dst = (uint64_t)(uintptr_t)pqspi->buffer;
+        xfer.src_fixed = true;
+    }
+    xfer.blk_size = len;
+
+    pqspi->dma_len = len;
+    if ((dma_setup_transfer(pqspi->dma, &xfer, 1U, DMA_TRANSFER_WIDTH4,
+            DMA_TRANSFER_WIDTH4) != 0) || (dma_start_transfer(pqspi->dma) !=
+            0))
+    {
+        pqspi->dma_len = 0U;
+        return QSPI_ERROR;
+    }
+    return QSPI_OK;
+}
+
+/*wait for the fill level to cover the next block of the read*/
+static void qspi_dma_arm_read(qspi_descriptor_t *pqspi)
+{
+    uint32_t want = (pqspi->seg_left < pqspi->dma_chunk) ?
+            pqspi->seg_left : pqspi->dma_chunk;
+
+    /*the breach is signalled once the fill level exceeds the watermark*/
+    qspi_set_indrdwater(want - 1U);
+    qspi_enable_interrupt(QSPI_XFER_LVLBRCH | QSPI_IND_OPDONE);
+}
+
+/*start the indirect operation for the next bank of a read or page of a write*/
+static int32_t qspi_dma_seg_start(qspi_descriptor_t *pqspi)
+{
+    uint32_t bank_addr = ((pqspi->start_addr & QSPI_BANK_ADDR_OFFSET) >>
+            QSPI_BANK_ADDR_POS);
+    uint32_t bank_offset = pqspi->start_addr & (QSPI_BANK_SIZE - 1U);
+    uint32_t sram_partition;
+    uint32_t int_status;
+    uint32_t limit;
+
+    /*a transfer runs in 256 byte pages, switch only when it crosses a bank*/
+    if ((cur_bank != bank_addr) && (qspi_select_bank(&bank_addr) != QSPI_OK))
+    {
+        return QSPI_ERROR;
+    }
+    prev_bank_addr = bank_addr;
+    int_status = qspi_get_int_status();
+    qspi_set_int_status(int_status);
+
+    if (pqspi->is_wr_op != 0U)
+    {
+        /*a page fits the write share of the SRAM, copy it in one block*/
+        limit = QSPI_PAGE_SIZE - (bank_offset & (QSPI_PAGE_SIZE - 1U));
+        pqspi->seg_left = (pqspi->bytes_left < limit) ? pqspi->bytes_left :
+                limit;
+        pqspi->seg_done = false;
+        qspi_set_indwrstaddr(bank_offset);
+        qspi_set_indwrcnt(pqspi->seg_left);
+        qspi_start_indwr();
+        qspi_enable_interrupt(QSPI_IND_OPDONE);
+        return qspi_dma_copy(pqspi, pqspi->seg_left);
+    }
+
+    limit = QSPI_BANK_SIZE - bank_offset;
+    pqspi->seg_left = (pqspi->bytes_left < limit) ? pqspi->bytes_left : limit;
+    /*half the read share, the flash refills one half while the other drains*/
+    sram_partition = ((qspi_reg_get_data((uint32_t)QSPI_SRAMPART)) &
+            QSPI_SRAM_RD_CAP_MASK);
+    pqspi->dma_chunk = (sram_partition * (uint32_t)sizeof(uint32_t)) / 2U;
+    if (pqspi->dma_chunk < sizeof(uint32_t))
+    {
+        pqspi->dma_chunk = sizeof(uint32_t);
+    }
+    qspi_set_indrdstaddr(bank_offset);
+    qspi_set_indrdcnt(pqspi->seg_left);
+    qspi_dma_arm_read(pqspi);
+    qspi_start_indrd();
+    return QSPI_OK;
+}
+
+/*
+ * Run the transfer forward, called from the QSPI and the DMA interrupt.
+ * Both share one priority, so the two never nest.
+ */
+static void qspi_dma_advance(qspi_descriptor_t *pqspi)
+{
+    uint32_t fill;
+    uint32_t len;
+    int32_t ret;
+
+    if (pqspi->dma_len != 0U)
+    {
+        /*the DMA completion calls back in*/
+        return;
+    }
+
+    if (pqspi->seg_left == 0U)
+    {
+        if (pqspi->is_wr_op != 0U)
+        {
+            if (!pqspi->seg_done)
+            {
+                /*the page is still being programmed*/
+                return;
+            }
+        }
+        else
+        {
+            qspi_clear_indrd_op_status();
+        }
+        if (pqspi->bytes_left == 0U)
+        {
+            qspi_dma_done(pqspi, QSPI_OK);
+            return;
+        }
+        ret = qspi_dma_seg_start(pqspi);
+    }
+    else
+    {
+        fill = ((qspi_get_sramfill() >> QSPI_SRAMFILL_RD_STATUS_POS) &
+                QSPI_SRAMFILL_RD_STATUS_MASK) * (uint32_t)sizeof(uint32_t);
+        len = (fill < pqspi->seg_left) ? fill : pqspi->seg_left;
+        if (len == 0U)
+        {
+            qspi_dma_arm_read(pqspi);
+            return;
+        }
+        qspi_disable_int(QSPI_XFER_LVLBRCH | QSPI_IND_OPDONE);
+        ret = qspi_dma_copy(pqspi, len);
+    }
+
+    if (ret != QSPI_OK)
+    {
+        qspi_dma_done(pqspi, QSPI_ERROR);
+    }
+}
+
+static void qspi_dma_callback(dma_handle_t pdma_handle)
+{
+    qspi_descriptor_t *pqspi = qspi_dma_desc;
+    cache_range_t range;
+    uint32_t len;
+
+    (void)pdma_handle;
+    if ((pqspi == NULL) || (pqspi->is_dma == 0U))
+    {
+        return;
+    }
+
+    len = pqspi->dma_len;
+    if (pqspi->is_wr_op == 0U)
+    {
+        /*drop lines fetched speculatively while the block was written*/
+        range.addr = pqspi->buffer;
+        range.size = len;
+        cache_range_list_op(CACHE_OP_INVALIDATE, &range, 1U);
+    }
+    pqspi->dma_len = 0U;
+    pqspi->buffer += len;
+    pqspi->start_addr += len;
+    pqspi->bytes_left -= len;
+    pqspi->seg_left -= len;
+    qspi_dma_advance(pqspi);
+}
+
+/**
+ * @brief Open the QSPI DMA channel
+ */
+int32_t qspi_dma_init(qspi_descriptor_t *qspi_handle)
+{
+    dma_config_t cfg = { 0 };
+
+    if (qspi_handle->dma != NULL)
+    {
+        return QSPI_OK;
+    }
+    qspi_handle->dma = dma_open(QSPI_DMA_INSTANCE, QSPI_DMA_CHANNEL);
+    if (qspi_handle->dma == NULL)
+    {
+        return QSPI_ERROR;
+    }
+
+    /*the controller has no request line to the DMA, the QSPI interrupts pace it*/
+    cfg.instance = (uint8_t)QSPI_DMA_INSTANCE;
+    cfg.ch_dir = DMA_MEM_TO_MEM_DMAC;
+    cfg.ch_prio = 0U;
+    cfg.peri_id = DMA_INVALID_CH;
+    cfg.callback = qspi_dma_callback;
+    if (dma_config(qspi_handle->dma, &cfg) != 0)
+    {
+        (void)dma_close(qspi_handle->dma);
+        qspi_handle->dma = NULL;
+        return QSPI_ERROR;
+    }
+    qspi_dma_desc = qspi_handle;
+    return QSPI_OK;
+}
+
+/**
+ * @brief Close the QSPI DMA channel
+ */
+void qspi_dma_deinit(qspi_descriptor_t *qspi_handle)
+{
+    if (qspi_handle->dma != NULL)
+    {
+        (void)dma_close(qspi_handle->dma);
+        qspi_handle->dma = NULL;
+    }
+    qspi_dma_desc = NULL;
+}
+
+/**
+ * @brief Start a DMA driven indirect transfer
+ */
+int32_t qspi_dma_start(qspi_descriptor_t *qspi_handle)
+{
+    cache_range_t range;
+
+    if ((qspi_handle->dma == NULL) || (qspi_handle->bytes_left == 0U) ||
+            ((((uintptr_t)qspi_handle->buffer) | qspi_handle->bytes_left) &
+            (sizeof(uint32_t) - 1U)) != 0U)
+    {
+        return QSPI_ERROR;
+    }
+
+    /*
+     * Writes need the data in memory. Reads must not have dirty lines
+     * evicted over the data the DMA stores.
+     */
+    range.addr = qspi_handle->buffer;
+    range.size = qspi_handle->bytes_left;
+    cache_range_list_op((qspi_handle->is_wr_op != 0U) ? CACHE_OP_CLEAN :
+            CACHE_OP_FLUSH, &range, 1U);
+
+    qspi_handle->xfer_status = QSPI_OK;
+    qspi_handle->dma_len = 0U;
+    qspi_handle->is_dma = true;
+    if (qspi_dma_seg_start(qspi_handle) != QSPI_OK)
+    {
+        qspi_disable_int(QSPI_XFER_LVLBRCH | QSPI_IND_OPDONE);
+        qspi_handle->is_dma = false;
+        return QSPI_ERROR;
+    }
+    return QSPI_OK;
+}
+#endif
 
 /**
  * @brief QSPI ISR
@@ -65,6 +367,20 @@ void qspi_isr(void *pparam){
     status = qspi_get_int_status();
     qspi_set_int_status(status);
 
+#if QSPI_ENABLE_DMA_MODE
+    if (pqspi_peripheral->is_dma != 0U)
+    {
+        if (((status & QSPI_IND_OPDONE) != 0U) &&
+                (pqspi_peripheral->is_wr_op != 0U))
+        {
+            qspi_clear_indwr_op_status();
+            pqspi_peripheral->seg_done = true;
+        }
+        qspi_dma_advance(pqspi_peripheral);
+        return;
+    }
+#endif
+
     if (((status & QSPI_IND_OPDONE) != 0U) || ((status & QSPI_XFER_LVLBRCH) !=
             0U))
     {
@@ -91,6 +407,9 @@ void qspi_isr(void *pparam){
                     {
                         qspi_clear_indwr_op_status();
                     }
+                    qspi_xip_invalidate(pqspi_peripheral->start_addr -
+                            pqspi_peripheral->xfer_size,
+                            pqspi_peripheral->xfer_size);
                     if (pqspi_peripheral->is_async != 0U)
                     {
                         (*pqspi_peripheral->xqspi_callback)(QSPI_OK,
@@ -152,6 +471,56 @@ void qspi_isr(void *pparam){
 }
 #endif
 
+/*program a read instruction into devrd, the controller must be disabled*/
+static int32_t qspi_apply_read_mode(const qspi_read_mode_t *mode)
+{
+    uint32_t bits_per_clock, mode_byte_clocks, dummy;
+
+    /*the mode byte goes out on the address lines, on both edges for DTR*/
+    bits_per_clock = ((uint32_t)1U << mode->addr_width) * (mode->dtr ? 2U :
+            1U);
+    mode_byte_clocks = 8U / bits_per_clock;
+    dummy = (uint32_t)mode->dummy_clocks + mode->mode_clocks;
+    if (mode->mode_clocks >= mode_byte_clocks)
+    {
+        /*drive the mode bits rather than leave the lines floating*/
+        dummy -= mode_byte_clocks;
+    }
+    /*
+     * The instruction width of devrd applies to every instruction the
+     * controller sends, and the flash is never switched out of single line
+     * commands, so only single line read instructions are usable
+     */
+    if ((dummy > QSPI_MAX_DUMMY_CLOCKS) || (mode->inst_width != 0U) ||
+            (mode->addr_width > 2U) || (mode->data_width > 2U))
+    {
+        return QSPI_ERROR;
+    }
+
+    qspi_set_read_opcode(mode->opcode);
+    qspi_set_addr_width(mode->addr_width);
+    qspi_set_data_width(mode->data_width);
+    qspi_enable_ddr(mode->dtr ? 1U : 0U);
+    qspi_set_mode_bits(QSPI_READ_MODE_BITS);
+    qspi_enable_mode_bit((mode->mode_clocks >= mode_byte_clocks) ? 1U : 0U);
+    qspi_set_dummy_delay((uint8_t)dummy);
+    return QSPI_OK;
+}
+
+/*change the read clock, the controller is briefly disabled*/
+static int32_t qspi_set_read_timing(uint32_t baud_div, uint32_t delay)
+{
+    if (qspi_is_busy() != 0U)
+    {
+        return QSPI_BUSY;
+    }
+    qspi_disable();
+    qspi_set_baud_divisor(baud_div);
+    qspi_set_read_capture_delay(delay);
+    qspi_enable();
+    return QSPI_OK;
+}
+
 /**
  * @brief Initialize QSPI interface
  */
@@ -189,14 +558,14 @@ int32_t qspi_init(qspi_descriptor_t *qspi_handle)
     qspi_set_init_delay(qspi_handle->init_delay);
     qspi_set_remap_address(DEFAULT_REMAP_ADDR);
     qspi_set_bytes_per_page(qspi_handle->page_size);
-    qspi_enable_fast_read_mode();
     qspi_set_instruction_width(qspi_handle->inst_width);
-    qspi_set_addr_width(qspi_handle->addr_width);
-    qspi_set_data_width(qspi_handle->data_width);
-    qspi_enable_mode_bit(1);
-    qspi_set_dummy_delay(qspi_handle->dummy_cycles);
+    if (qspi_apply_read_mode(&qspi_handle->read_mode) != QSPI_OK)
+    {
+        return QSPI_ERROR;
+    }
     qspi_cfg_write_mode();
     qspi_set_baud_divisor(qspi_handle->baud_div);
+    qspi_set_read_capture_delay(qspi_handle->read_delay);
     qspi_enable();
 
     status = qspi_get_int_status();
@@ -413,9 +782,9 @@ int32_t qspi_wait_for_eraseand_program(void)
 }
 
 /**
- * @brief Send command for QSPI sector erase
+ * @brief Start an erase without waiting for it
  */
-int32_t qspi_erase(uint32_t address)
+int32_t qspi_erase_start(uint32_t address, uint8_t opcode, bool with_addr)
 {
 
     int32_t ret = QSPI_OK;
@@ -433,6 +802,7 @@ int32_t qspi_erase(uint32_t address)
     {
         return QSPI_ERROR;
     }
+    cur_bank = bank_addr;
 
     ret = qspi_send_flashcmd(QSPI_WRITE_DISABLE_CMD);
     if (ret != QSPI_OK)
@@ -441,7 +811,7 @@ int32_t qspi_erase(uint32_t address)
         return QSPI_ERROR;
     }
 
-    /*Start of sequence for 4k erase*/
+    /*Start of sequence for the erase*/
     ret = qspi_send_flashcmd(QSPI_WRITE_ENABLE_CMD);
     if (ret != QSPI_OK)
     {
@@ -449,16 +819,35 @@ int32_t qspi_erase(uint32_t address)
     }
 
     qspi_select_chip(0);
-    qspi_set_flashcmd(QSPI_SECTOR_ERASE_CMD);
-    qspi_set_enablecmdaddr();
-    qspi_set_flashcmdaddrbytes(3);
-    qspi_set_flashcmdaddr(address);
+    qspi_set_flashcmd(opcode);
+    if (with_addr)
+    {
+        qspi_set_enablecmdaddr();
+        qspi_set_flashcmdaddrbytes(3);
+        qspi_set_flashcmdaddr(address);
+    }
 
-    ret = qspi_flash_cmd_helper();
-    if (ret != QSPI_OK)
+    return qspi_flash_cmd_helper();
+}
+
+/**
+ * @brief Send command for QSPI sector erase
+ */
+int32_t qspi_erase(uint32_t address)
+{
+    if (qspi_erase_start(address, QSPI_SECTOR_ERASE_CMD, true) != QSPI_OK)
     {
         return QSPI_ERROR;
     }
+    return qspi_erase_wait();
+}
+
+/**
+ * @brief Wait for an erase started by qspi_erase_start
+ */
+int32_t qspi_erase_wait(void)
+{
+    int32_t ret;
 
     ret = qspi_wait_for_eraseand_program();
     if (ret != QSPI_OK)
@@ -522,6 +911,7 @@ int32_t qspi_select_bank(uint32_t *bank_addr)
     {
         return QSPI_ERROR;
     }
+    cur_bank = *bank_addr;
 
     ret = qspi_send_flashcmd(QSPI_WRITE_DISABLE_CMD);
     if (ret != QSPI_OK)
@@ -976,6 +1366,203 @@ int32_t qspi_indirect_read(uint32_t address, uint8_t *buffer, uint32_t size,
 #endif
 }
 
+/**
+ * @brief Program the read instruction
+ */
+int32_t qspi_set_read_mode(qspi_descriptor_t *qspi_handle,
+        const qspi_read_mode_t *mode)
+{
+    int32_t ret;
+
+    if ((qspi_handle == NULL) || (mode == NULL))
+    {
+        return QSPI_ERROR;
+    }
+    if (qspi_is_busy() != 0U)
+    {
+        return QSPI_BUSY;
+    }
+    qspi_disable();
+    ret = qspi_apply_read_mode(mode);
+    if (ret != QSPI_OK)
+    {
+        /*keep the working instruction*/
+        (void)qspi_apply_read_mode(&qspi_handle->read_mode);
+    }
+    else
+    {
+        qspi_handle->read_mode = *mode;
+    }
+    qspi_enable();
+    return ret;
+}
+
+/*read the mapped range afresh and compare it with the reference*/
+static bool qspi_cal_read_ok(const uint8_t *win, const uint8_t *ref,
+        uint32_t size)
+{
+    cache_range_t range;
+
+    range.addr = (void *)(uintptr_t)win;
+    range.size = size;
+    cache_range_list_op(CACHE_OP_INVALIDATE, &range, 1U);
+    return memcmp(win, ref, size) == 0;
+}
+
+/**
+ * @brief Calibrate the read clock and the read data capture delay
+ */
+int32_t qspi_calibrate_read(qspi_descriptor_t *qspi_handle, uint32_t address,
+        const uint8_t *ref, uint32_t size)
+{
+    const uint8_t *win;
+    uint32_t div, delay, first, len, best_first, best_len;
+
+    if ((qspi_handle == NULL) || (ref == NULL) ||
+            (qspi_xip_map(address, size, &win) != QSPI_OK))
+    {
+        return QSPI_ERROR;
+    }
+
+    /*the lowest divisor first, the first one with a window is the fastest*/
+    for (div = QSPI_CAL_MIN_BAUDDIV; div <= qspi_handle->baud_div; div++)
+    {
+        first = 0U;
+        len = 0U;
+        best_first = 0U;
+        best_len = 0U;
+        for (delay = 0U; delay <= QSPI_RDDATACAP_DELAY_MASK; delay++)
+        {
+            if (qspi_set_read_timing(div, delay) != QSPI_OK)
+            {
+                qspi_xip_unmap();
+                return QSPI_ERROR;
+            }
+            if (!qspi_cal_read_ok(win, ref, size))
+            {
+                len = 0U;
+                continue;
+            }
+            if (len == 0U)
+            {
+                first = delay;
+            }
+            len++;
+            if (len > best_len)
+            {
+                best_first = first;
+                best_len = len;
+            }
+        }
+        if (best_len >= QSPI_CAL_MIN_WINDOW)
+        {
+            qspi_handle->baud_div = div;
+            qspi_handle->read_delay = best_first + ((best_len - 1U) / 2U);
+            (void)qspi_set_read_timing(qspi_handle->baud_div,
+                    qspi_handle->read_delay);
+            qspi_xip_unmap();
+            return QSPI_OK;
+        }
+    }
+
+    (void)qspi_set_read_timing(qspi_handle->baud_div, qspi_handle->read_delay);
+    qspi_xip_unmap();
+    return QSPI_ERROR;
+}
+
+/**
+ * @brief Map a flash range into the direct access window
+ */
+int32_t qspi_xip_map(uint32_t address, uint32_t size, const uint8_t **pptr)
+{
+    uint32_t bank_addr = ((address & QSPI_BANK_ADDR_OFFSET) >>
+            QSPI_BANK_ADDR_POS);
+    uint32_t bank_offset = address & (QSPI_BANK_SIZE - 1U);
+    cache_range_t range;
+
+    if ((pptr == NULL) || (size == 0U) || (size > QSPI_XIP_WINDOW_SIZE) ||
+            (size > (QSPI_BANK_SIZE - bank_offset)))
+    {
+        return QSPI_ERROR;
+    }
+    if ((cur_bank != bank_addr) && (qspi_select_bank(&bank_addr) != QSPI_OK))
+    {
+        return QSPI_ERROR;
+    }
+
+    /*
+     * The flash sees the window offset plus the remap address. Only the
+     * low 24 bits reach it, the bank register supplies the rest, so the
+     * subtraction may wrap.
+     */
+    qspi_set_remap_address(bank_offset - QSPI_XIP_GUARD);
+    qspi_enable_direct_access(1U);
+
+    /*the window may still hold lines of the previous mapping*/
+    range.addr = (void *)(uintptr_t)(QSPI_DATA_BASE + QSPI_XIP_GUARD);
+    range.size = size;
+    cache_range_list_op(CACHE_OP_INVALIDATE, &range, 1U);
+
+    xip.start = address;
+    xip.size = size;
+    xip.bank = bank_addr;
+    xip.mapped = true;
+    *pptr = (const uint8_t *)(uintptr_t)(QSPI_DATA_BASE + QSPI_XIP_GUARD);
+    return QSPI_OK;
+}
+
+/**
+ * @brief Remove the direct access mapping
+ */
+void qspi_xip_unmap(void)
+{
+    if (xip.mapped)
+    {
+        qspi_enable_direct_access(0U);
+        qspi_set_remap_address(DEFAULT_REMAP_ADDR);
+        xip.mapped = false;
+    }
+}
+
+/**
+ * @brief Select the mapped bank again after an indirect operation
+ */
+int32_t qspi_xip_restore(void)
+{
+    uint32_t bank_addr = xip.bank;
+
+    if ((!xip.mapped) || (cur_bank == bank_addr))
+    {
+        return QSPI_OK;
+    }
+    return qspi_select_bank(&bank_addr);
+}
+
+/**
+ * @brief Invalidate mapped lines of a programmed or erased range
+ */
+void qspi_xip_invalidate(uint32_t address, uint32_t size)
+{
+    uint32_t start, end;
+    cache_range_t range;
+
+    if (!xip.mapped)
+    {
+        return;
+    }
+    start = (address > xip.start) ? address : xip.start;
+    end = ((address + size) < (xip.start + xip.size)) ? (address + size) :
+            (xip.start + xip.size);
+    if (start >= end)
+    {
+        return;
+    }
+    range.addr = (void *)(uintptr_t)(QSPI_DATA_BASE + QSPI_XIP_GUARD +
+            (start - xip.start));
+    range.size = end - start;
+    cache_range_list_op(CACHE_OP_INVALIDATE, &range, 1U);
+}
+
 /**
  * @brief Deinitialize QSPI interface
  */
@@ -990,6 +1577,7 @@ int32_t qspi_deinit(void)
     qspi_disable_interrupt(QSPI_ALL_INT_MASK);
 #endif
 
+    qspi_xip_unmap();
     qspi_disable();
     if (qspi_is_busy() != 0U)
     {
@@ -12,9 +12,24 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include "socfpga_defines.h"
+#include "socfpga_dma.h"
 
 #define QSPI_ENABLE_INT_MODE    1U
 
+/*move indirect SRAM data with the DMA controller, needs the interrupt mode*/
+#if QSPI_ENABLE_INT_MODE
+#define QSPI_ENABLE_DMA_MODE    1U
+#else
+#define QSPI_ENABLE_DMA_MODE    0U
+#endif
+
+#ifndef QSPI_DMA_INSTANCE
+#define QSPI_DMA_INSTANCE    DMA_INSTANCE1
+#endif
+#ifndef QSPI_DMA_CHANNEL
+#define QSPI_DMA_CHANNEL     DMA_CH4
+#endif
+
 #define QSPI_BUSY                      1
 #define QSPI_OK                        0
 #define QSPI_ERROR                     -1
@@ -32,6 +47,8 @@
 #define QSPI_WRITE_ENABLE_CMD           0x06U
 #define QSPI_WRITE_DISABLE_CMD          0x04U
 #define QSPI_SECTOR_ERASE_CMD           0x20U
+#define QSPI_CHIP_ERASE_CMD             0xc7U
+#define QSPI_MAX_ERASE_TYPES            4U
 #define QSPI_READ_SFDP_CMD              0x5aU
 #define QSPI_READ_STATUS_CMD            0x5U
 #define QSPI_READ_STATUS_POS            0x1U
@@ -64,6 +81,23 @@
 #define QSPI_IND_OPDONE      0x4U
 #define QSPI_XFER_LVLBRCH    0x40U
 
+/*start of the 1 MB AHB window, kept clear of the indirect trigger address*/
+#define QSPI_XIP_GUARD          0x1000U
+#define QSPI_XIP_WINDOW_SIZE    (0x100000U - QSPI_XIP_GUARD)
+
+/*read modes tried and the calibration of the fastest one that works*/
+#define QSPI_MAX_READ_MODES     6U
+#define QSPI_FAST_READ_CMD      0x0bU
+#define QSPI_FAST_READ_DUMMY    8U
+#define QSPI_READ_MODE_BITS     0xffU
+#define QSPI_MAX_DUMMY_CLOCKS   0x1fU
+#ifndef QSPI_CAL_MIN_BAUDDIV
+#define QSPI_CAL_MIN_BAUDDIV    0U
+#endif
+#ifndef QSPI_CAL_MIN_WINDOW
+#define QSPI_CAL_MIN_WINDOW     2U
+#endif
+
 /**
  * @brief This is the FlashCallback
  *
@@ -76,6 +110,25 @@ typedef void (*flash_callback_t)(uint32_t op_status, void *puser_context);
  */
 typedef flash_callback_t *qspi_callback_t;
 
+/**
+ * @brief Read instruction and the clocks between its address and data
+ *
+ * Widths are 0 for one line, 1 for two and 2 for four. The instruction
+ * itself always goes out on one line, inst_width other than 0 is rejected.
+ * Mode clocks are the clocks the flash samples mode bits in, dummy clocks
+ * follow them.
+ */
+typedef struct
+{
+    uint8_t opcode;
+    uint8_t inst_width;
+    uint8_t addr_width;
+    uint8_t data_width;
+    uint8_t mode_clocks;
+    uint8_t dummy_clocks;
+    bool dtr;
+} qspi_read_mode_t;
+
 /*
  * @brief This is the structure used to hold the flash
  *        descriptor variables
@@ -83,9 +136,14 @@ typedef flash_callback_t *qspi_callback_t;
 typedef struct qpsi_descriptor
 {
     uint32_t inst_width;
-    uint32_t addr_width;
-    uint32_t data_width;
     uint32_t baud_div;
+    uint32_t read_delay;
+    qspi_read_mode_t read_mode;
+    qspi_read_mode_t read_modes[QSPI_MAX_READ_MODES];
+    uint32_t num_read_modes;
+    uint32_t erase_size[QSPI_MAX_ERASE_TYPES];
+    uint8_t erase_cmd[QSPI_MAX_ERASE_TYPES];
+    uint8_t chip_erase_cmd;
     uint64_t flash_size;
     uint32_t sector_size;
     uint32_t page_size;
@@ -95,7 +153,6 @@ typedef struct qpsi_descriptor
     uint32_t after_delay;
     uint32_t btwn_delay;
     uint32_t num_addr_bytes;
-    uint8_t dummy_cycles;
     uint8_t qspi_mode;
 
     osal_semaphore_t sem;
@@ -109,6 +166,15 @@ typedef struct qpsi_descriptor
     BaseType_t is_async;
     BaseType_t is_busy;
     qspi_callback_t xqspi_callback;
+
+    /*DMA transfer state, see qspi_dma_start()*/
+    dma_handle_t dma;
+    BaseType_t is_dma;
+    BaseType_t seg_done;
+    uint32_t seg_left;
+    uint32_t dma_len;
+    uint32_t dma_chunk;
+    int32_t xfer_status;
 } qspi_descriptor_t;
 
 /**
@@ -336,6 +402,32 @@ int32_t qspi_wait_for_eraseand_program(void);
  */
 int32_t qspi_erase(uint32_t address);
 
+/**
+ * @brief Start an erase and return while the flash is busy.
+ *
+ * Selects the bank of the address. qspi_erase_wait() must follow before
+ * any other flash access.
+ *
+ * @param[in] address   Address in the block to be erased.
+ * @param[in] opcode    Erase instruction.
+ * @param[in] with_addr false for instructions without an address, such
+ *                      as chip erase.
+ *
+ * @return
+ * - QSPI_ERROR: if the erase could not be started.
+ * - QSPI_OK:    if the erase is running.
+ */
+int32_t qspi_erase_start(uint32_t address, uint8_t opcode, bool with_addr);
+
+/**
+ * @brief Wait for an erase started by qspi_erase_start().
+ *
+ * @return
+ * - QSPI_ERROR: if the erase failed.
+ * - QSPI_OK:    if the erase is complete.
+ */
+int32_t qspi_erase_wait(void);
+
 /**
  * @brief Deinitialize the flash handle.
  *
@@ -358,6 +450,139 @@ int32_t qspi_deinit(void);
 int32_t qspi_set_callback(qspi_descriptor_t *qspi_handle, qspi_callback_t
         callback, void *puser_context);
 
+#if QSPI_ENABLE_DMA_MODE
+/**
+ * @brief Open the DMA channel used for indirect transfers.
+ *
+ * @param[in,out] qspi_handle Pointer to the QSPI descriptor.
+ *
+ * @return
+ * - QSPI_ERROR: if the channel could not be opened or configured.
+ * - QSPI_OK:    if the channel is ready.
+ */
+int32_t qspi_dma_init(qspi_descriptor_t *qspi_handle);
+
+/**
+ * @brief Close the DMA channel used for indirect transfers.
+ *
+ * @param[in,out] qspi_handle Pointer to the QSPI descriptor.
+ *
+ * @return none
+ */
+void qspi_dma_deinit(qspi_descriptor_t *qspi_handle);
+
+/**
+ * @brief Start an indirect transfer moved by the DMA controller.
+ *
+ * Transfers bytes_left bytes between buffer and the flash at start_addr,
+ * in the direction given by is_wr_op. Reads are split at 16 MB banks and
+ * pulled out of the SRAM each time its fill level breaches the watermark,
+ * writes are split at pages. The CPU takes part only in the interrupts
+ * between DMA blocks.
+ *
+ * The buffer address and the size must be multiples of 4. Completion is
+ * reported through the callback when is_async is set, else through the
+ * semaphore, with the result in xfer_status.
+ *
+ * @param[in,out] qspi_handle Pointer to the QSPI descriptor.
+ *
+ * @return
+ * - QSPI_ERROR: if the transfer could not be started, nothing is reported.
+ * - QSPI_OK:    if the transfer is started.
+ */
+int32_t qspi_dma_start(qspi_descriptor_t *qspi_handle);
+#endif
+
+/**
+ * @brief Program the read instruction used by indirect and direct reads.
+ *
+ * Stores the mode in the descriptor, which qspi_init() applies again.
+ *
+ * @param[in,out] qspi_handle Pointer to the QSPI descriptor.
+ * @param[in]     mode        Read instruction to use.
+ *
+ * @return
+ * - QSPI_ERROR: if the controller cannot send the instruction.
+ * - QSPI_BUSY:  if the controller is busy.
+ * - QSPI_OK:    if the instruction is set.
+ */
+int32_t qspi_set_read_mode(qspi_descriptor_t *qspi_handle,
+        const qspi_read_mode_t *mode);
+
+/**
+ * @brief Find the fastest clock the current read mode works at.
+ *
+ * Reads the range through the direct access window for each baud
+ * divisor from QSPI_CAL_MIN_BAUDDIV up to the one in the descriptor and
+ * each read data capture delay, comparing against data read before at a
+ * known good setting. The first divisor with at least QSPI_CAL_MIN_WINDOW
+ * consecutive passing delays is kept, with the delay centred in the
+ * widest window. Replaces any direct access mapping.
+ *
+ * @param[in,out] qspi_handle Pointer to the QSPI descriptor, baud_div and
+ *                            read_delay are updated on success.
+ * @param[in]     address     Start address of the reference data.
+ * @param[in]     ref         Reference data.
+ * @param[in]     size        Size of the reference data.
+ *
+ * @return
+ * - QSPI_ERROR: if no setting reads the data back, the previous divisor
+ *               and delay are restored.
+ * - QSPI_OK:    if a setting is found and applied.
+ */
+int32_t qspi_calibrate_read(qspi_descriptor_t *qspi_handle, uint32_t address,
+        const uint8_t *ref, uint32_t size);
+
+/**
+ * @brief Map a flash range into the direct access window.
+ *
+ * Replaces any earlier mapping. The range must not cross a 16 MB bank.
+ *
+ * @param[in]  address Start address in the flash.
+ * @param[in]  size    Size of the range, at most QSPI_XIP_WINDOW_SIZE.
+ * @param[out] pptr    Address the range is readable at.
+ *
+ * @return
+ * - QSPI_ERROR: if the range cannot be mapped.
+ * - QSPI_OK:    if the range is mapped.
+ */
+int32_t qspi_xip_map(uint32_t address, uint32_t size, const uint8_t **pptr);
+
+/**
+ * @brief Remove the mapping of the direct access window.
+ *
+ * @param none
+ *
+ * @return none
+ */
+void qspi_xip_unmap(void);
+
+/**
+ * @brief Bring the mapping back after an indirect operation.
+ *
+ * Indirect operations may select another 16 MB bank, which the direct
+ * window then reads from. Selects the mapped bank again if needed. The
+ * bank switch polls the flash, so this is called from task context once
+ * the operation completed, never from the interrupt.
+ *
+ * @param none
+ *
+ * @return
+ * - QSPI_ERROR: if the bank could not be selected.
+ * - QSPI_OK:    if the mapping is valid or nothing is mapped.
+ */
+int32_t qspi_xip_restore(void);
+
+/**
+ * @brief Drop cached copies of mapped flash contents that have changed.
+ *
+ * @param[in] address Start address of the programmed or erased range.
+ * @param[in] size    Size of the range.
+ *
+ * @return none
+ */
+void qspi_xip_invalidate(uint32_t address, uint32_t size);
+
 /**
  * @brief QSPI isr function.
  *
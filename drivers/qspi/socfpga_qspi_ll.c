@@ -186,6 +186,69 @@ void qspi_enable_fast_read_mode(void)
     WR_REG32(QSPI_DEVRD, devrd);
 }
 
+/**
+ * @brief Set the opcode of the read instruction.
+ *
+ * @param[in] opcode The read instruction opcode.
+ *
+ * @return NONE
+ */
+void qspi_set_read_opcode(uint8_t opcode)
+{
+    uint32_t devrd = RD_REG32(QSPI_DEVRD);
+    devrd = (devrd & ~QSPI_DEVRD_OPCODE_MASK) | (uint32_t)opcode;
+    WR_REG32(QSPI_DEVRD, devrd);
+}
+
+/**
+ * @brief Enable or disable double transfer rate reads.
+ *
+ * @param[in] enable 1 for enable and 0 for disable.
+ *
+ * @return NONE
+ */
+void qspi_enable_ddr(uint32_t enable)
+{
+    uint32_t devrd = RD_REG32(QSPI_DEVRD);
+    if (enable != 0U)
+    {
+        devrd |= ((uint32_t)QSPI_DEVRD_DDR_MASK << QSPI_DEVRD_DDR_POS);
+    }
+    else
+    {
+        devrd &= ~((uint32_t)QSPI_DEVRD_DDR_MASK << QSPI_DEVRD_DDR_POS);
+    }
+    WR_REG32(QSPI_DEVRD, devrd);
+}
+
+/**
+ * @brief Set the mode bits sent after the read address.
+ *
+ * @param[in] mode_bits The mode byte.
+ *
+ * @return NONE
+ */
+void qspi_set_mode_bits(uint8_t mode_bits)
+{
+    WR_REG32(QSPI_MODEBIT, ((uint32_t)mode_bits & QSPI_MODEBIT_MASK));
+}
+
+/**
+ * @brief Set the read data capture delay.
+ *
+ * @param[in] delay Number of reference clocks the capture is delayed by.
+ *
+ * @return NONE
+ */
+void qspi_set_read_capture_delay(uint32_t delay)
+{
+    uint32_t rdcap = RD_REG32(QSPI_RDDATACAP);
+    rdcap = (rdcap & ~(QSPI_RDDATACAP_DELAY_MASK <<
+            QSPI_RDDATACAP_DELAY_POS)) | ((delay &
+            QSPI_RDDATACAP_DELAY_MASK) << QSPI_RDDATACAP_DELAY_POS);
+    WR_REG32(QSPI_RDDATACAP, rdcap);
+}
+
 /**
  * @brief Obtain a flash handle.
  *
@@ -299,6 +362,27 @@ void qspi_set_remap_address(uint32_t address)
     WR_REG32(QSPI_REMAPADDR, address);
 }
 
+/**
+ * @brief Enable or disable direct access through the remapped AHB window.
+ *
+ * @param[in] enable 1 for enable and 0 for disable.
+ *
+ * @return NONE
+ */
+void qspi_enable_direct_access(uint32_t enable)
+{
+    uint32_t cfg = RD_REG32(QSPI_CFG);
+    if (enable != 0U)
+    {
+        cfg |= (QSPI_CFG_ENDIRACC_MASK | QSPI_CFG_ENAHBREMAP_MASK);
+    }
+    else
+    {
+        cfg &= ~(QSPI_CFG_ENDIRACC_MASK | QSPI_CFG_ENAHBREMAP_MASK);
+    }
+    WR_REG32(QSPI_CFG, cfg);
+}
+
 /**
  * @brief Set the baud divisor.
  *
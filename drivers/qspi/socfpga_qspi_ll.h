@@ -32,6 +32,14 @@ void qspi_set_instruction_width(uint32_t width);
 
 void qspi_enable_mode_bit(uint32_t enable);
 
+void qspi_set_read_opcode(uint8_t opcode);
+
+void qspi_enable_ddr(uint32_t enable);
+
+void qspi_set_mode_bits(uint8_t mode_bits);
+
+void qspi_set_read_capture_delay(uint32_t delay);
+
 void qspi_set_bytes_per_page(uint32_t page_bytes);
 
 void qspi_set_nss_delay(uint32_t nss_delay);
@@ -44,6 +52,8 @@ void qspi_set_init_delay(uint32_t init_delay);
 
 void qspi_set_remap_address(uint32_t address);
 
+void qspi_enable_direct_access(uint32_t enable);
+
 void qspi_set_baud_divisor(uint32_t divisor);
 
 void qspi_enable(void);
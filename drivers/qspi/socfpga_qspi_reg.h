@@ -58,7 +58,8 @@
 #define QSPI_REMAPADDR           QSPI_CSR_BASE_ADDRESS + QSPI_REMAPADDR_OFFSET
 
 /* Mode Bit Configuration Register */
-#define QSPI_MODEBIT             0x28U
+#define QSPI_MODEBIT_OFFSET      0x28U
+#define QSPI_MODEBIT             QSPI_CSR_BASE_ADDRESS + QSPI_MODEBIT_OFFSET
 
 /* SRAM Fill Register */
 #define QSPI_SRAMFILL_OFFSET     0x2CU
@@ -191,6 +192,12 @@
 #define QSPI_DEVRD_DATAWIDTH_MASK            0x3U
 #define QSPI_DEVRD_MODEBIT_POS               20U
 #define QSPI_DEVRD_MODEBIT_MASK              1U
+#define QSPI_DEVRD_OPCODE_MASK               0xFFU
+#define QSPI_DEVRD_DDR_POS                   10U
+#define QSPI_DEVRD_DDR_MASK                  1U
+#define QSPI_RDDATACAP_DELAY_POS             1U
+#define QSPI_RDDATACAP_DELAY_MASK            0xFU
+#define QSPI_MODEBIT_MASK                    0xFFU
 #define QSPI_DUMMY_DELAY_POS                 24U
 #define QSPI_DUMMY_DELAY_MASK                0x1FU
 #define QSPI_SUBSECTOR_BYTES_POS             16U
@@ -233,6 +240,10 @@
 #define QSPI_CFG_BAUDDIV_MASK       (0UxFU << 19U)
 #define QSPI_CFG_BAUDDIV_POS        19U
 
+/* 16U: Enable AHB Address Remapping */
+#define QSPI_CFG_ENAHBREMAP_MASK    (1U << 16U)
+#define QSPI_CFG_ENAHBREMAP_POS     16U
+
 /* 15U: Enable DMA Mode */
 #define QSPI_CFG_ENDMA_MASK         (1U << 15U)
 #define QSPI_CFG_ENDMA_POS          15U
@@ -82,6 +82,9 @@
 #define MAX_CLIENT_INSTANCES       16U
 #define MAX_JOB_ID                 16U
 #define JOB_POOL_FULL              0xFFFFU
+#ifndef MBOX_CLIENT_WINDOW
+#define MBOX_CLIENT_WINDOW         1U
+#endif
 #define SIP_SMC_GET_RESP           0x420000C8U
 #define SIP_SMC_GET_TRANS_ID       0x420000C9U
 #define SIP_GENERIC_MAILBOX_CMD    0x420000EEU
@@ -93,21 +96,31 @@
 #define MBOX_TASK_CLOSED    0U
 #define MBOX_TASK_OPEN      1U
 #define MBOX_TASK_BUSY      2U
+#define MBOX_TRANS_WORDS    4U
+#define MBOX_MAX_TRANS      (MBOX_TRANS_WORDS * 64U)
+#ifndef MBOX_POLL_MAX_ROUNDS
+#define MBOX_POLL_MAX_ROUNDS    8U
+#endif
 
 typedef struct
 {
     uint64_t *resp_data;
     uint64_t resp_len;
+    void *context;
+    uint64_t sent;
 } job_id_resp_map;
 struct sdm_client_descriptor
 {
     uint16_t job_pool;
     uint8_t job_head;
     uint8_t client_status;
+    uint8_t window;
     mbox_call_back_t call_back;
+    mbox_ctx_call_back_t ctx_call_back;
     osal_mutex_t client_mutex;
     osal_semaphore_t client_free;
     job_id_resp_map job_resp[MAX_JOB_ID];
+    mbox_latency_stats_t latency;
 };
 static struct sdm_mbox_descriptor
 {
@@ -121,63 +134,171 @@ void mbox_poll_resp_task(void *param);
 
 void mbox_irq_handler(void *param);
 
+/*
+ * Job IDs are claimed and released with atomic operations on job_pool, so
+ * senders and the response task never take a lock for them. The search
+ * starts after the last ID handed out, so that an ID is not reused right
+ * after its response was collected.
+ */
 static uint8_t assign_job_id(sdm_client_handle mbox_handle)
 {
-    uint8_t i = 0;
-    if ((mbox_handle == NULL) || (mbox_handle->job_pool == (JOB_POOL_FULL)))
+    uint16_t pool, free_ids, rotated;
+    uint8_t head, i;
+
+    if (mbox_handle == NULL)
     {
-        ERROR("Maximum allowed jobs running");
         return 0xFFU;
     }
-    if (osal_mutex_lock(mbox_descriptor->client_list_mutex,
-            OSAL_TIMEOUT_WAIT_FOREVER) == pdTRUE)
+    pool = __atomic_load_n(&mbox_handle->job_pool, __ATOMIC_RELAXED);
+    do
     {
-        i = mbox_handle->job_head;
-        /*Find free job_id*/
-        while (((mbox_handle->job_pool) & (((uint16_t)0x1U << i))) != 0U)
+        if (pool == JOB_POOL_FULL)
         {
-            i++;
-            i %= MAX_JOB_ID;
-        }
-        mbox_handle->job_pool |= ((uint16_t)1U << i);
-        mbox_handle->job_head = (i + 1U) % MAX_JOB_ID;
-        if (osal_mutex_unlock(mbox_descriptor->client_list_mutex) == false)
-        {
-            ERROR("Failed to unlock mutex");
+            ERROR("Maximum allowed jobs running");
             return 0xFFU;
         }
-    }
+        head = __atomic_load_n(&mbox_handle->job_head, __ATOMIC_RELAXED);
+        free_ids = (uint16_t)~pool;
+        rotated = (uint16_t)((free_ids >> head) |
+                (free_ids << ((MAX_JOB_ID - head) % MAX_JOB_ID)));
+        i = (uint8_t)((__builtin_ctz(rotated) + head) % MAX_JOB_ID);
+    } while (__atomic_compare_exchange_n(&mbox_handle->job_pool, &pool,
+            (uint16_t)(pool | ((uint16_t)1U << i)), false, __ATOMIC_ACQUIRE,
+            __ATOMIC_RELAXED) == false);
+    __atomic_store_n(&mbox_handle->job_head, (uint8_t)((i + 1U) % MAX_JOB_ID),
+            __ATOMIC_RELAXED);
     return i;
 }
 
 static int8_t free_job_id(uint8_t client_id, uint8_t job_id)
 {
     sdm_client_handle mbox_handle = &client_descriptors[client_id];
-    if ((mbox_handle == NULL) || (mbox_handle->job_pool == 0U))
+    uint16_t mask = (uint16_t)1U << job_id;
+    uint16_t pool;
+
+    pool = __atomic_fetch_and(&mbox_handle->job_pool, (uint16_t)~mask,
+            __ATOMIC_RELEASE);
+    if ((pool & mask) == 0U)
     {
         return -EIO;
     }
-    if (osal_mutex_lock(mbox_descriptor->client_list_mutex,
-            OSAL_TIMEOUT_WAIT_FOREVER) == pdTRUE)
+    return 0;
+}
+
+static inline uint64_t mbox_counter(void)
+{
+    uint64_t cnt;
+
+    __asm volatile ("MRS %0, CNTVCT_EL0" : "=r" (cnt));
+    return cnt;
+}
+
+static inline uint64_t mbox_counter_freq(void)
+{
+    uint64_t freq;
+
+    __asm volatile ("MRS %0, CNTFRQ_EL0" : "=r" (freq));
+    return freq;
+}
+
+/*
+ * @brief Map a handle to its client ID, the handle points into
+ * client_descriptors so this is a pointer difference
+ */
+static uint8_t mbox_client_id(sdm_client_handle mbox_handle)
+{
+    uintptr_t base = (uintptr_t)&client_descriptors[0];
+    uintptr_t addr = (uintptr_t)mbox_handle;
+    uintptr_t offset;
+
+    if ((addr < base) || (addr >= (uintptr_t)&client_descriptors[
+            MAX_CLIENT_INSTANCES]))
     {
-        mbox_handle->job_pool ^= ((uint16_t)1U << job_id);
-        if (osal_mutex_unlock(mbox_descriptor->client_list_mutex) == false)
-        {
-            ERROR("Failed to unlock mutex");
-            return -EIO;
-        }
+        return 0xFFU;
     }
-    return 0;
+    offset = addr - base;
+    /* Since ATF uses client ID 1 we start from 2 */
+    if (((offset % sizeof(client_descriptors[0])) != 0U) ||
+            ((offset / sizeof(client_descriptors[0])) < 2U))
+    {
+        return 0xFFU;
+    }
+    return (uint8_t)(offset / sizeof(client_descriptors[0]));
 }
 
-void mbox_poll_resp_task(void *param)
+static void mbox_update_latency(sdm_client_handle mbox_handle,
+        uint64_t latency)
 {
-    (void)param;
+    mbox_latency_stats_t *stats = &mbox_handle->latency;
+
+    osal_enter_critical();
+    if ((stats->count == 0U) || (latency < stats->min_ticks))
+    {
+        stats->min_ticks = latency;
+    }
+    if (latency > stats->max_ticks)
+    {
+        stats->max_ticks = latency;
+    }
+    stats->last_ticks = latency;
+    stats->total_ticks += latency;
+    stats->count++;
+    osal_exit_critical();
+}
 
+/*
+ * @brief Hand the response of one transaction back to its client
+ */
+static void mbox_complete_trans(uint8_t trans_id, uint64_t *smc_args)
+{
     sdm_client_handle mbox_handle;
-    uint64_t bitmask[4], smc_args[12];
-    uint8_t trans_id, i, j;
     uint8_t client_id, job_id;
+    uint64_t latency;
+    void *context;
+
+    client_id = GET_CLIENT_ID(trans_id);
+    job_id = GET_JOB_ID(trans_id);
+    mbox_handle = &client_descriptors[client_id];
+    latency = mbox_counter() - mbox_handle->job_resp[job_id].sent;
+    DEBUG("Transaction ID: %x, latency: %lu ticks", trans_id, latency);
+
+    if ((mbox_handle->job_resp[job_id].resp_data != NULL) &&
+            (mbox_handle->job_resp[job_id].resp_len != 0UL))
+    {
+        (void)memcpy(mbox_handle->job_resp[job_id].resp_data, smc_args,
+                mbox_handle->job_resp[job_id].resp_len);
+    }
+    context = mbox_handle->job_resp[job_id].context;
+    mbox_handle->job_resp[job_id].context = NULL;
+    if (free_job_id(client_id, job_id) != 0)
+    {
+        ERROR("Failed to free job id");
+        return;
+    }
+    mbox_update_latency(mbox_handle, latency);
+    if (mbox_handle->call_back != NULL)
+    {
+        mbox_handle->call_back(smc_args);
+    }
+    /* Route the completion to the request that sent it */
+    if ((mbox_handle->ctx_call_back != NULL) && (context != NULL))
+    {
+        mbox_handle->ctx_call_back(smc_args, context);
+    }
+    if (osal_semaphore_post(mbox_handle->client_free) == false)
+    {
+        ERROR("Failed to post semaphore");
+    }
+}
+
+void mbox_poll_resp_task(void *param)
+{
+    (void)param;
+
+    uint64_t bitmask[MBOX_TRANS_WORDS], smc_args[12], word;
+    uint8_t ready[MBOX_MAX_TRANS];
+    uint32_t n_ready, round, i, k;
+    uint8_t trans_id;
     int ret;
     cache_force_write_back(smc_args, sizeof(smc_args));
     cache_force_invalidate(smc_args, sizeof(smc_args));
@@ -190,87 +311,65 @@ void mbox_poll_resp_task(void *param)
             {
                 break;
             }
-            /* response is available to poll */
-            (void)memset(bitmask, 0, sizeof(bitmask));
-            (void)memset(smc_args, 0, sizeof(smc_args));
-            ret = smc_call(SIP_SMC_GET_TRANS_ID, bitmask);
-            if (ret == 0)
+            /*
+             * Keep collecting responses till none are left, so that
+             * responses arriving while others are fetched don't cost
+             * another interrupt and task wake-up
+             */
+            round = 0U;
+            do
             {
+                n_ready = 0U;
+                (void)memset(bitmask, 0, sizeof(bitmask));
+                ret = smc_call(SIP_SMC_GET_TRANS_ID, bitmask);
+                if (ret != 0)
+                {
+                    ERROR("Failed to get transaction IDs");
+                    break;
+                }
                 DEBUG("Transaction ID bitmasks:\r\n"
                         "bitmask[0]: %lx\r\n"
                         "bitmask[1]: %lx\r\n"
                         "bitmask[2]: %lx\r\n"
                         "bitmask[3]: %lx", bitmask[0], bitmask[1], bitmask[2],
                         bitmask[3]);
-                /* Finding the transaction id corresponding to the response */
-                for (i = 0U; i < 4U; i++)
+                /*
+                 * Transaction ID of a set bit is (i * 64) + j, where j is
+                 * the bit position in bitmask[i]. Each set bit is taken
+                 * with a count trailing zeros and then cleared.
+                 */
+                for (i = 0U; i < MBOX_TRANS_WORDS; i++)
                 {
-                    /*
-                     * Transaction Id is obtained as follows from the bit mask
-                     *
-                     * trans_id = (i * 64) + j;
-                     * Where i is the bitmask which contains the response
-                     * j is the bit in the bitmask which is high
-                     */
-                    j = 0U;
-                    while (bitmask[i] != 0UL)
+                    word = bitmask[i];
+                    while (word != 0UL)
                     {
-                        trans_id = (i * 64U);
-                        /* 64 bits to process */
-                        while (j < 64U)
-                        {
-                            if (((bitmask[i] >> j) & 1UL) == 1UL)
-                            {
-                                break;
-                            }
-                            j++;
-                        }
-                        trans_id += j;
-                        /* Setting the bit as 0 to show its been processed */
-                        bitmask[i] = bitmask[i] & ~((uint64_t)1 << j);
-                        client_id = GET_CLIENT_ID(trans_id);
-                        if (client_id == ATF_CLIENT_ID)
-                        {
-                            /* Ignoring any transactions belonging to ATF */
-                            continue;
-                        }
-                        mbox_handle = &client_descriptors[client_id];
-                        job_id = GET_JOB_ID(trans_id);
-                        smc_args[0] = trans_id;
-                        DEBUG("Polling response, transaction ID: %x", trans_id);
-
-                        ret = smc_call(SIP_SMC_GET_RESP, smc_args);
-                        if (ret != 0)
-                        {
-                            (void)memset(smc_args, 0, sizeof(smc_args));
-                            ERROR("Failed to poll response");
-                            continue;
-                        }
-                        if ((mbox_handle->job_resp[job_id].resp_data != NULL) &&
-                                (mbox_handle->job_resp[job_id].resp_len != 0UL))
-                        {
-                            (void)memcpy(
-                                    mbox_handle->job_resp[job_id].resp_data,
-                                    smc_args,
-                                    mbox_handle->job_resp[job_id].resp_len);
-                        }
-                        if (free_job_id(client_id, job_id) != 0)
+                        trans_id = (uint8_t)((i * 64U) +
+                                (uint32_t)__builtin_ctzll(word));
+                        word &= (word - 1UL);
+                        /* Ignoring any transactions belonging to ATF */
+                        if (GET_CLIENT_ID(trans_id) != ATF_CLIENT_ID)
                         {
-                            ERROR("Failed to free job id");
-                            continue;
-                        }
-                        if (client_descriptors[client_id].call_back != NULL)
-                        {
-                            client_descriptors[client_id].call_back(smc_args);
-                        }
-                        if (osal_semaphore_post(mbox_handle->client_free) ==
-                                false)
-                        {
-                            ERROR("Failed to post semaphore");
+                            ready[n_ready] = trans_id;
+                            n_ready++;
                         }
                     }
                 }
-            }
+                /* Fetch all the collected responses back to back */
+                for (k = 0U; k < n_ready; k++)
+                {
+                    (void)memset(smc_args, 0, sizeof(smc_args));
+                    smc_args[0] = ready[k];
+                    ret = smc_call(SIP_SMC_GET_RESP, smc_args);
+                    if (ret != 0)
+                    {
+                        ERROR("Failed to poll response, transaction ID: %x",
+                                ready[k]);
+                        continue;
+                    }
+                    mbox_complete_trans(ready[k], smc_args);
+                }
+                round++;
+            } while ((n_ready != 0U) && (round < MBOX_POLL_MAX_ROUNDS));
         }
         mbox_descriptor->task_state = MBOX_TASK_OPEN;
         if (interrupt_enable(SDM_APS_MAILBOX_INTR, 14) != ERR_OK)
@@ -295,14 +394,18 @@ sdm_client_handle mbox_open_client(void)
             {
                 client_descriptors[i].client_status = 1;
                 ret_val = &client_descriptors[i];
+                (void)memset(&client_descriptors[i].latency, 0,
+                        sizeof(client_descriptors[i].latency));
                 client_descriptors[i].client_mutex = osal_mutex_create(
                         NULL);
-                client_descriptors[i].client_free = osal_semaphore_create(
-                        NULL);
-                if (osal_semaphore_post(client_descriptors[i].client_free) ==
-                        false)
+                client_descriptors[i].window = MBOX_CLIENT_WINDOW;
+                /* Sized for the largest window, see mbox_set_window() */
+                client_descriptors[i].client_free =
+                        osal_semaphore_counting_create(NULL,
+                        MAX_JOB_ID, MBOX_CLIENT_WINDOW);
+                if (client_descriptors[i].client_free == NULL)
                 {
-                    ERROR("Failed to post semaphore");
+                    ERROR("Failed to create semaphore");
                     return NULL;
                 }
                 break;
@@ -324,7 +427,7 @@ int32_t mbox_close_client(sdm_client_handle mbox_handle)
         return -EINVAL;
     }
     /* Check if it has any outstanding jobs */
-    if (mbox_handle->job_pool != 0U)
+    if (__atomic_load_n(&mbox_handle->job_pool, __ATOMIC_ACQUIRE) != 0U)
     {
         return -EIO;
     }
@@ -402,12 +505,20 @@ int32_t mbox_send_command(sdm_client_handle mbox_handle, uint32_t command,
 int32_t sip_svc_send(sdm_client_handle mbox_handle, uint64_t smc_func_id,
         uint64_t *mbox_args, uint32_t arg_len, uint64_t *resp_data,
         uint32_t resp_len)
+{
+    return sip_svc_send_ctx(mbox_handle, smc_func_id, mbox_args, arg_len,
+            resp_data, resp_len, NULL);
+}
+
+int32_t sip_svc_send_ctx(sdm_client_handle mbox_handle, uint64_t smc_func_id,
+        uint64_t *mbox_args, uint32_t arg_len, uint64_t *resp_data,
+        uint32_t resp_len, void *context)
 {
     uint64_t smc_values[12] =
     {
         0
     };
-    uint8_t client_id = 0xFFU, job_id, i;
+    uint8_t client_id, job_id;
     int ret = 0;
 
     if ((mbox_handle == NULL) || (mbox_handle->client_status == 0U) ||
@@ -416,79 +527,130 @@ int32_t sip_svc_send(sdm_client_handle mbox_handle, uint64_t smc_func_id,
     {
         return -EIO;
     }
-    else
+    client_id = mbox_client_id(mbox_handle);
+    if (client_id == 0xFFU)
+    {
+        ERROR("Failed to find client");
+        return -EIO;
+    }
+    if ((mbox_handle->call_back == NULL) &&
+            (mbox_handle->ctx_call_back == NULL))
     {
-        /* Since ATF uses client ID 1 we start from 2 */
-        for (i = 2; i < MAX_CLIENT_INSTANCES; i++)
+        WARN("No callback registered");
+    }
+    /*
+     * client_free counts the free slots of the in-flight window. Job IDs
+     * are allocated lock-free, so senders of one client only wait when the
+     * window is full.
+     */
+    if (osal_semaphore_wait(mbox_handle->client_free,
+            OSAL_TIMEOUT_WAIT_FOREVER) == pdTRUE)
+    {
+        job_id = assign_job_id(mbox_handle);
+        if (job_id >= MAX_JOB_ID)
         {
-            if (memcmp((const void *)mbox_handle, (const
-                    void *)&client_descriptors[i],
-                    sizeof(client_descriptors[i])) == 0)
-            {
-                client_id = i;
-                break;
-            }
+            ERROR("Failed to assign job id");
+            (void)osal_semaphore_post(mbox_handle->client_free);
+            return -EIO;
         }
-        if (client_id == 0xFFU)
+        mbox_handle->job_resp[job_id].resp_data = resp_data;
+        mbox_handle->job_resp[job_id].resp_len = resp_len;
+        mbox_handle->job_resp[job_id].context = context;
+
+        smc_values[0] = FORMAT_TRANS_ID(client_id, job_id);
+        if (mbox_args != NULL)
         {
-            ERROR("Failed to find client");
+            (void)memcpy(&smc_values[1], mbox_args, arg_len);
+        }
+        if (interrupt_enable( SDM_APS_MAILBOX_INTR, 14) != ERR_OK)
+        {
+            ERROR("Failed to enable interrupt");
+            mbox_handle->job_resp[job_id].context = NULL;
+            (void)free_job_id(client_id, job_id);
+            (void)osal_semaphore_post(mbox_handle->client_free);
             return -EIO;
         }
+        mbox_handle->job_resp[job_id].sent = mbox_counter();
+        ret = smc_call(smc_func_id, smc_values);
+        if ((resp_data == NULL) || (resp_len == 0U) || (ret != 0))
+        {
+            /*
+             * No response so immediately release semaphore and free the
+             * job id
+             */
+            mbox_handle->job_resp[job_id].context = NULL;
+            if (free_job_id(client_id, job_id) != 0)
+            {
+                ERROR("Failed to free job id");
+                return -EIO;
+            }
+            if (osal_semaphore_post(mbox_handle->client_free) == false)
+            {
+                ERROR("Failed to post semaphore");
+                return -EIO;
+            }
+            if (ret != 0)
+            {
+                ret = -ret;
+            }
+        }
     }
-    if (mbox_handle->call_back == NULL)
+    return ret;
+}
+
+int32_t mbox_set_window(sdm_client_handle mbox_handle, uint8_t window)
+{
+    uint8_t taken = 0U;
+    int32_t ret = 0;
+
+    if ((mbox_handle == NULL) || (mbox_client_id(mbox_handle) == 0xFFU) ||
+            (window == 0U) || (window > MAX_JOB_ID))
     {
-        WARN("No callback registered");
+        return -EINVAL;
     }
-    if (osal_semaphore_wait(mbox_handle->client_free,
+    if (osal_mutex_lock(mbox_handle->client_mutex,
             OSAL_TIMEOUT_WAIT_FOREVER) == pdTRUE)
     {
-        if (osal_mutex_lock(mbox_handle->client_mutex,
-                OSAL_TIMEOUT_WAIT_FOREVER) == pdTRUE)
+        /*
+         * Senders use client_free without the client mutex, so the
+         * semaphore is resized in place. Growing adds free slots, shrinking
+         * takes free slots away and fails if too many are in use.
+         */
+        if (window > mbox_handle->window)
         {
-            job_id = assign_job_id(mbox_handle);
-            if (job_id >= MAX_JOB_ID)
+            for (taken = mbox_handle->window; taken < window; taken++)
             {
-                ERROR("Failed to assign job id");
-                return -EIO;
+                (void)osal_semaphore_post(mbox_handle->client_free);
             }
-            mbox_handle->job_resp[job_id].resp_data = resp_data;
-            mbox_handle->job_resp[job_id].resp_len = resp_len;
-
-            smc_values[0] = FORMAT_TRANS_ID(client_id, job_id);
-            if (mbox_args != NULL)
+            mbox_handle->window = window;
+        }
+        else if (window < mbox_handle->window)
+        {
+            while ((taken < (mbox_handle->window - window)) &&
+                    (osal_semaphore_wait(mbox_handle->client_free,
+                    OSAL_TIMEOUT_NOTIMEOUT) == pdTRUE))
             {
-                (void)memcpy(&smc_values[1], mbox_args, arg_len);
+                taken++;
             }
-            if (interrupt_enable( SDM_APS_MAILBOX_INTR, 14) != ERR_OK)
+            if (taken == (mbox_handle->window - window))
             {
-                ERROR("Failed to enable interrupt");
-                return -EIO;
+                mbox_handle->window = window;
             }
-            ret = smc_call(smc_func_id, smc_values);
-            if ((resp_data == NULL) || (resp_len == 0U) || (ret != 0))
+            else
             {
-                /* No response so immediately release semaphore and free the job id */
-                if (free_job_id(client_id, job_id) != 0)
-                {
-                    ERROR("Failed to free job id");
-                    return -EIO;
-                }
-                if (osal_semaphore_post(mbox_handle->client_free) == false)
-                {
-                    ERROR("Failed to post semaphore");
-                    return -EIO;
-                }
-                if (ret != 0)
+                while (taken > 0U)
                 {
-                    ret = -ret;
+                    (void)osal_semaphore_post(mbox_handle->client_free);
+                    taken--;
                 }
-            }
-            if (osal_mutex_unlock(mbox_handle->client_mutex) == false)
-            {
-                ERROR("Failed to unlock mutex");
-                return -EIO;
+                ret = -EBUSY;
             }
         }
+        if (osal_mutex_unlock(mbox_handle->client_mutex) == false)
+        {
+            ERROR("Failed to unlock mutex");
+            return -EIO;
+        }
     }
     return ret;
 }
@@ -516,6 +678,53 @@ int32_t mbox_set_callback(sdm_client_handle mbox_handle,
     }
     return 0;
 }
+int32_t mbox_set_ctx_callback(sdm_client_handle mbox_handle,
+        mbox_ctx_call_back_t callback)
+{
+    if (mbox_handle == NULL)
+    {
+        return -EIO;
+    }
+    if (osal_mutex_lock(mbox_handle->client_mutex,
+            OSAL_TIMEOUT_WAIT_FOREVER) == pdTRUE)
+    {
+        /*callback can also be NULL*/
+        mbox_handle->ctx_call_back = callback;
+        if (osal_mutex_unlock(mbox_handle->client_mutex) == false)
+        {
+            ERROR("Failed to unlock mutex");
+            return -EIO;
+        }
+    }
+    return 0;
+}
+int32_t mbox_get_latency_stats(sdm_client_handle mbox_handle,
+        mbox_latency_stats_t *stats)
+{
+    if ((mbox_handle == NULL) || (stats == NULL) ||
+            (mbox_client_id(mbox_handle) == 0xFFU))
+    {
+        return -EINVAL;
+    }
+    osal_enter_critical();
+    *stats = mbox_handle->latency;
+    osal_exit_critical();
+    stats->timer_freq = mbox_counter_freq();
+    return 0;
+}
+
+int32_t mbox_reset_latency_stats(sdm_client_handle mbox_handle)
+{
+    if ((mbox_handle == NULL) || (mbox_client_id(mbox_handle) == 0xFFU))
+    {
+        return -EINVAL;
+    }
+    osal_enter_critical();
+    (void)memset(&mbox_handle->latency, 0, sizeof(mbox_handle->latency));
+    osal_exit_critical();
+    return 0;
+}
+
 int mbox_init(void)
 {
     if (mbox_descriptor == NULL)
@@ -70,6 +70,22 @@ struct sdm_client_descriptor;
  */
 typedef struct sdm_client_descriptor *sdm_client_handle;
 
+/**
+ * @brief Round trip latency of the transactions of one client.
+ *
+ * Latency is measured from the SMC that sends a request to the completion
+ * of its response, in ticks of the generic timer.
+ */
+typedef struct
+{
+    uint64_t count;       /*!< Number of completed transactions */
+    uint64_t total_ticks; /*!< Sum of all latencies */
+    uint64_t min_ticks;   /*!< Lowest latency seen */
+    uint64_t max_ticks;   /*!< Highest latency seen */
+    uint64_t last_ticks;  /*!< Latency of the last transaction */
+    uint64_t timer_freq;  /*!< Tick frequency in Hz */
+} mbox_latency_stats_t;
+
 /**
  * @}
  */
@@ -86,6 +102,14 @@ typedef struct sdm_client_descriptor *sdm_client_handle;
  */
 typedef void (*mbox_call_back_t)(uint64_t *resp_data);
 
+/**
+ * @brief Mailbox callback function type with a per request context
+ *
+ * @param[in] resp_data Pointer to the response data
+ * @param[in] context   Context passed to sip_svc_send_ctx() for this request
+ */
+typedef void (*mbox_ctx_call_back_t)(uint64_t *resp_data, void *context);
+
 /**
  * @brief mbox_init is used to create the mailbox task, allocate memory for the descriptor
  *        and initialize the semaphores and mutexes
@@ -167,6 +191,73 @@ int32_t sip_svc_send(sdm_client_handle mbox_handle, uint64_t smc_func_id,
         uint64_t *mbox_args, uint32_t arg_len, uint64_t *resp_data, uint32_t
         resp_len);
 
+/**
+ * @brief Send an SIP SVC request tagged with a caller context
+ *
+ * Same as sip_svc_send(), but the context is kept with the transaction ID
+ * of the request. When the response for that transaction arrives, the
+ * context callback of the client is called with it. This lets several
+ * callers wait on one client without picking up each other's completion.
+ *
+ * @param[in]  mbox_handle The Client handle returned in the open() call.
+ * @param[in]  smc_func_id Function Id specifying what command to perform.
+ * @param[in]  mbox_args   Arguments required for the command.
+ * @param[in]  arg_len     Length of the arguments provided in bytes.
+ * @param[out] resp_data   Pointer to store the response data.
+ * @param[in]  resp_len    Expected response length.
+ * @param[in]  context     Context returned in the completion callback.
+ *
+ * @return
+ * - 0: on success.
+ * - -EIO: If some internal errors occur.
+ */
+int32_t sip_svc_send_ctx(sdm_client_handle mbox_handle, uint64_t smc_func_id,
+        uint64_t *mbox_args, uint32_t arg_len, uint64_t *resp_data, uint32_t
+        resp_len, void *context);
+
+/**
+ * @brief Set the number of requests a client may have in flight
+ *
+ * By default a client has MBOX_CLIENT_WINDOW requests in flight, further
+ * sends block till a response arrives. A larger window lets one client
+ * pipeline requests; completions are then told apart with the context
+ * of sip_svc_send_ctx(). Can be called while other tasks send on the
+ * client; a smaller window only takes effect if enough slots are free.
+ *
+ * @param[in] mbox_handle The Client handle returned in the open() call.
+ * @param[in] window      Requests in flight, 1 to 16.
+ *
+ * @return
+ * - 0: on success.
+ * - -EINVAL: If the handle or window is invalid.
+ * - -EBUSY:  If more requests than the new window are in flight.
+ */
+int32_t mbox_set_window(sdm_client_handle mbox_handle, uint8_t window);
+
+/**
+ * @brief Read the latency counters of a client
+ *
+ * @param[in]  mbox_handle The Client handle returned in the open() call.
+ * @param[out] stats       Snapshot of the counters.
+ *
+ * @return
+ * - 0: on success.
+ * - -EINVAL: If the handle or stats pointer is invalid.
+ */
+int32_t mbox_get_latency_stats(sdm_client_handle mbox_handle,
+        mbox_latency_stats_t *stats);
+
+/**
+ * @brief Clear the latency counters of a client
+ *
+ * @param[in] mbox_handle The Client handle returned in the open() call.
+ *
+ * @return
+ * - 0: on success.
+ * - -EINVAL: If the handle is invalid.
+ */
+int32_t mbox_reset_latency_stats(sdm_client_handle mbox_handle);
+
 /**
  * @brief Set callback function for a client
  *
@@ -183,6 +274,22 @@ int32_t sip_svc_send(sdm_client_handle mbox_handle, uint64_t smc_func_id,
 int32_t mbox_set_callback(sdm_client_handle mbox_handle, mbox_call_back_t
         callback);
 
+/**
+ * @brief Set the context callback function for a client
+ *
+ *  The callback is called for every response of a request sent with
+ *  sip_svc_send_ctx(), along with the context of that request.
+ *
+ * @param[in] mbox_handle The Client handle returned in the open() call.
+ * @param[in] callback    Function pointer to callback function
+ *
+ * @return
+ * - 0: on success.
+ * - -EIO: if some internal errors occur.
+ */
+int32_t mbox_set_ctx_callback(sdm_client_handle mbox_handle,
+        mbox_ctx_call_back_t callback);
+
 /**
  * @}
  */
@@ -43,6 +43,9 @@
 #define CLK_WRDQS_DELAY              ((uint32_t) 0 << 16U)
 #define CLK_WR_DELAY                 ((uint32_t) 0 << 8U)
 #define READ_DQS_DELAY               (0U)
+#define READ_DQS_CMD_DELAY_POS       (24U)
+#define READ_DQS_DELAY_POS           (0U)
+#define DLL_SLAVE_DELAY_MAX          (0xFFU)
 #define IO_MASK_DISABLE              ((uint32_t) 0 << 31U)
 #define IO_MASK_END                  ((uint32_t) 0 << 27U)
 #define IO_MASK_START                ((uint32_t) 0 << 24U)
@@ -55,6 +55,7 @@
 
 #include <stdint.h>
 #include <stdio.h>
+#include <string.h>
 #include <errno.h>
 #include "osal.h"
 #include "osal_log.h"
@@ -62,6 +63,7 @@
 #include "socfpga_interrupt.h"
 #include "socfpga_sdmmc_ll.h"
 #include "socfpga_sdmmc.h"
+#include "socfpga_sdmmc_bcache.h"
 
 /*
  * Maximum time to wait for an sdmmc command response before timeout.
@@ -82,16 +84,84 @@
 #define DEV_TYPE    DEV_TYPE_SD
 
 /*INFO:
- * Driver supports High speed[speed upto 25 MBps at 50 MHz] and
- * Default speed[speed upto 12.5 MBps at 25 MHz] mode.
+ * Driver negotiates the fastest bus timing supported by host and card, up
+ * to SDR104 for SD and HS400 for eMMC. SUPPORT_DEF_SPEED keeps it at
+ * Default speed[speed upto 12.5 MBps at 25 MHz].
  **/
 
 #define SUPPORT_DEF_SPEED    DEF_SPEED_DI
 
+/*
+ * UHS-I needs the board to move the SD card I/O to 1.8V. When the switch
+ * does not complete the card is power cycled and kept at 3.3V.
+ */
+#ifndef SDMMC_UHS_EN
+#define SDMMC_UHS_EN    1
+#endif
+
+/*bounds on short data reads, a bad sampling point may never complete them*/
+#define SDMMC_DATA_CMD_TIMEOUT_MS    100UL
+#define SDMMC_TUNE_TIMEOUT_MS        10UL
+/*narrowest run of passing taps accepted as a sampling window*/
+#define SDMMC_TUNE_MIN_WINDOW        4U
+
 #if SDMMC_MAX_DESCRIPTOR < 1
 #error Invalid descriptor count
 #endif
 
+/*largest block count of one data command, bound by the block count register*/
+#define SDMMC_SG_MAX_BLOCKS    (0xFFFFU)
+
+/*priority of the request queue task*/
+#define SDMMC_Q_TASK_PRIORITY    (configMAX_PRIORITIES - 2)
+/*number of data commands prepared ahead without a command queue engine*/
+#define SDMMC_Q_LEGACY_SLOTS     2U
+
+/*use the eMMC command queue engine when both host and device have it*/
+#ifndef SDMMC_CQE_EN
+#define SDMMC_CQE_EN             1
+#endif
+/*tasks kept in flight on the command queue engine*/
+#ifndef SDMMC_CQE_DEPTH
+#define SDMMC_CQE_DEPTH          8U
+#endif
+/*transfer descriptors per command queue task*/
+#define SDMMC_CQE_SLOT_DESC      32U
+
+/*without a command queue engine, run the data commands as ADMA3 chains*/
+#ifndef SDMMC_ADMA3_EN
+#define SDMMC_ADMA3_EN           1
+#endif
+/*data commands chained under a single interrupt*/
+#ifndef SDMMC_ADMA3_DEPTH
+#define SDMMC_ADMA3_DEPTH        8U
+#endif
+/*data descriptors per ADMA3 descriptor set*/
+#define SDMMC_ADMA3_SLOT_DESC    32U
+
+/*route the sync block calls through the block cache*/
+#ifndef SDMMC_BCACHE_EN
+#define SDMMC_BCACHE_EN          1
+#endif
+
+#if (DEV_TYPE == DEV_TYPE_EMMC) && (SDMMC_CQE_EN == 1)
+#define SDMMC_Q_CQE              1
+#define SDMMC_Q_SLOTS            SDMMC_CQE_DEPTH
+#elif (SDMMC_ADMA3_EN == 1)
+#define SDMMC_Q_CQE              0
+#define SDMMC_Q_SLOTS            SDMMC_ADMA3_DEPTH
+#else
+#define SDMMC_Q_CQE              0
+#define SDMMC_Q_SLOTS            SDMMC_Q_LEGACY_SLOTS
+#endif
+
+#if (SDMMC_Q_SLOTS < SDMMC_Q_LEGACY_SLOTS) || (SDMMC_Q_SLOTS > CQE_MAX_SLOTS)
+#error Invalid command queue depth
+#endif
+#if (SDMMC_ADMA3_EN == 1) && (SDMMC_ADMA3_DEPTH < 1U)
+#error Invalid ADMA3 chain depth
+#endif
+
 #if (DEV_TYPE ==  DEV_TYPE_SD)
 #define BUS_PARAM    0
 static int32_t sd_mmc_init(uint64_t *sec_num);
@@ -107,6 +177,34 @@ static int32_t sd_en_card_ready(cmd_parameters_t *pcmd_handle);
 static int32_t sd_snd_app_bus_cmd(cmd_parameters_t *pcmd);
 static int32_t sd_set_bus_width(cmd_parameters_t *pcmd_handle);
 static int32_t sd_bus_width_4(cmd_parameters_t *pcmd);
+static int32_t sd_card_identify(uint64_t *sec_num);
+static int32_t sd_switch_voltage(cmd_parameters_t *pcmd);
+static void sd_power_cycle(void);
+static int32_t sd_switch_func(uint32_t arg);
+static int32_t sd_set_speed(sdmmc_timing_t timing, uint32_t func);
+static int32_t sd_select_timing(void);
+
+#define SD_DAT_LINES_HIGH     (0xFU)
+#define SD_POWER_OFF_MS       (20U)
+#define SD_FUNC_DS            (0U)
+#define SD_FUNC_NO_CHANGE     (0xFU)
+#define SD_UHS_TIMINGS        ((1U << SDMMC_TIMING_SDR50) | \
+            (1U << SDMMC_TIMING_SDR104))
+
+/*tuning block sent by SD cards in response to CMD19*/
+static const uint8_t sd_tuning_pattern[64] =
+{
+    0xFF, 0x0F, 0xFF, 0x00, 0xFF, 0xCC, 0xC3, 0xCC,
+    0xC3, 0x3C, 0xCC, 0xFF, 0xFE, 0xFF, 0xFE, 0xEF,
+    0xFF, 0xDF, 0xFF, 0xDD, 0xFF, 0xFB, 0xFF, 0xFB,
+    0xBF, 0xFF, 0x7F, 0xFF, 0x77, 0xF7, 0xBD, 0xEF,
+    0xFF, 0xF0, 0xFF, 0xF0, 0x0F, 0xFC, 0xCC, 0x3C,
+    0xCC, 0x33, 0xCC, 0xCF, 0xFF, 0xEF, 0xFF, 0xEE,
+    0xFF, 0xFD, 0xFF, 0xFD, 0xDF, 0xFF, 0xBF, 0xFF,
+    0xBB, 0xFF, 0xF7, 0xFF, 0xF7, 0x7F, 0x7B, 0xDE,
+};
+
+static uint8_t sd_switch_status[SDMMC_SD_SWITCH_LEN] __attribute__((aligned(64)));
 
 #elif (DEV_TYPE ==  DEV_TYPE_EMMC)
 #define BUS_PARAM    1
@@ -120,8 +218,37 @@ static int32_t mmc_snd_csd(cmd_parameters_t *pcmd);
 static int32_t mmc_send_ext_csd(cmd_parameters_t *pcmd,
         uint64_t *sector_count_ref);
 static int32_t mmc_switch_bus_width(cmd_parameters_t *pcmd);
+static int32_t mmc_cmdq_enable(uint32_t *pdepth);
+static int32_t mmc_switch(cmd_parameters_t *pcmd, uint32_t arg);
+static int32_t mmc_verify_bus(cmd_parameters_t *pcmd);
+static int32_t mmc_select_hs(cmd_parameters_t *pcmd);
+static int32_t mmc_select_hs200(cmd_parameters_t *pcmd);
+static int32_t mmc_select_hs400(cmd_parameters_t *pcmd);
+static int32_t mmc_select_hs400es(cmd_parameters_t *pcmd);
+static int32_t mmc_select_timing(cmd_parameters_t *pcmd);
+
+/*tuning block sent by eMMC devices in response to CMD21 on an 8 bit bus*/
+static const uint8_t mmc_tuning_pattern[128] =
+{
+    0xFF, 0xFF, 0x00, 0xFF, 0xFF, 0xFF, 0x00, 0x00,
+    0xFF, 0xFF, 0xCC, 0xCC, 0xCC, 0x33, 0xCC, 0xCC,
+    0xCC, 0x33, 0x33, 0xCC, 0xCC, 0xCC, 0xFF, 0xFF,
+    0xFF, 0xEE, 0xFF, 0xFF, 0xFF, 0xEE, 0xEE, 0xFF,
+    0xFF, 0xFF, 0xDD, 0xFF, 0xFF, 0xFF, 0xDD, 0xDD,
+    0xFF, 0xFF, 0xFF, 0xBB, 0xFF, 0xFF, 0xFF, 0xBB,
+    0xBB, 0xFF, 0xFF, 0xFF, 0x77, 0xFF, 0xFF, 0xFF,
+    0x77, 0x77, 0xFF, 0x77, 0xBB, 0xDD, 0xEE, 0xFF,
+    0xFF, 0xFF, 0xFF, 0x00, 0xFF, 0xFF, 0xFF, 0x00,
+    0x00, 0xFF, 0xFF, 0xCC, 0xCC, 0xCC, 0x33, 0xCC,
+    0xCC, 0xCC, 0x33, 0x33, 0xCC, 0xCC, 0xCC, 0xFF,
+    0xFF, 0xFF, 0xEE, 0xFF, 0xFF, 0xFF, 0xEE, 0xEE,
+    0xFF, 0xFF, 0xFF, 0xDD, 0xFF, 0xFF, 0xFF, 0xDD,
+    0xDD, 0xFF, 0xFF, 0xFF, 0xBB, 0xFF, 0xFF, 0xFF,
+    0xBB, 0xBB, 0xFF, 0xFF, 0xFF, 0x77, 0xFF, 0xFF,
+    0xFF, 0x77, 0x77, 0xFF, 0x77, 0xBB, 0xDD, 0xEE,
+};
 
-static uint8_t ext_csd_buff[512];
+static uint8_t ext_csd_buff[512] __attribute__((aligned(64)));
 
 #else
 #error "Device not supported"
@@ -132,6 +259,19 @@ static int32_t sdmmc_setup_host(void);
 static void sdmmc_wait_xfer_done(void);
 void sdmmc_irq_handler(void *data);
 static void sdmmc_wait_cmd_done(void);
+static int32_t sdmmc_read_data_cmd(cmd_parameters_t *pcmd, uint8_t *pbuff,
+        uint32_t len, uint64_t timeout_ms);
+static int32_t sdmmc_execute_tuning(uint8_t cmd_index,
+        const uint8_t *ppattern, uint32_t len);
+
+static const char *const sdmmc_timing_names[SDMMC_TIMING_COUNT] =
+{
+    "DS", "HS", "SDR50", "SDR104", "legacy", "HS", "HS200", "HS400",
+    "HS400ES"
+};
+
+/*tuning blocks are at most 128 bytes, on the 8 bit eMMC bus*/
+static uint8_t tuning_buff[128] __attribute__((aligned(64)));
 
 static card_data_t *pcard_specific_data;
 static card_data_t card_data;
@@ -146,13 +286,90 @@ struct sdmmc_context
     osal_semaphore_t semaphore_xfer;
     osal_semaphore_t semaphore_cmd;
     sdmmc_cb_fun xfer_call_back;
-    dma_descriptor_t dma_descriptor[SDMMC_MAX_DESCRIPTOR];
+    /*two tables so the next one is filled while the other is in flight*/
+    dma_descriptor_t dma_descriptor[2][SDMMC_MAX_DESCRIPTOR];
     uint32_t is_def_speed_supported;
     uint32_t dev_type;
+    /*bus timing negotiated with the card*/
+    sdmmc_timing_t timing;
+    /*1.8V requested at identification, kept once the card switched*/
+    bool use_uhs;
 };
 
 static struct sdmmc_context sdmmc_descriptor;
 
+/*state of a command slot of the request queue*/
+#define SDMMC_SLOT_FREE      0U
+#define SDMMC_SLOT_BUILT     1U
+#define SDMMC_SLOT_ACTIVE    2U
+
+/*one data command of the request queue, legacy or command queue task*/
+struct sdmmc_q_cmd
+{
+    uint32_t state;
+    uint32_t order;
+    bool is_read;
+    uint64_t lba;
+    uint32_t blocks;
+    uint32_t desc_count;
+    sdmmc_request_t *first;
+    sdmmc_request_t *last;
+};
+
+struct sdmmc_queue
+{
+    bool started;
+    bool use_cqe;
+    bool use_adma3;
+    uint32_t slot_count;
+    osal_semaphore_t kick;
+    /*pending requests sorted by block address*/
+    sdmmc_request_t *pending;
+    /*request being split over several commands, with its merged followers*/
+    sdmmc_request_t *cur;
+    uint64_t cur_lba;
+    uint32_t seq;
+    uint32_t order;
+    volatile uint32_t cqe_done;
+    volatile uint32_t cqe_err;
+    struct sdmmc_q_cmd cmd[SDMMC_Q_SLOTS];
+    /*slots of the ADMA3 chain in flight, in execution order*/
+    uint32_t chain[SDMMC_Q_SLOTS];
+    uint32_t chain_len;
+};
+
+static struct sdmmc_queue sdmmc_q;
+static osal_semaphore_def_t osal_def_kick;
+
+#if (SDMMC_Q_CQE == 1)
+/*the engine may index any of its slots, keep the whole list*/
+static cqe_task_slot_t cqe_tdl[CQE_MAX_SLOTS] __attribute__((aligned(1024)));
+static cqe_descriptor_t cqe_desc[SDMMC_CQE_DEPTH][SDMMC_CQE_SLOT_DESC]
+__attribute__((aligned(64)));
+#endif
+
+#if (SDMMC_ADMA3_EN == 1)
+/*descriptor set of a slot, the host expects the data right after the command*/
+struct sdmmc_adma3_set
+{
+    adma3_cmd_desc_t cmd;
+    dma_descriptor_t data[SDMMC_ADMA3_SLOT_DESC];
+};
+static struct sdmmc_adma3_set adma3_sets[SDMMC_Q_SLOTS]
+__attribute__((aligned(64)));
+static adma3_integrated_desc_t adma3_chain[SDMMC_Q_SLOTS]
+__attribute__((aligned(64)));
+#endif
+
+/*position within a scatter-gather segment list*/
+struct sdmmc_sg_cursor
+{
+    const sdmmc_iovec_t *iov;
+    uint32_t iov_count;
+    uint32_t seg;
+    size_t off;
+};
+
 int32_t sdmmc_read_block_async(uint64_t *pread_buffer, uint64_t read_addr,
         uint32_t block_size, uint32_t number_of_blocks,
         sdmmc_cb_fun xfer_done_call_back)
@@ -164,6 +381,10 @@ int32_t sdmmc_read_block_async(uint64_t *pread_buffer, uint64_t read_addr,
     int32_t state;
     sdmmc_descriptor.status_code = 0;
 
+    if (sdmmc_q.started)
+    {
+        return -EBUSY;
+    }
     sdmmc_descriptor.is_api_sync = false;
     sdmmc_descriptor.xfer_call_back = xfer_done_call_back;
 
@@ -230,7 +451,7 @@ int32_t sdmmc_read_block_async(uint64_t *pread_buffer, uint64_t read_addr,
     /*send cmd to request data from the card*/
     else
     {
-        sdmmc_set_up_xfer(sdmmc_descriptor.dma_descriptor, pread_buffer,
+        sdmmc_set_up_xfer(sdmmc_descriptor.dma_descriptor[0], pread_buffer,
                 block_size, number_of_blocks);
         sdmmc_set_xfer_config(pcmd);
         DEBUG("Initiating sdmmc data read");
@@ -247,27 +468,56 @@ int32_t sdmmc_read_block_async(uint64_t *pread_buffer, uint64_t read_addr,
 int32_t sdmmc_read_block_sync(uint64_t *pread_buffer, uint64_t read_addr,
         uint32_t block_size, uint32_t number_of_blocks)
 {
-    sdmmc_descriptor.is_api_sync = false;
+    sdmmc_iovec_t iov;
+
+    if ((pread_buffer == NULL) || (number_of_blocks == 0U))
+    {
+        return -EINVAL;
+    }
+#if (SDMMC_BCACHE_EN == 1)
+    if ((block_size == SDMMC_BLOCK_SIZE) &&
+            ((read_addr % SDMMC_BLOCK_SIZE) == 0U) && sdmmc_bcache_enabled())
+    {
+        return sdmmc_bcache_read((uint8_t *)pread_buffer,
+                read_addr / SDMMC_BLOCK_SIZE, number_of_blocks);
+    }
+#endif
+    iov.addr = pread_buffer;
+    iov.size = (size_t)block_size * number_of_blocks;
+
+    return sdmmc_read_blocks_sg(&iov, 1U, read_addr, block_size);
+}
+
+int32_t sdmmc_write_block_async(uint64_t *pwrite_buffer, uint64_t write_addr,
+        uint32_t block_size, uint32_t number_of_blocks,
+        sdmmc_cb_fun xfer_done_call_back)
+{
     cmd_parameters_t *pcmd;
     cmd_parameters_t command_config;
     pcmd = &command_config;
     uint32_t req_desc_count;
     int32_t state;
 
-    sdmmc_descriptor.is_api_sync = true;
+    if (sdmmc_q.started)
+    {
+        return -EBUSY;
+    }
+    sdmmc_descriptor.is_api_sync = false;
+    sdmmc_descriptor.xfer_call_back = xfer_done_call_back;
+
     if (block_size == 0U)
     {
         return -EINVAL;
     }
 
-    /*convert address into block number*/
-    read_addr /= block_size;
+    /*converts address into block number*/
+    write_addr /= block_size;
 
-    if ((pread_buffer == NULL) || (number_of_blocks == 0U))
+    if ((pwrite_buffer == NULL) || (number_of_blocks == 0U))
     {
         return -EINVAL;
     }
-    /*send cmd to set block size*/
+    /*set cmd to set block size*/
     pcmd->argument = block_size;
     pcmd->command_index = SDMMC_CMD_SET_BLOCK_LEN;
     pcmd->data_xfer_present = SDMMC_DATA_XFER_NOT_PST;
@@ -287,11 +537,11 @@ int32_t sdmmc_read_block_sync(uint64_t *pread_buffer, uint64_t read_addr,
     {
         return -EIO;
     }
-    /*argument preparation for data read*/
+    /*argument preparation for data transfer*/
     if (number_of_blocks > 1U)
     {
-        pcmd->argument = read_addr;
-        pcmd->command_index = SDMMC_CMD_READ_MULT_BLOCK;
+        pcmd->argument = write_addr;
+        pcmd->command_index = SDMMC_CMD_WRITE_MULT_BLOCK;
         pcmd->data_xfer_present = SDMMC_DATA_XFER_PST;
         pcmd->response_type = SDMMC_SHORT_RESPONSE;
         pcmd->id_check_enable = SDMMC_CMD_ID_CHECK_EN;
@@ -299,8 +549,8 @@ int32_t sdmmc_read_block_sync(uint64_t *pread_buffer, uint64_t read_addr,
     }
     else
     {
-        pcmd->argument = read_addr;
-        pcmd->command_index = SDMMC_CMD_READ_SINGLE_BLOCK;
+        pcmd->argument = write_addr;
+        pcmd->command_index = SDMMC_CMD_WRITE_MULT_BLOCK;
         pcmd->data_xfer_present = SDMMC_DATA_XFER_PST;
         pcmd->response_type = SDMMC_SHORT_RESPONSE;
         pcmd->id_check_enable = SDMMC_CMD_ID_CHECK_EN;
@@ -309,233 +559,1149 @@ int32_t sdmmc_read_block_sync(uint64_t *pread_buffer, uint64_t read_addr,
     /*calculate no of descriptors required*/
     req_desc_count = ((block_size * number_of_blocks) + (DESC_MAX_XFER_SIZE)
             -1U) / DESC_MAX_XFER_SIZE;
-
     if (req_desc_count > SDMMC_MAX_DESCRIPTOR)
     {
-        return -EIO;
+        return -EIO;
+    }
+
+    /*send cmd to transfer data to the card*/
+    else
+    {
+        cache_force_write_back((uint64_t *)pwrite_buffer, block_size *
+                number_of_blocks);
+        sdmmc_set_up_xfer(sdmmc_descriptor.dma_descriptor[0], pwrite_buffer,
+                block_size, number_of_blocks);
+        sdmmc_set_xfer_config(pcmd);
+
+        state = sdmmc_send_command(pcmd);
+        INFO("Initiating sdmmc data write");
+        if (state != 0)
+        {
+            return -EIO;
+        }
+    }
+    return 0;
+}
+
+int32_t sdmmc_write_block_sync(uint64_t *pwrite_buffer, uint64_t write_addr,
+        uint32_t block_size, uint32_t number_of_blocks)
+{
+    sdmmc_iovec_t iov;
+
+    if ((pwrite_buffer == NULL) || (number_of_blocks == 0U))
+    {
+        return -EINVAL;
+    }
+#if (SDMMC_BCACHE_EN == 1)
+    if ((block_size == SDMMC_BLOCK_SIZE) &&
+            ((write_addr % SDMMC_BLOCK_SIZE) == 0U) && sdmmc_bcache_enabled())
+    {
+        return sdmmc_bcache_write((const uint8_t *)pwrite_buffer,
+                write_addr / SDMMC_BLOCK_SIZE, number_of_blocks);
+    }
+#endif
+    iov.addr = pwrite_buffer;
+    iov.size = (size_t)block_size * number_of_blocks;
+
+    return sdmmc_write_blocks_sg(&iov, 1U, write_addr, block_size);
+}
+
+static int32_t sdmmc_set_block_len(uint32_t block_size)
+{
+    cmd_parameters_t command_config;
+    int32_t state;
+
+    command_config.argument = block_size;
+    command_config.command_index = SDMMC_CMD_SET_BLOCK_LEN;
+    command_config.data_xfer_present = SDMMC_DATA_XFER_NOT_PST;
+    command_config.response_type = SDMMC_SHORT_RESPONSE;
+    command_config.id_check_enable = SDMMC_CMD_ID_CHECK_EN;
+    command_config.crc_check_enable = SDMMC_CMD_CRC_CHECK_EN;
+    state = sdmmc_send_command(&command_config);
+
+    if (state != 0)
+    {
+        return -EIO;
+    }
+
+    sdmmc_wait_cmd_done();
+
+    if (sdmmc_descriptor.status_code != 0)
+    {
+        return -EIO;
+    }
+    return 0;
+}
+
+/*
+ * Fill a descriptor table from the current position of the segment list.
+ * The table is cut at the last whole block it can hold so that every data
+ * command moves whole blocks, the position is advanced past what was used.
+ * Returns the number of blocks described, 0 once the list is consumed.
+ */
+static int32_t sdmmc_sg_build(struct sdmmc_sg_cursor *pcur,
+        dma_descriptor_t *pdesc, uint32_t block_size, uint32_t *pdesc_count)
+{
+    const sdmmc_iovec_t *iov = pcur->iov;
+    uint32_t seg = pcur->seg;
+    size_t off = pcur->off;
+    size_t bytes = 0U;
+    size_t len;
+    uint32_t count = 0U;
+    uint32_t blocks;
+
+    /*find how many whole blocks a table can hold from here*/
+    while ((seg < pcur->iov_count) && (count < SDMMC_MAX_DESCRIPTOR))
+    {
+        len = iov[seg].size - off;
+        if (len > DESC_MAX_XFER_SIZE)
+        {
+            len = DESC_MAX_XFER_SIZE;
+        }
+        if (len != 0U)
+        {
+            bytes += len;
+            count++;
+        }
+        off += len;
+        if (off == iov[seg].size)
+        {
+            seg++;
+            off = 0U;
+        }
+    }
+
+    blocks = (uint32_t)(bytes / block_size);
+    if (blocks > SDMMC_SG_MAX_BLOCKS)
+    {
+        blocks = SDMMC_SG_MAX_BLOCKS;
+    }
+    if (blocks == 0U)
+    {
+        /*a full table of segments smaller than one block*/
+        return (seg < pcur->iov_count) ? -EINVAL : 0;
+    }
+
+    bytes = (size_t)blocks * block_size;
+    count = 0U;
+    while (bytes != 0U)
+    {
+        len = iov[pcur->seg].size - pcur->off;
+        if (len > DESC_MAX_XFER_SIZE)
+        {
+            len = DESC_MAX_XFER_SIZE;
+        }
+        if (len > bytes)
+        {
+            len = bytes;
+        }
+        if (len != 0U)
+        {
+            sdmmc_set_desc(&pdesc[count], (uint64_t)(uintptr_t)
+                    iov[pcur->seg].addr + pcur->off, (uint32_t)len,
+                    (len == bytes));
+            count++;
+            bytes -= len;
+        }
+        pcur->off += len;
+        if (pcur->off == iov[pcur->seg].size)
+        {
+            pcur->seg++;
+            pcur->off = 0U;
+        }
+    }
+
+    *pdesc_count = count;
+    return (int32_t)blocks;
+}
+
+static int32_t sdmmc_sg_check(const sdmmc_iovec_t *iov, uint32_t iov_count,
+        uint32_t block_size, uint64_t *ptotal)
+{
+    uint64_t total = 0U;
+    uint32_t i;
+
+    if ((iov == NULL) || (iov_count == 0U) || (block_size == 0U))
+    {
+        return -EINVAL;
+    }
+    for (i = 0U; i < iov_count; i++)
+    {
+        if ((iov[i].addr == NULL) ||
+                (((uintptr_t)iov[i].addr & (SDMMC_SG_ALIGN - 1U)) != 0U) ||
+                ((iov[i].size & (SDMMC_SG_ALIGN - 1U)) != 0U))
+        {
+            return -EINVAL;
+        }
+        total += iov[i].size;
+    }
+    if ((total == 0U) || ((total % block_size) != 0U))
+    {
+        return -EINVAL;
+    }
+
+    *ptotal = total;
+    return 0;
+}
+
+static int32_t sdmmc_xfer_sg(const sdmmc_iovec_t *iov, uint32_t iov_count,
+        uint64_t addr, uint32_t block_size, bool is_read)
+{
+    cmd_parameters_t command_config;
+    struct sdmmc_sg_cursor cur;
+    uint32_t desc_count = 0U;
+    uint32_t next_desc_count = 0U;
+    uint32_t table = 0U;
+    uint64_t total = 0U;
+    int32_t blocks;
+    int32_t next_blocks;
+    int32_t ret = 0;
+
+    if (sdmmc_q.started)
+    {
+        return -EBUSY;
+    }
+    ret = sdmmc_sg_check(iov, iov_count, block_size, &total);
+    if (ret != 0)
+    {
+        return ret;
+    }
+
+    sdmmc_descriptor.is_api_sync = true;
+
+    if (is_read)
+    {
+        /*write back dirty lines sharing the buffer edges before the DMA*/
+        cache_range_list_op(CACHE_OP_FLUSH, iov, iov_count);
+    }
+    else
+    {
+        cache_range_list_op(CACHE_OP_CLEAN, iov, iov_count);
+    }
+
+    ret = sdmmc_set_block_len(block_size);
+    if (ret != 0)
+    {
+        return ret;
+    }
+
+    /*convert address into block number*/
+    addr /= block_size;
+
+    cur.iov = iov;
+    cur.iov_count = iov_count;
+    cur.seg = 0U;
+    cur.off = 0U;
+    blocks = sdmmc_sg_build(&cur, sdmmc_descriptor.dma_descriptor[table],
+            block_size, &desc_count);
+
+    while (blocks > 0)
+    {
+        command_config.argument = addr;
+        if (is_read)
+        {
+            command_config.command_index = (blocks > 1) ?
+                    SDMMC_CMD_READ_MULT_BLOCK : SDMMC_CMD_READ_SINGLE_BLOCK;
+        }
+        else
+        {
+            command_config.command_index = SDMMC_CMD_WRITE_MULT_BLOCK;
+        }
+        command_config.data_xfer_present = SDMMC_DATA_XFER_PST;
+        command_config.response_type = SDMMC_SHORT_RESPONSE;
+        command_config.id_check_enable = SDMMC_CMD_ID_CHECK_EN;
+        command_config.crc_check_enable = SDMMC_CMD_CRC_CHECK_EN;
+
+        sdmmc_start_adma(sdmmc_descriptor.dma_descriptor[table], desc_count,
+                block_size, (uint32_t)blocks);
+        sdmmc_set_xfer_config(&command_config);
+        DEBUG("Initiating sdmmc data %s of %x blocks",
+                is_read ? "read" : "write", blocks);
+        if (sdmmc_send_command(&command_config) != 0)
+        {
+            ret = -EIO;
+            break;
+        }
+
+        /*prepare the next table while this one is in flight*/
+        next_blocks = sdmmc_sg_build(&cur,
+                sdmmc_descriptor.dma_descriptor[table ^ 1U], block_size,
+                &next_desc_count);
+
+        sdmmc_wait_xfer_done();
+
+        if (sdmmc_descriptor.status_code != 0)
+        {
+            ret = -EIO;
+            break;
+        }
+        if (next_blocks < 0)
+        {
+            ret = next_blocks;
+            break;
+        }
+
+        addr += (uint64_t)blocks;
+        table ^= 1U;
+        blocks = next_blocks;
+        desc_count = next_desc_count;
+    }
+    if ((ret == 0) && (blocks < 0))
+    {
+        ret = blocks;
+    }
+
+    if (is_read)
+    {
+        /*drop lines speculatively fetched while the DMA was running*/
+        cache_range_list_op(CACHE_OP_INVALIDATE, iov, iov_count);
+    }
+
+    return ret;
+}
+
+int32_t sdmmc_read_blocks_sg(const sdmmc_iovec_t *iov, uint32_t iov_count,
+        uint64_t read_addr, uint32_t block_size)
+{
+    return sdmmc_xfer_sg(iov, iov_count, read_addr, block_size, true);
+}
+
+int32_t sdmmc_write_blocks_sg(const sdmmc_iovec_t *iov, uint32_t iov_count,
+        uint64_t write_addr, uint32_t block_size)
+{
+    return sdmmc_xfer_sg(iov, iov_count, write_addr, block_size, false);
+}
+
+/*true when two block ranges overlap and at least one of them is written*/
+static bool sdmmc_q_conflict(uint64_t lba_a, uint32_t blocks_a, bool write_a,
+        uint64_t lba_b, uint32_t blocks_b, bool write_b)
+{
+    return (write_a || write_b) && (lba_a < (lba_b + blocks_b)) &&
+           (lba_b < (lba_a + blocks_a));
+}
+
+/*oldest pending request which must complete before req may start*/
+static sdmmc_request_t *sdmmc_q_older_conflict(const sdmmc_request_t *req)
+{
+    sdmmc_request_t *it;
+    sdmmc_request_t *oldest = NULL;
+
+    for (it = sdmmc_q.pending; it != NULL; it = it->next)
+    {
+        if (((int32_t)(it->seq - req->seq) < 0) &&
+                sdmmc_q_conflict(it->lba, it->blocks,
+                (it->dir == SDMMC_REQ_WRITE), req->lba, req->blocks,
+                (req->dir == SDMMC_REQ_WRITE)) &&
+                ((oldest == NULL) || ((int32_t)(it->seq - oldest->seq) < 0)))
+        {
+            oldest = it;
+        }
+    }
+    return oldest;
+}
+
+/*
+ * Tasks on the command queue engine complete in any order, a request must
+ * not start while a command it conflicts with is still prepared or running.
+ */
+static bool sdmmc_q_busy_conflict(const sdmmc_request_t *req)
+{
+    const struct sdmmc_q_cmd *cmd;
+    uint32_t i;
+
+    if (!sdmmc_q.use_cqe)
+    {
+        return false;
+    }
+    for (i = 0U; i < sdmmc_q.slot_count; i++)
+    {
+        cmd = &sdmmc_q.cmd[i];
+        if ((cmd->state != SDMMC_SLOT_FREE) &&
+                sdmmc_q_conflict(cmd->lba, cmd->blocks, !cmd->is_read,
+                req->lba, req->blocks, (req->dir == SDMMC_REQ_WRITE)))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void sdmmc_q_unlink(sdmmc_request_t *req)
+{
+    sdmmc_request_t **link = &sdmmc_q.pending;
+
+    while (*link != req)
+    {
+        link = &(*link)->next;
+    }
+    *link = req->next;
+    req->next = NULL;
+}
+
+/*
+ * Elevator, take the lowest pending block address at or above the last
+ * one dispatched and wrap around once the top is reached.
+ */
+static sdmmc_request_t *sdmmc_q_pick(uint64_t head_pos)
+{
+    sdmmc_request_t *cand = NULL;
+    sdmmc_request_t *older;
+    sdmmc_request_t *it;
+
+    for (it = sdmmc_q.pending; it != NULL; it = it->next)
+    {
+        if (it->lba >= head_pos)
+        {
+            cand = it;
+            break;
+        }
+    }
+    if (cand == NULL)
+    {
+        cand = sdmmc_q.pending;
+    }
+    if (cand == NULL)
+    {
+        return NULL;
+    }
+
+    /*never let a request overtake an older one it conflicts with*/
+    older = sdmmc_q_older_conflict(cand);
+    while (older != NULL)
+    {
+        cand = older;
+        older = sdmmc_q_older_conflict(cand);
+    }
+    if (sdmmc_q_busy_conflict(cand))
+    {
+        return NULL;
+    }
+
+    sdmmc_q_unlink(cand);
+    return cand;
+}
+
+/*pending request which continues the data command at lba*/
+static sdmmc_request_t *sdmmc_q_pick_adjacent(uint64_t lba,
+        sdmmc_req_dir_t dir)
+{
+    sdmmc_request_t *it;
+
+    for (it = sdmmc_q.pending; (it != NULL) && (it->lba <= lba);
+            it = it->next)
+    {
+        if ((it->lba == lba) && (it->dir == dir) &&
+                (sdmmc_q_older_conflict(it) == NULL) &&
+                !sdmmc_q_busy_conflict(it))
+        {
+            sdmmc_q_unlink(it);
+            return it;
+        }
+    }
+    return NULL;
+}
+
+static void sdmmc_q_finish(sdmmc_request_t *req)
+{
+    if (req->dir == SDMMC_REQ_READ)
+    {
+        /*drop lines speculatively fetched while the DMA was running*/
+        cache_range_list_op(CACHE_OP_INVALIDATE, req->iov, req->iov_count);
+    }
+    if (req->done != NULL)
+    {
+        req->done(req);
+    }
+    (void)osal_semaphore_post(req->sem);
+}
+
+static void sdmmc_q_set_desc(uint32_t slot, uint32_t idx, uint64_t addr,
+        uint32_t len, bool last)
+{
+#if (SDMMC_Q_CQE == 1)
+    if (sdmmc_q.use_cqe)
+    {
+        sdmmc_set_cqe_desc(&cqe_desc[slot][idx], addr, len, last);
+        return;
+    }
+#endif
+#if (SDMMC_ADMA3_EN == 1)
+    if (sdmmc_q.use_adma3)
+    {
+        sdmmc_set_adma3_desc(&adma3_sets[slot].data[idx], addr, len, last);
+        return;
+    }
+#endif
+    sdmmc_set_desc(&sdmmc_descriptor.dma_descriptor[slot][idx], addr, len,
+            last);
+}
+
+/*
+ * Build the next data command into a slot. The command continues the
+ * request being split, if any, and pulls in pending requests which carry
+ * on at the next block in the same direction until the descriptor table
+ * is full. Returns false when there is nothing to dispatch.
+ */
+static bool sdmmc_q_build(uint32_t slot)
+{
+    struct sdmmc_q_cmd *cmd = &sdmmc_q.cmd[slot];
+    uint32_t max_desc = SDMMC_MAX_DESCRIPTOR;
+    sdmmc_request_t *req;
+    sdmmc_request_t *tail;
+    sdmmc_request_t *next;
+    sdmmc_request_t *touched = NULL;
+    uint32_t seg;
+    size_t off;
+    size_t bytes = 0U;
+    size_t len;
+    uint32_t count = 0U;
+    uint32_t blocks;
+
+    /*the slot is only built once it has a first request*/
+    cmd->first = NULL;
+    cmd->last = NULL;
+    if (sdmmc_q.use_cqe)
+    {
+        max_desc = SDMMC_CQE_SLOT_DESC;
+    }
+    else if (sdmmc_q.use_adma3)
+    {
+        max_desc = SDMMC_ADMA3_SLOT_DESC;
+    }
+
+    osal_enter_critical();
+    if (sdmmc_q.cur == NULL)
+    {
+        sdmmc_q.cur = sdmmc_q_pick(sdmmc_q.cur_lba);
+        if (sdmmc_q.cur != NULL)
+        {
+            sdmmc_q.cur_lba = sdmmc_q.cur->lba;
+        }
+    }
+    osal_exit_critical();
+    req = sdmmc_q.cur;
+    if (req == NULL)
+    {
+        return false;
+    }
+
+    /*size the command, merging adjacent requests as the table allows*/
+    tail = req;
+    seg = req->seg;
+    off = req->off;
+    while (count < max_desc)
+    {
+        if (seg == tail->iov_count)
+        {
+            /*requests merged by the previous command but left untouched*/
+            next = tail->next;
+            if (next == NULL)
+            {
+                osal_enter_critical();
+                next = sdmmc_q_pick_adjacent(tail->lba + tail->blocks,
+                        tail->dir);
+                osal_exit_critical();
+            }
+            if (next == NULL)
+            {
+                break;
+            }
+            tail->next = next;
+            tail = next;
+            seg = 0U;
+            off = 0U;
+            continue;
+        }
+        len = tail->iov[seg].size - off;
+        if (len > DESC_MAX_XFER_SIZE)
+        {
+            len = DESC_MAX_XFER_SIZE;
+        }
+        if (len != 0U)
+        {
+            bytes += len;
+            count++;
+        }
+        off += len;
+        if (off == tail->iov[seg].size)
+        {
+            seg++;
+            off = 0U;
+        }
+    }
+
+    blocks = (uint32_t)(bytes / SDMMC_BLOCK_SIZE);
+    if (blocks > SDMMC_SG_MAX_BLOCKS)
+    {
+        blocks = SDMMC_SG_MAX_BLOCKS;
+    }
+    if (blocks == 0U)
+    {
+        /*a full table of segments smaller than one block, give up on them*/
+        sdmmc_q.cur = NULL;
+        for (; req != NULL; req = next)
+        {
+            next = req->next;
+            req->status = -EINVAL;
+            req->seg = req->iov_count;
+            if (req->inflight == 0U)
+            {
+                sdmmc_q_finish(req);
+            }
+        }
+        return true;
+    }
+
+    cmd->is_read = (req->dir == SDMMC_REQ_READ);
+    cmd->lba = sdmmc_q.cur_lba;
+    cmd->blocks = blocks;
+    cmd->first = req;
+
+    bytes = (size_t)blocks * SDMMC_BLOCK_SIZE;
+    count = 0U;
+    while (bytes != 0U)
+    {
+        if (req->seg == req->iov_count)
+        {
+            req = req->next;
+            continue;
+        }
+        len = req->iov[req->seg].size - req->off;
+        if (len > DESC_MAX_XFER_SIZE)
+        {
+            len = DESC_MAX_XFER_SIZE;
+        }
+        if (len > bytes)
+        {
+            len = bytes;
+        }
+        if (len != 0U)
+        {
+            if (touched != req)
+            {
+                req->inflight++;
+                touched = req;
+            }
+            sdmmc_q_set_desc(slot, count, (uint64_t)(uintptr_t)
+                    req->iov[req->seg].addr + req->off, (uint32_t)len,
+                    (len == bytes));
+            count++;
+            bytes -= len;
+        }
+        req->off += len;
+        if (req->off == req->iov[req->seg].size)
+        {
+            req->seg++;
+            req->off = 0U;
+        }
+    }
+    cmd->last = touched;
+    cmd->desc_count = count;
+
+    /*the first request not fully described carries on in the next command*/
+    while ((req != NULL) && (req->seg == req->iov_count))
+    {
+        req = (req == tail) ? NULL : req->next;
+    }
+    sdmmc_q.cur = req;
+    sdmmc_q.cur_lba += blocks;
+
+    return true;
+}
+
+static void sdmmc_q_complete(uint32_t slot, int32_t status)
+{
+    struct sdmmc_q_cmd *cmd = &sdmmc_q.cmd[slot];
+    sdmmc_request_t *req = cmd->first;
+    sdmmc_request_t *next;
+    bool is_last = false;
+
+    cmd->state = SDMMC_SLOT_FREE;
+    while (!is_last)
+    {
+        /*the request may be reused by its owner once finished*/
+        next = req->next;
+        is_last = (req == cmd->last);
+        if (status != 0)
+        {
+            req->status = status;
+        }
+        req->inflight--;
+        if ((req->inflight == 0U) && (req->seg == req->iov_count))
+        {
+            sdmmc_q_finish(req);
+        }
+        req = next;
+    }
+    cmd->first = NULL;
+    cmd->last = NULL;
+}
+
+static void sdmmc_q_issue(uint32_t slot)
+{
+    struct sdmmc_q_cmd *cmd = &sdmmc_q.cmd[slot];
+    cmd_parameters_t command_config;
+
+    cmd->state = SDMMC_SLOT_ACTIVE;
+#if (SDMMC_Q_CQE == 1)
+    if (sdmmc_q.use_cqe)
+    {
+        sdmmc_cqe_set_task(&cqe_tdl[slot], cmd->is_read, cmd->blocks,
+                (uint32_t)cmd->lba, cqe_desc[slot], cmd->desc_count);
+        sdmmc_cqe_ring(slot);
+        return;
+    }
+#endif
+
+    /*auto CMD23 sets the block count up front, no CMD12 is needed*/
+    command_config.argument = cmd->lba;
+    if (cmd->is_read)
+    {
+        command_config.command_index = (cmd->blocks > 1U) ?
+                SDMMC_CMD_READ_MULT_BLOCK : SDMMC_CMD_READ_SINGLE_BLOCK;
+    }
+    else
+    {
+        command_config.command_index = SDMMC_CMD_WRITE_MULT_BLOCK;
+    }
+    command_config.data_xfer_present = SDMMC_DATA_XFER_PST;
+    command_config.response_type = SDMMC_SHORT_RESPONSE;
+    command_config.id_check_enable = SDMMC_CMD_ID_CHECK_EN;
+    command_config.crc_check_enable = SDMMC_CMD_CRC_CHECK_EN;
+
+    sdmmc_start_adma(sdmmc_descriptor.dma_descriptor[slot], cmd->desc_count,
+            SDMMC_BLOCK_SIZE, cmd->blocks);
+    sdmmc_set_xfer_config(&command_config);
+    if (sdmmc_send_command(&command_config) != 0)
+    {
+        ERROR("SDMMC: failed to issue queued command");
+        sdmmc_q_complete(slot, -EIO);
+    }
+}
+
+#if (SDMMC_ADMA3_EN == 1)
+/*
+ * Hand every built command to the host as one ADMA3 chain, in the order
+ * they were built. The host runs them back to back and interrupts once.
+ */
+static void sdmmc_q_issue_chain(void)
+{
+    struct sdmmc_q_cmd *cmd;
+    uint32_t count = 0U;
+    uint32_t slot;
+    uint32_t i;
+    uint32_t k;
+
+    for (i = 0U; i < sdmmc_q.slot_count; i++)
+    {
+        if (sdmmc_q.cmd[i].state != SDMMC_SLOT_BUILT)
+        {
+            continue;
+        }
+        /*insert by build order*/
+        k = count;
+        while ((k > 0U) && ((int32_t)(sdmmc_q.cmd[i].order -
+                sdmmc_q.cmd[sdmmc_q.chain[k - 1U]].order) < 0))
+        {
+            sdmmc_q.chain[k] = sdmmc_q.chain[k - 1U];
+            k--;
+        }
+        sdmmc_q.chain[k] = i;
+        count++;
+    }
+    if (count == 0U)
+    {
+        return;
+    }
+
+    for (k = 0U; k < count; k++)
+    {
+        slot = sdmmc_q.chain[k];
+        cmd = &sdmmc_q.cmd[slot];
+        cmd->state = SDMMC_SLOT_ACTIVE;
+        sdmmc_set_adma3_cmd(&adma3_sets[slot].cmd, cmd->is_read, cmd->blocks,
+                (uint32_t)cmd->lba);
+        sdmmc_set_adma3_entry(&adma3_chain[k], &adma3_sets[slot].cmd,
+                cmd->desc_count, ((k + 1U) == count));
+    }
+    sdmmc_q.chain_len = count;
+
+    if (sdmmc_start_adma3(adma3_chain, count) != CTRL_CONFIG_PASS)
+    {
+        ERROR("SDMMC: failed to start ADMA3 chain");
+        for (k = 0U; k < count; k++)
+        {
+            sdmmc_q_complete(sdmmc_q.chain[k], -EIO);
+        }
+        sdmmc_q.chain_len = 0U;
+    }
+}
+
+static void sdmmc_q_reap_chain(void)
+{
+    uint32_t failed = sdmmc_q.chain_len;
+    uint64_t pos;
+    uint32_t k;
+
+    if (sdmmc_descriptor.status_code != 0)
+    {
+        /*the host stops on the failing set, the ones ahead of it are done*/
+        pos = sdmmc_adma3_position();
+        failed = 0U;
+        for (k = 0U; k < sdmmc_q.chain_len; k++)
+        {
+            if (pos == (uint64_t)(uintptr_t)&adma3_chain[k])
+            {
+                failed = k;
+                break;
+            }
+        }
+    }
+    for (k = 0U; k < sdmmc_q.chain_len; k++)
+    {
+        if (k < failed)
+        {
+            sdmmc_q_complete(sdmmc_q.chain[k], 0);
+        }
+        else if (k == failed)
+        {
+            sdmmc_q_complete(sdmmc_q.chain[k], -EIO);
+        }
+        else
+        {
+            /*never started, goes out again with the next chain*/
+            sdmmc_q.cmd[sdmmc_q.chain[k]].state = SDMMC_SLOT_BUILT;
+        }
+    }
+    sdmmc_q.chain_len = 0U;
+}
+#endif
+
+static bool sdmmc_q_any(uint32_t state)
+{
+    uint32_t i;
+
+    for (i = 0U; i < sdmmc_q.slot_count; i++)
+    {
+        if (sdmmc_q.cmd[i].state == state)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void sdmmc_q_issue_built(void)
+{
+    uint32_t i;
+    int32_t oldest = -1;
+
+    if (sdmmc_q.use_cqe)
+    {
+        for (i = 0U; i < sdmmc_q.slot_count; i++)
+        {
+            if (sdmmc_q.cmd[i].state == SDMMC_SLOT_BUILT)
+            {
+                sdmmc_q_issue(i);
+            }
+        }
+        return;
+    }
+
+    /*one command or chain at a time, in the order they were built*/
+    if (sdmmc_q_any(SDMMC_SLOT_ACTIVE))
+    {
+        return;
+    }
+#if (SDMMC_ADMA3_EN == 1)
+    if (sdmmc_q.use_adma3)
+    {
+        sdmmc_q_issue_chain();
+        return;
+    }
+#endif
+    for (i = 0U; i < sdmmc_q.slot_count; i++)
+    {
+        if ((sdmmc_q.cmd[i].state == SDMMC_SLOT_BUILT) && ((oldest < 0) ||
+                ((int32_t)(sdmmc_q.cmd[i].order -
+                sdmmc_q.cmd[oldest].order) < 0)))
+        {
+            oldest = (int32_t)i;
+        }
+    }
+    if (oldest >= 0)
+    {
+        sdmmc_q_issue((uint32_t)oldest);
     }
+}
 
-    /*send cmd to request data from the card*/
-    else
+static void sdmmc_q_fill(void)
+{
+    uint32_t i;
+
+    for (i = 0U; i < sdmmc_q.slot_count; i++)
     {
-        sdmmc_set_up_xfer(sdmmc_descriptor.dma_descriptor, pread_buffer,
-                block_size, number_of_blocks);
-        sdmmc_set_xfer_config(pcmd);
-        DEBUG("Initiating sdmmc data read");
-        state = sdmmc_send_command(pcmd);
-        if (state != 0)
+        if (sdmmc_q.cmd[i].state != SDMMC_SLOT_FREE)
         {
-            return -EIO;
+            continue;
+        }
+        if (!sdmmc_q_build(i))
+        {
+            return;
+        }
+        if (sdmmc_q.cmd[i].first != NULL)
+        {
+            sdmmc_q.cmd[i].state = SDMMC_SLOT_BUILT;
+            sdmmc_q.cmd[i].order = sdmmc_q.order++;
         }
+    }
+}
 
-        sdmmc_wait_xfer_done();
+static void sdmmc_q_reap(void)
+{
+    uint32_t i;
+#if (SDMMC_Q_CQE == 1)
+    uint32_t done;
+    uint32_t err;
 
-        if (sdmmc_descriptor.status_code == 0)
-        {
-            cache_force_invalidate((uint64_t *)pread_buffer, block_size *
-                    number_of_blocks);
-            DEBUG("Read %x blocks", number_of_blocks);
+    if (sdmmc_q.use_cqe)
+    {
+        osal_enter_critical();
+        done = sdmmc_q.cqe_done;
+        err = sdmmc_q.cqe_err;
+        sdmmc_q.cqe_done = 0U;
+        sdmmc_q.cqe_err = 0U;
+        osal_exit_critical();
 
-            return 0;
+        if (err != 0U)
+        {
+            /*discard whatever the engine still holds and start it afresh*/
+            ERROR("SDMMC: command queue error, tasks %x", err);
+            if (sdmmc_cqe_disable() != CTRL_CONFIG_PASS)
+            {
+                ERROR("SDMMC: command queue did not halt");
+            }
+            err = (uint32_t)~done | err;
+            done = 0xFFFFFFFFU;
         }
-        else
+        for (i = 0U; i < sdmmc_q.slot_count; i++)
         {
-            return -EIO;
+            if ((sdmmc_q.cmd[i].state == SDMMC_SLOT_ACTIVE) &&
+                    ((done & ((uint32_t)1U << i)) != 0U))
+            {
+                sdmmc_q_complete(i, ((err & ((uint32_t)1U << i)) != 0U) ?
+                        -EIO : 0);
+            }
+        }
+        if (err != 0U)
+        {
+            sdmmc_cqe_enable(cqe_tdl);
+        }
+        return;
+    }
+#endif
+#if (SDMMC_ADMA3_EN == 1)
+    if (sdmmc_q.use_adma3)
+    {
+        sdmmc_q_reap_chain();
+        return;
+    }
+#endif
+    for (i = 0U; i < sdmmc_q.slot_count; i++)
+    {
+        if (sdmmc_q.cmd[i].state == SDMMC_SLOT_ACTIVE)
+        {
+            sdmmc_q_complete(i, (sdmmc_descriptor.status_code == 0) ? 0 :
+                    -EIO);
         }
     }
 }
 
-int32_t sdmmc_write_block_async(uint64_t *pwrite_buffer, uint64_t write_addr,
-        uint32_t block_size, uint32_t number_of_blocks,
-        sdmmc_cb_fun xfer_done_call_back)
+static void sdmmc_queue_task(void *arg)
 {
-    cmd_parameters_t *pcmd;
-    cmd_parameters_t command_config;
-    pcmd = &command_config;
-    uint32_t req_desc_count;
-    int32_t state;
+    (void)arg;
 
-    sdmmc_descriptor.is_api_sync = false;
-    sdmmc_descriptor.xfer_call_back = xfer_done_call_back;
-
-    if (block_size == 0U)
+    for (;;)
     {
-        return -EINVAL;
+        sdmmc_q_issue_built();
+        /*prepare the next commands while the current ones run*/
+        sdmmc_q_fill();
+
+        if (sdmmc_q.use_cqe)
+        {
+            /*
+             * New requests and task completions both post the kick, so the
+             * engine gets more tasks while earlier ones are still running
+             */
+            if (!sdmmc_q_any(SDMMC_SLOT_BUILT))
+            {
+                (void)osal_semaphore_wait(sdmmc_q.kick,
+                        OSAL_TIMEOUT_WAIT_FOREVER);
+            }
+            sdmmc_q_reap();
+            continue;
+        }
+        if (!sdmmc_q_any(SDMMC_SLOT_ACTIVE))
+        {
+            if (!sdmmc_q_any(SDMMC_SLOT_BUILT))
+            {
+                (void)osal_semaphore_wait(sdmmc_q.kick,
+                        OSAL_TIMEOUT_WAIT_FOREVER);
+            }
+            continue;
+        }
+        sdmmc_wait_xfer_done();
+        sdmmc_q_reap();
     }
+}
 
-    /*converts address into block number*/
-    write_addr /= block_size;
+int32_t sdmmc_queue_start(void)
+{
+    int32_t ret;
+#if (SDMMC_Q_CQE == 1)
+    uint32_t depth = 0U;
+#endif
 
-    if ((pwrite_buffer == NULL) || (number_of_blocks == 0U))
+    if (sdmmc_q.started)
     {
-        return -EINVAL;
+        return 0;
     }
-    /*set cmd to set block size*/
-    pcmd->argument = block_size;
-    pcmd->command_index = SDMMC_CMD_SET_BLOCK_LEN;
-    pcmd->data_xfer_present = SDMMC_DATA_XFER_NOT_PST;
-    pcmd->response_type = SDMMC_SHORT_RESPONSE;
-    pcmd->id_check_enable = SDMMC_CMD_ID_CHECK_EN;
-    pcmd->crc_check_enable = SDMMC_CMD_CRC_CHECK_EN;
-    state = sdmmc_send_command(pcmd);
 
-    if (state != 0)
+    /*the queue task owns the card from now on, hand it the cached writes*/
+    if (sdmmc_bcache_disable() != 0)
     {
         return -EIO;
     }
 
-    sdmmc_wait_cmd_done();
-
-    if (sdmmc_descriptor.status_code != 0)
+    sdmmc_q.kick = osal_semaphore_create(&osal_def_kick);
+    if (sdmmc_q.kick == NULL)
     {
-        return -EIO;
+        return -ENOMEM;
     }
-    /*argument preparation for data transfer*/
-    if (number_of_blocks > 1U)
+
+    sdmmc_descriptor.is_api_sync = true;
+    ret = sdmmc_set_block_len(SDMMC_BLOCK_SIZE);
+    if (ret != 0)
     {
-        pcmd->argument = write_addr;
-        pcmd->command_index = SDMMC_CMD_WRITE_MULT_BLOCK;
-        pcmd->data_xfer_present = SDMMC_DATA_XFER_PST;
-        pcmd->response_type = SDMMC_SHORT_RESPONSE;
-        pcmd->id_check_enable = SDMMC_CMD_ID_CHECK_EN;
-        pcmd->crc_check_enable = SDMMC_CMD_CRC_CHECK_EN;
+        return ret;
     }
-    else
+    sdmmc_enable_cmd23();
+
+    sdmmc_q.slot_count = SDMMC_Q_LEGACY_SLOTS;
+    sdmmc_q.use_cqe = false;
+    sdmmc_q.use_adma3 = false;
+#if (SDMMC_Q_CQE == 1)
+    if ((sdmmc_cqe_supported() != 0U) && (mmc_cmdq_enable(&depth) == 0))
     {
-        pcmd->argument = write_addr;
-        pcmd->command_index = SDMMC_CMD_WRITE_MULT_BLOCK;
-        pcmd->data_xfer_present = SDMMC_DATA_XFER_PST;
-        pcmd->response_type = SDMMC_SHORT_RESPONSE;
-        pcmd->id_check_enable = SDMMC_CMD_ID_CHECK_EN;
-        pcmd->crc_check_enable = SDMMC_CMD_CRC_CHECK_EN;
+        sdmmc_q.slot_count = (depth < SDMMC_CQE_DEPTH) ? depth :
+                SDMMC_CQE_DEPTH;
+        sdmmc_q.use_cqe = true;
+        sdmmc_cqe_enable(cqe_tdl);
+        INFO("SDMMC: command queue enabled, depth %d", sdmmc_q.slot_count);
     }
-    /*calculate no of descriptors required*/
-    req_desc_count = ((block_size * number_of_blocks) + (DESC_MAX_XFER_SIZE)
-            -1U) / DESC_MAX_XFER_SIZE;
-    if (req_desc_count > SDMMC_MAX_DESCRIPTOR)
+#endif
+#if (SDMMC_ADMA3_EN == 1)
+    if (!sdmmc_q.use_cqe && (sdmmc_adma3_supported() != 0U))
     {
-        return -EIO;
+        sdmmc_q.slot_count = (SDMMC_ADMA3_DEPTH < SDMMC_Q_SLOTS) ?
+                SDMMC_ADMA3_DEPTH : SDMMC_Q_SLOTS;
+        sdmmc_q.use_adma3 = true;
+        INFO("SDMMC: ADMA3 enabled, up to %d commands per chain",
+                sdmmc_q.slot_count);
     }
+#endif
 
-    /*send cmd to transfer data to the card*/
-    else
+    sdmmc_q.started = true;
+    if (osal_task_create(sdmmc_queue_task, "SDMMC_Queue", NULL,
+            SDMMC_Q_TASK_PRIORITY) == false)
     {
-        cache_force_write_back((uint64_t *)pwrite_buffer, block_size *
-                number_of_blocks);
-        sdmmc_set_up_xfer(sdmmc_descriptor.dma_descriptor, pwrite_buffer,
-                block_size, number_of_blocks);
-        sdmmc_set_xfer_config(pcmd);
-
-        state = sdmmc_send_command(pcmd);
-        INFO("Initiating sdmmc data write");
-        if (state != 0)
-        {
-            return -EIO;
-        }
+        ERROR("SDMMC: failed to create queue task");
+        sdmmc_q.started = false;
+        return -EIO;
     }
     return 0;
 }
 
-int32_t sdmmc_write_block_sync(uint64_t *pwrite_buffer, uint64_t write_addr,
-        uint32_t block_size, uint32_t number_of_blocks)
+int32_t sdmmc_request_init(sdmmc_request_t *req)
 {
-    cmd_parameters_t *pcmd;
-    cmd_parameters_t command_config;
-    pcmd = &command_config;
-    uint32_t req_desc_count;
-    int32_t state;
-
-    sdmmc_descriptor.is_api_sync = true;
-    if (block_size == 0U)
+    if (req == NULL)
     {
         return -EINVAL;
     }
+    req->sem = osal_semaphore_create(&req->sem_def);
+    if (req->sem == NULL)
+    {
+        return -ENOMEM;
+    }
+    return 0;
+}
 
-    /*converts address into block number*/
-    write_addr /= block_size;
+int32_t sdmmc_submit(sdmmc_request_t *req)
+{
+    sdmmc_request_t **link;
+    uint64_t total;
+    int32_t ret;
 
-    if ((pwrite_buffer == NULL) || (number_of_blocks == 0U))
+    if ((req == NULL) || (req->sem == NULL))
     {
         return -EINVAL;
     }
-    /*set cmd to set block size*/
-    pcmd->argument = block_size;
-    pcmd->command_index = SDMMC_CMD_SET_BLOCK_LEN;
-    pcmd->data_xfer_present = SDMMC_DATA_XFER_NOT_PST;
-    pcmd->response_type = SDMMC_SHORT_RESPONSE;
-    pcmd->id_check_enable = SDMMC_CMD_ID_CHECK_EN;
-    pcmd->crc_check_enable = SDMMC_CMD_CRC_CHECK_EN;
-    state = sdmmc_send_command(pcmd);
-
-    if (state != 0)
+    if (!sdmmc_q.started)
     {
         return -EIO;
     }
-
-    sdmmc_wait_cmd_done();
-
-    if (sdmmc_descriptor.status_code != 0)
+    ret = sdmmc_sg_check(req->iov, req->iov_count, SDMMC_BLOCK_SIZE, &total);
+    if (ret != 0)
     {
-        return -EIO;
+        return ret;
     }
-    /*argument preparation for data transfer*/
-    if (number_of_blocks > 1U)
+
+    if (req->dir == SDMMC_REQ_READ)
     {
-        pcmd->argument = write_addr;
-        pcmd->command_index = SDMMC_CMD_WRITE_MULT_BLOCK;
-        pcmd->data_xfer_present = SDMMC_DATA_XFER_PST;
-        pcmd->response_type = SDMMC_SHORT_RESPONSE;
-        pcmd->id_check_enable = SDMMC_CMD_ID_CHECK_EN;
-        pcmd->crc_check_enable = SDMMC_CMD_CRC_CHECK_EN;
+        /*write back dirty lines sharing the buffer edges before the DMA*/
+        cache_range_list_op(CACHE_OP_FLUSH, req->iov, req->iov_count);
     }
     else
     {
-        pcmd->argument = write_addr;
-        pcmd->command_index = SDMMC_CMD_WRITE_MULT_BLOCK;
-        pcmd->data_xfer_present = SDMMC_DATA_XFER_PST;
-        pcmd->response_type = SDMMC_SHORT_RESPONSE;
-        pcmd->id_check_enable = SDMMC_CMD_ID_CHECK_EN;
-        pcmd->crc_check_enable = SDMMC_CMD_CRC_CHECK_EN;
+        cache_range_list_op(CACHE_OP_CLEAN, req->iov, req->iov_count);
     }
-    /*calculate no of descriptors required*/
-    req_desc_count = ((block_size * number_of_blocks) + (DESC_MAX_XFER_SIZE)
-            -1U) / DESC_MAX_XFER_SIZE;
 
-    if (req_desc_count > SDMMC_MAX_DESCRIPTOR)
+    req->blocks = (uint32_t)(total / SDMMC_BLOCK_SIZE);
+    req->seg = 0U;
+    req->off = 0U;
+    req->inflight = 0U;
+    req->status = 0;
+    osal_semaphore_reset(req->sem);
+
+    osal_enter_critical();
+    req->seq = sdmmc_q.seq++;
+    /*keep the list sorted, equal addresses in arrival order*/
+    link = &sdmmc_q.pending;
+    while ((*link != NULL) && ((*link)->lba <= req->lba))
     {
-        return -EIO;
+        link = &(*link)->next;
     }
-    /*send cmd to transfer data to the card*/
-    else
-    {
-        cache_force_write_back((uint64_t *)pwrite_buffer, block_size *
-                number_of_blocks);
-        sdmmc_set_up_xfer(sdmmc_descriptor.dma_descriptor, pwrite_buffer,
-                block_size, number_of_blocks);
-        sdmmc_set_xfer_config(pcmd);
-
-        state = sdmmc_send_command(pcmd);
-        INFO("Initiating sdmmc data write");
-        if (state != 0)
-        {
-            return -EIO;
-        }
+    req->next = *link;
+    *link = req;
+    osal_exit_critical();
 
-        sdmmc_wait_xfer_done();
+    (void)osal_semaphore_post(sdmmc_q.kick);
+    return 0;
+}
 
-        if (sdmmc_descriptor.status_code == 0)
-        {
-            INFO("Written %x blocks", number_of_blocks);
-            return 0;
-        }
-        else
-        {
-            return -EIO;
-        }
+int32_t sdmmc_request_wait(sdmmc_request_t *req, uint64_t timeout_ms)
+{
+    if ((req == NULL) || (req->sem == NULL))
+    {
+        return -EINVAL;
     }
+    if (!osal_semaphore_wait(req->sem, timeout_ms))
+    {
+        return -ETIMEDOUT;
+    }
+    return req->status;
 }
 
-
 int32_t sdmmc_init_card(uint64_t *ptr_sec_num)
 {
     int32_t ret;
@@ -553,6 +1719,14 @@ int32_t sdmmc_init_card(uint64_t *ptr_sec_num)
         return -EINVAL;
     }
 
+#if (SDMMC_BCACHE_EN == 1)
+    /*write back what the cache holds before the card is set up again*/
+    if (sdmmc_bcache_flush() != 0)
+    {
+        WARN("SDMMC: block cache write back failed, retried after init");
+    }
+#endif
+
     if (sdmmc_is_card_present() != SDMMC_IS_CARD_DET)
     {
         ERROR("Device detection failed");
@@ -585,6 +1759,13 @@ int32_t sdmmc_init_card(uint64_t *ptr_sec_num)
 
     if (cmd_status == 0)
     {
+#if (SDMMC_BCACHE_EN == 1)
+        /*the card works without the cache, only slower*/
+        if (sdmmc_bcache_init(*ptr_sec_num) != 0)
+        {
+            WARN("SDMMC: block cache not available");
+        }
+#endif
         return 0;
     }
     else
@@ -595,6 +1776,28 @@ int32_t sdmmc_init_card(uint64_t *ptr_sec_num)
 #if (DEV_TYPE ==  DEV_TYPE_SD)
 /*follows SD association standard*/
 static int32_t sd_mmc_init(uint64_t *sec_num)
+{
+    int32_t state;
+
+    sdmmc_descriptor.use_uhs = (SDMMC_UHS_EN == 1) &&
+            (SUPPORT_DEF_SPEED == DEF_SPEED_DI) &&
+            ((sdmmc_host_timings() & SD_UHS_TIMINGS) != 0U);
+    state = sd_card_identify(sec_num);
+    if (state == -EAGAIN)
+    {
+        WARN("SDMMC: 1.8V switch failed, continuing at 3.3V");
+        sdmmc_descriptor.use_uhs = false;
+        sd_power_cycle();
+        state = sd_card_identify(sec_num);
+    }
+    if (state != 0)
+    {
+        return -EIO;
+    }
+    return sd_select_timing();
+}
+
+static int32_t sd_card_identify(uint64_t *sec_num)
 {
     cmd_parameters_t *pcmd_handle;
     cmd_parameters_t command_config;
@@ -622,6 +1825,18 @@ static int32_t sd_mmc_init(uint64_t *sec_num)
         return -EIO;
     }
     sd_get_card_type(pcard_specific_data);
+    /*move to 1.8V signalling when the card accepted it*/
+    if (sdmmc_descriptor.use_uhs)
+    {
+        if (sd_is_18v_accepted() == 0U)
+        {
+            sdmmc_descriptor.use_uhs = false;
+        }
+        else if (sd_switch_voltage(pcmd_handle) != 0)
+        {
+            return -EAGAIN;
+        }
+    }
     /*send cmd to request cid of the card*/
     state = sd_snd_all_cid(pcmd_handle);
     if (state != 0)
@@ -710,6 +1925,10 @@ static int32_t sd_check_ocr(cmd_parameters_t *pcmd)
 {
     int32_t state;
     pcmd->argument = SDMMC_ARG_SDHC_OCR;
+    if (sdmmc_descriptor.use_uhs)
+    {
+        pcmd->argument |= SDMMC_ARG_S18R;
+    }
     pcmd->command_index = SDMMC_CMD_READ_OCR;
     pcmd->data_xfer_present = SDMMC_DATA_XFER_NOT_PST;
     pcmd->response_type = SDMMC_SHORT_RESPONSE;
@@ -869,23 +2088,164 @@ static int32_t sd_bus_width_4(cmd_parameters_t *pcmd)
     sdmmc_wait_cmd_done();
     return sdmmc_descriptor.status_code;
 }
-static int32_t sd_snd_app_bus_cmd(cmd_parameters_t *pcmd)
+static int32_t sd_snd_app_bus_cmd(cmd_parameters_t *pcmd)
+{
+    int32_t state;
+    pcmd->argument = (pcard_specific_data->relative_address) <<
+            SDMMC_ARG_MASK_REL_ADD;
+    pcmd->command_index = SDMMC_CMD_SEND_APP;
+    pcmd->data_xfer_present = SDMMC_DATA_XFER_NOT_PST;
+    pcmd->response_type = SDMMC_SHORT_RESPONSE;
+    pcmd->id_check_enable = SDMMC_CMD_ID_CHECK_DI;
+    pcmd->crc_check_enable = SDMMC_CMD_CRC_CHECK_DI;
+    state = sdmmc_send_command(pcmd);
+    if (state != 0)
+    {
+        return state;
+    }
+    sdmmc_wait_cmd_done();
+    return sdmmc_descriptor.status_code;
+}
+
+static int32_t sd_switch_voltage(cmd_parameters_t *pcmd)
 {
     int32_t state;
-    pcmd->argument = (pcard_specific_data->relative_address) <<
-            SDMMC_ARG_MASK_REL_ADD;
-    pcmd->command_index = SDMMC_CMD_SEND_APP;
+    pcmd->argument = SDMMC_NO_CMD_ARG;
+    pcmd->command_index = SDMMC_CMD_VOLTAGE_SWITCH;
     pcmd->data_xfer_present = SDMMC_DATA_XFER_NOT_PST;
     pcmd->response_type = SDMMC_SHORT_RESPONSE;
-    pcmd->id_check_enable = SDMMC_CMD_ID_CHECK_DI;
-    pcmd->crc_check_enable = SDMMC_CMD_CRC_CHECK_DI;
+    pcmd->id_check_enable = SDMMC_CMD_ID_CHECK_EN;
+    pcmd->crc_check_enable = SDMMC_CMD_CRC_CHECK_EN;
     state = sdmmc_send_command(pcmd);
     if (state != 0)
     {
         return state;
     }
     sdmmc_wait_cmd_done();
-    return sdmmc_descriptor.status_code;
+    if (sdmmc_descriptor.status_code != 0)
+    {
+        return sdmmc_descriptor.status_code;
+    }
+
+    /*the card holds DAT low until the clock stops*/
+    sdmmc_sd_clock_enable(false);
+    if (sdmmc_get_dat_level() != 0U)
+    {
+        return -EIO;
+    }
+    sdmmc_set_signal_18v(true);
+    /*the card regulator needs 5 ms to settle*/
+    osal_task_delay(5);
+    sdmmc_sd_clock_enable(true);
+    osal_task_delay(1);
+    /*the card releases DAT once it runs at 1.8V*/
+    if (sdmmc_get_dat_level() != SD_DAT_LINES_HIGH)
+    {
+        return -EIO;
+    }
+    return 0;
+}
+
+static void sd_power_cycle(void)
+{
+    sdmmc_sd_clock_enable(false);
+    sdmmc_set_bus_power(false);
+    sdmmc_set_signal_18v(false);
+    /*keep the supply off long enough for the card to reset*/
+    osal_task_delay(SD_POWER_OFF_MS);
+    sdmmc_set_bus_power(true);
+    osal_task_delay(SD_POWER_OFF_MS);
+    sdmmc_sd_clock_enable(true);
+}
+
+static int32_t sd_switch_func(uint32_t arg)
+{
+    cmd_parameters_t command_config;
+
+    command_config.argument = arg;
+    command_config.command_index = SDMMC_CMD_SWITCH;
+    return sdmmc_read_data_cmd(&command_config, sd_switch_status,
+            SDMMC_SD_SWITCH_LEN, SDMMC_DATA_CMD_TIMEOUT_MS);
+}
+
+static int32_t sd_set_speed(sdmmc_timing_t timing, uint32_t func)
+{
+    if (sd_switch_func(SDMMC_ARG_SWITCH_SET | func) != 0)
+    {
+        return -EIO;
+    }
+    /*group 1 result in bits 379:376 of the big endian switch status*/
+    if ((sd_switch_status[16] & 0xFU) != func)
+    {
+        return -EIO;
+    }
+    if (sdmmc_set_timing(timing) != CTRL_CONFIG_PASS)
+    {
+        return -EIO;
+    }
+    if (sdmmc_timing_needs_tuning(timing))
+    {
+        return sdmmc_execute_tuning(SDMMC_CMD_SEND_TUNING, sd_tuning_pattern,
+                sizeof(sd_tuning_pattern));
+    }
+    return 0;
+}
+
+/*fastest access mode first, each with its CMD6 group 1 function*/
+static const struct
+{
+    sdmmc_timing_t timing;
+    uint32_t func;
+} sd_speeds[] =
+{
+    { SDMMC_TIMING_SDR104, 3U },
+    { SDMMC_TIMING_SDR50, 2U },
+    { SDMMC_TIMING_SD_HS, 1U },
+};
+
+static int32_t sd_select_timing(void)
+{
+    uint32_t host = sdmmc_host_timings();
+    uint32_t card;
+    uint32_t i;
+    sdmmc_timing_t timing;
+
+    if ((SUPPORT_DEF_SPEED == DEF_SPEED_DI) &&
+            (sd_switch_func(SDMMC_ARG_SWITCH_CHECK | SD_FUNC_NO_CHANGE) == 0))
+    {
+        /*group 1 support in bits 415:400 of the big endian switch status*/
+        card = ((uint32_t)sd_switch_status[12] << 8U) | sd_switch_status[13];
+        for (i = 0U; i < (sizeof(sd_speeds) / sizeof(sd_speeds[0])); i++)
+        {
+            timing = sd_speeds[i].timing;
+            if (((host & (1U << timing)) == 0U) ||
+                    ((card & (1U << sd_speeds[i].func)) == 0U) ||
+                    (((SD_UHS_TIMINGS & (1U << timing)) != 0U) &&
+                    !sdmmc_descriptor.use_uhs))
+            {
+                continue;
+            }
+            if (sd_set_speed(timing, sd_speeds[i].func) == 0)
+            {
+                sdmmc_descriptor.timing = timing;
+                INFO("SDMMC: bus timing %s", sdmmc_timing_names[timing]);
+                return 0;
+            }
+            WARN("SDMMC: %s failed, falling back",
+                    sdmmc_timing_names[timing]);
+            /*every access mode accepts the default speed clock*/
+            (void)sdmmc_set_timing(SDMMC_TIMING_SD_DS);
+        }
+        (void)sd_switch_func(SDMMC_ARG_SWITCH_SET | SD_FUNC_DS);
+    }
+
+    if (sdmmc_set_timing(SDMMC_TIMING_SD_DS) != CTRL_CONFIG_PASS)
+    {
+        return -EIO;
+    }
+    sdmmc_descriptor.timing = SDMMC_TIMING_SD_DS;
+    INFO("SDMMC: bus timing %s", sdmmc_timing_names[SDMMC_TIMING_SD_DS]);
+    return 0;
 }
 #endif
 
@@ -947,7 +2307,11 @@ static int32_t sd_mmc_init(uint64_t *sec_num)
     }
     /*send cmd to request extended csd of the card*/
     state = mmc_send_ext_csd(pcmd_handle, sec_num);
-    return state;
+    if (state != 0)
+    {
+        return -EIO;
+    }
+    return mmc_select_timing(pcmd_handle);
 }
 
 
@@ -1074,30 +2438,23 @@ static int32_t mmc_send_ext_csd(cmd_parameters_t *pcmd,
     pcmd->id_check_enable = SDMMC_CMD_ID_CHECK_EN;
     pcmd->crc_check_enable = SDMMC_CMD_CRC_CHECK_EN;
 
-    sdmmc_descriptor.is_api_sync = true;
-
-    sdmmc_set_up_xfer(sdmmc_descriptor.dma_descriptor, (uint64_t *)ext_csd_buff,
-            SDMMC_BLOCK_SIZE, SDMMC_SINGLE_BLOCK);
-    sdmmc_set_xfer_config(pcmd);
-
-    state = sdmmc_send_command(pcmd);
-    if (state != 0)
-    {
-        return -EIO;
-    }
-    sdmmc_wait_xfer_done();
-
-    if (sdmmc_descriptor.status_code == 0)
+    state = sdmmc_read_data_cmd(pcmd, ext_csd_buff, SDMMC_BLOCK_SIZE,
+            SDMMC_DATA_CMD_TIMEOUT_MS);
+    if (state == 0)
     {
-        cache_force_invalidate(ext_csd_buff, SDMMC_BLOCK_SIZE);
         *sector_count_ref = *(uint32_t *)(ext_csd_buff + SDMMC_EXT_CSD_SEC_NUM);
     }
-    return sdmmc_descriptor.status_code;
+    return state;
 }
 static int32_t mmc_switch_bus_width(cmd_parameters_t *pcmd)
+{
+    return mmc_switch(pcmd, SDMMC_SET_EXT_BUS_WIDTH);
+}
+
+static int32_t mmc_switch(cmd_parameters_t *pcmd, uint32_t arg)
 {
     int32_t state;
-    pcmd->argument = SDMMC_SET_EXT_BUS_WIDTH;
+    pcmd->argument = arg;
     pcmd->command_index = SDMMC_CMD_SWITCH;
     pcmd->data_xfer_present = SDMMC_DATA_XFER_NOT_PST;
     pcmd->response_type = SDMMC_SHORT_RESPONSE_BUSY;
@@ -1113,8 +2470,276 @@ static int32_t mmc_switch_bus_width(cmd_parameters_t *pcmd)
     sdmmc_wait_xfer_done();
     return sdmmc_descriptor.status_code;
 }
+
+static int32_t mmc_cmdq_enable(uint32_t *pdepth)
+{
+    cmd_parameters_t command_config;
+
+    /*ext_csd was read during card init*/
+    if ((ext_csd_buff[SDMMC_EXT_CSD_CMDQ_SUPPORT] & 0x1U) == 0U)
+    {
+        return -ENOTSUP;
+    }
+    *pdepth = (uint32_t)(ext_csd_buff[SDMMC_EXT_CSD_CMDQ_DEPTH] & 0x1FU) + 1U;
+
+    return mmc_switch(&command_config, SDMMC_SET_EXT_CMDQ_MODE);
+}
+
+/*re-read ext_csd to prove the data path works at the new timing*/
+static int32_t mmc_verify_bus(cmd_parameters_t *pcmd)
+{
+    uint64_t sec_num;
+
+    return mmc_send_ext_csd(pcmd, &sec_num);
+}
+
+/*high speed on the 8 bit sdr bus, where every faster timing starts from*/
+static int32_t mmc_select_hs(cmd_parameters_t *pcmd)
+{
+    if (sdmmc_set_timing(SDMMC_TIMING_MMC_LEGACY) != CTRL_CONFIG_PASS)
+    {
+        return -EIO;
+    }
+    if ((mmc_switch(pcmd, SDMMC_SET_HS_TIMING_HS) != 0) ||
+            (mmc_switch(pcmd, SDMMC_SET_EXT_BUS_WIDTH) != 0))
+    {
+        return -EIO;
+    }
+    if (sdmmc_set_timing(SDMMC_TIMING_MMC_HS) != CTRL_CONFIG_PASS)
+    {
+        return -EIO;
+    }
+    return mmc_verify_bus(pcmd);
+}
+
+static int32_t mmc_select_hs200(cmd_parameters_t *pcmd)
+{
+    if (mmc_switch(pcmd, SDMMC_SET_HS_TIMING_HS200) != 0)
+    {
+        return -EIO;
+    }
+    if (sdmmc_set_timing(SDMMC_TIMING_HS200) != CTRL_CONFIG_PASS)
+    {
+        return -EIO;
+    }
+    return sdmmc_execute_tuning(SDMMC_CMD_SEND_TUNING_HS200,
+            mmc_tuning_pattern, sizeof(mmc_tuning_pattern));
+}
+
+/*entered from tuned hs200, the bus only goes ddr at high speed timing*/
+static int32_t mmc_select_hs400(cmd_parameters_t *pcmd)
+{
+    if (mmc_switch(pcmd, SDMMC_SET_HS_TIMING_HS) != 0)
+    {
+        return -EIO;
+    }
+    if (sdmmc_set_timing(SDMMC_TIMING_MMC_HS) != CTRL_CONFIG_PASS)
+    {
+        return -EIO;
+    }
+    if ((mmc_switch(pcmd, SDMMC_SET_EXT_BUS_DDR8) != 0) ||
+            (mmc_switch(pcmd, SDMMC_SET_HS_TIMING_HS400) != 0))
+    {
+        return -EIO;
+    }
+    if (sdmmc_set_timing(SDMMC_TIMING_HS400) != CTRL_CONFIG_PASS)
+    {
+        return -EIO;
+    }
+    return mmc_verify_bus(pcmd);
+}
+
+/*entered from high speed, the strobe makes tuning unnecessary*/
+static int32_t mmc_select_hs400es(cmd_parameters_t *pcmd)
+{
+    if ((mmc_switch(pcmd, SDMMC_SET_EXT_BUS_DDR8_ES) != 0) ||
+            (mmc_switch(pcmd, SDMMC_SET_HS_TIMING_HS400) != 0))
+    {
+        return -EIO;
+    }
+    if (sdmmc_set_timing(SDMMC_TIMING_HS400ES) != CTRL_CONFIG_PASS)
+    {
+        return -EIO;
+    }
+    return mmc_verify_bus(pcmd);
+}
+
+static int32_t mmc_select_timing(cmd_parameters_t *pcmd)
+{
+    static const sdmmc_timing_t mmc_timings[] =
+    {
+        SDMMC_TIMING_HS400ES, SDMMC_TIMING_HS400, SDMMC_TIMING_HS200
+    };
+    uint32_t host = sdmmc_host_timings();
+    uint32_t card = 0U;
+    uint32_t dev_type = ext_csd_buff[SDMMC_EXT_CSD_DEVICE_TYPE];
+    sdmmc_timing_t timing;
+    int32_t state;
+    uint32_t i;
+
+    if ((dev_type & SDMMC_EXT_CSD_HS200_18V) != 0U)
+    {
+        card |= 1U << SDMMC_TIMING_HS200;
+    }
+    if ((dev_type & SDMMC_EXT_CSD_HS400_18V) != 0U)
+    {
+        card |= 1U << SDMMC_TIMING_HS400;
+        if ((ext_csd_buff[SDMMC_EXT_CSD_STROBE_SUPPORT] & 0x1U) != 0U)
+        {
+            card |= 1U << SDMMC_TIMING_HS400ES;
+        }
+    }
+
+    for (i = 0U; (SUPPORT_DEF_SPEED == DEF_SPEED_DI) &&
+            (i < (sizeof(mmc_timings) / sizeof(mmc_timings[0]))); i++)
+    {
+        timing = mmc_timings[i];
+        if ((host & card & (1U << timing)) == 0U)
+        {
+            continue;
+        }
+        /*every attempt starts over from high speed*/
+        if (mmc_select_hs(pcmd) != 0)
+        {
+            break;
+        }
+        if (timing == SDMMC_TIMING_HS400ES)
+        {
+            state = mmc_select_hs400es(pcmd);
+        }
+        else
+        {
+            state = mmc_select_hs200(pcmd);
+            if ((state == 0) && (timing == SDMMC_TIMING_HS400))
+            {
+                state = mmc_select_hs400(pcmd);
+            }
+        }
+        if (state == 0)
+        {
+            sdmmc_descriptor.timing = timing;
+            INFO("SDMMC: bus timing %s", sdmmc_timing_names[timing]);
+            return 0;
+        }
+        WARN("SDMMC: %s failed, falling back", sdmmc_timing_names[timing]);
+    }
+
+    if ((SUPPORT_DEF_SPEED == DEF_SPEED_DI) && (mmc_select_hs(pcmd) == 0))
+    {
+        timing = SDMMC_TIMING_MMC_HS;
+    }
+    else
+    {
+        timing = SDMMC_TIMING_MMC_LEGACY;
+        if (sdmmc_set_timing(timing) != CTRL_CONFIG_PASS)
+        {
+            return -EIO;
+        }
+        if ((mmc_switch(pcmd, SDMMC_SET_HS_TIMING_LEGACY) != 0) ||
+                (mmc_switch(pcmd, SDMMC_SET_EXT_BUS_WIDTH) != 0) ||
+                (mmc_verify_bus(pcmd) != 0))
+        {
+            return -EIO;
+        }
+    }
+    sdmmc_descriptor.timing = timing;
+    INFO("SDMMC: bus timing %s", sdmmc_timing_names[timing]);
+    return 0;
+}
 #endif
 
+/*single block read of a short status or tuning block, bounded in time*/
+static int32_t sdmmc_read_data_cmd(cmd_parameters_t *pcmd, uint8_t *pbuff,
+        uint32_t len, uint64_t timeout_ms)
+{
+    int32_t state;
+
+    pcmd->data_xfer_present = SDMMC_DATA_XFER_PST;
+    pcmd->response_type = SDMMC_SHORT_RESPONSE;
+    pcmd->id_check_enable = SDMMC_CMD_ID_CHECK_EN;
+    pcmd->crc_check_enable = SDMMC_CMD_CRC_CHECK_EN;
+    sdmmc_descriptor.is_api_sync = true;
+    /*drop a completion left over from an earlier read that timed out*/
+    osal_semaphore_reset(sdmmc_descriptor.semaphore_xfer);
+
+    sdmmc_set_up_xfer(sdmmc_descriptor.dma_descriptor[0], (uint64_t *)pbuff,
+            len, SDMMC_SINGLE_BLOCK);
+    sdmmc_set_xfer_config(pcmd);
+
+    state = sdmmc_send_command(pcmd);
+    if (state != 0)
+    {
+        return -EIO;
+    }
+    if (!osal_semaphore_wait(sdmmc_descriptor.semaphore_xfer, timeout_ms))
+    {
+        return -ETIMEDOUT;
+    }
+    if (sdmmc_descriptor.status_code != 0)
+    {
+        return -EIO;
+    }
+    cache_force_invalidate(pbuff, len);
+    return 0;
+}
+
+/*
+ * Sweep the sampling point over the phy delay line, reading the tuning
+ * block at each tap, and settle in the middle of the widest passing run.
+ */
+static int32_t sdmmc_execute_tuning(uint8_t cmd_index,
+        const uint8_t *ppattern, uint32_t len)
+{
+    cmd_parameters_t command_config;
+    uint32_t tap;
+    uint32_t start = 0U;
+    uint32_t run = 0U;
+    uint32_t best_start = 0U;
+    uint32_t best_run = 0U;
+
+    for (tap = 0U; tap < SDMMC_TUNE_TAPS; tap++)
+    {
+        if (sdmmc_set_tune_val(tap) != CTRL_CONFIG_PASS)
+        {
+            return -EIO;
+        }
+        command_config.argument = SDMMC_NO_CMD_ARG;
+        command_config.command_index = cmd_index;
+        if ((sdmmc_read_data_cmd(&command_config, tuning_buff, len,
+                SDMMC_TUNE_TIMEOUT_MS) == 0) &&
+                (memcmp(tuning_buff, ppattern, len) == 0))
+        {
+            if (run == 0U)
+            {
+                start = tap;
+            }
+            run++;
+            if (run > best_run)
+            {
+                best_run = run;
+                best_start = start;
+            }
+        }
+        else
+        {
+            run = 0U;
+        }
+    }
+
+    if (best_run < SDMMC_TUNE_MIN_WINDOW)
+    {
+        ERROR("SDMMC: tuning found no sampling window");
+        return -EIO;
+    }
+    if (sdmmc_set_tune_val(best_start + (best_run / 2U)) != CTRL_CONFIG_PASS)
+    {
+        return -EIO;
+    }
+    INFO("SDMMC: tuned, passing taps %d to %d", best_start,
+            best_start + best_run - 1U);
+    return 0;
+}
+
 static int32_t sdmmc_setup_host(void)
 {
     /*
@@ -1168,6 +2793,19 @@ void sdmmc_irq_handler(void *data)
     sdmmc_disable_int();
     sdmmc_clear_int();
 
+#if (SDMMC_Q_CQE == 1)
+    if (sdmmc_q.use_cqe)
+    {
+        uint32_t err_tags = 0U;
+
+        sdmmc_q.cqe_done |= sdmmc_cqe_get_done(&err_tags);
+        sdmmc_q.cqe_err |= err_tags;
+        sdmmc_enable_cqe_int();
+        (void)osal_semaphore_post(sdmmc_q.kick);
+        return;
+    }
+#endif
+
     switch (int_status)
     {
         case SDMMC_CMD_CPT_INT_LOG:
@@ -1190,6 +2828,12 @@ void sdmmc_irq_handler(void *data)
             }
             break;
 
+        case SDMMC_DMA_INT_LOG:
+            /*end of an ADMA3 chain, only the queue task runs them*/
+            sdmmc_descriptor.status_code = 0;
+            (void)osal_semaphore_post(sdmmc_descriptor.semaphore_xfer);
+            break;
+
         case SDMMC_CMD_TIMOUT_INT_LOG:
             sdmmc_descriptor.status_code = -EIO;
             (void)osal_semaphore_post(sdmmc_descriptor.semaphore_cmd);
@@ -1211,7 +2855,19 @@ void sdmmc_irq_handler(void *data)
             }
             break;
         default:
-            /*Do Nothing*/
+            /*any other error ends the transfer in flight*/
+            if ((int_status & SDMMC_ERR_INT_LOG) != 0U)
+            {
+                sdmmc_descriptor.status_code = -EIO;
+                if (sdmmc_descriptor.is_api_sync == true)
+                {
+                    (void)osal_semaphore_post(sdmmc_descriptor.semaphore_xfer);
+                }
+                else if (sdmmc_descriptor.xfer_call_back != NULL)
+                {
+                    sdmmc_descriptor.xfer_call_back(-EIO);
+                }
+            }
             break;
     }
 }
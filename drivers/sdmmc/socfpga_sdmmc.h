@@ -10,6 +10,10 @@
 #ifndef __SOCFPGA_SDMMC_H__
 #define __SOCFPGA_SDMMC_H__
 
+#include <stdbool.h>
+#include "osal.h"
+#include "socfpga_cache.h"
+
 /**
  * @file socfpga_sdmmc.h
  * @brief File for the HAL APIs of SDMMC called by application layer.
@@ -21,11 +25,14 @@
  * @ingroup drivers
  * @brief APIs for SoC FPGA SD/eMMC driver.
  * @details
- * The SD/eMMC driver supports both High-Speed and Default-Speed modes
- * over the SD and eMMC protocols.
+ * The SD/eMMC driver negotiates the fastest bus timing the host, the
+ * card and the board support, tuning the sampling point where the timing
+ * needs it and falling back to a slower timing when a step fails.
  *
- * SD cards support up to 25 MBps with a 4-bit data bus.
- * eMMC supports up to 50 MBps with an 8-bit data bus.
+ * SD cards run Default-Speed, High-Speed or, once switched to 1.8V
+ * signalling, UHS-I SDR50 and SDR104 (up to 104 MBps) on a 4-bit bus.
+ * eMMC devices run legacy, High-Speed, HS200, HS400 or HS400 with
+ * enhanced strobe (up to 400 MBps) on an 8-bit bus.
  *
  * To see example usage, see @ref sdmmc_rw_sample  "SDMMC Sample Application".
  * @{
@@ -74,10 +81,13 @@
 #define SDMMC_CMD_SEND_EXT_CSD          (8U)     /*!< SDMMC send EXT CSD command */
 #define SDMMC_CMD_READ_CID              (9U)     /*!< SDMMC read CID command */
 #define SDMMC_CMD_SEND_CSD              (9U)     /*!< SDMMC send CSD command */
+#define SDMMC_CMD_VOLTAGE_SWITCH        (11U)     /*!< SD switch to 1.8V signalling command */
 #define SDMMC_CMD_STOP_TRANSMISSION     (12U)     /*!< SDMMC stop xfer command */
 #define SDMMC_CMD_SET_BLOCK_LEN         (16U)     /*!< SDMMC set block length command */
 #define SDMMC_CMD_READ_SINGLE_BLOCK     (17U)     /*!< SDMMC read single block command */
 #define SDMMC_CMD_READ_MULT_BLOCK       (18U)     /*!< SDMMC read multi block command */
+#define SDMMC_CMD_SEND_TUNING           (19U)     /*!< SD send tuning block command */
+#define SDMMC_CMD_SEND_TUNING_HS200     (21U)     /*!< eMMC send tuning block command */
 #define SDMMC_CMD_WRITE_SINGLE_BLOCK    (24U)     /*!< SDMMC write single block command */
 #define SDMMC_CMD_WRITE_MULT_BLOCK      (25U)     /*!< SDMMC write multi block command */
 #define SDMMC_CMD_READ_OCR              (41U)     /*!< SDMMC read OCR command */
@@ -93,6 +103,16 @@
 #define SDMMC_ARG_CHECK_PATTERN    (0x000001AAU)          /*!< Check pattern for echo back*/
 #define SDMMC_ARG_SDHC_OCR         (0x40010000U)          /*!< Argument for voltage negotiation*/
 #define SDMMC_SET_EXT_BUS_WIDTH    (0x03B70200U)          /*!< Argument to set the bus width as 8*/
+#define SDMMC_SET_EXT_CMDQ_MODE    (0x030F0100U)          /*!< Argument to enable the eMMC command queue*/
+#define SDMMC_SET_EXT_BUS_DDR8     (0x03B70600U)          /*!< Argument to set the bus width as 8 DDR*/
+#define SDMMC_SET_EXT_BUS_DDR8_ES  (0x03B78600U)          /*!< Argument to set the bus width as 8 DDR with enhanced strobe*/
+#define SDMMC_SET_HS_TIMING_LEGACY (0x03B90000U)          /*!< Argument to select backward compatible timing*/
+#define SDMMC_SET_HS_TIMING_HS     (0x03B90100U)          /*!< Argument to select high speed timing*/
+#define SDMMC_SET_HS_TIMING_HS200  (0x03B90200U)          /*!< Argument to select HS200 timing*/
+#define SDMMC_SET_HS_TIMING_HS400  (0x03B90300U)          /*!< Argument to select HS400 timing*/
+#define SDMMC_ARG_S18R             (0x01000000U)          /*!< ACMD41 request for 1.8V signalling*/
+#define SDMMC_ARG_SWITCH_CHECK     (0x00FFFFF0U)          /*!< CMD6 query of the group 1 functions*/
+#define SDMMC_ARG_SWITCH_SET       (0x80FFFFF0U)          /*!< CMD6 switch of the group 1 function*/
 
 /**
  * @brief The SDMMC response type as defined by the protocol.
@@ -115,7 +135,15 @@
 #define SDMMC_REL_CARD_ADDRESS     (1U)          /*!< Default relative card address*/
 #define SDMMC_SINGLE_BLOCK         (1U)          /*!< Used for single block transaction*/
 #define SDMMC_EXT_CSD_SEC_NUM      (212U)          /*!< Used to extract number of sectors from csd */
+#define SDMMC_EXT_CSD_CMDQ_DEPTH   (307U)          /*!< Used to extract the command queue depth from ext csd */
+#define SDMMC_EXT_CSD_CMDQ_SUPPORT (308U)          /*!< Used to check command queue support in ext csd */
+#define SDMMC_EXT_CSD_STROBE_SUPPORT (184U)        /*!< Used to check enhanced strobe support in ext csd */
+#define SDMMC_EXT_CSD_DEVICE_TYPE  (196U)          /*!< Used to extract the supported bus timings from ext csd */
+#define SDMMC_EXT_CSD_HS200_18V    (0x10U)          /*!< Device type bit of HS200 at 1.8V */
+#define SDMMC_EXT_CSD_HS400_18V    (0x40U)          /*!< Device type bit of HS400 at 1.8V */
+#define SDMMC_SD_SWITCH_LEN        (64U)          /*!< Size of the CMD6 switch status */
 #define SDMMC_BLOCK_SIZE           (512U)          /*!< Size of block for each transaction*/
+#define SDMMC_SG_ALIGN             (4U)          /*!< Alignment of scatter-gather segment addresses and lengths*/
 
 /**
  * @brief Types of interrupts raised by the host controller.
@@ -125,6 +153,8 @@
 #define SDMMC_CMD_TIMOUT_INT_LOG     (0x18000U)        /*!< Command timeout interrupt*/
 #define SDMMC_IS_CARD_DET            (1U)     /*!< Check the card detection state*/
 #define SDMMC_XFER_TIMOUT_INT_LOG    (0x108000U)          /*!< transfer timeout interrupt*/
+#define SDMMC_ERR_INT_LOG            (0x8000U)          /*!< Error interrupt summary*/
+#define SDMMC_DMA_INT_LOG            (0x8U)          /*!< DMA interrupt, end of an ADMA3 chain*/
 /**
  * @}
  */
@@ -137,6 +167,66 @@
  */
 struct sdmmc_context;
 
+/**
+ * @brief One segment of a scatter-gather block transfer
+ * @ingroup sdmmc_structs
+ *
+ * Shares its layout with the cache range type so that a segment list is
+ * maintained in the cache in a single batch.
+ */
+typedef cache_range_t sdmmc_iovec_t;
+
+/**
+ * @brief Direction of a queued block request
+ * @ingroup sdmmc_structs
+ */
+typedef enum
+{
+    SDMMC_REQ_READ = 0,    /*!< Read blocks from the card */
+    SDMMC_REQ_WRITE        /*!< Write blocks to the card */
+} sdmmc_req_dir_t;
+
+struct sdmmc_request;
+
+/**
+ * @brief Completion callback of a queued block request
+ *
+ * Called from the queue task once every block of the request has been
+ * transferred or the request has failed.
+ *
+ * @param[in] req The completed request, status holds the result.
+ */
+typedef void (*sdmmc_req_done_t)(struct sdmmc_request *req);
+
+/**
+ * @brief Block request for the SDMMC request queue
+ * @ingroup sdmmc_structs
+ *
+ * The caller fills in the fields up to status and keeps the request and
+ * its segments untouched until it completes. Block addresses and counts
+ * are in units of SDMMC_BLOCK_SIZE.
+ */
+typedef struct sdmmc_request
+{
+    sdmmc_req_dir_t dir;             /*!< Transfer direction */
+    uint64_t lba;                    /*!< First block on the card */
+    const sdmmc_iovec_t *iov;        /*!< Memory segments, as for sdmmc_read_blocks_sg() */
+    uint32_t iov_count;              /*!< Number of segments */
+    sdmmc_req_done_t done;           /*!< Optional completion callback */
+    void *priv;                      /*!< Caller data, not used by the driver */
+    int32_t status;                  /*!< 0 on success, negative error code on failure */
+
+    /* Driver private */
+    osal_semaphore_def_t sem_def;
+    osal_semaphore_t sem;
+    struct sdmmc_request *next;
+    uint32_t seq;
+    uint32_t blocks;
+    uint32_t seg;
+    size_t off;
+    uint32_t inflight;
+} sdmmc_request_t;
+
 /**
  * @addtogroup sdmmc_fns
  * @{
@@ -181,10 +271,58 @@ int32_t sdmmc_read_block_sync(uint64_t *pread_buffer, uint64_t read_addr,
  * - -EIO:    Write operation failed.
  * - -EIO:    Command execution failed.
  * - -EINVAL: One or more arguments are invalid.
+ *
+ * With the block cache in write-back mode, writes of 512 byte blocks may
+ * complete in the cache; call sdmmc_bcache_flush() before the card is
+ * removed.
  */
 int32_t sdmmc_write_block_sync(uint64_t *pwrite_buffer, uint64_t write_addr,
         uint32_t block_size, uint32_t number_of_blocks);
 
+/**
+ * @brief Reads consecutive blocks into a list of memory segments.
+ *
+ * The blocks starting at read_addr are scattered over the segments in list
+ * order. A block may straddle two segments. Requests of any size are split
+ * into data commands of one descriptor table each, the table of the next
+ * command is built while the current one is in flight.
+ *
+ * @param[in] iov        List of destination segments, each SDMMC_SG_ALIGN
+ *                       aligned in address and length.
+ * @param[in] iov_count  Number of segments in the list.
+ * @param[in] read_addr  The SD/eMMC address from which the data should be read.
+ * @param[in] block_size The size (in bytes) of each block to be read.
+ *
+ * @return
+ * - 0:       Read operation was successful.
+ * - -EIO:    Read operation failed.
+ * - -EINVAL: One or more arguments are invalid, or the segments do not add
+ *            up to whole blocks.
+ */
+int32_t sdmmc_read_blocks_sg(const sdmmc_iovec_t *iov, uint32_t iov_count,
+        uint64_t read_addr, uint32_t block_size);
+
+/**
+ * @brief Writes a list of memory segments to consecutive blocks.
+ *
+ * The segments are gathered in list order into the blocks starting at
+ * write_addr. Requests are split as for sdmmc_read_blocks_sg().
+ *
+ * @param[in] iov        List of source segments, each SDMMC_SG_ALIGN aligned
+ *                       in address and length.
+ * @param[in] iov_count  Number of segments in the list.
+ * @param[in] write_addr The SD/eMMC address to which the data should be written.
+ * @param[in] block_size The size (in bytes) of each block to be written.
+ *
+ * @return
+ * - 0:       Write operation was successful.
+ * - -EIO:    Write operation failed.
+ * - -EINVAL: One or more arguments are invalid, or the segments do not add
+ *            up to whole blocks.
+ */
+int32_t sdmmc_write_blocks_sg(const sdmmc_iovec_t *iov, uint32_t iov_count,
+        uint64_t write_addr, uint32_t block_size);
+
 /**
  * @brief Performs a single or multi-block read from a specified address.
  * @warning If the input handle is invalid, this function silently takes no action.
@@ -225,6 +363,75 @@ int32_t sdmmc_write_block_async(uint64_t *pwrite_buffer, uint64_t write_addr,
         uint32_t block_size, uint32_t number_of_blocks, sdmmc_cb_fun
         xfer_done_call_back);
 
+/**
+ * @brief Starts the request queue.
+ *
+ * Creates the task which owns the controller from then on. Pending requests
+ * are served in ascending block order, sweeping back to the lowest address
+ * once the top is reached, and requests continuing one another in the same
+ * direction are merged into a single data command. A request never passes
+ * an older one it overlaps with when either of them writes. On eMMC devices
+ * with command queuing the commands are handed to the command queue engine.
+ * Otherwise, on hosts with ADMA3, the commands built meanwhile are chained
+ * and run back to back under a single interrupt, and on other hosts the
+ * next command is prepared while the current one runs.
+ *
+ * Once started, the sync, async and scatter-gather calls return -EBUSY.
+ * Blocks held dirty in the block cache are written back first.
+ * Must be called after sdmmc_init_card().
+ *
+ * @return
+ * - 0:       Queue started, or already running.
+ * - -ENOMEM: Could not allocate the queue resources.
+ * - -EIO:    Command execution failed.
+ */
+int32_t sdmmc_queue_start(void);
+
+/**
+ * @brief Prepares a request for use with the queue.
+ *
+ * Called once per request object, the object may then be submitted any
+ * number of times, one submission at a time.
+ *
+ * @param[in] req Request to prepare.
+ *
+ * @return
+ * - 0:       Success.
+ * - -EINVAL: req is NULL.
+ * - -ENOMEM: Could not create the completion semaphore.
+ */
+int32_t sdmmc_request_init(sdmmc_request_t *req);
+
+/**
+ * @brief Queues a block request.
+ *
+ * Returns once the request is queued. Completion is signalled through the
+ * done callback, if set, and to sdmmc_request_wait().
+ *
+ * @param[in] req Initialized request with dir, lba, iov and iov_count set.
+ *
+ * @return
+ * - 0:       Request queued.
+ * - -EINVAL: The request or its segments are invalid, or the segments do
+ *            not add up to whole blocks.
+ * - -EIO:    The queue is not started.
+ */
+int32_t sdmmc_submit(sdmmc_request_t *req);
+
+/**
+ * @brief Waits for a queued request to complete.
+ *
+ * @param[in] req        Submitted request.
+ * @param[in] timeout_ms Time to wait, in milliseconds.
+ *
+ * @return
+ * - 0:          Request completed successfully.
+ * - -ETIMEDOUT: Request did not complete in time.
+ * - -EINVAL:    req is invalid.
+ * - Otherwise the error code the request completed with.
+ */
+int32_t sdmmc_request_wait(sdmmc_request_t *req, uint64_t timeout_ms);
+
 /**
  * @brief Performs the initialization sequence on the card.
  * @warning If the input handle is invalid, this function silently takes no action.
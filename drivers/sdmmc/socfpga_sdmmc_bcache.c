@@ -0,0 +1,754 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (C) 2025 Altera Corporation
+ *
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Block cache between the FAT media driver and the SDMMC driver
+ */
+
+/*
+ * The cache holds SDMMC_BCACHE_BLOCKS blocks of 512 bytes. Cached blocks
+ * are found through a hash of their block number. Unpinned blocks sit on
+ * a least recently used list, the tail of which is evicted when a free
+ * block is needed. Blocks of the pinned range are kept off that list, so
+ * the FAT and directory blocks survive long file transfers.
+ *
+ * All card accesses go through the scatter-gather calls of the driver, so
+ * a miss and its read-ahead window, or a run of dirty blocks, each take a
+ * single transfer however the blocks are scattered over the cache.
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include "osal.h"
+#include "osal_log.h"
+#include "socfpga_sdmmc.h"
+#include "socfpga_sdmmc_bcache.h"
+
+/*blocks held by the cache*/
+#ifndef SDMMC_BCACHE_BLOCKS
+#define SDMMC_BCACHE_BLOCKS      256U
+#endif
+/*blocks of the pinned range kept resident at most*/
+#ifndef SDMMC_BCACHE_PIN_MAX
+#define SDMMC_BCACHE_PIN_MAX     (SDMMC_BCACHE_BLOCKS / 4U)
+#endif
+/*read-ahead window, doubling from min to max while reads are sequential*/
+#ifndef SDMMC_BCACHE_RA_MIN
+#define SDMMC_BCACHE_RA_MIN      8U
+#endif
+#ifndef SDMMC_BCACHE_RA_MAX
+#define SDMMC_BCACHE_RA_MAX      64U
+#endif
+/*transfers of at least this many blocks go around the cache*/
+#ifndef SDMMC_BCACHE_BYPASS
+#define SDMMC_BCACHE_BYPASS      64U
+#endif
+/*write everything back once this many blocks are dirty*/
+#ifndef SDMMC_BCACHE_DIRTY_MAX
+#define SDMMC_BCACHE_DIRTY_MAX   (SDMMC_BCACHE_BLOCKS / 2U)
+#endif
+/*1 holds writes in the cache, 0 writes them through to the card at once*/
+#ifndef SDMMC_BCACHE_WRITE_BACK
+#define SDMMC_BCACHE_WRITE_BACK  0
+#endif
+/*longest run of dirty blocks written back by one transfer*/
+#define SDMMC_BCACHE_RUN_MAX     64U
+
+#define BC_NONE          (0xFFFFU)
+#define BC_VALID         (1U << 0U)
+#define BC_DIRTY         (1U << 1U)
+#define BC_PINNED        (1U << 2U)
+#define BC_DATA_ALIGN    (64U)
+
+#if (SDMMC_BCACHE_BLOCKS < 16U) || (SDMMC_BCACHE_BLOCKS >= BC_NONE)
+#error Invalid block cache size
+#endif
+/*a read-ahead window must never evict blocks of its own transfer*/
+#if (SDMMC_BCACHE_PIN_MAX + (2U * SDMMC_BCACHE_RA_MAX) + \
+    SDMMC_BCACHE_BYPASS) > SDMMC_BCACHE_BLOCKS
+#error Block cache too small for its pinned share and read-ahead window
+#endif
+
+struct bcache_line
+{
+    uint64_t block;
+    uint16_t prev;
+    uint16_t next;
+    uint16_t hnext;
+    uint8_t flags;
+};
+
+struct bcache
+{
+    bool ready;
+    osal_mutex_t lock;
+    void *pmem;
+    struct bcache_line *lines;
+    uint8_t *data;
+    uint16_t hash[SDMMC_BCACHE_BLOCKS];
+    /*unpinned blocks, most recently used at the head*/
+    uint16_t lru_head;
+    uint16_t lru_tail;
+    uint16_t free_head;
+    uint32_t dirty_count;
+    uint32_t pinned_count;
+    uint64_t pin_start;
+    uint32_t pin_count;
+    /*blocks on the card, read-ahead stops at the end*/
+    uint64_t block_count;
+    /*block a sequential read starts at, and the window it pulls in*/
+    uint64_t seq_next;
+    uint32_t ra_window;
+    sdmmc_bcache_stats_t stats;
+    /*caller buffer and read-ahead blocks of a read*/
+    sdmmc_iovec_t iov[SDMMC_BCACHE_RA_MAX + 1U];
+    /*kept apart, a write back may run while a read is being set up*/
+    sdmmc_iovec_t wb_iov[SDMMC_BCACHE_RUN_MAX];
+};
+
+static struct bcache bcache;
+static osal_mutex_def_t bcache_lock_def;
+
+static uint8_t *bc_data(uint16_t idx)
+{
+    return &bcache.data[(size_t)idx * SDMMC_BLOCK_SIZE];
+}
+
+static uint16_t bc_lookup(uint64_t block)
+{
+    uint16_t idx = bcache.hash[block % SDMMC_BCACHE_BLOCKS];
+
+    while ((idx != BC_NONE) && (bcache.lines[idx].block != block))
+    {
+        idx = bcache.lines[idx].hnext;
+    }
+    return idx;
+}
+
+static void bc_hash_remove(uint16_t idx)
+{
+    uint16_t *plink = &bcache.hash[bcache.lines[idx].block %
+            SDMMC_BCACHE_BLOCKS];
+
+    while (*plink != idx)
+    {
+        plink = &bcache.lines[*plink].hnext;
+    }
+    *plink = bcache.lines[idx].hnext;
+}
+
+static void bc_lru_unlink(uint16_t idx)
+{
+    struct bcache_line *pline = &bcache.lines[idx];
+
+    if (pline->prev != BC_NONE)
+    {
+        bcache.lines[pline->prev].next = pline->next;
+    }
+    else
+    {
+        bcache.lru_head = pline->next;
+    }
+    if (pline->next != BC_NONE)
+    {
+        bcache.lines[pline->next].prev = pline->prev;
+    }
+    else
+    {
+        bcache.lru_tail = pline->prev;
+    }
+}
+
+static void bc_lru_push(uint16_t idx)
+{
+    struct bcache_line *pline = &bcache.lines[idx];
+
+    pline->prev = BC_NONE;
+    pline->next = bcache.lru_head;
+    if (bcache.lru_head != BC_NONE)
+    {
+        bcache.lines[bcache.lru_head].prev = idx;
+    }
+    else
+    {
+        bcache.lru_tail = idx;
+    }
+    bcache.lru_head = idx;
+}
+
+static void bc_touch(uint16_t idx)
+{
+    if ((bcache.lines[idx].flags & BC_PINNED) == 0U)
+    {
+        bc_lru_unlink(idx);
+        bc_lru_push(idx);
+    }
+}
+
+static void bc_reset(void)
+{
+    uint32_t i;
+
+    for (i = 0U; i < SDMMC_BCACHE_BLOCKS; i++)
+    {
+        bcache.hash[i] = BC_NONE;
+        bcache.lines[i].flags = 0U;
+        bcache.lines[i].next = ((i + 1U) < SDMMC_BCACHE_BLOCKS) ?
+                (uint16_t)(i + 1U) : BC_NONE;
+    }
+    bcache.free_head = 0U;
+    bcache.lru_head = BC_NONE;
+    bcache.lru_tail = BC_NONE;
+    bcache.dirty_count = 0U;
+    bcache.pinned_count = 0U;
+    bcache.seq_next = UINT64_MAX;
+    bcache.ra_window = 0U;
+}
+
+static int32_t bc_io(bool is_read, const sdmmc_iovec_t *iov,
+        uint32_t iov_count, uint64_t block)
+{
+    uint64_t addr = block * SDMMC_BLOCK_SIZE;
+
+    if (is_read)
+    {
+        return sdmmc_read_blocks_sg(iov, iov_count, addr, SDMMC_BLOCK_SIZE);
+    }
+    return sdmmc_write_blocks_sg(iov, iov_count, addr, SDMMC_BLOCK_SIZE);
+}
+
+/*write back the run of consecutive dirty blocks around a dirty block*/
+static int32_t bc_write_run(uint16_t idx)
+{
+    uint64_t start = bcache.lines[idx].block;
+    uint16_t cur;
+    uint32_t n = 0U;
+    uint32_t i;
+    int32_t ret;
+
+    while ((start > 0U) && (n < (SDMMC_BCACHE_RUN_MAX - 1U)))
+    {
+        cur = bc_lookup(start - 1U);
+        if ((cur == BC_NONE) || ((bcache.lines[cur].flags & BC_DIRTY) == 0U))
+        {
+            break;
+        }
+        start--;
+        n++;
+    }
+
+    n = 0U;
+    cur = bc_lookup(start);
+    while ((cur != BC_NONE) && ((bcache.lines[cur].flags & BC_DIRTY) != 0U) &&
+            (n < SDMMC_BCACHE_RUN_MAX))
+    {
+        bcache.wb_iov[n].addr = bc_data(cur);
+        bcache.wb_iov[n].size = SDMMC_BLOCK_SIZE;
+        n++;
+        cur = bc_lookup(start + n);
+    }
+
+    ret = bc_io(false, bcache.wb_iov, n, start);
+    if (ret != 0)
+    {
+        ERROR("SDMMC: block cache write back failed at block %lx", start);
+        return ret;
+    }
+    bcache.stats.write_backs++;
+    for (i = 0U; i < n; i++)
+    {
+        cur = bc_lookup(start + i);
+        bcache.lines[cur].flags &= (uint8_t)~BC_DIRTY;
+    }
+    bcache.dirty_count -= n;
+    return 0;
+}
+
+/*write back all dirty blocks in ascending order, one transfer per run*/
+static int32_t bc_flush_all(void)
+{
+    uint16_t low;
+    uint16_t idx;
+    int32_t ret;
+
+    while (bcache.dirty_count != 0U)
+    {
+        low = BC_NONE;
+        for (idx = 0U; idx < SDMMC_BCACHE_BLOCKS; idx++)
+        {
+            if (((bcache.lines[idx].flags & BC_DIRTY) != 0U) &&
+                    ((low == BC_NONE) ||
+                    (bcache.lines[idx].block < bcache.lines[low].block)))
+            {
+                low = idx;
+            }
+        }
+        ret = bc_write_run(low);
+        if (ret != 0)
+        {
+            return ret;
+        }
+    }
+    return 0;
+}
+
+/*take a free block or evict the least recently used one*/
+static int32_t bc_alloc(uint64_t block, uint16_t *pidx)
+{
+    struct bcache_line *pline;
+    uint16_t idx = bcache.free_head;
+    uint32_t h;
+    int32_t ret;
+
+    if (idx != BC_NONE)
+    {
+        bcache.free_head = bcache.lines[idx].next;
+    }
+    else
+    {
+        /*the pinned share is bounded, the list is never empty here*/
+        idx = bcache.lru_tail;
+        if ((bcache.lines[idx].flags & BC_DIRTY) != 0U)
+        {
+            ret = bc_write_run(idx);
+            if (ret != 0)
+            {
+                return ret;
+            }
+        }
+        bc_hash_remove(idx);
+        bc_lru_unlink(idx);
+        bcache.stats.evictions++;
+    }
+
+    pline = &bcache.lines[idx];
+    pline->block = block;
+    pline->flags = BC_VALID;
+    if ((block >= bcache.pin_start) &&
+            ((block - bcache.pin_start) < bcache.pin_count) &&
+            (bcache.pinned_count < SDMMC_BCACHE_PIN_MAX))
+    {
+        pline->flags |= BC_PINNED;
+        bcache.pinned_count++;
+    }
+    else
+    {
+        bc_lru_push(idx);
+    }
+    h = (uint32_t)(block % SDMMC_BCACHE_BLOCKS);
+    pline->hnext = bcache.hash[h];
+    bcache.hash[h] = idx;
+
+    *pidx = idx;
+    return 0;
+}
+
+/*return a clean block to the free list*/
+static void bc_drop(uint16_t idx)
+{
+    bc_hash_remove(idx);
+    if ((bcache.lines[idx].flags & BC_PINNED) != 0U)
+    {
+        bcache.pinned_count--;
+    }
+    else
+    {
+        bc_lru_unlink(idx);
+    }
+    bcache.lines[idx].flags = 0U;
+    bcache.lines[idx].next = bcache.free_head;
+    bcache.free_head = idx;
+}
+
+static int32_t bc_read_bypass(uint8_t *pbuff, uint64_t block, uint32_t count)
+{
+    uint16_t idx;
+    uint32_t i;
+    int32_t ret;
+
+    bcache.iov[0].addr = pbuff;
+    bcache.iov[0].size = (size_t)count * SDMMC_BLOCK_SIZE;
+    ret = bc_io(true, bcache.iov, 1U, block);
+    if (ret != 0)
+    {
+        return ret;
+    }
+    bcache.stats.bypass += count;
+
+    /*blocks not written back yet are newer than the card*/
+    for (i = 0U; (i < count) && (bcache.dirty_count != 0U); i++)
+    {
+        idx = bc_lookup(block + i);
+        if ((idx != BC_NONE) && ((bcache.lines[idx].flags & BC_DIRTY) != 0U))
+        {
+            (void)memcpy(&pbuff[(size_t)i * SDMMC_BLOCK_SIZE], bc_data(idx),
+                    SDMMC_BLOCK_SIZE);
+        }
+    }
+    return 0;
+}
+
+static int32_t bc_read_cached(uint8_t *pbuff, uint64_t block, uint32_t count)
+{
+    uint64_t ra_block = block + count;
+    uint16_t idx;
+    uint32_t i = 0U;
+    uint32_t j;
+    uint32_t n;
+    int32_t ret;
+
+    while (i < count)
+    {
+        idx = bc_lookup(block + i);
+        if (idx != BC_NONE)
+        {
+            (void)memcpy(&pbuff[(size_t)i * SDMMC_BLOCK_SIZE], bc_data(idx),
+                    SDMMC_BLOCK_SIZE);
+            bc_touch(idx);
+            bcache.stats.hits++;
+            i++;
+            continue;
+        }
+
+        /*read the run of missing blocks straight into the caller buffer*/
+        j = i + 1U;
+        while ((j < count) && (bc_lookup(block + j) == BC_NONE))
+        {
+            j++;
+        }
+        bcache.iov[0].addr = &pbuff[(size_t)i * SDMMC_BLOCK_SIZE];
+        bcache.iov[0].size = (size_t)(j - i) * SDMMC_BLOCK_SIZE;
+        n = 1U;
+
+        /*a sequential stream also pulls in the blocks behind the request*/
+        if (j == count)
+        {
+            while (((n - 1U) < bcache.ra_window) &&
+                    ((ra_block + n - 1U) < bcache.block_count) &&
+                    (bc_lookup(ra_block + n - 1U) == BC_NONE))
+            {
+                ret = bc_alloc(ra_block + n - 1U, &idx);
+                if (ret != 0)
+                {
+                    break;
+                }
+                bcache.iov[n].addr = bc_data(idx);
+                bcache.iov[n].size = SDMMC_BLOCK_SIZE;
+                n++;
+            }
+        }
+
+        ret = bc_io(true, bcache.iov, n, block + i);
+        if (ret != 0)
+        {
+            /*the read-ahead blocks hold nothing valid*/
+            while (n > 1U)
+            {
+                n--;
+                bc_drop(bc_lookup(ra_block + n - 1U));
+            }
+            return ret;
+        }
+        bcache.stats.misses += j - i;
+        bcache.stats.read_ahead += n - 1U;
+
+        /*keep a copy of the blocks just read*/
+        for (; i < j; i++)
+        {
+            ret = bc_alloc(block + i, &idx);
+            if (ret != 0)
+            {
+                return ret;
+            }
+            (void)memcpy(bc_data(idx), &pbuff[(size_t)i * SDMMC_BLOCK_SIZE],
+                    SDMMC_BLOCK_SIZE);
+        }
+    }
+    return 0;
+}
+
+static int32_t bc_write_bypass(const uint8_t *pbuff, uint64_t block,
+        uint32_t count)
+{
+    uint16_t idx;
+    uint32_t i;
+    int32_t ret;
+
+    bcache.iov[0].addr = (void *)pbuff;
+    bcache.iov[0].size = (size_t)count * SDMMC_BLOCK_SIZE;
+    ret = bc_io(false, bcache.iov, 1U, block);
+    if (ret != 0)
+    {
+        return ret;
+    }
+    bcache.stats.bypass += count;
+
+    /*cached copies take the new data, which is on the card now*/
+    for (i = 0U; i < count; i++)
+    {
+        idx = bc_lookup(block + i);
+        if (idx == BC_NONE)
+        {
+            continue;
+        }
+        (void)memcpy(bc_data(idx), &pbuff[(size_t)i * SDMMC_BLOCK_SIZE],
+                SDMMC_BLOCK_SIZE);
+        if ((bcache.lines[idx].flags & BC_DIRTY) != 0U)
+        {
+            bcache.lines[idx].flags &= (uint8_t)~BC_DIRTY;
+            bcache.dirty_count--;
+        }
+    }
+    return 0;
+}
+
+static int32_t bc_write_cached(const uint8_t *pbuff, uint64_t block,
+        uint32_t count)
+{
+    uint16_t idx;
+    uint32_t i;
+    int32_t ret;
+
+    if (SDMMC_BCACHE_WRITE_BACK == 0)
+    {
+        /*write through, the card has the data before the call returns*/
+        bcache.iov[0].addr = (void *)pbuff;
+        bcache.iov[0].size = (size_t)count * SDMMC_BLOCK_SIZE;
+        ret = bc_io(false, bcache.iov, 1U, block);
+        if (ret != 0)
+        {
+            /*the card may hold old or new data, forget the cached copies*/
+            for (i = 0U; i < count; i++)
+            {
+                idx = bc_lookup(block + i);
+                if (idx != BC_NONE)
+                {
+                    bc_drop(idx);
+                }
+            }
+            return ret;
+        }
+    }
+
+    for (i = 0U; i < count; i++)
+    {
+        idx = bc_lookup(block + i);
+        if (idx == BC_NONE)
+        {
+            ret = bc_alloc(block + i, &idx);
+            if (ret != 0)
+            {
+                return ret;
+            }
+        }
+        else
+        {
+            bc_touch(idx);
+        }
+        (void)memcpy(bc_data(idx), &pbuff[(size_t)i * SDMMC_BLOCK_SIZE],
+                SDMMC_BLOCK_SIZE);
+        if ((SDMMC_BCACHE_WRITE_BACK != 0) &&
+                ((bcache.lines[idx].flags & BC_DIRTY) == 0U))
+        {
+            bcache.lines[idx].flags |= BC_DIRTY;
+            bcache.dirty_count++;
+        }
+    }
+
+    if (bcache.dirty_count >= SDMMC_BCACHE_DIRTY_MAX)
+    {
+        return bc_flush_all();
+    }
+    return 0;
+}
+
+int32_t sdmmc_bcache_init(uint64_t block_count)
+{
+    int32_t ret;
+
+    if (bcache.lock == NULL)
+    {
+        bcache.lock = osal_mutex_create(&bcache_lock_def);
+        if (bcache.lock == NULL)
+        {
+            return -ENOMEM;
+        }
+    }
+    if (bcache.pmem == NULL)
+    {
+        bcache.pmem = pvPortMalloc((SDMMC_BCACHE_BLOCKS *
+                (sizeof(struct bcache_line) + SDMMC_BLOCK_SIZE)) +
+                BC_DATA_ALIGN);
+        if (bcache.pmem == NULL)
+        {
+            return -ENOMEM;
+        }
+        bcache.lines = (struct bcache_line *)bcache.pmem;
+        /*blocks are DMA targets, keep them off the cache lines of the list*/
+        bcache.data = (uint8_t *)(((uintptr_t)&bcache.lines[
+                SDMMC_BCACHE_BLOCKS] + BC_DATA_ALIGN - 1U) &
+                ~((uintptr_t)BC_DATA_ALIGN - 1U));
+    }
+
+    (void)osal_mutex_lock(bcache.lock, OSAL_TIMEOUT_WAIT_FOREVER);
+    /*never drop blocks the card has not seen yet*/
+    ret = bcache.ready ? bc_flush_all() : 0;
+    if (ret != 0)
+    {
+        ERROR("SDMMC: %u dirty blocks lost", bcache.dirty_count);
+        bc_reset();
+        bcache.ready = false;
+        (void)osal_mutex_unlock(bcache.lock);
+        return -EIO;
+    }
+    bc_reset();
+    bcache.pin_start = 0U;
+    bcache.pin_count = 0U;
+    bcache.block_count = (block_count != 0U) ? block_count : UINT64_MAX;
+    (void)memset(&bcache.stats, 0, sizeof(bcache.stats));
+    bcache.ready = true;
+    (void)osal_mutex_unlock(bcache.lock);
+
+    INFO("SDMMC: block cache of %d blocks", SDMMC_BCACHE_BLOCKS);
+    return 0;
+}
+
+int32_t sdmmc_bcache_pin(uint64_t block, uint32_t count)
+{
+    int32_t ret;
+
+    if (!bcache.ready)
+    {
+        return -EINVAL;
+    }
+
+    (void)osal_mutex_lock(bcache.lock, OSAL_TIMEOUT_WAIT_FOREVER);
+    ret = bc_flush_all();
+    if (ret == 0)
+    {
+        bc_reset();
+        bcache.pin_start = block;
+        bcache.pin_count = count;
+    }
+    (void)osal_mutex_unlock(bcache.lock);
+    return (ret == 0) ? 0 : -EIO;
+}
+
+int32_t sdmmc_bcache_read(uint8_t *pbuff, uint64_t block, uint32_t count)
+{
+    int32_t ret;
+
+    if ((!bcache.ready) || (pbuff == NULL) || (count == 0U))
+    {
+        return -EINVAL;
+    }
+
+    (void)osal_mutex_lock(bcache.lock, OSAL_TIMEOUT_WAIT_FOREVER);
+    if (block == bcache.seq_next)
+    {
+        bcache.ra_window = (bcache.ra_window == 0U) ? SDMMC_BCACHE_RA_MIN :
+                (bcache.ra_window * 2U);
+        if (bcache.ra_window > SDMMC_BCACHE_RA_MAX)
+        {
+            bcache.ra_window = SDMMC_BCACHE_RA_MAX;
+        }
+    }
+    else
+    {
+        bcache.ra_window = 0U;
+    }
+    bcache.seq_next = block + count;
+
+    if (count >= SDMMC_BCACHE_BYPASS)
+    {
+        ret = bc_read_bypass(pbuff, block, count);
+    }
+    else
+    {
+        ret = bc_read_cached(pbuff, block, count);
+    }
+    (void)osal_mutex_unlock(bcache.lock);
+    return ret;
+}
+
+int32_t sdmmc_bcache_write(const uint8_t *pbuff, uint64_t block,
+        uint32_t count)
+{
+    int32_t ret;
+
+    if ((!bcache.ready) || (pbuff == NULL) || (count == 0U))
+    {
+        return -EINVAL;
+    }
+
+    (void)osal_mutex_lock(bcache.lock, OSAL_TIMEOUT_WAIT_FOREVER);
+    if (count >= SDMMC_BCACHE_BYPASS)
+    {
+        ret = bc_write_bypass(pbuff, block, count);
+    }
+    else
+    {
+        ret = bc_write_cached(pbuff, block, count);
+    }
+    (void)osal_mutex_unlock(bcache.lock);
+    return ret;
+}
+
+bool sdmmc_bcache_enabled(void)
+{
+    return bcache.ready;
+}
+
+int32_t sdmmc_bcache_disable(void)
+{
+    int32_t ret;
+
+    if (!bcache.ready)
+    {
+        return 0;
+    }
+
+    (void)osal_mutex_lock(bcache.lock, OSAL_TIMEOUT_WAIT_FOREVER);
+    ret = bc_flush_all();
+    if (ret == 0)
+    {
+        bc_reset();
+        bcache.ready = false;
+    }
+    (void)osal_mutex_unlock(bcache.lock);
+    return (ret == 0) ? 0 : -EIO;
+}
+
+int32_t sdmmc_bcache_flush(void)
+{
+    int32_t ret;
+
+    if (!bcache.ready)
+    {
+        return 0;
+    }
+
+    (void)osal_mutex_lock(bcache.lock, OSAL_TIMEOUT_WAIT_FOREVER);
+    ret = bc_flush_all();
+    (void)osal_mutex_unlock(bcache.lock);
+    return (ret == 0) ? 0 : -EIO;
+}
+
+void sdmmc_bcache_get_stats(sdmmc_bcache_stats_t *pstats)
+{
+    if (pstats == NULL)
+    {
+        return;
+    }
+    if (!bcache.ready)
+    {
+        (void)memset(pstats, 0, sizeof(*pstats));
+        return;
+    }
+
+    (void)osal_mutex_lock(bcache.lock, OSAL_TIMEOUT_WAIT_FOREVER);
+    *pstats = bcache.stats;
+    (void)osal_mutex_unlock(bcache.lock);
+}
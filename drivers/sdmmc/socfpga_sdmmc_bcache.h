@@ -0,0 +1,207 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (C) 2025 Altera Corporation
+ *
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Header file for the SDMMC block cache
+ */
+
+#ifndef __SOCFPGA_SDMMC_BCACHE_H__
+#define __SOCFPGA_SDMMC_BCACHE_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * @file socfpga_sdmmc_bcache.h
+ * @brief Block cache between the FAT media driver and the SDMMC driver.
+ *
+ */
+
+/**
+ * @defgroup sdmmc_bcache SD/eMMC block cache
+ * @ingroup sdmmc
+ * @brief Cache of 512 byte blocks in front of the SD/eMMC driver.
+ * @details
+ * sdmmc_init_card() sets up the cache when SDMMC_BCACHE_EN is 1, and
+ * sdmmc_read_block_sync() and sdmmc_write_block_sync() of whole 512 byte
+ * blocks, as issued by the FAT media driver, then go through it.
+ *
+ * - Blocks are kept in least recently used order. A block range set with
+ *   sdmmc_bcache_pin(), typically the FAT and the root directory, stays
+ *   resident up to a configured share of the cache.
+ * - Reads continuing the previous one are extended by a read-ahead window
+ *   which doubles while the access stays sequential.
+ * - Writes go to the card at once and keep a copy in the cache. With
+ *   SDMMC_BCACHE_WRITE_BACK set to 1 they are held in the cache and written
+ *   back later instead. Dirty blocks at consecutive addresses then go out
+ *   as one scatter-gather command.
+ * - Transfers of many blocks, such as bitstream loads, bypass the cache
+ *   and keep cached copies coherent.
+ *
+ * In write-back mode dirty blocks reach the card only on eviction, when the
+ * dirty share of the cache gets high, or on sdmmc_bcache_flush(). The flush
+ * must then be called after FF_Unmount() and before the card is removed or
+ * powered off.
+ * The cache uses the direct transfer calls, so it cannot be used while
+ * the request queue runs.
+ * @{
+ */
+
+/**
+ * @defgroup sdmmc_bcache_fns Functions
+ * @ingroup sdmmc_bcache
+ * SDMMC block cache APIs
+ */
+
+/**
+ * @defgroup sdmmc_bcache_structs Structures
+ * @ingroup sdmmc_bcache
+ * SDMMC block cache structures
+ */
+
+/**
+ * @addtogroup sdmmc_bcache_structs
+ * @{
+ */
+
+/**
+ * @brief Block cache counters
+ */
+typedef struct
+{
+    uint32_t hits;          /*!< Blocks served from the cache */
+    uint32_t misses;        /*!< Blocks read from the card on demand */
+    uint32_t read_ahead;    /*!< Blocks read from the card ahead of use */
+    uint32_t bypass;        /*!< Blocks transferred around the cache */
+    uint32_t write_backs;   /*!< Write commands issued for dirty blocks */
+    uint32_t evictions;     /*!< Blocks dropped to make room */
+} sdmmc_bcache_stats_t;
+
+/**
+ * @}
+ */
+/* end of group sdmmc_bcache_structs */
+
+/**
+ * @addtogroup sdmmc_bcache_fns
+ * @{
+ */
+
+/**
+ * @brief Allocates the cache.
+ *
+ * Called by sdmmc_init_card() when SDMMC_BCACHE_EN is 1. Calling it again
+ * writes back the dirty blocks and then drops all cached blocks.
+ *
+ * @param[in] block_count Number of blocks on the card, read-ahead stops at
+ *                        the last one. 0 if unknown.
+ *
+ * @return
+ * - 0:       Cache ready.
+ * - -ENOMEM: Could not allocate the cache.
+ * - -EIO:    Writing back dirty blocks failed. They are lost and the
+ *            cache stays disabled.
+ */
+int32_t sdmmc_bcache_init(uint64_t block_count);
+
+/**
+ * @brief Sets the block range kept resident.
+ *
+ * Writes back and drops all cached blocks, then keeps blocks of the range
+ * resident once read or written, up to the configured pinned share.
+ *
+ * @param[in] block First block of the range.
+ * @param[in] count Number of blocks, 0 to pin nothing.
+ *
+ * @return
+ * - 0:       Range set.
+ * - -EINVAL: The cache is not initialized.
+ * - -EIO:    Writing back dirty blocks failed.
+ */
+int32_t sdmmc_bcache_pin(uint64_t block, uint32_t count);
+
+/**
+ * @brief Reads blocks through the cache.
+ *
+ * @param[out] pbuff Destination, SDMMC_SG_ALIGN aligned.
+ * @param[in]  block First block to read.
+ * @param[in]  count Number of blocks.
+ *
+ * @return
+ * - 0:       Read successful.
+ * - -EINVAL: One or more arguments are invalid, or the cache is not
+ *            initialized.
+ * - -EIO:    Read from the card failed.
+ */
+int32_t sdmmc_bcache_read(uint8_t *pbuff, uint64_t block, uint32_t count);
+
+/**
+ * @brief Writes blocks through the cache.
+ *
+ * In write-back mode small writes complete in the cache and reach the card
+ * later.
+ *
+ * @param[in] pbuff Source, SDMMC_SG_ALIGN aligned.
+ * @param[in] block First block to write.
+ * @param[in] count Number of blocks.
+ *
+ * @return
+ * - 0:       Write successful.
+ * - -EINVAL: One or more arguments are invalid, or the cache is not
+ *            initialized.
+ * - -EIO:    Write to the card failed, for the blocks themselves or for
+ *            dirty blocks written back to make room.
+ */
+int32_t sdmmc_bcache_write(const uint8_t *pbuff, uint64_t block,
+        uint32_t count);
+
+/**
+ * @brief Tells whether the sync block calls go through the cache.
+ *
+ * @return true once sdmmc_bcache_init() succeeded and until
+ *         sdmmc_bcache_disable().
+ */
+bool sdmmc_bcache_enabled(void);
+
+/**
+ * @brief Writes all dirty blocks to the card and stops using the cache.
+ *
+ * Called by sdmmc_queue_start(). sdmmc_bcache_init() enables the cache
+ * again.
+ *
+ * @return
+ * - 0:    Cache disabled, or it was not initialized.
+ * - -EIO: Write to the card failed, the cache stays enabled.
+ */
+int32_t sdmmc_bcache_disable(void);
+
+/**
+ * @brief Writes all dirty blocks to the card.
+ *
+ * Cached blocks stay valid.
+ *
+ * @return
+ * - 0:    All blocks written, or the cache is not initialized.
+ * - -EIO: Write to the card failed, the failed blocks stay dirty.
+ */
+int32_t sdmmc_bcache_flush(void);
+
+/**
+ * @brief Reads the cache counters.
+ *
+ * @param[out] pstats Counters since sdmmc_bcache_init().
+ */
+void sdmmc_bcache_get_stats(sdmmc_bcache_stats_t *pstats);
+
+/**
+ * @}
+ */
+/* end of group sdmmc_bcache_fns */
+
+/**
+ * @}
+ */
+/* end of group sdmmc_bcache */
+
+#endif /* __SOCFPGA_SDMMC_BCACHE_H__ */
@@ -7,6 +7,7 @@
  */
 
 #include <stdint.h>
+#include <stdbool.h>
 #include "osal_log.h"
 #include "socfpga_cache.h"
 #include "socfpga_defines.h"
@@ -26,7 +27,12 @@
 #define DATA_READ                 (1U)
 #define MULTI_BLOCK               (1U)
 #define CMD_ID_CHECK_EN           (1U)
+#define CMD_CRC_CHECK_EN          (1U)
+#define SHORT_RESP                (2U)
+#define CMD_SWITCH_FUNC           (6U)
 #define CMD_SEND_EXT_CSD          (8U)
+#define CMD_SEND_TUNING           (19U)
+#define CMD_SEND_TUNING_HS200     (21U)
 #define CMD_READ_SINGLE_BLOCK     (17U)
 #define CMD_READ_MULT_BLOCK       (18U)
 #define CMD_WRITE_SINGLE_BLOCK    (24U)
@@ -37,7 +43,10 @@
 
 #define CLEAR_INT      (0x0U)
 #define EN_CMD_INT     (0x10001U)
-#define EN_XFER_INT    (0x100002U)
+/*data crc and end bit errors end a transfer as well, a tuning miss raises them*/
+#define EN_XFER_INT    (0x700002U)
+/*end of an ADMA3 chain, command, data, auto CMD23 and ADMA errors*/
+#define EN_ADMA3_INT   (0x37F0008U)
 
 #define SDCLK_FREQ            (2U)
 #define EN_INTERN_CLK         (1U)
@@ -57,6 +66,16 @@
 #define FREQ_SEL_50MHz     (2U)
 #define AUTO_CMD_23_EN     (2U)
 
+#define ADMA3_ACT_CMD          (1U << 3U)
+#define ADMA3_ACT_INTEGRATED   (7U << 3U)
+
+#define CQE_ACT_TASK           (5U << 3U)
+#define CQE_ACT_LINK           (6U << 3U)
+#define CQE_TASK_DATA_READ     (1U << 12U)
+#define CQE_TASK_BLK_CT_POS    16U
+#define CQE_INT_MASK           (SDMMC_CQRS04_CQTCC_MASK | SDMMC_CQRS04_CQREDI_MASK | \
+            SDMMC_CQRS04_CQHAC_MASK | SDMMC_CQRS04_CQTCL_MASK)
+
 #define SDSC_DETECTED     (0x0U)
 #define SDHC_DETECTED     (0x1U)
 #define DAT_TIMOUT_CTR    (0xeU)
@@ -78,61 +97,126 @@
 
 #define SOFTPHY_CLK_200_MHZ    1
 
+/*card clock source when the capabilities do not report one*/
+#define BASE_CLK_MHZ_DEF       (200U)
+#define S18A_ACCEPTED          ((uint32_t)1 << 24U)
+
+#define HRS06_MODE_SD          (0U)
+#define HRS06_MODE_MMC_SDR     (2U)
+#define HRS06_MODE_HS200       (4U)
+#define HRS06_MODE_HS400       (5U)
+#define HRS06_MODE_HS400ES     (6U)
+
+#define UHS_MODE_SDR12         (0U)
+#define UHS_MODE_SDR25         (1U)
+#define UHS_MODE_SDR50         (2U)
+#define UHS_MODE_SDR104        (3U)
+
+#define PHY_CFG_LEGACY         (0U)
+#define PHY_CFG_SDR            (1U)
+#define PHY_CFG_HS400          (2U)
+#define PHY_CFG_HS400ES        (3U)
+
+#define PHY_TUNE_CMD           (1U << 0U)
+#define PHY_TUNE_DATA          (1U << 1U)
+
+/*host side settings of one bus timing*/
+struct sdmmc_timing_cfg
+{
+    uint32_t clk_mhz;
+    uint32_t hrs06_mode;
+    uint32_t uhs_mode;
+    uint32_t phy_cfg;
+    bool hse;
+    bool v18;
+};
+
+/*combo phy capture settings, gate and dq timing stay as set by sdmmc_init_phy*/
+struct sdmmc_phy_cfg
+{
+    uint32_t dqs_timing;
+    uint32_t dll_master_ctl;
+    uint32_t dll_slave_ctl;
+    uint32_t tune_fields;
+};
+
+static const struct sdmmc_timing_cfg timing_cfgs[SDMMC_TIMING_COUNT] =
+{
+    /*SDMMC_TIMING_SD_DS*/
+    { 25U, HRS06_MODE_SD, UHS_MODE_SDR12, PHY_CFG_LEGACY, false, false },
+    /*SDMMC_TIMING_SD_HS*/
+    { 50U, HRS06_MODE_SD, UHS_MODE_SDR25, PHY_CFG_LEGACY, true, false },
+    /*SDMMC_TIMING_SDR50*/
+    { 100U, HRS06_MODE_SD, UHS_MODE_SDR50, PHY_CFG_SDR, true, true },
+    /*SDMMC_TIMING_SDR104*/
+    { 200U, HRS06_MODE_SD, UHS_MODE_SDR104, PHY_CFG_SDR, true, true },
+    /*SDMMC_TIMING_MMC_LEGACY*/
+    { 25U, HRS06_MODE_MMC_SDR, UHS_MODE_SDR12, PHY_CFG_LEGACY, false, false },
+    /*SDMMC_TIMING_MMC_HS*/
+    { 50U, HRS06_MODE_MMC_SDR, UHS_MODE_SDR12, PHY_CFG_LEGACY, true, false },
+    /*SDMMC_TIMING_HS200*/
+    { 200U, HRS06_MODE_HS200, UHS_MODE_SDR12, PHY_CFG_SDR, true, true },
+    /*SDMMC_TIMING_HS400*/
+    { 200U, HRS06_MODE_HS400, UHS_MODE_SDR12, PHY_CFG_HS400, true, true },
+    /*SDMMC_TIMING_HS400ES*/
+    { 200U, HRS06_MODE_HS400ES, UHS_MODE_SDR12, PHY_CFG_HS400ES, true, true },
+};
+
+static const struct sdmmc_phy_cfg phy_cfgs[] =
+{
+    /*up to 50 MHz, loopback capture with the dll bypassed*/
+    {
+        USE_EXT_LPBK_DQS | USE_LPBK_DQS | USE_PHONY_DQS | USE_PHONY_DQS_CMD |
+        DQS_SEL_OE_END, SEL_DLL_BYPASS_MODE | PARAM_DLL_START_POINT,
+        READ_DQS_CMD_DELAY | CLK_WRDQS_DELAY | CLK_WR_DELAY | READ_DQS_DELAY,
+        0U
+    },
+    /*sdr above 50 MHz, loopback capture at the tuned delay of the locked dll*/
+    {
+        USE_EXT_LPBK_DQS | USE_LPBK_DQS | USE_PHONY_DQS | USE_PHONY_DQS_CMD |
+        DQS_SEL_OE_END, PARAM_DLL_START_POINT, CLK_WRDQS_DELAY | CLK_WR_DELAY,
+        PHY_TUNE_CMD | PHY_TUNE_DATA
+    },
+    /*hs400, data on the device strobe, response at the delay tuned in hs200*/
+    {
+        USE_PHONY_DQS_CMD | DQS_SEL_OE_END, PARAM_DLL_START_POINT,
+        CLK_WRDQS_DELAY | CLK_WR_DELAY, PHY_TUNE_CMD
+    },
+    /*hs400 enhanced strobe, data and response on the device strobe*/
+    {
+        DQS_SEL_OE_END, PARAM_DLL_START_POINT, CLK_WRDQS_DELAY | CLK_WR_DELAY,
+        0U
+    },
+};
+
+static sdmmc_timing_t cur_timing = SDMMC_TIMING_SD_DS;
+static uint32_t phy_tune_val;
+
 static int32_t reset_dll(void);
 static void prgm_host_config(void);
 static void program_reg(uint32_t val, uint32_t reg_add);
-static void config_phy_xfer_params(void);
+static int32_t config_phy_xfer_params(sdmmc_timing_t timing);
 static void sdmmc_enable_cmd_int(void);
 static void sdmmc_enable_xfer_int(void);
+static void sdmmc_enable_adma3_int(void);
+static int32_t reset_lines(void);
 
 /**
  * @brief Set up the command parameters and send the command to the card.
  */
 int32_t sdmmc_send_command(const cmd_parameters_t *params)
 {
-    uint32_t count = 0;
     uint32_t srs03_reg_value = 0;
     uint32_t srs02_reg_value;
-    uint32_t srs11_reg_value = 0;
     /*should retain the loaded configs*/
     srs03_reg_value = RD_REG32(SRS_BASE_ADDR + SDMMC_SRS03);
-    srs11_reg_value = RD_REG32(SRS_BASE_ADDR + SDMMC_SRS11);
 
     srs03_reg_value &= ~(SDMMC_SRS03_CIDX_MASK | SDMMC_SRS03_DPS_MASK |
             SDMMC_SRS03_CRCCE_MASK | SDMMC_SRS03_CICE_MASK |
             SDMMC_SRS03_RTS_MASK);
-    /*reset cmd line*/
-    srs11_reg_value |= SDMMC_SRS11_SRCMD_MASK;
-    /*reset data line */
-    srs11_reg_value |= SDMMC_SRS11_SRDAT_MASK;
-    WR_REG32(SRS_BASE_ADDR + SDMMC_SRS11, srs11_reg_value);
-    /*host requires some delay to reset cmd line*/
-    count = RESET_TIMEOUT;
-    while ((RD_REG32(SRS_BASE_ADDR + SDMMC_SRS11) & SDMMC_SRS11_SRCMD_MASK) ==
-            SDMMC_SRS11_SRCMD_MASK)
-    {
-        if (count == 0U)
-        {
-            return CTRL_CONFIG_FAIL;
-        }
-        else
-        {
-            count--;
-        }
-    }
-    /*Host requires some delay to reset data line*/
-    count = RESET_TIMEOUT;
-    while ((RD_REG32(SRS_BASE_ADDR + SDMMC_SRS11) & SDMMC_SRS11_SRDAT_MASK) ==
-            SDMMC_SRS11_SRDAT_MASK)
+    if (reset_lines() != CTRL_CONFIG_PASS)
     {
-        if (count == 0U)
-        {
-            return CTRL_CONFIG_FAIL;
-        }
-        else
-        {
-            count--;
-        }
+        return CTRL_CONFIG_FAIL;
     }
     /*argument and dependent param configuration*/
     srs03_reg_value |= (uint32_t)params->command_index << SDMMC_SRS03_CIDX_POS;
@@ -175,6 +259,49 @@ int32_t sdmmc_send_command(const cmd_parameters_t *params)
     return CMD_SND_OK;
 }
 
+/*reset the command and data line state machines ahead of a new command*/
+static int32_t reset_lines(void)
+{
+    uint32_t count;
+    uint32_t srs11_reg_value;
+
+    srs11_reg_value = RD_REG32(SRS_BASE_ADDR + SDMMC_SRS11);
+    /*reset cmd line*/
+    srs11_reg_value |= SDMMC_SRS11_SRCMD_MASK;
+    /*reset data line */
+    srs11_reg_value |= SDMMC_SRS11_SRDAT_MASK;
+    WR_REG32(SRS_BASE_ADDR + SDMMC_SRS11, srs11_reg_value);
+    /*host requires some delay to reset cmd line*/
+    count = RESET_TIMEOUT;
+    while ((RD_REG32(SRS_BASE_ADDR + SDMMC_SRS11) & SDMMC_SRS11_SRCMD_MASK) ==
+            SDMMC_SRS11_SRCMD_MASK)
+    {
+        if (count == 0U)
+        {
+            return CTRL_CONFIG_FAIL;
+        }
+        else
+        {
+            count--;
+        }
+    }
+    /*Host requires some delay to reset data line*/
+    count = RESET_TIMEOUT;
+    while ((RD_REG32(SRS_BASE_ADDR + SDMMC_SRS11) & SDMMC_SRS11_SRDAT_MASK) ==
+            SDMMC_SRS11_SRDAT_MASK)
+    {
+        if (count == 0U)
+        {
+            return CTRL_CONFIG_FAIL;
+        }
+        else
+        {
+            count--;
+        }
+    }
+    return CTRL_CONFIG_PASS;
+}
+
 /**
  * @brief Configure the host for data transmission and reception.
  */
@@ -196,6 +323,9 @@ void sdmmc_set_xfer_config(cmd_parameters_t const *params)
         case CMD_READ_MULT_BLOCK:
         case CMD_READ_SINGLE_BLOCK:
         case CMD_SEND_EXT_CSD:
+        case CMD_SWITCH_FUNC:
+        case CMD_SEND_TUNING:
+        case CMD_SEND_TUNING_HS200:
             srs03_reg_value |= DATA_READ << SDMMC_SRS03_DTDS_POS;
             break;
 
@@ -218,6 +348,9 @@ void sdmmc_set_xfer_config(cmd_parameters_t const *params)
         case CMD_READ_SINGLE_BLOCK:
         case CMD_WRITE_SINGLE_BLOCK:
         case CMD_SEND_EXT_CSD:
+        case CMD_SWITCH_FUNC:
+        case CMD_SEND_TUNING:
+        case CMD_SEND_TUNING_HS200:
             srs03_reg_value |= (uint32_t)SINGLE_BLOCK << SDMMC_SRS03_MSBS_POS;
             break;
         default:
@@ -240,7 +373,6 @@ void sdmmc_set_up_xfer(dma_descriptor_t *pdesc, uint64_t *buff,
         uint32_t block_size, uint32_t block_ct)
 {
     uint64_t desc = 0;
-    uint32_t volatile val = 0;
     uint32_t volatile i = 0;
     uint32_t size = block_size * block_ct;
     uint32_t descriptor_count = 0;
@@ -257,6 +389,7 @@ void sdmmc_set_up_xfer(dma_descriptor_t *pdesc, uint64_t *buff,
         pdesc->addr_lo = (uint32_t)((uint64_t)buff & BIT_MASK_32) +
                 (DESC_MAX_XFER_SIZE * i);
         pdesc->addr_hi = (uint32_t)(((uint64_t)buff >> 32U) & BIT_MASK_32);
+        pdesc->reserved_hi = 0U;
         size -= SDMMC_DMA_MAX_BUFFER_SIZE;
         pdesc++;
         i++;
@@ -267,12 +400,45 @@ void sdmmc_set_up_xfer(dma_descriptor_t *pdesc, uint64_t *buff,
     pdesc->addr_lo = (uint32_t)(((uint64_t)(uintptr_t)buff & BIT_MASK_32) +
             ((uint64_t)DESC_MAX_XFER_SIZE * i));
     pdesc->addr_hi = (uint32_t)((((uint64_t)buff >> 32U) & BIT_MASK_32));
+    pdesc->reserved_hi = 0U;
+
+    sdmmc_start_adma((dma_descriptor_t *)desc, descriptor_count, block_size,
+            block_ct);
+}
+
+/**
+ * @brief Fill one ADMA2 transfer descriptor.
+ */
+void sdmmc_set_desc(dma_descriptor_t *pdesc, uint64_t addr, uint32_t len,
+        bool last)
+{
+    pdesc->attribute = XFER_DATA | VAL_DESCRIPTOR | EN_DMA_INT;
+    if (last)
+    {
+        pdesc->attribute |= END_DESCRIPTOR;
+    }
+    pdesc->reserved = 0U;
+    /*a length of 0 encodes the full 64KB*/
+    pdesc->len = (uint16_t)(len & 0xFFFFU);
+    pdesc->addr_lo = (uint32_t)(addr & BIT_MASK_32);
+    pdesc->addr_hi = (uint32_t)((addr >> 32U) & BIT_MASK_32);
+    pdesc->reserved_hi = 0U;
+}
+
+/**
+ * @brief Hand a prepared descriptor table to the host.
+ */
+void sdmmc_start_adma(dma_descriptor_t *pdesc, uint32_t desc_count,
+        uint32_t block_size, uint32_t block_ct)
+{
+    uint32_t volatile val = 0;
+    uint64_t desc = (uint64_t)pdesc;
 
-    cache_force_write_back((uint64_t *)desc, descriptor_count *
+    cache_force_write_back((uint64_t *)desc, desc_count *
             sizeof(dma_descriptor_t));
 
     WR_REG32(SRS_BASE_ADDR + SDMMC_SRS22, (uint32_t)desc);
-    WR_REG32(SRS_BASE_ADDR + SDMMC_SRS23, (uint32_t)((uint64_t)desc >> 32U));
+    WR_REG32(SRS_BASE_ADDR + SDMMC_SRS23, (uint32_t)(desc >> 32U));
     WR_REG32(SRS_BASE_ADDR + SDMMC_SRS00, (uint32_t)block_ct);
 
     val = (uint32_t)(block_ct << SDMMC_SRS01_BCCT_POS);
@@ -281,6 +447,322 @@ void sdmmc_set_up_xfer(dma_descriptor_t *pdesc, uint64_t *buff,
     WR_REG32(SRS_BASE_ADDR + SDMMC_SRS01, val);
 }
 
+/**
+ * @brief Let the host issue CMD23 ahead of multi-block transfers.
+ */
+void sdmmc_enable_cmd23(void)
+{
+    uint32_t srs15_reg_value;
+
+    srs15_reg_value = RD_REG32(SRS_BASE_ADDR + SDMMC_SRS15);
+    srs15_reg_value |= SDMMC_SRS15_CMD23E_MASK;
+    WR_REG32(SRS_BASE_ADDR + SDMMC_SRS15, srs15_reg_value);
+}
+
+/**
+ * @brief Check for the command queue engine.
+ */
+uint32_t sdmmc_cqe_supported(void)
+{
+    return RD_REG32(HRS_BASE_ADDR + SDMMC_HRS30) & SDMMC_HRS30_CQSUP_MASK;
+}
+
+/**
+ * @brief Enable the command queue engine.
+ */
+void sdmmc_cqe_enable(cqe_task_slot_t *ptdl)
+{
+    uint64_t tdl = (uint64_t)ptdl;
+    uint32_t val;
+
+    /*tasks always move whole 512 byte sectors*/
+    val = RD_REG32(SRS_BASE_ADDR + SDMMC_SRS01);
+    val &= ~SDMMC_SRS01_TBS_MASK;
+    val |= DATA_XFER_BITS_512 << SDMMC_SRS01_TBS_POS;
+    WR_REG32(SRS_BASE_ADDR + SDMMC_SRS01, val);
+
+    /*64 bit task descriptors, no direct command slot*/
+    WR_REG32(SRS_BASE_ADDR + SDMMC_CQRS02, 0U);
+    WR_REG32(SRS_BASE_ADDR + SDMMC_CQRS08, (uint32_t)tdl);
+    WR_REG32(SRS_BASE_ADDR + SDMMC_CQRS09, (uint32_t)(tdl >> 32U));
+
+    WR_REG32(SRS_BASE_ADDR + SDMMC_CQRS05, CQE_INT_MASK);
+    WR_REG32(SRS_BASE_ADDR + SDMMC_CQRS06, CQE_INT_MASK);
+    WR_REG32(SRS_BASE_ADDR + SDMMC_CQRS04, CQE_INT_MASK);
+
+    WR_REG32(SRS_BASE_ADDR + SDMMC_CQRS02, SDMMC_CQRS02_CQE_MASK);
+    sdmmc_enable_cqe_int();
+}
+
+/**
+ * @brief Halt and disable the command queue engine.
+ */
+int32_t sdmmc_cqe_disable(void)
+{
+    uint32_t count;
+
+    WR_REG32(SRS_BASE_ADDR + SDMMC_CQRS03, SDMMC_CQRS03_CQHLT_MASK);
+    count = RESET_TIMEOUT;
+    while ((RD_REG32(SRS_BASE_ADDR + SDMMC_CQRS03) &
+            SDMMC_CQRS03_CQHLT_MASK) == 0U)
+    {
+        if (count == 0U)
+        {
+            return CTRL_CONFIG_FAIL;
+        }
+        count--;
+    }
+    WR_REG32(SRS_BASE_ADDR + SDMMC_CQRS03, SDMMC_CQRS03_CQHLT_MASK |
+            SDMMC_CQRS03_CQCAT_MASK);
+    count = RESET_TIMEOUT;
+    while ((RD_REG32(SRS_BASE_ADDR + SDMMC_CQRS03) &
+            SDMMC_CQRS03_CQCAT_MASK) != 0U)
+    {
+        if (count == 0U)
+        {
+            return CTRL_CONFIG_FAIL;
+        }
+        count--;
+    }
+    WR_REG32(SRS_BASE_ADDR + SDMMC_CQRS04, CQE_INT_MASK);
+    WR_REG32(SRS_BASE_ADDR + SDMMC_CQRS02, 0U);
+    WR_REG32(SRS_BASE_ADDR + SDMMC_CQRS03, 0U);
+    sdmmc_clear_int();
+
+    return CTRL_CONFIG_PASS;
+}
+
+/**
+ * @brief Fill one command queue transfer descriptor.
+ */
+void sdmmc_set_cqe_desc(cqe_descriptor_t *pdesc, uint64_t addr, uint32_t len,
+        bool last)
+{
+    pdesc->attribute = XFER_DATA | VAL_DESCRIPTOR;
+    if (last)
+    {
+        pdesc->attribute |= END_DESCRIPTOR;
+    }
+    /*a length of 0 encodes the full 64KB*/
+    pdesc->len = (uint16_t)(len & 0xFFFFU);
+    pdesc->addr_lo = (uint32_t)(addr & BIT_MASK_32);
+    pdesc->addr_hi = (uint32_t)((addr >> 32U) & BIT_MASK_32);
+    pdesc->reserved = 0U;
+}
+
+/**
+ * @brief Prepare a command queue task slot.
+ */
+void sdmmc_cqe_set_task(cqe_task_slot_t *pslot, bool is_read,
+        uint32_t block_ct, uint32_t block_addr, cqe_descriptor_t *pdesc,
+        uint32_t desc_count)
+{
+    uint64_t desc = (uint64_t)pdesc;
+
+    pslot->task_attr = VAL_DESCRIPTOR | END_DESCRIPTOR | EN_DMA_INT |
+            CQE_ACT_TASK | (block_ct << CQE_TASK_BLK_CT_POS);
+    if (is_read)
+    {
+        pslot->task_attr |= CQE_TASK_DATA_READ;
+    }
+    pslot->block_addr = block_addr;
+
+    pslot->link.attribute = CQE_ACT_LINK | VAL_DESCRIPTOR;
+    pslot->link.len = 0U;
+    pslot->link.addr_lo = (uint32_t)(desc & BIT_MASK_32);
+    pslot->link.addr_hi = (uint32_t)((desc >> 32U) & BIT_MASK_32);
+    pslot->link.reserved = 0U;
+
+    cache_force_write_back(pdesc, desc_count * sizeof(cqe_descriptor_t));
+    cache_force_write_back(pslot, sizeof(cqe_task_slot_t));
+}
+
+/**
+ * @brief Ring the doorbell of a task.
+ */
+void sdmmc_cqe_ring(uint32_t tag)
+{
+    WR_REG32(SRS_BASE_ADDR + SDMMC_CQRS10, (uint32_t)1U << tag);
+}
+
+/**
+ * @brief Acknowledge command queue interrupts.
+ */
+uint32_t sdmmc_cqe_get_done(uint32_t *perr_tags)
+{
+    uint32_t status;
+    uint32_t done;
+    uint32_t err;
+
+    status = RD_REG32(SRS_BASE_ADDR + SDMMC_CQRS04);
+    WR_REG32(SRS_BASE_ADDR + SDMMC_CQRS04, status);
+
+    done = RD_REG32(SRS_BASE_ADDR + SDMMC_CQRS11);
+    WR_REG32(SRS_BASE_ADDR + SDMMC_CQRS11, done);
+
+    *perr_tags = 0U;
+    if ((status & SDMMC_CQRS04_CQREDI_MASK) != 0U)
+    {
+        err = RD_REG32(SRS_BASE_ADDR + SDMMC_CQRS21);
+        if ((err & SDMMC_CQRS21_CQRMEFV_MASK) != 0U)
+        {
+            *perr_tags |= (uint32_t)1U << ((err & SDMMC_CQRS21_CQRMETID_MASK)
+                    >> SDMMC_CQRS21_CQRMETID_POS);
+        }
+        if ((err & SDMMC_CQRS21_CQDTEFV_MASK) != 0U)
+        {
+            *perr_tags |= (uint32_t)1U << ((err & SDMMC_CQRS21_CQDTETID_MASK)
+                    >> SDMMC_CQRS21_CQDTETID_POS);
+        }
+        /*the engine names no task, fail everything in flight*/
+        if (*perr_tags == 0U)
+        {
+            *perr_tags = (uint32_t)BIT_MASK_32;
+        }
+    }
+
+    return done | *perr_tags;
+}
+
+/**
+ * @brief Enable command queue interrupts.
+ */
+void sdmmc_enable_cqe_int(void)
+{
+    WR_REG32(SRS_BASE_ADDR + SDMMC_SRS14, SDMMC_SRS14_CQINT_IE_MASK);
+    WR_REG32(SRS_BASE_ADDR + SDMMC_SRS13, SDMMC_SRS13_CQINT_SE_MASK);
+}
+
+/**
+ * @brief Check for ADMA3 support.
+ */
+uint32_t sdmmc_adma3_supported(void)
+{
+    return RD_REG32(SRS_BASE_ADDR + SDMMC_SRS17) & SDMMC_SRS17_ADMA3SUP_MASK;
+}
+
+/**
+ * @brief Fill one data descriptor of an ADMA3 descriptor set.
+ */
+void sdmmc_set_adma3_desc(dma_descriptor_t *pdesc, uint64_t addr,
+        uint32_t len, bool last)
+{
+    /*no interrupt per descriptor, the chain raises one at its end*/
+    pdesc->attribute = XFER_DATA | VAL_DESCRIPTOR;
+    if (last)
+    {
+        pdesc->attribute |= END_DESCRIPTOR;
+    }
+    pdesc->reserved = 0U;
+    /*a length of 0 encodes the full 64KB*/
+    pdesc->len = (uint16_t)(len & 0xFFFFU);
+    pdesc->addr_lo = (uint32_t)(addr & BIT_MASK_32);
+    pdesc->addr_hi = (uint32_t)((addr >> 32U) & BIT_MASK_32);
+    pdesc->reserved_hi = 0U;
+}
+
+/**
+ * @brief Fill an ADMA3 command descriptor.
+ */
+void sdmmc_set_adma3_cmd(adma3_cmd_desc_t *pcmd, bool is_read,
+        uint32_t block_ct, uint32_t block_addr)
+{
+    uint32_t attr = VAL_DESCRIPTOR | ADMA3_ACT_CMD;
+    uint32_t cmd_index;
+    uint32_t xfer;
+
+    xfer = (EN_DMA << SDMMC_SRS03_DMAE_POS) | (EN_BCT << SDMMC_SRS03_BCE_POS) |
+            (DATA_PRESENT << SDMMC_SRS03_DPS_POS) |
+            (CMD_ID_CHECK_EN << SDMMC_SRS03_CICE_POS) |
+            (CMD_CRC_CHECK_EN << SDMMC_SRS03_CRCCE_POS) |
+            (SHORT_RESP << SDMMC_SRS03_RTS_POS);
+    if (is_read)
+    {
+        cmd_index = (block_ct > 1U) ? CMD_READ_MULT_BLOCK :
+                CMD_READ_SINGLE_BLOCK;
+        xfer |= DATA_READ << SDMMC_SRS03_DTDS_POS;
+    }
+    else
+    {
+        cmd_index = CMD_WRITE_MULT_BLOCK;
+    }
+    /*auto CMD23 sets the block count up front, same as sdmmc_send_command*/
+    if (cmd_index != CMD_READ_SINGLE_BLOCK)
+    {
+        xfer |= (MULTI_BLOCK << SDMMC_SRS03_MSBS_POS) |
+                (AUTO_CMD_23_EN << SDMMC_SRS03_ACE_POS);
+    }
+    xfer |= cmd_index << SDMMC_SRS03_CIDX_POS;
+
+    /*the lines are written to SRS00 to SRS03 in turn*/
+    pcmd->line[0].attribute = attr;
+    pcmd->line[0].value = block_ct;
+    pcmd->line[1].attribute = attr;
+    pcmd->line[1].value = (block_ct << SDMMC_SRS01_BCCT_POS) |
+            (DATA_XFER_BITS_512 << SDMMC_SRS01_TBS_POS);
+    pcmd->line[2].attribute = attr;
+    pcmd->line[2].value = block_addr;
+    pcmd->line[3].attribute = attr | END_DESCRIPTOR;
+    pcmd->line[3].value = xfer;
+}
+
+/**
+ * @brief Point an integrated descriptor at a descriptor set.
+ */
+void sdmmc_set_adma3_entry(adma3_integrated_desc_t *pentry,
+        adma3_cmd_desc_t *pcmd, uint32_t desc_count, bool last)
+{
+    uint64_t set = (uint64_t)pcmd;
+
+    pentry->attribute = VAL_DESCRIPTOR | ADMA3_ACT_INTEGRATED;
+    if (last)
+    {
+        pentry->attribute |= END_DESCRIPTOR | EN_DMA_INT;
+    }
+    pentry->reserved = 0U;
+    pentry->addr_lo = (uint32_t)(set & BIT_MASK_32);
+    pentry->addr_hi = (uint32_t)((set >> 32U) & BIT_MASK_32);
+
+    cache_force_write_back(pcmd, sizeof(adma3_cmd_desc_t) +
+            (desc_count * sizeof(dma_descriptor_t)));
+}
+
+/**
+ * @brief Start an ADMA3 chain.
+ */
+int32_t sdmmc_start_adma3(adma3_integrated_desc_t *pchain, uint32_t count)
+{
+    uint64_t chain = (uint64_t)pchain;
+
+    cache_force_write_back(pchain, count * sizeof(adma3_integrated_desc_t));
+
+    if (reset_lines() != CTRL_CONFIG_PASS)
+    {
+        return CTRL_CONFIG_FAIL;
+    }
+    if ((RD_REG32(SRS_BASE_ADDR + SDMMC_SRS09) & (SDMMC_SRS09_CICMD_MASK |
+            SDMMC_SRS09_CIDAT_MASK)) != 0U)
+    {
+        return CTRL_CONFIG_FAIL;
+    }
+    sdmmc_enable_adma3_int();
+
+    /*the host starts fetching once the address is complete*/
+    WR_REG32(SRS_BASE_ADDR + SDMMC_SRS30, (uint32_t)chain);
+    WR_REG32(SRS_BASE_ADDR + SDMMC_SRS31, (uint32_t)(chain >> 32U));
+
+    return CTRL_CONFIG_PASS;
+}
+
+/**
+ * @brief Read the current ADMA3 integrated descriptor address.
+ */
+uint64_t sdmmc_adma3_position(void)
+{
+    return ((uint64_t)RD_REG32(SRS_BASE_ADDR + SDMMC_SRS31) << 32U) |
+           RD_REG32(SRS_BASE_ADDR + SDMMC_SRS30);
+}
+
 /**
  * @brief Initialize sdmmc host configuration
  */
@@ -289,6 +771,7 @@ void sdmmc_init_configs(uint32_t emmc_bus_width, uint32_t def_speed)
     uint32_t srs10_reg_value = 0;
     uint32_t srs11_reg_value = 0;
     uint32_t srs03_reg_value = 0;
+    uint32_t srs15_reg_value;
 
     srs03_reg_value = RD_REG32(SRS_BASE_ADDR + SDMMC_SRS03);
     srs10_reg_value = RD_REG32(SRS_BASE_ADDR + SDMMC_SRS10);
@@ -325,7 +808,239 @@ void sdmmc_init_configs(uint32_t emmc_bus_width, uint32_t def_speed)
     WR_REG32(SRS_BASE_ADDR + SDMMC_SRS03, srs03_reg_value);
     WR_REG32(SRS_BASE_ADDR + SDMMC_SRS10, srs10_reg_value);
 
-    config_phy_xfer_params();
+    /*version 4 mode, 64 bit addressing with 128 bit ADMA2 descriptors and ADMA3*/
+    srs15_reg_value = RD_REG32(SRS_BASE_ADDR + SDMMC_SRS15);
+    srs15_reg_value |= SDMMC_SRS15_HV4E_MASK | SDMMC_SRS15_A64B_MASK;
+    WR_REG32(SRS_BASE_ADDR + SDMMC_SRS15, srs15_reg_value);
+
+    (void)config_phy_xfer_params((def_speed == 1U) ? SDMMC_TIMING_SD_DS :
+            SDMMC_TIMING_SD_HS);
+}
+
+/**
+ * @brief Report the bus timings supported by the host.
+ */
+uint32_t sdmmc_host_timings(void)
+{
+    uint32_t srs16_reg_value = RD_REG32(SRS_BASE_ADDR + SDMMC_SRS16);
+    uint32_t srs17_reg_value = RD_REG32(SRS_BASE_ADDR + SDMMC_SRS17);
+    uint32_t timings;
+
+    timings = (1U << SDMMC_TIMING_SD_DS) | (1U << SDMMC_TIMING_MMC_LEGACY);
+    if ((srs16_reg_value & SDMMC_SRS16_HSS_MASK) != 0U)
+    {
+        timings |= (1U << SDMMC_TIMING_SD_HS) | (1U << SDMMC_TIMING_MMC_HS);
+    }
+    /*every mode above 50 MHz signals at 1.8V*/
+    if ((srs16_reg_value & SDMMC_SRS16_VS18_MASK) == 0U)
+    {
+        return timings;
+    }
+    if ((srs17_reg_value & SDMMC_SRS17_SDR50_MASK) != 0U)
+    {
+        timings |= 1U << SDMMC_TIMING_SDR50;
+    }
+    if ((srs17_reg_value & SDMMC_SRS17_SDR104_MASK) != 0U)
+    {
+        timings |= 1U << SDMMC_TIMING_SDR104;
+        /*hs200 and hs400 need the same 200 MHz clock over eight data lines*/
+        if ((srs16_reg_value & SDMMC_SRS16_EDS8_MASK) != 0U)
+        {
+            timings |= (1U << SDMMC_TIMING_HS200) | (1U << SDMMC_TIMING_HS400);
+            if ((RD_REG32(HRS_BASE_ADDR + SDMMC_HRS30) &
+                    SDMMC_HRS30_HS400ESSUP_MASK) != 0U)
+            {
+                timings |= 1U << SDMMC_TIMING_HS400ES;
+            }
+        }
+    }
+    return timings;
+}
+
+/**
+ * @brief Check whether a bus timing needs tuning.
+ */
+bool sdmmc_timing_needs_tuning(sdmmc_timing_t timing)
+{
+    switch (timing)
+    {
+        case SDMMC_TIMING_SDR104:
+        case SDMMC_TIMING_HS200:
+            return true;
+
+        case SDMMC_TIMING_SDR50:
+            return (RD_REG32(SRS_BASE_ADDR + SDMMC_SRS17) &
+                   SDMMC_SRS17_UTSM50_MASK) != 0U;
+
+        default:
+            return false;
+    }
+}
+
+/**
+ * @brief Switch the host to a bus timing.
+ */
+int32_t sdmmc_set_timing(sdmmc_timing_t timing)
+{
+    const struct sdmmc_timing_cfg *cfg;
+    uint32_t srs10_reg_value;
+    uint32_t srs11_reg_value;
+    uint32_t srs15_reg_value;
+    uint32_t hrs06_reg_value;
+    uint32_t base_mhz;
+    uint32_t div = 0U;
+    uint32_t count;
+    int32_t ret;
+
+    if (timing >= SDMMC_TIMING_COUNT)
+    {
+        return CTRL_CONFIG_FAIL;
+    }
+    cfg = &timing_cfgs[timing];
+
+    /*the card clock is stopped while its frequency and the phy change*/
+    sdmmc_sd_clock_enable(false);
+
+    srs10_reg_value = RD_REG32(SRS_BASE_ADDR + SDMMC_SRS10);
+    srs10_reg_value &= ~SDMMC_SRS10_HSE_MASK;
+    if (cfg->hse)
+    {
+        srs10_reg_value |= HIGH_SPEED_MODE << SDMMC_SRS10_HSE_POS;
+    }
+    WR_REG32(SRS_BASE_ADDR + SDMMC_SRS10, srs10_reg_value);
+
+    /*once at 1.8V the card stays there until it is power cycled*/
+    srs15_reg_value = RD_REG32(SRS_BASE_ADDR + SDMMC_SRS15);
+    srs15_reg_value &= ~SDMMC_SRS15_UMS_MASK;
+    srs15_reg_value |= cfg->uhs_mode << SDMMC_SRS15_UMS_POS;
+    if (cfg->v18)
+    {
+        srs15_reg_value |= SDMMC_SRS15_V18SE_MASK;
+    }
+    WR_REG32(SRS_BASE_ADDR + SDMMC_SRS15, srs15_reg_value);
+
+    hrs06_reg_value = RD_REG32(HRS_BASE_ADDR + SDMMC_HRS06);
+    hrs06_reg_value &= ~SDMMC_HRS06_EMM_MASK;
+    hrs06_reg_value |= cfg->hrs06_mode << SDMMC_HRS06_EMM_POS;
+    WR_REG32(HRS_BASE_ADDR + SDMMC_HRS06, hrs06_reg_value);
+
+    /*the card clock is base / (2 * div), a divider of 0 passes base through*/
+    base_mhz = (RD_REG32(SRS_BASE_ADDR + SDMMC_SRS16) &
+            SDMMC_SRS16_BCSDCLK_MASK) >> SDMMC_SRS16_BCSDCLK_POS;
+    if (base_mhz == 0U)
+    {
+        base_mhz = BASE_CLK_MHZ_DEF;
+    }
+    if (cfg->clk_mhz < base_mhz)
+    {
+        div = (base_mhz + (2U * cfg->clk_mhz) - 1U) / (2U * cfg->clk_mhz);
+    }
+    srs11_reg_value = RD_REG32(SRS_BASE_ADDR + SDMMC_SRS11);
+    srs11_reg_value &= ~(SDMMC_SRS11_SDCFSL_MASK | SDMMC_SRS11_SDCFSH_MASK);
+    srs11_reg_value |= (div & 0xFFU) << SDMMC_SRS11_SDCFSL_POS;
+    srs11_reg_value |= ((div >> 8U) & 0x3U) << SDMMC_SRS11_SDCFSH_POS;
+    WR_REG32(SRS_BASE_ADDR + SDMMC_SRS11, srs11_reg_value);
+
+    count = RESET_TIMEOUT;
+    while ((RD_REG32(SRS_BASE_ADDR + SDMMC_SRS11) & SDMMC_SRS11_ICS_MASK) ==
+            0U)
+    {
+        if (count == 0U)
+        {
+            return CTRL_CONFIG_FAIL;
+        }
+        count--;
+    }
+
+    ret = config_phy_xfer_params(timing);
+    sdmmc_sd_clock_enable(true);
+    return ret;
+}
+
+/**
+ * @brief Move the read sampling point of the phy.
+ */
+int32_t sdmmc_set_tune_val(uint32_t tap)
+{
+    /*spread the taps over the whole slave delay line*/
+    phy_tune_val = (tap * (DLL_SLAVE_DELAY_MAX + 1U)) / SDMMC_TUNE_TAPS;
+    if (phy_tune_val > DLL_SLAVE_DELAY_MAX)
+    {
+        phy_tune_val = DLL_SLAVE_DELAY_MAX;
+    }
+    return config_phy_xfer_params(cur_timing);
+}
+
+/**
+ * @brief Start or stop the card clock.
+ */
+void sdmmc_sd_clock_enable(bool enable)
+{
+    uint32_t srs11_reg_value = RD_REG32(SRS_BASE_ADDR + SDMMC_SRS11);
+
+    if (enable)
+    {
+        srs11_reg_value |= SDMMC_SRS11_SDCE_MASK;
+    }
+    else
+    {
+        srs11_reg_value &= ~SDMMC_SRS11_SDCE_MASK;
+    }
+    WR_REG32(SRS_BASE_ADDR + SDMMC_SRS11, srs11_reg_value);
+}
+
+/**
+ * @brief Select the signalling level.
+ */
+void sdmmc_set_signal_18v(bool enable)
+{
+    uint32_t srs15_reg_value = RD_REG32(SRS_BASE_ADDR + SDMMC_SRS15);
+
+    if (enable)
+    {
+        srs15_reg_value |= SDMMC_SRS15_V18SE_MASK;
+    }
+    else
+    {
+        srs15_reg_value &= ~SDMMC_SRS15_V18SE_MASK;
+    }
+    WR_REG32(SRS_BASE_ADDR + SDMMC_SRS15, srs15_reg_value);
+}
+
+/**
+ * @brief Switch the card supply.
+ */
+void sdmmc_set_bus_power(bool on)
+{
+    uint32_t srs10_reg_value = RD_REG32(SRS_BASE_ADDR + SDMMC_SRS10);
+
+    if (on)
+    {
+        srs10_reg_value |= (uint32_t)EN_BUS_PWR << SDMMC_SRS10_BP_POS;
+    }
+    else
+    {
+        srs10_reg_value &= ~SDMMC_SRS10_BP_MASK;
+    }
+    WR_REG32(SRS_BASE_ADDR + SDMMC_SRS10, srs10_reg_value);
+}
+
+/**
+ * @brief Read the DAT[3:0] line levels.
+ */
+uint32_t sdmmc_get_dat_level(void)
+{
+    return (RD_REG32(SRS_BASE_ADDR + SDMMC_SRS09) & SDMMC_SRS09_DATSL1_MASK) >>
+           SDMMC_SRS09_DATSL1_POS;
+}
+
+/**
+ * @brief Parse the ACMD41 response for S18A.
+ */
+uint32_t sd_is_18v_accepted(void)
+{
+    return ((RD_REG32(SRS_BASE_ADDR + SDMMC_SRS04) & S18A_ACCEPTED) != 0U) ?
+           1U : 0U;
 }
 
 /**
@@ -590,16 +1305,34 @@ int32_t sdmmc_reset_per0(void)
 }
 
 /**
- * @brief Enable the extended read,write and command mode.
+ * @brief Load the phy delays of a bus timing and enable the extended
+ * read,write and command mode.
  */
-static void config_phy_xfer_params(void)
+static int32_t config_phy_xfer_params(sdmmc_timing_t timing)
 {
+    const struct sdmmc_phy_cfg *phy = &phy_cfgs[timing_cfgs[timing].phy_cfg];
+    uint32_t dll_slave_ctl = phy->dll_slave_ctl;
     uint32_t hrs09_reg_val;
+    uint32_t count;
+
+    if ((phy->tune_fields & PHY_TUNE_CMD) != 0U)
+    {
+        dll_slave_ctl |= phy_tune_val << READ_DQS_CMD_DELAY_POS;
+    }
+    if ((phy->tune_fields & PHY_TUNE_DATA) != 0U)
+    {
+        dll_slave_ctl |= phy_tune_val << READ_DQS_DELAY_POS;
+    }
 
     hrs09_reg_val = RD_REG32(HRS_BASE_ADDR + SDMMC_HRS09);
     hrs09_reg_val &= ~(PHY_SW_RST);
     WR_REG32(HRS_BASE_ADDR + SDMMC_HRS09, hrs09_reg_val);
 
+    /*the delay lines only take new settings while the phy is held in reset*/
+    program_reg(phy->dqs_timing, PHY_DQS_TIM_REG_ADD);
+    program_reg(phy->dll_master_ctl, PHY_DLL_MASTER_CTL_ADD);
+    program_reg(dll_slave_ctl, PHY_DLL_SLAVE_CTL_ADD);
+
     hrs09_reg_val |= ((EN_EXT_WR_MODE << SDMMC_HRS09_EXTENDED_WR_MODE_POS) |
             ((uint32_t)EN_EXT_RDCMD_MODE << SDMMC_HRS09_RDCMD_EN_POS) |
             ((uint32_t)EN_EXT_RDDATA_MODE << SDMMC_HRS09_RDDATA_EN_POS));
@@ -607,6 +1340,20 @@ static void config_phy_xfer_params(void)
     WR_REG32(HRS_BASE_ADDR + SDMMC_HRS09, hrs09_reg_val);
     hrs09_reg_val |= PHY_SW_RST;
     WR_REG32(HRS_BASE_ADDR + SDMMC_HRS09, hrs09_reg_val);
+    cur_timing = timing;
+
+    /*wait for the dll to lock*/
+    count = RESET_TIMEOUT;
+    while ((RD_REG32(HRS_BASE_ADDR + SDMMC_HRS09) &
+            SDMMC_HRS09_PHY_INIT_COMPLETE_MASK) == 0U)
+    {
+        if (count == 0U)
+        {
+            return CTRL_CONFIG_FAIL;
+        }
+        count--;
+    }
+    return CTRL_CONFIG_PASS;
 }
 
 /**
@@ -648,6 +1395,15 @@ static void sdmmc_enable_xfer_int(void)
     WR_REG32(SRS_BASE_ADDR + SDMMC_SRS13, EN_XFER_INT);
 }
 
+/**
+ * @brief Enable ADMA3 chain interrupts.
+ */
+static void sdmmc_enable_adma3_int(void)
+{
+    WR_REG32(SRS_BASE_ADDR + SDMMC_SRS14, EN_ADMA3_INT);
+    WR_REG32(SRS_BASE_ADDR + SDMMC_SRS13, EN_ADMA3_INT);
+}
+
 /**
  * @brief Clear sdmmc interrupt flags.
  */
@@ -9,6 +9,8 @@
 #ifndef __SOCFPGA_SDMMC_LL_H__
 #define __SOCFPGA_SDMMC_LL_H__
 
+#include <stdbool.h>
+
 #define PER0MODRST_ADDR    (0x10D11024U)
 
 #define DESC_MAX_XFER_SIZE    (64U * 1024U)
@@ -30,6 +32,7 @@ typedef struct
     uint8_t card_type;
 } card_data_t;
 
+/*ADMA2 transfer descriptor, 128 bit form of host version 4 64 bit addressing*/
 typedef struct __attribute__((packed))
 {
     uint8_t attribute;
@@ -37,8 +40,72 @@ typedef struct __attribute__((packed))
     uint16_t len;
     uint32_t addr_lo;
     uint32_t addr_hi;
+    uint32_t reserved_hi;
 } dma_descriptor_t;
 
+/*command queue transfer or link descriptor, 128 bit form for 64 bit addressing*/
+typedef struct __attribute__((packed))
+{
+    uint16_t attribute;
+    uint16_t len;
+    uint32_t addr_lo;
+    uint32_t addr_hi;
+    uint32_t reserved;
+} cqe_descriptor_t;
+
+/*command queue slot, a task descriptor and a link to its transfer descriptors*/
+typedef struct __attribute__((packed))
+{
+    uint32_t task_attr;
+    uint32_t block_addr;
+    cqe_descriptor_t link;
+} cqe_task_slot_t;
+
+#define CQE_MAX_SLOTS       32U
+
+/*one register write of an ADMA3 command descriptor*/
+typedef struct __attribute__((packed))
+{
+    uint32_t attribute;
+    uint32_t value;
+} adma3_cmd_line_t;
+
+/*block count, block size, argument and command, in that order*/
+#define ADMA3_CMD_LINES     4U
+
+/*ADMA3 command descriptor, the ADMA2 descriptors of its data follow it*/
+typedef struct __attribute__((packed))
+{
+    adma3_cmd_line_t line[ADMA3_CMD_LINES];
+} adma3_cmd_desc_t;
+
+/*ADMA3 integrated descriptor, points to one descriptor set*/
+typedef struct __attribute__((packed))
+{
+    uint32_t attribute;
+    uint32_t reserved;
+    uint32_t addr_lo;
+    uint32_t addr_hi;
+} adma3_integrated_desc_t;
+
+/*bus timings, each fixes the card clock, signalling level and phy delays*/
+typedef enum
+{
+    SDMMC_TIMING_SD_DS = 0,     /*SD default speed, 25 MHz*/
+    SDMMC_TIMING_SD_HS,         /*SD high speed or UHS-I SDR25, 50 MHz*/
+    SDMMC_TIMING_SDR50,         /*UHS-I SDR50, 100 MHz at 1.8V*/
+    SDMMC_TIMING_SDR104,        /*UHS-I SDR104, 200 MHz at 1.8V*/
+    SDMMC_TIMING_MMC_LEGACY,    /*eMMC backward compatible, 25 MHz*/
+    SDMMC_TIMING_MMC_HS,        /*eMMC high speed SDR, 50 MHz*/
+    SDMMC_TIMING_HS200,         /*eMMC HS200, 200 MHz SDR at 1.8V*/
+    SDMMC_TIMING_HS400,         /*eMMC HS400, 200 MHz DDR sampled on the data strobe*/
+    SDMMC_TIMING_HS400ES,       /*eMMC HS400 with the response on the strobe as well*/
+    SDMMC_TIMING_COUNT
+} sdmmc_timing_t;
+
+/*sampling points tried by the tuning procedure*/
+#define SDMMC_TUNE_TAPS     40U
+
 #define CMD_SND_OK          0
 #define CMD_ERR             1
 #define XFER_CPT_OK         2
@@ -83,6 +150,271 @@ void sd_read_response_rel_addr(card_data_t *pxcard);
 void sdmmc_set_up_xfer(dma_descriptor_t *pdesc, uint64_t *buff, uint32_t
         block_size, uint32_t block_ct);
 
+/**
+ * @brief Fills one ADMA2 transfer descriptor.
+ *
+ * @param[in] pdesc Descriptor to fill.
+ * @param[in] addr  Bus address of the data, 4 byte aligned.
+ * @param[in] len   Length in bytes, up to DESC_MAX_XFER_SIZE.
+ * @param[in] last  Marks the end of the descriptor table.
+ */
+void sdmmc_set_desc(dma_descriptor_t *pdesc, uint64_t addr, uint32_t len,
+        bool last);
+
+/**
+ * @brief Programs the host with a prepared descriptor table.
+ *
+ * Writes the table back to memory and loads its address along with the
+ * block size and count of the next data command.
+ *
+ * @param[in] pdesc      Start of the descriptor table.
+ * @param[in] desc_count Number of descriptors in the table.
+ * @param[in] block_size Size of each block in bytes.
+ * @param[in] block_ct   Number of blocks to be transferred/received.
+ */
+void sdmmc_start_adma(dma_descriptor_t *pdesc, uint32_t desc_count,
+        uint32_t block_size, uint32_t block_ct);
+
+/**
+ * @brief Lets the host issue CMD23 ahead of multi-block transfers.
+ */
+void sdmmc_enable_cmd23(void);
+
+/**
+ * @brief Checks whether the host has a command queue engine.
+ *
+ * @return
+ * - 1, if the command queue engine is present.
+ * - 0, otherwise.
+ */
+uint32_t sdmmc_cqe_supported(void);
+
+/**
+ * @brief Enables the command queue engine on a task descriptor list.
+ *
+ * @param[in] ptdl Task descriptor list of CQE_MAX_SLOTS slots.
+ */
+void sdmmc_cqe_enable(cqe_task_slot_t *ptdl);
+
+/**
+ * @brief Halts the command queue engine, discards all queued tasks and
+ * disables it.
+ *
+ * @return
+ *  - CTRL_CONFIG_PASS , when the engine is stopped.
+ *  - CTRL_CONFIG_FAIL , on timeout.
+ */
+int32_t sdmmc_cqe_disable(void);
+
+/**
+ * @brief Fills one command queue transfer descriptor.
+ *
+ * @param[in] pdesc Descriptor to fill.
+ * @param[in] addr  Bus address of the data, 4 byte aligned.
+ * @param[in] len   Length in bytes, up to DESC_MAX_XFER_SIZE.
+ * @param[in] last  Marks the end of the transfer descriptors of a task.
+ */
+void sdmmc_set_cqe_desc(cqe_descriptor_t *pdesc, uint64_t addr, uint32_t len,
+        bool last);
+
+/**
+ * @brief Prepares a task slot and makes it and its descriptors visible to
+ * the engine.
+ *
+ * @param[in] pslot      Slot of the task in the task descriptor list.
+ * @param[in] is_read    Direction of the transfer.
+ * @param[in] block_ct   Number of blocks of the task.
+ * @param[in] block_addr First block of the task on the device.
+ * @param[in] pdesc      Transfer descriptors of the task.
+ * @param[in] desc_count Number of transfer descriptors.
+ */
+void sdmmc_cqe_set_task(cqe_task_slot_t *pslot, bool is_read,
+        uint32_t block_ct, uint32_t block_addr, cqe_descriptor_t *pdesc,
+        uint32_t desc_count);
+
+/**
+ * @brief Hands a prepared task to the engine.
+ *
+ * @param[in] tag Slot number of the task.
+ */
+void sdmmc_cqe_ring(uint32_t tag);
+
+/**
+ * @brief Acknowledges command queue interrupts.
+ *
+ * @param[out] perr_tags Tasks which completed with an error.
+ *
+ * @return
+ *  Tasks which completed, one bit per slot, including failed ones.
+ */
+uint32_t sdmmc_cqe_get_done(uint32_t *perr_tags);
+
+/**
+ * @brief Enables command queue interrupts.
+ */
+void sdmmc_enable_cqe_int(void);
+
+/**
+ * @brief Checks whether the host can run ADMA3 descriptor chains.
+ *
+ * @return
+ * - 1, if ADMA3 is supported.
+ * - 0, otherwise.
+ */
+uint32_t sdmmc_adma3_supported(void);
+
+/**
+ * @brief Fills one ADMA2 transfer descriptor of an ADMA3 descriptor set.
+ *
+ * Unlike sdmmc_set_desc() the descriptor raises no interrupt, the chain
+ * signals once at its end.
+ *
+ * @param[in] pdesc Descriptor to fill.
+ * @param[in] addr  Bus address of the data, 4 byte aligned.
+ * @param[in] len   Length in bytes, up to DESC_MAX_XFER_SIZE.
+ * @param[in] last  Marks the end of the data of the set.
+ */
+void sdmmc_set_adma3_desc(dma_descriptor_t *pdesc, uint64_t addr,
+        uint32_t len, bool last);
+
+/**
+ * @brief Fills an ADMA3 command descriptor with a block read or write.
+ *
+ * Multi-block commands are preceded by an auto CMD23 with the block count.
+ *
+ * @param[in] pcmd       Command descriptor.
+ * @param[in] is_read    Direction of the transfer.
+ * @param[in] block_ct   Number of blocks, up to 65535.
+ * @param[in] block_addr First block on the device.
+ */
+void sdmmc_set_adma3_cmd(adma3_cmd_desc_t *pcmd, bool is_read,
+        uint32_t block_ct, uint32_t block_addr);
+
+/**
+ * @brief Points an integrated descriptor at a descriptor set and makes the
+ * set visible to the host.
+ *
+ * A set is a command descriptor directly followed in memory by the ADMA2
+ * descriptors of its data.
+ *
+ * @param[in] pentry     Integrated descriptor to fill.
+ * @param[in] pcmd       Command descriptor of the set.
+ * @param[in] desc_count Number of data descriptors following it.
+ * @param[in] last       Ends the chain and raises the interrupt after it.
+ */
+void sdmmc_set_adma3_entry(adma3_integrated_desc_t *pentry,
+        adma3_cmd_desc_t *pcmd, uint32_t desc_count, bool last);
+
+/**
+ * @brief Starts an ADMA3 chain.
+ *
+ * The host runs every command of the chain with its data and raises a
+ * single DMA interrupt at the end, or an error interrupt at the first
+ * failing command.
+ *
+ * @param[in] pchain Integrated descriptors of the chain.
+ * @param[in] count  Number of integrated descriptors.
+ *
+ * @return
+ *  - CTRL_CONFIG_PASS , when the chain is started.
+ *  - CTRL_CONFIG_FAIL , if the command or data line is busy.
+ */
+int32_t sdmmc_start_adma3(adma3_integrated_desc_t *pchain, uint32_t count);
+
+/**
+ * @brief Reads the integrated descriptor the host is on.
+ *
+ * After an error this is the descriptor of the failing command, all sets
+ * ahead of it have completed.
+ *
+ * @return
+ *  Bus address of the current integrated descriptor.
+ */
+uint64_t sdmmc_adma3_position(void);
+
+/**
+ * @brief Reports the bus timings the host supports.
+ *
+ * @return
+ *  One bit per sdmmc_timing_t value.
+ */
+uint32_t sdmmc_host_timings(void);
+
+/**
+ * @brief Checks whether a bus timing needs the sampling point tuned.
+ *
+ * @param[in] timing Bus timing.
+ *
+ * @return
+ * - true, if tuning must run after switching to the timing.
+ * - false, otherwise.
+ */
+bool sdmmc_timing_needs_tuning(sdmmc_timing_t timing);
+
+/**
+ * @brief Switches the host to a bus timing.
+ *
+ * Stops the card clock, programs the speed mode, signalling level and
+ * clock divider, loads the phy delays of the timing and restarts the clock.
+ * The card must already have been switched to the timing.
+ *
+ * @param[in] timing Bus timing.
+ *
+ * @return
+ *  - CTRL_CONFIG_PASS , on success.
+ *  - CTRL_CONFIG_FAIL , if the clock or the phy did not come up.
+ */
+int32_t sdmmc_set_timing(sdmmc_timing_t timing);
+
+/**
+ * @brief Moves the read sampling point of the phy.
+ *
+ * @param[in] tap Sampling point, below SDMMC_TUNE_TAPS.
+ *
+ * @return
+ *  - CTRL_CONFIG_PASS , on success.
+ *  - CTRL_CONFIG_FAIL , if the phy did not come out of reset.
+ */
+int32_t sdmmc_set_tune_val(uint32_t tap);
+
+/**
+ * @brief Starts or stops the card clock.
+ *
+ * @param[in] enable True to drive the clock.
+ */
+void sdmmc_sd_clock_enable(bool enable);
+
+/**
+ * @brief Selects 1.8V or 3.3V signalling.
+ *
+ * @param[in] enable True for 1.8V.
+ */
+void sdmmc_set_signal_18v(bool enable);
+
+/**
+ * @brief Switches the card supply.
+ *
+ * @param[in] on True to power the card.
+ */
+void sdmmc_set_bus_power(bool on);
+
+/**
+ * @brief Reads the level of the DAT[3:0] lines.
+ *
+ * @return
+ *  Line levels, DAT0 in bit 0.
+ */
+uint32_t sdmmc_get_dat_level(void);
+
+/**
+ * @brief Parses the ACMD41 response for the 1.8V switch acceptance.
+ *
+ * @return
+ * - 1, if the card accepted 1.8V signalling.
+ * - 0, otherwise.
+ */
+uint32_t sd_is_18v_accepted(void);
+
 /**
  * @brief Checks the card type based on its capacity.
  *
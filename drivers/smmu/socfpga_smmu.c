@@ -59,6 +59,7 @@
 
 #define ADDR_SPACE_SDM      0x80000000U
 #define ADDR_SPACE_PER      0x80000000U
+#define SDM_VA_SPACE_SIZE   0x20000000U
 #define GRANULE_SIZE_4KB    0x1000U
 #define OFFSET_SIZE_2MB     0x200000U
 
@@ -389,6 +390,29 @@ int32_t smmu_enable(void)
     return 0;
 }
 
+int32_t smmu_sdm_map(const void *addr, uint64_t size, uint64_t *sdm_addr)
+{
+    uint64_t pa = (uint64_t)(uintptr_t)addr;
+
+    if (sdm_addr == NULL)
+    {
+        return -EINVAL;
+    }
+    if (size == 0U)
+    {
+        *sdm_addr = 0U;
+        return 0;
+    }
+    /*the SDM page tables map a flat window starting at ADDR_SPACE_SDM*/
+    if ((pa < ADDR_SPACE_SDM) || (size > SDM_VA_SPACE_SIZE) ||
+            ((pa - ADDR_SPACE_SDM) > (SDM_VA_SPACE_SIZE - size)))
+    {
+        return -EINVAL;
+    }
+    *sdm_addr = pa - ADDR_SPACE_SDM;
+    return 0;
+}
+
 /*Command queue
  * PROD index is updated by software after inserting an item to the queue
  * The CONS index is updated by SMMU after consuming an item.
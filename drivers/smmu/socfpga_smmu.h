@@ -229,4 +229,22 @@ typedef struct
 
 int32_t smmu_enable(void);
 
+/**
+ * @brief Translate a buffer address to the address seen by the SDM.
+ *
+ * The SDM stream is given a flat 512 MB window of DDR. Buffers that lie
+ * entirely inside the window can be handed to the SDM directly, without
+ * staging them through a driver owned buffer. The caller remains
+ * responsible for cache maintenance of the buffer.
+ *
+ * @param[in]  addr     Start of the buffer.
+ * @param[in]  size     Size of the buffer in bytes, zero maps to address 0.
+ * @param[out] sdm_addr Address of the buffer in the SDM address space.
+ *
+ * @return
+ * - 0:       on success
+ * - -EINVAL: if the buffer is not fully covered by the SDM window.
+ */
+int32_t smmu_sdm_map(const void *addr, uint64_t size, uint64_t *sdm_addr);
+
 #endif
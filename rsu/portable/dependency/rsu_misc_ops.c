@@ -9,6 +9,7 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <stdint.h>
+#include <string.h>
 #include <errno.h>
 
 #include "socfpga_flash.h"
@@ -31,18 +32,34 @@
 #define DCMF3_VERSION_OFFSET    0x180420
 #define DCIO_MAX_RETRY_OFFSET   0x20018C
 
-char buf_a[DCMF_SIZE] = {0};
-char buf_b[DCMF_SIZE] = {0};
+char buf_a[DCMF_SIZE] __attribute__((aligned(64))) = {0};
 
 extern sdm_client_handle rsu_client;
 extern flash_handle_t rsu_rtos_qspi_handle;
 extern osal_semaphore_t rsu_sem;
 
+/*copy a few bytes out of the direct access window*/
+static int rsu_flash_peek(uint32_t offset, void *data, uint32_t len)
+{
+    const uint8_t *src;
+    int status;
+
+    status = flash_map(rsu_rtos_qspi_handle, offset, len, &src);
+    if (status != 0)
+    {
+        return status;
+    }
+    (void)memcpy(data, src, len);
+    (void)flash_unmap(rsu_rtos_qspi_handle);
+    return 0;
+}
+
 static RSU_OSAL_INT rsu_get_dcmf_status(struct rsu_dcmf_status *data)
 {
     uint32_t *rsu_status_resp;
     uint64_t smc_resp[2] = {0};
     uint32_t crt_dcmf, idx;
+    const uint8_t *crt_image;
     int ret;
     if (data == NULL)
     {
@@ -86,11 +103,12 @@ static RSU_OSAL_INT rsu_get_dcmf_status(struct rsu_dcmf_status *data)
         RSU_LOG_ERR("Failed to open the flash");
         return -EFAULT;
     }
-    ret = flash_read_sync(rsu_rtos_qspi_handle, crt_dcmf * DCMF_SIZE,
-            (uint8_t *)buf_a, DCMF_SIZE);
+    /*the running copy is compared in place, each other copy is read once*/
+    ret = flash_map(rsu_rtos_qspi_handle, crt_dcmf * DCMF_SIZE, DCMF_SIZE,
+            &crt_image);
     if (ret != 0)
     {
-        RSU_LOG_ERR("Failed to get DCMF status from flash");
+        RSU_LOG_ERR("Failed to map DCMF in flash");
         return -EFAULT;
     }
 
@@ -101,22 +119,20 @@ static RSU_OSAL_INT rsu_get_dcmf_status(struct rsu_dcmf_status *data)
         {
             continue;
         }
-        ret = flash_read_sync(rsu_rtos_qspi_handle, crt_dcmf * DCMF_SIZE,
-                (uint8_t *)buf_b, DCMF_SIZE);
+        ret = flash_read_sync(rsu_rtos_qspi_handle, idx * DCMF_SIZE,
+                (uint8_t *)buf_a, DCMF_SIZE);
         if (ret != 0)
         {
             RSU_LOG_ERR("Failed to get DCMF status from flash");
+            (void)flash_unmap(rsu_rtos_qspi_handle);
             return -EFAULT;
         }
-        for (int i = 0; i < DCMF_SIZE; i++)
+        if (memcmp(buf_a, crt_image, DCMF_SIZE) != 0)
         {
-            if (buf_a[i] != buf_b[i])
-            {
-                data->dcmf[idx] = 1;
-                break;
-            }
+            data->dcmf[idx] = 1;
         }
     }
+    (void)flash_unmap(rsu_rtos_qspi_handle);
     return 0;
 }
 
@@ -135,8 +151,7 @@ static RSU_OSAL_INT rsu_get_dcmf_version(struct rsu_dcmf_version *version)
     }
     uint32_t value = 0;
 
-    status = flash_read_sync(rsu_rtos_qspi_handle, DCMF0_VERSION_OFFSET,
-            (uint8_t *)&value, 4);
+    status = rsu_flash_peek(DCMF0_VERSION_OFFSET, &value, 4);
     if (status != 0)
     {
         RSU_LOG_ERR("Failed to read dcmf0 from flash");
@@ -144,8 +159,7 @@ static RSU_OSAL_INT rsu_get_dcmf_version(struct rsu_dcmf_version *version)
     }
     version->dcmf[0] = (RSU_OSAL_U32)value;
 
-    status = flash_read_sync(rsu_rtos_qspi_handle, DCMF1_VERSION_OFFSET,
-            (uint8_t *)&value, 4);
+    status = rsu_flash_peek(DCMF1_VERSION_OFFSET, &value, 4);
     if (status != 0)
     {
         RSU_LOG_ERR("Failed to read dcmf1 from flash");
@@ -154,8 +168,7 @@ static RSU_OSAL_INT rsu_get_dcmf_version(struct rsu_dcmf_version *version)
     version->dcmf[1] = (RSU_OSAL_U32)value;
 
 
-    status = flash_read_sync(rsu_rtos_qspi_handle, DCMF2_VERSION_OFFSET,
-            (uint8_t *)&value, 4);
+    status = rsu_flash_peek(DCMF2_VERSION_OFFSET, &value, 4);
     if (status != 0)
     {
         RSU_LOG_ERR("Failed to read dcmf2 from flash");
@@ -164,8 +177,7 @@ static RSU_OSAL_INT rsu_get_dcmf_version(struct rsu_dcmf_version *version)
     version->dcmf[2] = (RSU_OSAL_U32)value;
 
 
-    status = flash_read_sync(rsu_rtos_qspi_handle, DCMF3_VERSION_OFFSET,
-            (uint8_t *)&value, 4);
+    status = rsu_flash_peek(DCMF3_VERSION_OFFSET, &value, 4);
     if (status != 0)
     {
         RSU_LOG_ERR("Failed to read dcmf3 from flash");
@@ -190,8 +202,7 @@ static RSU_OSAL_INT rsu_get_max_retry_count(RSU_OSAL_U8 *rsu_max_retry)
         RSU_LOG_ERR("Failed to open the flash handle");
         return -EFAULT;
     }
-    status = flash_read_sync(rsu_rtos_qspi_handle,DCIO_MAX_RETRY_OFFSET,
-            &max_retry_count, 1);
+    status = rsu_flash_peek(DCIO_MAX_RETRY_OFFSET, &max_retry_count, 1);
     if (status != 0)
     {
         RSU_LOG_ERR("Failed to read from the flash");
@@ -9,6 +9,7 @@
 #include <stdio.h>
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 #include <errno.h>
 #include <unistd.h>
 
@@ -24,6 +25,7 @@ static RSU_OSAL_INT plat_qspi_read(RSU_OSAL_OFFSET offset, RSU_OSAL_VOID *data,
         RSU_OSAL_SIZE len)
 {
     RSU_OSAL_INT status;
+    const uint8_t *src;
 
     if (rsu_rtos_qspi_handle == NULL)
     {
@@ -31,6 +33,15 @@ static RSU_OSAL_INT plat_qspi_read(RSU_OSAL_OFFSET offset, RSU_OSAL_VOID *data,
         return -EINVAL;
     }
 
+    /*SPT and CPB tables fit the direct access window, read them from it*/
+    if ((len <= FLASH_XIP_WINDOW_SIZE) && (flash_map(rsu_rtos_qspi_handle,
+            offset, len, &src) == 0))
+    {
+        (void)memcpy(data, src, len);
+        (void)flash_unmap(rsu_rtos_qspi_handle);
+        return 0;
+    }
+
     cache_force_write_back((void *)data, len);
 
     status = flash_read_sync(rsu_rtos_qspi_handle, offset, (uint8_t *)data, len);
@@ -57,9 +68,9 @@ static RSU_OSAL_INT plat_qspi_write(RSU_OSAL_OFFSET offset,
         return -EINVAL;
     }
 
-    cache_force_write_back((void *)data, len);
-
-    status = flash_write_sync(rsu_rtos_qspi_handle, offset, (uint8_t *)data, len);
+    /*unchanged pages are skipped, pages needing set bits are erased first*/
+    status = flash_update(rsu_rtos_qspi_handle, offset,
+            (const uint8_t *)data, len, NULL, NULL);
 
     if (status != 0)
     {
@@ -79,7 +90,8 @@ static RSU_OSAL_INT plat_qspi_erase(RSU_OSAL_OFFSET offset, RSU_OSAL_SIZE len)
         return -EINVAL;
     }
 
-    status = flash_erase_sectors(rsu_rtos_qspi_handle, offset, len);
+    /*blank blocks are skipped, the rest erased with the largest blocks*/
+    status = flash_update(rsu_rtos_qspi_handle, offset, NULL, len, NULL, NULL);
 
     if (status < 0)
     {
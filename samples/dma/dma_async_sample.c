@@ -0,0 +1,208 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (C) 2025 Altera Corporation
+ *
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Sample application for the queue mode of the SoC FPGA DMA
+ */
+
+
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include "osal.h"
+#include "osal_log.h"
+#include "socfpga_dma.h"
+#include "socfpga_cache.h"
+
+/**
+ * @defgroup dma_async_sample DMA Queue Mode
+ * @ingroup samples
+ *
+ * Sample Application for the DMA queue mode
+ *
+ * @details
+ * @section dma_async_desc Description
+ * This sample puts a DMA channel into queue mode and submits more
+ * memory-to-memory transfers than its descriptor ring holds. When the ring
+ * is full dma_async_submit() returns -ENOSPC and the sample waits for the
+ * completion callback to free descriptors before submitting the rest. The
+ * callback checks that every transfer completes without error and in
+ * submission order. At the end the destination buffers are compared with
+ * the source buffers.
+ *
+ * @section dma_async_param Configurable Parameters
+ * - Number of transfers can be configured by changing the value of
+ *   @c ASYNC_XFER_COUNT macro.
+ * - Transfer size can be configured by changing the value of
+ *   @c ASYNC_XFER_SIZE macro.
+ *
+ * @section dma_async_how_to How to Run
+ * 1. Follow the common README instructions to build and flash the application.
+ * 2. Run the application on the board.
+ * 3. Output can be observed in the UART terminal.
+ *
+ * @section dma_async_result Expected Results
+ * - All transfers complete in order, including the ones submitted after
+ *   the ring was full.
+ * - The destination buffers match the source buffers.
+ * - A message confirming successful verification is printed to the terminal.
+ */
+
+/* Test configurations */
+
+#define ASYNC_XFER_COUNT      (3U * DMA_ASYNC_RING_SIZE)
+#define ASYNC_XFER_SIZE       256U
+#define ASYNC_TIMEOUT_MS      1000U
+
+static uint8_t async_src[ASYNC_XFER_COUNT][ASYNC_XFER_SIZE]
+__attribute__((aligned(64)));
+static uint8_t async_dst[ASYNC_XFER_COUNT][ASYNC_XFER_SIZE]
+__attribute__((aligned(64)));
+
+static osal_semaphore_def_t async_sem_mem;
+static osal_semaphore_t async_sem;
+static volatile uint32_t async_done;
+static volatile uint32_t async_errors;
+
+/*
+ * @brief Completion callback, runs in the DMA interrupt
+ */
+static void dma_async_done_callback(dma_handle_t dma_handle,
+        const dma_completion_t *done, uint32_t count, void *puser_context)
+{
+    uint32_t i;
+
+    (void)dma_handle;
+    (void)puser_context;
+
+    for (i = 0U; i < count; i++)
+    {
+        /* The cookie carries the index of the transfer */
+        if ((done[i].status != 0) ||
+                ((uint32_t)(uintptr_t)done[i].cookie != async_done))
+        {
+            async_errors++;
+        }
+        async_done++;
+    }
+    (void)osal_semaphore_post(async_sem);
+}
+
+void dma_async_task(void)
+{
+    dma_config_t dma_chconfig = { 0 };
+    dma_async_xfer_t xfer = { 0 };
+    dma_handle_t dma_handle;
+    uint32_t submitted = 0U, ring_full = 0U;
+    int32_t ret_val;
+    bool timed_out = false;
+
+    PRINT("DMA queue mode sample application");
+
+    for (uint32_t j = 0U; j < ASYNC_XFER_COUNT; j++)
+    {
+        for (uint32_t i = 0U; i < ASYNC_XFER_SIZE; i++)
+        {
+            async_src[j][i] = (uint8_t)(i + j);
+        }
+    }
+    (void)memset(async_dst, 0, sizeof(async_dst));
+    cache_force_write_back((void *)async_src, sizeof(async_src));
+    cache_force_write_back((void *)async_dst, sizeof(async_dst));
+
+    async_sem = osal_semaphore_create(&async_sem_mem);
+    async_done = 0U;
+    async_errors = 0U;
+
+    dma_handle = dma_open(DMA_INSTANCE0, DMA_CH2);
+    if (dma_handle == NULL)
+    {
+        ERROR("Opening DMA channel failed");
+        osal_semaphore_delete(async_sem);
+        return;
+    }
+
+    dma_chconfig.ch_dir = DMA_MEM_TO_MEM_DMAC;
+    dma_chconfig.ch_prio = 0;
+    if ((dma_config(dma_handle, &dma_chconfig) != 0) ||
+            (dma_async_start(dma_handle, DMA_ID_XFER_WIDTH8,
+            DMA_ID_XFER_WIDTH8, dma_async_done_callback, NULL) != 0))
+    {
+        ERROR("Setting up DMA queue mode failed");
+        dma_close(dma_handle);
+        osal_semaphore_delete(async_sem);
+        return;
+    }
+
+    PRINT("Submitting %u transfers to a ring of %u descriptors ...",
+            ASYNC_XFER_COUNT, DMA_ASYNC_RING_SIZE);
+    while (submitted < ASYNC_XFER_COUNT)
+    {
+        xfer.src = (uint64_t)(uintptr_t)async_src[submitted];
+        xfer.dst = (uint64_t)(uintptr_t)async_dst[submitted];
+        xfer.size = ASYNC_XFER_SIZE;
+        xfer.cookie = (void *)(uintptr_t)submitted;
+
+        ret_val = dma_async_submit(dma_handle, &xfer, 1U);
+        if (ret_val == 0)
+        {
+            submitted++;
+        }
+        else if (ret_val == -ENOSPC)
+        {
+            /* Ring is full, wait for completions to free descriptors */
+            ring_full++;
+            if (osal_semaphore_wait(async_sem, ASYNC_TIMEOUT_MS) != pdTRUE)
+            {
+                timed_out = true;
+                break;
+            }
+        }
+        else
+        {
+            ERROR("Submitting transfer %u failed", submitted);
+            break;
+        }
+    }
+
+    while ((timed_out == false) && (async_done < submitted))
+    {
+        if (osal_semaphore_wait(async_sem, ASYNC_TIMEOUT_MS) != pdTRUE)
+        {
+            timed_out = true;
+        }
+    }
+
+    (void)dma_async_stop(dma_handle);
+    dma_close(dma_handle);
+    osal_semaphore_delete(async_sem);
+
+    PRINT("%u of %u transfers completed, ring full %u times",
+            async_done, ASYNC_XFER_COUNT, ring_full);
+
+    if (timed_out == true)
+    {
+        ERROR("Timed out waiting for DMA completions");
+    }
+    else if ((submitted != ASYNC_XFER_COUNT) || (async_errors != 0U))
+    {
+        ERROR("%u transfers failed or completed out of order",
+                async_errors + (ASYNC_XFER_COUNT - submitted));
+    }
+    else
+    {
+        PRINT("Verifying data ...");
+        cache_force_invalidate((void *)async_dst, sizeof(async_dst));
+        if (memcmp(async_src, async_dst, sizeof(async_dst)) == 0)
+        {
+            PRINT("Verification PASSED");
+        }
+        else
+        {
+            ERROR("Verification FAILED");
+        }
+    }
+
+    PRINT("DMA queue mode sample completed.");
+}
@@ -17,6 +17,7 @@
 #define TASK_PRIORITY    (configMAX_PRIORITIES - 2)
 
 void dma_task();
+void dma_async_task(void);
 void run_samples( void *arg );
 
 void vApplicationTickHook( void )
@@ -64,6 +65,8 @@ void run_samples( void *arg )
 
     dma_task();
 
+    dma_async_task();
+
     vTaskSuspend(NULL);
 }
 
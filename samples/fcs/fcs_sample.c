@@ -27,6 +27,9 @@
  * - All key IDs can be configured at their corresponding macros
  * - Modes of operation can also be configured for ECC related cryptographic functions
  * - Input size can be configured in @c INPUT_DATA_SIZE macro
+ * - Size of the multi-chunk AES jobs can be configured in
+ *   @c AES_CHUNK_DATA_SIZE macro, it should stay larger than the driver
+ *   request buffer so that the job is split into several updates
  * @note Ensure the correct key ID and modes are provided
  * @section fcs_howto How to Run
  * 1. Follow the common README for build and flashing instructions.
@@ -65,6 +68,16 @@
 #define AES_IV_SIZE     16U
 #define AES_TAG_SIZE    16U
 
+/*
+ * Multi-chunk jobs, larger than the driver request buffer of 1 MB with the
+ * default FCS_MAX_REQUESTS
+ */
+#define AES_CBC_FILE          "/cb256"
+#define AES_CBC_KEY_ID        0x5D
+#define AES_CHUNK_DATA_SIZE   0x280000U
+#define AES_CHUNK_GCM_SIZE    (AES_CHUNK_DATA_SIZE - 8U)
+#define AES_CHUNK_OFFSET      4U
+
 #define DIGEST_KEY_FILE    "/hm256"
 #define DIGEST_KEY_ID      22U
 
@@ -79,6 +92,12 @@
 static FF_Disk_t *disk_obj = NULL;
 static uint8_t mount_status = UNMOUNTED;
 
+static char chunk_input[AES_CHUNK_DATA_SIZE] __attribute__((aligned(64)));
+static char chunk_cipher[AES_CHUNK_DATA_SIZE + 64U]
+__attribute__((aligned(64)));
+static char chunk_plain[AES_CHUNK_DATA_SIZE + 64U]
+__attribute__((aligned(64)));
+
 /*Functions to read data from a file_name*/
 static void fat_mount(const char *MountName)
 {
@@ -382,6 +401,127 @@ static void fcs_sample_encryption(char *session_id)
     vPortFree(key_buf);
 }
 
+/*
+ * Run AES jobs larger than one driver request buffer. The output buffers
+ * are deliberately not cache line aligned so the driver stages the data
+ * through its request buffers and splits it into several updates.
+ */
+static int fcs_sample_aes_chunk_crypt(char *session_id, uint32_t key_id,
+        uint32_t context_id, struct fcs_aes_req *aes_req, char *input_data,
+        char *output_data, uint32_t size)
+{
+    uint32_t out_len = size;
+
+    aes_req->input = input_data;
+    aes_req->ip_len = size;
+    aes_req->output = output_data;
+    aes_req->op_len = &out_len;
+    return fcs_aes_crypt(session_id, key_id, context_id, aes_req);
+}
+
+static void fcs_sample_aes_multi_chunk(char *session_id)
+{
+    int ret, i;
+    char *key_buf, *iv_data, *aad_data, *tag_data, *cipher, *plain;
+    uint32_t bytes_read, context_id = 10;
+    struct fcs_aes_req aes_req;
+
+    key_buf = (char *)pvPortMalloc(MAX_KEY_SIZE);
+    iv_data = (char *)pvPortMalloc(AES_IV_SIZE);
+    aad_data = (char *)pvPortMalloc(AES_AAD_SIZE);
+    tag_data = (char *)pvPortMalloc(AES_TAG_SIZE);
+    if ((key_buf == NULL) || (iv_data == NULL) || (aad_data == NULL) ||
+            (tag_data == NULL))
+    {
+        ERROR("Failed to allocate memory");
+        goto out;
+    }
+    cipher = &chunk_cipher[AES_CHUNK_OFFSET];
+    plain = &chunk_plain[AES_CHUNK_OFFSET];
+    for (i = 0; i < (int)AES_CHUNK_DATA_SIZE; i++)
+    {
+        chunk_input[i] = (char)(i * 7);
+    }
+    (void)memset(iv_data, 0x5A, AES_IV_SIZE);
+    (void)memset(aad_data, 0xA5, AES_AAD_SIZE);
+    (void)memset(&aes_req, 0, sizeof(aes_req));
+    aes_req.iv_source = 0;
+    aes_req.iv = iv_data;
+    aes_req.iv_len = AES_IV_SIZE;
+
+    PRINT("Importing AES-CBC key");
+    bytes_read = fat_read(AES_CBC_FILE, (void *)key_buf);
+    ret = fcs_import_service_key(session_id, key_buf, bytes_read, NULL, 0);
+    if (ret)
+    {
+        ERROR("Failed to import AES-CBC key");
+        goto out;
+    }
+    PRINT("AES256-CBC on %u bytes ....", AES_CHUNK_DATA_SIZE);
+    aes_req.block_mode = FCS_AES_CBC;
+    aes_req.crypt_mode = FCS_AES_ENCRYPT_MODE;
+    ret = fcs_sample_aes_chunk_crypt(session_id, AES_CBC_KEY_ID, context_id++,
+            &aes_req, chunk_input, cipher, AES_CHUNK_DATA_SIZE);
+    if (ret == 0)
+    {
+        aes_req.crypt_mode = FCS_AES_DECRYPT_MODE;
+        ret = fcs_sample_aes_chunk_crypt(session_id, AES_CBC_KEY_ID,
+                context_id++, &aes_req, cipher, plain, AES_CHUNK_DATA_SIZE);
+    }
+    if ((ret != 0) || (memcmp(chunk_input, plain, AES_CHUNK_DATA_SIZE) != 0))
+    {
+        ERROR("Multi-chunk AES-CBC FAILED");
+    }
+    else
+    {
+        PRINT("Multi-chunk AES-CBC PASSED");
+    }
+    (void)fcs_remove_service_key(session_id, AES_CBC_KEY_ID);
+
+    /*
+     * The GCM key was removed by the previous sample, import it again. The
+     * size is not a multiple of the block size so the last update also
+     * carries padding and the tag.
+     */
+    bytes_read = fat_read(AES_FILE, (void *)key_buf);
+    ret = fcs_import_service_key(session_id, key_buf, bytes_read, NULL, 0);
+    if (ret)
+    {
+        ERROR("Failed to import AES key");
+        goto out;
+    }
+    PRINT("AES256-GCM decrypt on %u bytes ....", AES_CHUNK_GCM_SIZE);
+    (void)memset(chunk_plain, 0, sizeof(chunk_plain));
+    aes_req.block_mode = FCS_AES_GCM;
+    aes_req.crypt_mode = FCS_AES_ENCRYPT_MODE;
+    aes_req.tag = tag_data;
+    aes_req.tag_len = 0x3;
+    aes_req.aad = aad_data;
+    aes_req.aad_len = AES_AAD_SIZE;
+    ret = fcs_sample_aes_chunk_crypt(session_id, AES_KEY_ID, context_id++,
+            &aes_req, chunk_input, cipher, AES_CHUNK_GCM_SIZE);
+    if (ret == 0)
+    {
+        aes_req.crypt_mode = FCS_AES_DECRYPT_MODE;
+        ret = fcs_sample_aes_chunk_crypt(session_id, AES_KEY_ID,
+                context_id++, &aes_req, cipher, plain, AES_CHUNK_GCM_SIZE);
+    }
+    if ((ret != 0) || (memcmp(chunk_input, plain, AES_CHUNK_GCM_SIZE) != 0))
+    {
+        ERROR("Multi-chunk AES-GCM decrypt FAILED");
+    }
+    else
+    {
+        PRINT("Multi-chunk AES-GCM decrypt PASSED");
+    }
+    (void)fcs_remove_service_key(session_id, AES_KEY_ID);
+out:
+    vPortFree(tag_data);
+    vPortFree(aad_data);
+    vPortFree(iv_data);
+    vPortFree(key_buf);
+}
+
 static void fcs_sample_get_digest(char *session_id)
 {
     char *key_buf, *input_data, *resp_data,
@@ -670,6 +810,8 @@ void fcs_task()
             fcs_qspi_sample();
             PRINT("AES Encryption");
             fcs_sample_encryption(sess_uuid);
+            PRINT("Multi-chunk AES");
+            fcs_sample_aes_multi_chunk(sess_uuid);
             PRINT("Digest Generation");
             fcs_sample_get_digest(sess_uuid);
             PRINT("Public Key and ECDH");
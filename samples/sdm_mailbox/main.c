@@ -17,6 +17,7 @@
 #define TASK_PRIORITY    (configMAX_PRIORITIES - 2)
 void run_samples( void *arg );
 void mbox_sample_task();
+void mbox_bench_task(void);
 
 void vApplicationTickHook( void )
 {
@@ -63,6 +64,8 @@ void run_samples( void *arg )
 
     mbox_sample_task();
 
+    mbox_bench_task();
+
     vTaskSuspend(NULL);
 }
 
@@ -0,0 +1,201 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (C) 2025 Altera Corporation
+ *
+ * SPDX-License-Identifier: MIT-0
+ *
+ * Transactions per second benchmark for the SDM mailbox
+ */
+
+/**
+ * @defgroup sdm_mbox_bench SDM Mailbox Benchmark
+ * @ingroup samples
+ *
+ * Throughput benchmark for the SDM mailbox client.
+ *
+ * @details
+ * @section mbx_bench_desc Description
+ * This sample opens MBOX_BENCH_CLIENTS mailbox clients, each driven by its
+ * own task. Every task keeps up to MBOX_BENCH_WINDOW hardware monitor
+ * requests in flight and resubmits as soon as a response arrives. After
+ * MBOX_BENCH_TIME_MS the completed transactions are counted and the
+ * transactions per second and the round trip latency of each client are
+ * printed.
+ *
+ * @section mbx_bench_pre Prerequisites
+ * ATF version 12 or above
+ * @section mbx_bench_howto How to Run
+ * 1. Follow the common README for build and flashing instructions.
+ * 2. Optionally override MBOX_BENCH_CLIENTS and MBOX_BENCH_WINDOW.
+ * 3. Run the sample.
+ *
+ * @section mbx_bench_res Expected Results
+ * - The transactions per second of each client and in total, and the
+ *   min/avg/max latency of each client are displayed in the console.
+ * @{
+ */
+/** @} */
+
+#include <stdint.h>
+#include <string.h>
+
+#include "osal.h"
+#include "osal_log.h"
+
+#include "socfpga_mbox_client.h"
+
+#define SIP_SMC_HWMON_TEMP       0x420000E8
+#define READ_PEAK_TEMPERATURE    0x1
+#ifndef MBOX_BENCH_CLIENTS
+#define MBOX_BENCH_CLIENTS       4U
+#endif
+#ifndef MBOX_BENCH_WINDOW
+#define MBOX_BENCH_WINDOW        4U
+#endif
+#ifndef MBOX_BENCH_TIME_MS
+#define MBOX_BENCH_TIME_MS       5000U
+#endif
+#define MBOX_BENCH_PRIORITY      (configMAX_PRIORITIES - 3)
+
+typedef struct
+{
+    sdm_client_handle handle;
+    osal_semaphore_t slots;
+    uint64_t resp_data[2];
+    uint32_t completed;
+    uint32_t errors;
+} mbox_bench_client_t;
+
+static mbox_bench_client_t bench_clients[MBOX_BENCH_CLIENTS];
+static osal_semaphore_t bench_done;
+static volatile bool bench_stop;
+
+static void mbox_bench_callback(uint64_t *resp_values, void *context)
+{
+    mbox_bench_client_t *client = (mbox_bench_client_t *)context;
+
+    if (resp_values[0] != 0U)
+    {
+        __atomic_add_fetch(&client->errors, 1U, __ATOMIC_RELAXED);
+    }
+    __atomic_add_fetch(&client->completed, 1U, __ATOMIC_RELAXED);
+    (void)osal_semaphore_post(client->slots);
+}
+
+static void mbox_bench_worker(void *param)
+{
+    mbox_bench_client_t *client = (mbox_bench_client_t *)param;
+    uint64_t channel = READ_PEAK_TEMPERATURE;
+    uint32_t i;
+
+    while (bench_stop == false)
+    {
+        (void)osal_semaphore_wait(client->slots, OSAL_TIMEOUT_WAIT_FOREVER);
+        /*
+         * All requests of a client share one response buffer, the
+         * benchmark only counts completions
+         */
+        if (sip_svc_send_ctx(client->handle, SIP_SMC_HWMON_TEMP, &channel,
+                sizeof(channel), client->resp_data,
+                sizeof(client->resp_data), client) != 0)
+        {
+            __atomic_add_fetch(&client->errors, 1U, __ATOMIC_RELAXED);
+            (void)osal_semaphore_post(client->slots);
+        }
+    }
+    /* Drain the window before reporting back */
+    for (i = 0U; i < MBOX_BENCH_WINDOW; i++)
+    {
+        (void)osal_semaphore_wait(client->slots, OSAL_TIMEOUT_WAIT_FOREVER);
+    }
+    (void)osal_semaphore_post(bench_done);
+    osal_task_delete();
+}
+
+void mbox_bench_task(void)
+{
+    mbox_latency_stats_t stats;
+    uint32_t i, opened = 0U, snapshot[MBOX_BENCH_CLIENTS], total = 0U;
+    uint64_t avg_ns;
+
+    PRINT("SDM mailbox benchmark: %u clients, window %u, %u ms",
+            MBOX_BENCH_CLIENTS, MBOX_BENCH_WINDOW, MBOX_BENCH_TIME_MS);
+    (void)mbox_init();
+    bench_stop = false;
+    bench_done = osal_semaphore_counting_create(NULL, MBOX_BENCH_CLIENTS, 0);
+    if (bench_done == NULL)
+    {
+        ERROR("Failed to create semaphore");
+        return;
+    }
+    for (i = 0U; i < MBOX_BENCH_CLIENTS; i++)
+    {
+        (void)memset(&bench_clients[i], 0, sizeof(bench_clients[i]));
+        bench_clients[i].handle = mbox_open_client();
+        if (bench_clients[i].handle == NULL)
+        {
+            ERROR("Failed to open client %u", i);
+            break;
+        }
+        bench_clients[i].slots = osal_semaphore_counting_create(NULL,
+                MBOX_BENCH_WINDOW, MBOX_BENCH_WINDOW);
+        if ((bench_clients[i].slots == NULL) ||
+                (mbox_set_window(bench_clients[i].handle,
+                (uint8_t)MBOX_BENCH_WINDOW) != 0) ||
+                (mbox_set_ctx_callback(bench_clients[i].handle,
+                mbox_bench_callback) != 0))
+        {
+            ERROR("Failed to set up client %u", i);
+            (void)mbox_close_client(bench_clients[i].handle);
+            break;
+        }
+        opened++;
+    }
+    for (i = 0U; i < opened; i++)
+    {
+        if (osal_task_create(mbox_bench_worker, "Mbox_Bench",
+                &bench_clients[i], MBOX_BENCH_PRIORITY) == false)
+        {
+            ERROR("Failed to create worker %u", i);
+            bench_stop = true;
+            opened = i;
+            break;
+        }
+    }
+
+    osal_task_delay(MBOX_BENCH_TIME_MS);
+    for (i = 0U; i < opened; i++)
+    {
+        snapshot[i] = __atomic_load_n(&bench_clients[i].completed,
+                __ATOMIC_RELAXED);
+    }
+    bench_stop = true;
+    for (i = 0U; i < opened; i++)
+    {
+        (void)osal_semaphore_wait(bench_done, OSAL_TIMEOUT_WAIT_FOREVER);
+    }
+
+    for (i = 0U; i < opened; i++)
+    {
+        total += snapshot[i];
+        PRINT("Client %u: %u transactions/s, %u errors", i,
+                (uint32_t)(((uint64_t)snapshot[i] * 1000U) /
+                MBOX_BENCH_TIME_MS), bench_clients[i].errors);
+        if ((mbox_get_latency_stats(bench_clients[i].handle, &stats) == 0) &&
+                (stats.count != 0U) && (stats.timer_freq != 0U))
+        {
+            avg_ns = ((stats.total_ticks / stats.count) * 1000000000U) /
+                    stats.timer_freq;
+            PRINT("  latency min/avg/max: %lu/%lu/%lu ns",
+                    (stats.min_ticks * 1000000000U) / stats.timer_freq,
+                    avg_ns,
+                    (stats.max_ticks * 1000000000U) / stats.timer_freq);
+        }
+        (void)mbox_close_client(bench_clients[i].handle);
+        (void)osal_semaphore_delete(bench_clients[i].slots);
+    }
+    PRINT("Total: %u transactions/s",
+            (uint32_t)(((uint64_t)total * 1000U) / MBOX_BENCH_TIME_MS));
+    (void)osal_semaphore_delete(bench_done);
+    (void)mbox_deinit();
+    PRINT("SDM mailbox benchmark completed");
+}
@@ -46,6 +46,7 @@
 #include "osal.h"
 #include "osal_log.h"
 #include "socfpga_sdmmc.h"
+#include "socfpga_sdmmc_bcache.h"
 #include "socfpga_cache.h"
 
 /* Block size of the card in bytes */
@@ -130,6 +131,17 @@ void sdmmc_task(void)
 
     PRINT("\rData written to the card successfully\r");
 
+    /*
+     * Write back and stop the block cache, so that the data is on the card
+     * and the read below comes from the card and not from the cache
+     */
+    status = sdmmc_bcache_disable();
+    if (status != 0)
+    {
+        ERROR("Block cache write back failed with status: %d", status);
+        return;
+    }
+
     cache_force_write_back((uint64_t *)read_buffer, block_size *
             number_of_blocks);
     cache_force_invalidate((uint64_t *)read_buffer, block_size *